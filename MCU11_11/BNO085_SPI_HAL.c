@@ -7,6 +7,10 @@
 #include "STM32L432KC_RCC.h"
 #include "STM32L432KC_TIMER.h"  // Provides GPIOA, GPIO_TypeDef, and ms_delay
 #include "STM32L432KC_RTT.h"    // For debug output
+#include "binlog.h"
+#include "latency_trace.h"
+#include "shtp_capture.h"
+#include "ramfunc.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>  // For NULL definition
@@ -40,11 +44,29 @@ typedef struct {
 #define SPI_SR_TXE   (1 << 1)  // Transmit buffer empty
 #define SPI_SR_BSY   (1 << 7)  // Busy flag
 
+// EXTI and SYSCFG for the H_INTN interrupt (PA1 -> EXTI1)
+#define SYSCFG_EXTICR1  (*((volatile uint32_t*)0x40010008))
+#define EXTI_IMR1       (*((volatile uint32_t*)0x40010400))
+#define EXTI_FTSR1      (*((volatile uint32_t*)0x4001040C))
+#define EXTI_PR1        (*((volatile uint32_t*)0x40010414))
+#define NVIC_ISER0      (*((volatile uint32_t*)0xE000E100))
+#define EXTI1_IRQN      7
+
+// Milliseconds spihal_read() polls H_INTN before reporting no data
+static uint8_t readWaitMs = 20;
+
+// Interrupt callbacks (NULL = none)
+static void (*dataReadyCallback)(void) = NULL;
+static void (*tickCallback)(void) = NULL;
+
 // Static HAL instance
 static sh2_Hal_t g_hal;
 
 // Forward declarations
 static uint32_t hal_getTimeUs(sh2_Hal_t *self);
+#if SHTP_CAPTURE
+static uint32_t hal_captureTimeUs(void);
+#endif
 static bool spihal_wait_for_int(void);
 static void hal_hardwareReset(void);
 static int spihal_open(sh2_Hal_t *self);
@@ -219,7 +241,8 @@ static bool spihal_wait_for_int(void) {
 
 // SPI transfer function (write and read simultaneously)
 // Added timeout to prevent infinite hanging
-static uint8_t SPI1_Transfer(uint8_t data) {
+// Runs from SRAM (ramfunc.h): called once per byte of every transfer
+static uint8_t RAMFUNC SPI1_Transfer(uint8_t data) {
     // Wait for TX buffer to be empty (with timeout)
     uint32_t timeout = 10000;  // 10000 iterations should be plenty
     while (!(SPI1->SR & SPI_SR_TXE) && timeout > 0) {
@@ -303,61 +326,50 @@ static int spihal_read(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint32_t
     static uint32_t read_call_count = 0;
     static uint32_t int_detected_count = 0;
     static uint32_t last_debug_time = 0;
+    static uint32_t oversize_count = 0;
     
     read_call_count++;
     
-    // Debug: Print first few calls and periodic status
+    // Debug: Log first few calls and periodic status (binary log: this
+    // runs in PendSV while thread mode may be printing)
     if (read_call_count <= 5 || read_call_count % 500 == 0) {
         uint32_t current_time = hal_getTimeUs(self);
         bool int_state = (GPIOA->IDR & (1 << BNO085_INT_PIN)) != 0;
-        DEBUG_PRINT("[SPI Read] Call #");
-        DEBUG_PRINT_INT(read_call_count);
-        DEBUG_PRINT(" | INT=");
-        DEBUG_PRINT(int_state ? "HIGH" : "LOW");
-        DEBUG_PRINT(" | Time=");
-        DEBUG_PRINT_INT(current_time / 1000);
-        DEBUG_PRINT(" ms");
-        if (read_call_count > 5) {
-            DEBUG_PRINT(" | Elapsed=");
-            DEBUG_PRINT_INT((current_time - last_debug_time) / 1000);
-            DEBUG_PRINT(" ms");
-        }
-        DEBUG_PRINT_NEWLINE();
+        BINLOG(BL_SPI_READ, BL_U(read_call_count), BL_U(int_state ? 1 : 0),
+               BL_U(current_time / 1000), BL_U((current_time - last_debug_time) / 1000));
         last_debug_time = current_time;
     }
     
     // Wait briefly for INT pin (data ready) - allows catching brief INT assertions
     // Per datasheet: H_INTN goes LOW when data is ready
-    // Wait up to 20ms to catch brief INT assertions (non-blocking for main loop)
+    // Wait up to readWaitMs (20ms by default) to catch brief INT assertions;
+    // with 0 the pin is checked once (interrupt-driven callers)
     bool int_asserted = false;
-    for (int i = 0; i < 20; i++) {  // 20ms wait (20 iterations * 1ms)
+    int int_checks = (readWaitMs > 0) ? readWaitMs : 1;
+    for (int i = 0; i < int_checks; i++) {  // 1ms per check
         if (!(GPIOA->IDR & (1 << BNO085_INT_PIN))) {
-            // INT is LOW (active) - data ready
+            // INT is LOW (active) - data ready; the record starts at the
+            // EXTI1 edge when there was one
+            LATENCY_TRACE_STAMP(LT_STAGE_INT);
             int_asserted = true;
             int_detected_count++;
             
-            // Debug: Print first few INT detections and periodic updates
+            // Debug: Log first few INT detections and periodic updates
             if (int_detected_count <= 3 || int_detected_count % 100 == 0) {
-                DEBUG_PRINT("[SPI Read] INT detected #");
-                DEBUG_PRINT_INT(int_detected_count);
-                DEBUG_PRINT(" (call #");
-                DEBUG_PRINT_INT(read_call_count);
-                DEBUG_PRINT(")");
-                DEBUG_PRINT_NEWLINE();
+                BINLOG(BL_SPI_INT, BL_U(int_detected_count), BL_U(read_call_count));
             }
             break;
         }
-        ms_delay(1);
+        if (i + 1 < int_checks) {
+            ms_delay(1);
+        }
     }
     
     if (!int_asserted) {
-        // INT never asserted within 20ms - no data ready
-        // Debug: Print periodic status (every 1000 calls)
+        // INT never asserted within the wait - no data ready
+        // Debug: Log periodic status (every 1000 calls)
         if (read_call_count % 1000 == 0) {
-            DEBUG_PRINT("[SPI Read] Call #");
-            DEBUG_PRINT_INT(read_call_count);
-            DEBUG_PRINT(" - INT still HIGH (no data)");
-            DEBUG_PRINT_NEWLINE();
+            BINLOG(BL_SPI_NO_DATA, BL_U(read_call_count));
         }
         return 0;
     }
@@ -573,17 +585,11 @@ static int spihal_read(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint32_t
         return 0;
     }
     
-    // Match Arduino behavior: return 0 if packet doesn't fit in buffer
-    // Let SHTP library handle fragmentation/retry
+    // Transfer larger than the buffer space shtp.c left (sh2_hal.h): drop it
+    // and log every one, since nothing upstream reports the lost data
     if (packet_size > len) {
-        if (int_detected_count <= 3) {
-            DEBUG_PRINT("[SPI Read] Packet size ");
-            DEBUG_PRINT_INT(packet_size);
-            DEBUG_PRINT(" > buffer size ");
-            DEBUG_PRINT_INT(len);
-            DEBUG_PRINT(" - returning 0 (library will handle)");
-            DEBUG_PRINT_NEWLINE();
-        }
+        oversize_count++;
+        BINLOG(BL_SPI_OVERSIZE, BL_U(packet_size), BL_U(len), BL_U(oversize_count));
         return 0;
     }
     
@@ -593,6 +599,7 @@ static int spihal_read(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint32_t
             DEBUG_PRINT("[SPI Read] Header-only packet, returning");
             DEBUG_PRINT_NEWLINE();
         }
+        SHTP_CAPTURE_RECORD(SHTP_CAPTURE_DIR_READ, pBuffer, packet_size, hal_captureTimeUs());
         if (t_us) {
             *t_us = hal_getTimeUs(self);
         }
@@ -665,6 +672,9 @@ static int spihal_read(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint32_t
         DEBUG_PRINT_NEWLINE();
     }
     
+    LATENCY_TRACE_STAMP(LT_STAGE_SPI);
+    SHTP_CAPTURE_RECORD(SHTP_CAPTURE_DIR_READ, pBuffer, packet_size, hal_captureTimeUs());
+    
     // Set timestamp
     if (t_us) {
         *t_us = hal_getTimeUs(self);
@@ -691,6 +701,8 @@ static int spihal_write(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len) {
     // Pull CS high to end transaction
     GPIOA->BSRR = (1 << BNO085_CS_PIN);  // Set bit (set high)
     
+    SHTP_CAPTURE_RECORD(SHTP_CAPTURE_DIR_WRITE, pBuffer, len, hal_captureTimeUs());
+    
     return len;
 }
 
@@ -708,8 +720,11 @@ static int spihal_write(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len) {
 static volatile uint32_t systick_ms_counter = 0;
 
 // SysTick interrupt handler (called every 1ms)
-void SysTick_Handler(void) {
+void RAMFUNC SysTick_Handler(void) {
     systick_ms_counter++;
+    if (tickCallback != NULL) {
+        tickCallback();
+    }
 }
 
 // Initialize SysTick for 1ms interrupts
@@ -718,10 +733,8 @@ static void SysTick_Init_ms(void) {
     SYSTICK_CTRL = 0;
     
     // Configure SysTick for 1ms ticks
-    // System clock is 80MHz, so 1ms = 80000 cycles
-    // LOAD register is 24-bit, so max value is 0xFFFFFF (16,777,215)
-    // 80000 fits in 24 bits, so we use 80000 - 1 = 79999
-    SYSTICK_LOAD = 79999;  // Reload value for 1ms (80000 cycles)
+    // 1ms = SYSCLK / 1000 cycles (80000 at 80MHz, well inside 24 bits)
+    SYSTICK_LOAD = RCC_GetSysclkHz() / 1000 - 1;
     SYSTICK_VAL = 0;       // Clear current value (writes to VAL clear it)
     
     // Configure SysTick:
@@ -743,6 +756,21 @@ static uint32_t hal_getTimeUs(sh2_Hal_t *self) {
     return systick_ms_counter * 1000;
 }
 
+#if SHTP_CAPTURE
+// Microsecond time for transfer captures
+// Adds the SysTick down-counter position within the current millisecond;
+// re-reads if the millisecond ticked over between the two reads.
+static uint32_t hal_captureTimeUs(void) {
+    uint32_t ms, val;
+    do {
+        ms = systick_ms_counter;
+        val = SYSTICK_VAL;
+    } while (ms != systick_ms_counter);
+    uint32_t load = SYSTICK_LOAD;
+    return ms * 1000 + (load - val) / ((load + 1) / 1000);
+}
+#endif
+
 // Initialize HAL structure
 // This should be called BEFORE sh2_open()
 // Matches Adafruit library: begin_SPI() sets up HAL, then _init() calls sh2_open()
@@ -775,3 +803,40 @@ void BNO085_SPI_HAL_DeInit(void) {
     SPI1->CR1 &= ~(1 << 6);  // SPE = 0
 }
 
+// Set how long spihal_read() polls H_INTN for data (0 = check once)
+// Bring-up uses the default 20ms; an interrupt-driven main loop only reads
+// after H_INTN has fired, so it sets 0.
+void BNO085_SPI_HAL_SetReadWait(uint8_t ms) {
+    readWaitMs = ms;
+}
+
+// H_INTN asserted (sensor hub has a transfer ready)
+bool BNO085_SPI_HAL_DataReady(void) {
+    return (GPIOA->IDR & (1 << BNO085_INT_PIN)) == 0;
+}
+
+// Call back on every H_INTN falling edge (EXTI1, interrupt context)
+void BNO085_SPI_HAL_EnableDataReadyIrq(void (*callback)(void)) {
+    dataReadyCallback = callback;
+    
+    RCC->APB2ENR |= (1 << 0);                          // SYSCFG clock
+    SYSCFG_EXTICR1 &= ~(0b111 << (4 * BNO085_INT_PIN)); // EXTI1 source = PA1
+    EXTI_FTSR1 |= (1 << BNO085_INT_PIN);                // Falling edge (H_INTN active low)
+    EXTI_PR1 = (1 << BNO085_INT_PIN);                   // Clear a stale edge
+    EXTI_IMR1 |= (1 << BNO085_INT_PIN);                 // Unmask
+    NVIC_ISER0 = (1 << EXTI1_IRQN);
+}
+
+// Call back on every 1ms SysTick (interrupt context)
+void BNO085_SPI_HAL_SetTickCallback(void (*callback)(void)) {
+    tickCallback = callback;
+}
+
+// H_INTN falling edge
+void RAMFUNC EXTI1_IRQHandler(void) {
+    EXTI_PR1 = (1 << BNO085_INT_PIN);  // Write 1 to clear
+    LATENCY_TRACE_INT_EDGE();
+    if (dataReadyCallback != NULL) {
+        dataReadyCallback();
+    }
+}
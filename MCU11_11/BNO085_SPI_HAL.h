@@ -8,6 +8,7 @@
 
 #include "sh2_hal.h"
 #include <stdint.h>
+#include <stdbool.h>
 
 // Pin definitions for BNO085
 #define BNO085_RST_PIN   0   // PA0 - NRST (Reset pin, active low)
@@ -24,6 +25,10 @@
 int BNO085_SPI_HAL_Init(sh2_Hal_t *hal);
 void BNO085_SPI_HAL_DeInit(void);
 void BNO085_HardwareReset(void);  // Public function for hardware reset
+void BNO085_SPI_HAL_SetReadWait(uint8_t ms);
+bool BNO085_SPI_HAL_DataReady(void);
+void BNO085_SPI_HAL_EnableDataReadyIrq(void (*callback)(void));
+void BNO085_SPI_HAL_SetTickCallback(void (*callback)(void));
 
 #endif // BNO085_SPI_HAL_H
 
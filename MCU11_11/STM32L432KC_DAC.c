@@ -10,6 +10,8 @@
 #include "STM32L432KC_DAC.h"
 #include "STM32L432KC_RCC.h"
 #include "STM32L432KC_TIMER.h"  // For ms_delay
+#include "STM32L432KC_DWT.h"
+#include "latency_trace.h"
 #include <stddef.h>  // For NULL
 
 // Enable DAC clock
@@ -436,52 +438,14 @@ void DAC_PlaySineWave(float frequency, uint32_t duration_ms, uint32_t sample_rat
     if (decay_samples > num_samples / 4) decay_samples = num_samples / 4;
     if (decay_samples == 0) decay_samples = 1;
     
-    // Calculate timing - CRITICAL: Verify CPU clock is actually 80MHz
-    // CPU clock (SYSCLK) should be 80MHz from PLL configuration
-    // At 80MHz: 1 cycle = 12.5ns
-    // Time per sample in microseconds = 1,000,000 / sample_rate
-    // Total cycles per sample = (1,000,000 / sample_rate) * CPU_FREQ_MHZ
-    // Example at 48kHz: 1,000,000 / 48000 = 20.833 us -> 20.833 * 80 = 1666.67 cycles
-    // 
-    // NOTE: If timing is still off, verify:
-    // 1. SYSCLK is actually 80MHz (check RCC->CFGR bits 2-3 should be 0b11 for PLL)
-    // 2. HCLK = SYSCLK (no AHB prescaler - check RCC->CFGR bits 4-7 should be 0b0000)
-    // 3. CPU is running at full speed (no sleep modes)
-    // 4. If audio sounds too slow/low res, CPU_FREQ_MHZ might be lower than 80
-    // 5. If audio sounds too fast/high pitched, CPU_FREQ_MHZ might be higher than 80
-    
-    // PLL configuration: (4MHz MSI) * (80/1) / 4 = 80MHz (expected SYSCLK)
-    // 
-    // CALCULATION FOR 48 kHz SAMPLE RATE:
-    // - Time per sample: 1,000,000 / 48,000 = 20.833 microseconds
-    // - At 80 MHz: 20.833 * 80 = 1,666.67 cycles per sample
-    //
-    // OVERHEAD BREAKDOWN (measured/estimated):
-    // - DAC_SetValue: ~30 cycles (register write + memory barriers + verification)
-    // - Direct table lookup: ~8 cycles (phase calc, 1 table lookup, modulo)
-    // - Phase wrapping (while loops): ~15 cycles (worst case, usually less)
-    // - Envelope calculation: ~35 cycles (when active: integer math, conditionals)
-    // - Loop overhead: ~12 cycles (increment, compare, branch)
-    // - Total overhead: ~100 cycles (sustain) to ~200 cycles (with envelope)
-    //
-    // Since envelope is only active at start/end, average overhead is ~130 cycles
-    // Using 150 cycles to be safe (accounts for cache misses, branch mispredictions)
-    //
-    // If audio is too low/slow: overhead is underestimated -> increase overhead_cycles
-    // If audio is too high/fast: overhead is overestimated -> decrease overhead_cycles
-    // CALIBRATED: Based on frequency measurements
-    // Test 1: 440 Hz target sounded like 330 Hz -> (20 × 330) / 440 = 15 MHz
-    // Test 2: 262 Hz target sounded like 197 Hz -> (20 × 197) / 262 = 15.04 MHz
-    // Average: 15 MHz (confirmed accurate)
-    #define CPU_FREQ_MHZ 18  // Calibrated CPU frequency in MHz
-    uint32_t us_per_sample = 1000000UL / sample_rate;
-    uint32_t total_cycles_needed = us_per_sample * CPU_FREQ_MHZ;
-    
-    // Overhead estimate - if audio is slightly too low, increase this value
-    // If audio is slightly too high, decrease this value
-    uint32_t overhead_cycles = 150;  // Reduced since we removed interpolation
-    uint32_t delay_cycles = (total_cycles_needed > overhead_cycles) ? 
-                            (total_cycles_needed - overhead_cycles) : 1;
+    // Pace samples on the DWT cycle counter against the actual SYSCLK
+    // (RCC_GetSysclkHz, checked at boot) rather than a calibrated loop count;
+    // the loop body's own cost is absorbed by waiting for an absolute deadline
+    uint32_t cycles_per_sample = RCC_GetSysclkHz() / sample_rate;
+    if (!(DWT_CTRL & DWT_CTRL_CYCCNTENA)) {
+        DWT_Init();
+    }
+    uint32_t deadline = DWT_GET_CYCLES();
     
     float phase = 0.0f;  // Always start at phase 0 to avoid phase jumps
     
@@ -519,9 +483,9 @@ void DAC_PlaySineWave(float frequency, uint32_t duration_ms, uint32_t sample_rat
         // Update phase
         phase += phase_increment;
         
-        // Delay to maintain sample rate
-        volatile uint32_t delay_count = delay_cycles;
-        while (delay_count-- > 0) {
+        // Wait for the next sample time
+        deadline += cycles_per_sample;
+        while ((int32_t)(DWT_GET_CYCLES() - deadline) < 0) {
             __asm("nop");
         }
     }
@@ -539,17 +503,12 @@ void DAC_PlayWAV(const int16_t* sample_data, uint32_t sample_length, uint32_t sa
         return;
     }
     
-    // Calculate timing - using calibrated CPU frequency
-    #define CPU_FREQ_MHZ 15  // Calibrated CPU frequency in MHz
-    uint32_t us_per_sample = 1000000UL / sample_rate;
-    uint32_t total_cycles_needed = us_per_sample * CPU_FREQ_MHZ;
-    
-    // Overhead: DAC_SetValue + loop overhead
-    // DAC_SetValue: ~30 cycles
-    // Loop overhead: ~10 cycles
-    uint32_t overhead_cycles = 50;  // Conservative estimate
-    uint32_t delay_cycles = (total_cycles_needed > overhead_cycles) ? 
-                            (total_cycles_needed - overhead_cycles) : 1;
+    // Sample clock from the actual SYSCLK (see DAC_PlaySineWave)
+    uint32_t cycles_per_sample = RCC_GetSysclkHz() / sample_rate;
+    if (!(DWT_CTRL & DWT_CTRL_CYCCNTENA)) {
+        DWT_Init();
+    }
+    uint32_t deadline = DWT_GET_CYCLES();
     
     // Play all samples
     for (uint32_t i = 0; i < sample_length; i++) {
@@ -569,10 +528,13 @@ void DAC_PlayWAV(const int16_t* sample_data, uint32_t sample_length, uint32_t sa
         
         // Output to DAC
         DAC_SetValue(DAC_CHANNEL_1, (uint16_t)dac_value);
+        if (i == 0) {
+            LATENCY_TRACE_STAMP(LT_STAGE_DAC);  // First sample of the voice is out
+        }
         
-        // Delay to maintain sample rate
-        volatile uint32_t delay_count = delay_cycles;
-        while (delay_count-- > 0) {
+        // Wait for the next sample time
+        deadline += cycles_per_sample;
+        while ((int32_t)(DWT_GET_CYCLES() - deadline) < 0) {
             __asm("nop");
         }
     }
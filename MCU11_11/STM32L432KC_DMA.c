@@ -0,0 +1,19 @@
+// STM32L432KC_DMA.c
+// DMA1 controller implementation
+
+#include "STM32L432KC_DMA.h"
+#include "STM32L432KC_RCC.h"
+
+#define RCC_AHB1ENR_DMA1EN  (1 << 0)
+
+// Enable the DMA1 clock
+void DMA1_Enable(void) {
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+    (void)RCC->AHB1ENR;  // Read back: the clock is running before the first access
+}
+
+// Route a peripheral request to a channel (1..7)
+void DMA1_SelectRequest(uint8_t channel, uint8_t request) {
+    uint32_t shift = 4 * (uint32_t)(channel - 1);
+    DMA1->CSELR = (DMA1->CSELR & ~(0xFUL << shift)) | ((uint32_t)(request & 0xF) << shift);
+}
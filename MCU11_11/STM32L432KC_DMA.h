@@ -0,0 +1,61 @@
+// STM32L432KC_DMA.h
+// DMA1 controller for STM32L432KC
+//
+// Seven channels; each peripheral request is routed to a fixed channel and
+// selected there by a 4-bit request number in CSELR (RM0394 Table 41).
+
+#ifndef STM32L432KC_DMA_H
+#define STM32L432KC_DMA_H
+
+#include <stdint.h>
+
+#define DMA1_BASE  (0x40020000UL)
+
+// Channel registers (one block per channel, 0x14 apart from offset 0x08)
+typedef struct {
+    volatile uint32_t CCR;      // Channel configuration
+    volatile uint32_t CNDTR;    // Number of data items left to transfer
+    volatile uint32_t CPAR;     // Peripheral address
+    volatile uint32_t CMAR;     // Memory address
+    uint32_t RESERVED;
+} DMA_Channel_TypeDef;
+
+typedef struct {
+    volatile uint32_t ISR;      // Interrupt status (4 flags per channel)
+    volatile uint32_t IFCR;     // Interrupt flag clear
+    DMA_Channel_TypeDef CH[7];  // Channels 1..7 at index 0..6
+    uint32_t RESERVED[5];
+    volatile uint32_t CSELR;    // Channel request selection (offset 0xA8)
+} DMA_TypeDef;
+
+#define DMA1 ((DMA_TypeDef *) DMA1_BASE)
+
+// Channel n (1..7)
+#define DMA1_CHANNEL(n)  (&DMA1->CH[(n) - 1])
+
+// CCR bits
+#define DMA_CCR_EN       (1 << 0)
+#define DMA_CCR_TCIE     (1 << 1)   // Transfer complete interrupt
+#define DMA_CCR_HTIE     (1 << 2)   // Half transfer interrupt
+#define DMA_CCR_TEIE     (1 << 3)   // Transfer error interrupt
+#define DMA_CCR_DIR      (1 << 4)   // 1 = memory to peripheral
+#define DMA_CCR_CIRC     (1 << 5)
+#define DMA_CCR_MINC     (1 << 7)   // Memory address increment
+#define DMA_CCR_PL_HIGH  (2 << 12)  // Priority level
+
+// ISR/IFCR flags for channel n: GIF, TCIF, HTIF, TEIF
+#define DMA_FLAG_GIF(n)   (1UL << (4 * ((n) - 1)))
+#define DMA_FLAG_TCIF(n)  (2UL << (4 * ((n) - 1)))
+#define DMA_FLAG_HTIF(n)  (4UL << (4 * ((n) - 1)))
+#define DMA_FLAG_TEIF(n)  (8UL << (4 * ((n) - 1)))
+
+// Request numbers used in this firmware (DMA1)
+#define DMA1_CH4_USART1_TX  2
+#define DMA1_CH6_USART2_RX  2
+#define DMA1_CH7_USART2_TX  2
+
+// Function prototypes
+void DMA1_Enable(void);
+void DMA1_SelectRequest(uint8_t channel, uint8_t request);
+
+#endif // STM32L432KC_DMA_H
@@ -0,0 +1,12 @@
+// STM32L432KC_DWT.c
+// DWT cycle counter implementation for STM32L432KC
+
+#include "STM32L432KC_DWT.h"
+
+// Enable the DWT cycle counter
+// Safe to call more than once; the counter is reset to 0 each time
+void DWT_Init(void) {
+    DEMCR |= DEMCR_TRCENA;          // Trace enable must be set before DWT is writable
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+}
@@ -0,0 +1,26 @@
+// STM32L432KC_DWT.h
+// DWT cycle counter for STM32L432KC
+//
+// Uses the Cortex-M4 Data Watchpoint and Trace unit as a free-running
+// 32-bit CPU cycle counter for timing measurements
+
+#ifndef STM32L432KC_DWT_H
+#define STM32L432KC_DWT_H
+
+#include <stdint.h>
+
+// Core debug and DWT registers (Cortex-M core peripherals)
+#define DWT_CTRL    (*((volatile uint32_t*)0xE0001000))
+#define DWT_CYCCNT  (*((volatile uint32_t*)0xE0001004))
+#define DEMCR       (*((volatile uint32_t*)0xE000EDFC))
+
+#define DEMCR_TRCENA       (1 << 24)  // Enable DWT/ITM blocks
+#define DWT_CTRL_CYCCNTENA (1 << 0)   // Enable cycle counter
+
+// Read the current cycle count (wraps every 2^32 cycles, ~53 s at 80MHz)
+#define DWT_GET_CYCLES() (DWT_CYCCNT)
+
+// Function prototypes
+void DWT_Init(void);
+
+#endif // STM32L432KC_DWT_H
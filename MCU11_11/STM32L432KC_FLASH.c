@@ -8,3 +8,104 @@ void configureFlash() {
     FLASH->ACR |= (1 << 8); // Turn on the ART
 }
 
+// Wait for the current flash operation to finish
+// Returns 0 on success, -1 if an error flag was raised
+static int flash_wait_ready(void) {
+    while (FLASH->SR & FLASH_SR_BSY) {
+        __asm("nop");
+    }
+    
+    uint32_t sr = FLASH->SR;
+    if (sr & FLASH_SR_ERRORS) {
+        FLASH->SR = sr & FLASH_SR_ERRORS;  // Error flags are cleared by writing 1
+        return -1;
+    }
+    
+    FLASH->SR = FLASH_SR_EOP;
+    return 0;
+}
+
+// Flush the data cache so reads after erase/program see the new contents
+// Reference: RM0394 Section 3.3.3 - DCRST only works while DCEN = 0
+static void flash_flush_dcache(void) {
+    uint32_t acr = FLASH->ACR;
+    if (acr & FLASH_ACR_DCEN) {
+        FLASH->ACR = acr & ~FLASH_ACR_DCEN;
+        FLASH->ACR |= FLASH_ACR_DCRST;
+        FLASH->ACR &= ~FLASH_ACR_DCRST;
+        FLASH->ACR |= FLASH_ACR_DCEN;
+    }
+}
+
+// Invalidate the ART instruction and data caches
+// Used to measure code timing with a cold cache. RM0394 Section 3.3.3:
+// ICRST/DCRST only work while the cache is disabled.
+void FLASH_ResetCaches(void) {
+    uint32_t acr = FLASH->ACR;
+    FLASH->ACR = acr & ~(FLASH_ACR_ICEN | FLASH_ACR_DCEN);
+    FLASH->ACR |= FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+    FLASH->ACR &= ~(FLASH_ACR_ICRST | FLASH_ACR_DCRST);
+    FLASH->ACR = acr;
+}
+
+// Unlock FLASH_CR for erase/program operations
+void FLASH_Unlock(void) {
+    if (FLASH->CR & FLASH_CR_LOCK) {
+        FLASH->KEYR = FLASH_KEY1;
+        FLASH->KEYR = FLASH_KEY2;
+    }
+}
+
+// Re-lock FLASH_CR
+void FLASH_Lock(void) {
+    FLASH->CR |= FLASH_CR_LOCK;
+}
+
+// Erase one 2KB page (0..FLASH_PAGE_COUNT-1)
+// Flash must be unlocked. Execution from flash stalls until the erase completes (~22ms).
+// Returns 0 on success, -1 on error
+int FLASH_ErasePage(uint32_t page) {
+    if (page >= FLASH_PAGE_COUNT) {
+        return -1;
+    }
+    
+    if (flash_wait_ready() != 0) {
+        return -1;
+    }
+    
+    FLASH->CR &= ~FLASH_CR_PNB_MASK;
+    FLASH->CR |= FLASH_CR_PER | (page << FLASH_CR_PNB_POS);
+    FLASH->CR |= FLASH_CR_STRT;
+    
+    int status = flash_wait_ready();
+    FLASH->CR &= ~(FLASH_CR_PER | FLASH_CR_PNB_MASK);
+    
+    flash_flush_dcache();
+    return status;
+}
+
+// Program one 64-bit double word at an 8-byte aligned address
+// The target double word must be erased. Flash must be unlocked.
+// Returns 0 on success, -1 on error
+int FLASH_ProgramDoubleWord(uint32_t address, uint32_t word0, uint32_t word1) {
+    if (address & 0x7) {
+        return -1;
+    }
+    
+    if (flash_wait_ready() != 0) {
+        return -1;
+    }
+    
+    FLASH->CR |= FLASH_CR_PG;
+    
+    // Both words must be written back to back (low word first)
+    *(volatile uint32_t *)address = word0;
+    __asm volatile("" ::: "memory");
+    *(volatile uint32_t *)(address + 4) = word1;
+    
+    int status = flash_wait_ready();
+    FLASH->CR &= ~FLASH_CR_PG;
+    
+    flash_flush_dcache();
+    return status;
+}
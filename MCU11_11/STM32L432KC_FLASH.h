@@ -18,18 +18,63 @@
 // Base addresses for GPIO ports
 #define FLASH_BASE (0x40022000UL) // base address of RCC
 
+// Main flash geometry (STM32L432KC: 256KB, 128 pages of 2KB)
+#define FLASH_MEM_BASE    (0x08000000UL)
+#define FLASH_PAGE_SIZE   (2048UL)
+#define FLASH_PAGE_COUNT  (128UL)
+#define FLASH_PAGE_ADDR(page) (FLASH_MEM_BASE + (uint32_t)(page) * FLASH_PAGE_SIZE)
+
+// Unlock keys (RM0394 Section 3.3.5)
+#define FLASH_KEY1  (0x45670123UL)
+#define FLASH_KEY2  (0xCDEF89ABUL)
+
+// FLASH_SR bits
+#define FLASH_SR_EOP      (1UL << 0)
+#define FLASH_SR_OPERR    (1UL << 1)
+#define FLASH_SR_PROGERR  (1UL << 3)
+#define FLASH_SR_WRPERR   (1UL << 4)
+#define FLASH_SR_PGAERR   (1UL << 5)
+#define FLASH_SR_SIZERR   (1UL << 6)
+#define FLASH_SR_PGSERR   (1UL << 7)
+#define FLASH_SR_MISERR   (1UL << 8)
+#define FLASH_SR_FASTERR  (1UL << 9)
+#define FLASH_SR_RDERR    (1UL << 14)
+#define FLASH_SR_OPTVERR  (1UL << 15)
+#define FLASH_SR_BSY      (1UL << 16)
+#define FLASH_SR_ERRORS   (FLASH_SR_OPERR | FLASH_SR_PROGERR | FLASH_SR_WRPERR | \
+                           FLASH_SR_PGAERR | FLASH_SR_SIZERR | FLASH_SR_PGSERR | \
+                           FLASH_SR_MISERR | FLASH_SR_FASTERR | FLASH_SR_RDERR | \
+                           FLASH_SR_OPTVERR)
+
+// FLASH_CR bits
+#define FLASH_CR_PG       (1UL << 0)
+#define FLASH_CR_PER      (1UL << 1)
+#define FLASH_CR_PNB_POS  3
+#define FLASH_CR_PNB_MASK (0xFFUL << FLASH_CR_PNB_POS)
+#define FLASH_CR_STRT     (1UL << 16)
+#define FLASH_CR_LOCK     (1UL << 31)
+
+// FLASH_ACR bits
+#define FLASH_ACR_PRFTEN  (1UL << 8)
+#define FLASH_ACR_ICEN    (1UL << 9)
+#define FLASH_ACR_DCEN    (1UL << 10)
+#define FLASH_ACR_ICRST   (1UL << 11)
+#define FLASH_ACR_DCRST   (1UL << 12)
+
 ///////////////////////////////////////////////////////////////////////////////
 // Bitfield struct for GPIO
 ///////////////////////////////////////////////////////////////////////////////
 
 typedef struct {
   __IO uint32_t ACR;      /*!< FLASH access control register,   Address offset: 0x00 */
-  __IO uint32_t KEYR;     /*!< FLASH key register,              Address offset: 0x04 */
-  __IO uint32_t OPTKEYR;  /*!< FLASH option key register,       Address offset: 0x08 */
-  __IO uint32_t SR;       /*!< FLASH status register,           Address offset: 0x0C */
-  __IO uint32_t CR;       /*!< FLASH control register,          Address offset: 0x10 */
-  __IO uint32_t OPTCR;    /*!< FLASH option control register ,  Address offset: 0x14 */
-  __IO uint32_t OPTCR1;   /*!< FLASH option control register 1, Address offset: 0x18 */
+  __IO uint32_t PDKEYR;   /*!< FLASH power down key register,   Address offset: 0x04 */
+  __IO uint32_t KEYR;     /*!< FLASH key register,              Address offset: 0x08 */
+  __IO uint32_t OPTKEYR;  /*!< FLASH option key register,       Address offset: 0x0C */
+  __IO uint32_t SR;       /*!< FLASH status register,           Address offset: 0x10 */
+  __IO uint32_t CR;       /*!< FLASH control register,          Address offset: 0x14 */
+  __IO uint32_t ECCR;     /*!< FLASH ECC register,              Address offset: 0x18 */
+  uint32_t      RESERVED; /*!< Reserved,                        Address offset: 0x1C */
+  __IO uint32_t OPTR;     /*!< FLASH option register,           Address offset: 0x20 */
 } FLASH_TypeDef;
 
 #define FLASH ((FLASH_TypeDef *) FLASH_BASE)
@@ -39,6 +84,10 @@ typedef struct {
 ///////////////////////////////////////////////////////////////////////////////
 
 void configureFlash(void);
+void FLASH_ResetCaches(void);
+void FLASH_Unlock(void);
+void FLASH_Lock(void);
+int FLASH_ErasePage(uint32_t page);
+int FLASH_ProgramDoubleWord(uint32_t address, uint32_t word0, uint32_t word1);
 
 #endif
-
@@ -0,0 +1,32 @@
+// STM32L432KC_NVIC.c
+// NVIC and system handler priority control implementation
+
+#include "STM32L432KC_NVIC.h"
+
+// Set a device interrupt's priority (0..15, 0 = highest)
+void NVIC_SetPriority(uint8_t irqn, uint8_t priority) {
+    NVIC_IPR_BASE[irqn] = (uint8_t)((priority & 0x0F) << (8 - NVIC_PRIO_BITS));
+}
+
+// Set the priority of PendSV or SysTick (0..15)
+void NVIC_SetSystemPriority(uint8_t handler, uint8_t priority) {
+    uint32_t shift = (handler == NVIC_SYS_SYSTICK) ? 24 : 16;
+    uint32_t value = (uint32_t)((priority & 0x0F) << (8 - NVIC_PRIO_BITS));
+    SCB_SHPR3 = (SCB_SHPR3 & ~(0xFFUL << shift)) | (value << shift);
+}
+
+// Enable a device interrupt
+void NVIC_EnableIRQ(uint8_t irqn) {
+    NVIC_ISER_BASE[irqn >> 5] = 1UL << (irqn & 31);
+}
+
+// Disable a device interrupt
+void NVIC_DisableIRQ(uint8_t irqn) {
+    NVIC_ICER_BASE[irqn >> 5] = 1UL << (irqn & 31);
+    __asm volatile ("dsb\n\tisb" : : : "memory");
+}
+
+// Pend a device interrupt from software
+void NVIC_SetPendingIRQ(uint8_t irqn) {
+    NVIC_ISPR_BASE[irqn >> 5] = 1UL << (irqn & 31);
+}
@@ -0,0 +1,49 @@
+// STM32L432KC_NVIC.h
+// NVIC and system handler priority control for STM32L432KC
+//
+// The STM32L4 implements 4 priority bits (16 levels, 0 = highest). With the
+// reset priority grouping every bit is a preemption bit, so a lower number
+// always preempts a higher one.
+
+#ifndef STM32L432KC_NVIC_H
+#define STM32L432KC_NVIC_H
+
+#include <stdint.h>
+
+// Cortex-M4 core registers
+#define NVIC_ISER_BASE  ((volatile uint32_t*)0xE000E100)  // Interrupt set-enable
+#define NVIC_ICER_BASE  ((volatile uint32_t*)0xE000E180)  // Interrupt clear-enable
+#define NVIC_ISPR_BASE  ((volatile uint32_t*)0xE000E200)  // Interrupt set-pending
+#define NVIC_IPR_BASE   ((volatile uint8_t*)0xE000E400)   // Interrupt priority (one byte per IRQ)
+#define SCB_ICSR        (*((volatile uint32_t*)0xE000ED04))
+#define SCB_SHPR3       (*((volatile uint32_t*)0xE000ED20))  // PendSV [23:16], SysTick [31:24]
+
+#define SCB_ICSR_PENDSVSET  (1UL << 28)
+#define NVIC_PRIO_BITS      4
+
+// Device interrupt numbers (RM0394 Table 46)
+#define IRQN_EXTI1       7
+#define IRQN_DMA1_CH4    14
+#define IRQN_DMA1_CH6    16
+#define IRQN_DMA1_CH7    17
+#define IRQN_SPI1        35
+#define IRQN_USART1      37
+#define IRQN_USART2      38
+#define IRQN_TIM6_DAC    54
+#define IRQN_TIM7        55
+
+// System handlers that have a settable priority
+#define NVIC_SYS_PENDSV   0
+#define NVIC_SYS_SYSTICK  1
+
+// Request PendSV (runs when no higher-priority handler is active)
+#define NVIC_TRIGGER_PENDSV()  (SCB_ICSR = SCB_ICSR_PENDSVSET)
+
+// Function prototypes
+void NVIC_SetPriority(uint8_t irqn, uint8_t priority);
+void NVIC_SetSystemPriority(uint8_t handler, uint8_t priority);
+void NVIC_EnableIRQ(uint8_t irqn);
+void NVIC_DisableIRQ(uint8_t irqn);
+void NVIC_SetPendingIRQ(uint8_t irqn);
+
+#endif // STM32L432KC_NVIC_H
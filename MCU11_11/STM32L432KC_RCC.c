@@ -4,6 +4,10 @@
 #include "STM32L432KC_RCC.h"
 #include "STM32L432KC_RTT.h"  // For debug output
 
+// Current SYSCLK in Hz: MSI 4MHz out of reset, 80MHz once the PLL is selected,
+// or the value measured by the boot clock check (clock_check.c)
+static uint32_t sysclkHz = RCC_MSI_RESET_HZ;
+
 void configurePLL() {
     // Set clock to 80 MHz
     // PLL Formula: SYSCLK = (MSI / PLLM) * PLLN / PLLR
@@ -116,8 +120,9 @@ void configureClock(){
     
     // Wait until PLL is selected as system clock (bits 2-3: SWS should be 0b11)
     DEBUG_PRINTLN("  Waiting for clock switch...");
+    // SWS must read back PLL (0b11); any other value means the switch failed
     int timeout = 10000;
-    while(!((RCC->CFGR >> 2) & 0b11) && timeout-- > 0);
+    while (((RCC->CFGR >> 2) & 0b11) != 0b11 && timeout-- > 0);
     if (timeout <= 0) {
         DEBUG_PRINTLN("  ERROR: Clock switch timeout!");
         return;
@@ -149,5 +154,22 @@ void configureClock(){
     }
     
     // Now SYSCLK = 80MHz, HCLK = 80MHz, APB1 = 80MHz, APB2 = 80MHz
+    sysclkHz = RCC_PLL_SYSCLK_HZ;
+}
+
+// SYSCLK in Hz (HCLK and both APB clocks run at the same rate)
+// Delay loops, SysTick, timers and baud rates derive their constants from it.
+uint32_t RCC_GetSysclkHz(void) {
+    return sysclkHz;
+}
+
+// Replace the nominal SYSCLK with a measured value
+void RCC_SetSysclkHz(uint32_t hz) {
+    sysclkHz = hz;
+}
+
+// Clock source currently driving SYSCLK (CFGR SWS: 0 MSI, 1 HSI16, 2 HSE, 3 PLL)
+uint32_t RCC_GetSysclkSource(void) {
+    return (RCC->CFGR >> 2) & 0b11;
 }
 
@@ -19,6 +19,16 @@
 #define PLLSRC_HSI 0
 #define PLLSRC_HSE 1
 
+// SYSCLK after reset (MSI range 6) and after configureClock() (PLL)
+#define RCC_MSI_RESET_HZ   4000000UL
+#define RCC_PLL_SYSCLK_HZ  80000000UL
+
+// SYSCLK sources as read back from CFGR SWS
+#define RCC_SWS_MSI    0
+#define RCC_SWS_HSI16  1
+#define RCC_SWS_HSE    2
+#define RCC_SWS_PLL    3
+
 // Clock configuration
 #define SW_HSI  0
 #define SW_HSE  1
@@ -79,6 +89,9 @@ typedef struct
 
 void configurePLL(void);
 void configureClock(void);
+uint32_t RCC_GetSysclkHz(void);
+void RCC_SetSysclkHz(uint32_t hz);
+uint32_t RCC_GetSysclkSource(void);
 
 #endif
 
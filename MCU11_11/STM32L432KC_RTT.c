@@ -50,3 +50,10 @@ void RTT_PrintNewline(void) {
     RTT_PrintChar('\n');
 }
 
+
+// Write raw bytes (binary data, no formatting or newline translation)
+void RTT_Write(const void *data, uint32_t len) {
+    if (data != NULL && len > 0) {
+        fwrite(data, 1, len, stdout);
+    }
+}
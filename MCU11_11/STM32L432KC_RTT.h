@@ -21,6 +21,7 @@ void RTT_PrintInt(int32_t num);
 void RTT_PrintFloat(float num, int decimals);
 void RTT_PrintHex(uint32_t num);
 void RTT_PrintNewline(void);
+void RTT_Write(const void *data, uint32_t len);
 
 // Convenience macros (replacing UART macros)
 #define DEBUG_PRINT(str) RTT_PrintStr(str)
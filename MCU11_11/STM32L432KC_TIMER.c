@@ -9,14 +9,15 @@
 
 #include "STM32L432KC_TIMER.h"
 #include "STM32L432KC_RCC.h"
+#include "STM32L432KC_DWT.h"
 
 // Initialize TIM2 for PWM generation
 void TIM2_Init(void) {
     // Enable TIM2 clock
     RCC->APB1ENR1 |= (1 << 0);
     
-    // Configure for 1MHz timer frequency (80MHz / 80)
-    TIM2->PSC = 79;  // 80MHz / 80 = 1MHz
+    // Configure for 1MHz timer frequency (SYSCLK / (SYSCLK in MHz))
+    TIM2->PSC = RCC_GetSysclkHz() / 1000000 - 1;
     
     // Set default values
     TIM2->ARR = 1000;  // Default 1kHz
@@ -60,12 +61,18 @@ void TIM2_SetFrequency(uint32_t frequency) {
     TIM2_Start();
 }
 
-// Function for dummy delay by executing nops
-// Calibrated for 80MHz system clock
+// Busy-wait on the DWT cycle counter, so the delay is right at any SYSCLK
+// (MSI before configureClock(), the PLL after) instead of assuming a loop
+// cost. The counter is started if needed but never reset here, since the
+// latency tracer and scheduler measure spans across delays.
 void ms_delay(int ms) {
+   if (!(DWT_CTRL & DWT_CTRL_CYCCNTENA)) {
+      DWT_Init();
+   }
+   uint32_t cycles_per_ms = RCC_GetSysclkHz() / 1000;
    while (ms-- > 0) {
-      volatile int x=8000;  // 8,000 NOPs for 1ms at 80MHz
-      while (x-- > 0)
+      uint32_t start = DWT_GET_CYCLES();
+      while (DWT_GET_CYCLES() - start < cycles_per_ms)
          __asm("nop");
    }
 }
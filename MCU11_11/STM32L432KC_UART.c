@@ -43,9 +43,8 @@ void UART_Init(uint32_t baudrate) {
     
     // Configure USART2
     // BRR calculation: BRR = fCK / baudrate
-    // For 80MHz PCLK and 115200 baud: BRR = 80000000 / 115200 = 694.44
-    // BRR = 0x02B6 (mantissa = 0x2B6 = 694, fraction = 0x6 = 0.375)
-    uint32_t pclk = 80000000;  // APB1 clock (80MHz)
+    // APB1 runs undivided, so fCK is SYSCLK (80MHz: 80000000 / 115200 = 694)
+    uint32_t pclk = RCC_GetSysclkHz();
     uint32_t brr_value = pclk / baudrate;
     USART2->BRR = brr_value;
     
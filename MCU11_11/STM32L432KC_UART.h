@@ -9,27 +9,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
-
-// USART2 base address
-#define USART2_BASE (0x40004400UL)
-
-// USART register structure
-typedef struct {
-    volatile uint32_t CR1;      // Control register 1
-    volatile uint32_t CR2;       // Control register 2
-    volatile uint32_t CR3;      // Control register 3
-    volatile uint32_t BRR;      // Baud rate register
-    volatile uint32_t GTPR;     // Guard time and prescaler
-    volatile uint32_t RTOR;     // Receiver timeout
-    volatile uint32_t RQR;      // Request register
-    volatile uint32_t ISR;      // Interrupt and status register
-    volatile uint32_t ICR;      // Interrupt flag clear register
-    volatile uint32_t RDR;      // Receive data register
-    volatile uint32_t TDR;      // Transmit data register
-    volatile uint32_t PRESC;    // Prescaler register
-} USART_TypeDef;
-
-#define USART2 ((USART_TypeDef *) USART2_BASE)
+#include "STM32L432KC_USART.h"
 
 // Function prototypes
 void UART_Init(uint32_t baudrate);
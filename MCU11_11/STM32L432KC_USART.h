@@ -0,0 +1,64 @@
+// STM32L432KC_USART.h
+// USART registers for STM32L432KC
+//
+// Register map and bit definitions shared by the polled debug output
+// (STM32L432KC_UART.c) and the DMA-driven serial link (serial_link.c).
+
+#ifndef STM32L432KC_USART_H
+#define STM32L432KC_USART_H
+
+#include <stdint.h>
+
+// USART base addresses
+#define USART1_BASE (0x40013800UL)
+#define USART2_BASE (0x40004400UL)
+
+// USART register structure
+typedef struct {
+    volatile uint32_t CR1;      // Control register 1
+    volatile uint32_t CR2;       // Control register 2
+    volatile uint32_t CR3;      // Control register 3
+    volatile uint32_t BRR;      // Baud rate register
+    volatile uint32_t GTPR;     // Guard time and prescaler
+    volatile uint32_t RTOR;     // Receiver timeout
+    volatile uint32_t RQR;      // Request register
+    volatile uint32_t ISR;      // Interrupt and status register
+    volatile uint32_t ICR;      // Interrupt flag clear register
+    volatile uint32_t RDR;      // Receive data register
+    volatile uint32_t TDR;      // Transmit data register
+    volatile uint32_t PRESC;    // Prescaler register
+} USART_TypeDef;
+
+#define USART1 ((USART_TypeDef *) USART1_BASE)
+#define USART2 ((USART_TypeDef *) USART2_BASE)
+
+// CR1 bits
+#define USART_CR1_UE      (1 << 0)   // USART enable
+#define USART_CR1_RE      (1 << 2)   // Receiver enable
+#define USART_CR1_TE      (1 << 3)   // Transmitter enable
+#define USART_CR1_IDLEIE  (1 << 4)   // Idle line interrupt enable
+
+// CR3 bits
+#define USART_CR3_EIE     (1 << 0)   // Error interrupt enable
+#define USART_CR3_DMAR    (1 << 6)   // DMA receive
+#define USART_CR3_DMAT    (1 << 7)   // DMA transmit
+#define USART_CR3_OVRDIS  (1 << 12)  // Overrun does not stop reception
+
+// ISR bits
+#define USART_ISR_FE      (1 << 1)   // Framing error
+#define USART_ISR_NE      (1 << 2)   // Noise
+#define USART_ISR_ORE     (1 << 3)   // Overrun
+#define USART_ISR_IDLE    (1 << 4)   // Idle line detected
+#define USART_ISR_TC      (1 << 6)   // Transmission complete
+#define USART_ISR_TXE     (1 << 7)   // Transmit data register empty
+
+// ICR bits (write 1 to clear the matching ISR flag)
+#define USART_ICR_FECF    (1 << 1)
+#define USART_ICR_NCF     (1 << 2)
+#define USART_ICR_ORECF   (1 << 3)
+#define USART_ICR_IDLECF  (1 << 4)
+
+// BRR for 16x oversampling (the USART kernel clock is PCLK = SYSCLK here)
+#define USART_BRR(clk, baud)  (((clk) + (baud) / 2) / (baud))
+
+#endif // STM32L432KC_USART_H
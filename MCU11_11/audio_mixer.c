@@ -0,0 +1,149 @@
+// audio_mixer.c
+// Interrupt-driven drum voice mixer implementation
+
+#include "audio_mixer.h"
+#include "irq_priority.h"
+#include "latency_trace.h"
+#include "ramfunc.h"
+#include "STM32L432KC_NVIC.h"
+#include "STM32L432KC_RCC.h"
+#include "STM32L432KC_DAC.h"
+#include "STM32L432KC_TIMER.h"  // For TIM_TypeDef
+#include <stdint.h>
+#include <stddef.h>  // For NULL definition
+
+// TIM6: basic timer on APB1 (80MHz)
+#define TIM6  ((TIM_TypeDef *) 0x40001000UL)
+#define RCC_APB1ENR1_TIM6EN  (1 << 4)
+
+// Timer reload for the sample rate (80MHz / 3628 = 22050.7 Hz)
+// Timer clock is SYSCLK (APB1 undivided), read at init
+#define MIXER_ARR(clk)  (((clk) + MIXER_SAMPLE_RATE / 2) / MIXER_SAMPLE_RATE - 1)
+
+// One playing sample
+// The handler only reads a voice while pos < length. Mixer_Play clears
+// length before changing data, so the handler never sees a half-written
+// voice and the audio interrupt is never masked.
+typedef struct {
+    const int16_t *data;
+    volatile uint32_t length;
+    volatile uint32_t pos;
+    volatile uint8_t traced;  // Stamp LT_STAGE_DAC on the first sample
+} MixerVoice_t;
+
+static MixerVoice_t voices[MIXER_VOICES];
+
+// Start the sample clock (DAC must already be initialized)
+void Mixer_Init(void) {
+    for (int v = 0; v < MIXER_VOICES; v++) {
+        voices[v].length = 0;
+        voices[v].pos = 0;
+        voices[v].data = NULL;
+        voices[v].traced = 0;
+    }
+    
+    RCC->APB1ENR1 |= RCC_APB1ENR1_TIM6EN;
+    
+    TIM6->CR1 = 0;
+    TIM6->PSC = 0;
+    TIM6->ARR = MIXER_ARR(RCC_GetSysclkHz());
+    TIM6->EGR = 1;   // Load PSC/ARR
+    TIM6->SR = 0;
+    TIM6->DIER = 1;  // Update interrupt
+    
+    NVIC_SetPriority(IRQN_TIM6_DAC, IRQ_PRIO_AUDIO);
+    NVIC_EnableIRQ(IRQN_TIM6_DAC);
+    TIM6->CR1 = 1;   // CEN
+}
+
+// Start a sample on a free voice, or on the one that has played longest
+// Callers in thread mode and PendSV are serialized with BASEPRI.
+void Mixer_Play(const int16_t *data, uint32_t length) {
+    if (data == NULL || length == 0) {
+        return;
+    }
+    
+    uint32_t basepri = irq_mask_sensor();
+    int best = 0;
+    uint32_t bestPos = 0;
+    for (int v = 0; v < MIXER_VOICES; v++) {
+        uint32_t pos = voices[v].pos;
+        if (pos >= voices[v].length) {
+            best = v;
+            break;
+        }
+        if (pos > bestPos) {
+            bestPos = pos;
+            best = v;
+        }
+    }
+    
+    MixerVoice_t *voice = &voices[best];
+    voice->length = 0;
+    __asm volatile ("" : : : "memory");
+    voice->data = data;
+    voice->pos = 0;
+    voice->traced = LATENCY_TRACE;
+    __asm volatile ("" : : : "memory");
+    voice->length = length;
+    irq_unmask(basepri);
+}
+
+// Silence all voices
+void Mixer_Stop(void) {
+    for (int v = 0; v < MIXER_VOICES; v++) {
+        voices[v].length = 0;
+    }
+}
+
+// Voices still sounding
+uint8_t Mixer_ActiveVoices(void) {
+    uint8_t active = 0;
+    for (int v = 0; v < MIXER_VOICES; v++) {
+        if (voices[v].pos < voices[v].length) {
+            active++;
+        }
+    }
+    return active;
+}
+
+// Mix one sample from every voice and write it to the DAC
+// Same scaling as DAC_PlayWAV (2048 + sample >> 4); overlapping voices clip.
+static inline __attribute__((always_inline)) void render_sample(void) {
+    int32_t mix = 0;
+    for (int v = 0; v < MIXER_VOICES; v++) {
+        MixerVoice_t *voice = &voices[v];
+        uint32_t pos = voice->pos;
+        if (pos < voice->length) {
+            mix += voice->data[pos];
+            voice->pos = pos + 1;
+            if (voice->traced) {
+                voice->traced = 0;
+                LATENCY_TRACE_STAMP(LT_STAGE_DAC);  // First sample of the voice is out
+            }
+        }
+    }
+    
+    int32_t dac_value = 2048 + (mix >> 4);
+    if (dac_value < 0) dac_value = 0;
+    if (dac_value > 4095) dac_value = 4095;
+    DAC->DHR12R1 = (uint32_t)dac_value;
+}
+
+// Render one sample outside the interrupt (benchmarks)
+void RAMFUNC Mixer_RenderSample(void) {
+    render_sample();
+}
+
+#if RAMFUNC_BENCHMARK
+// The same render, left in flash, for the flash/SRAM comparison
+void __attribute__((noinline)) Mixer_RenderSampleFlash(void) {
+    render_sample();
+}
+#endif
+
+// Sample clock (TIM6 update, 22050 Hz)
+void RAMFUNC TIM6_DAC_IRQHandler(void) {
+    TIM6->SR = 0;
+    render_sample();
+}
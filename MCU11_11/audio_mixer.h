@@ -0,0 +1,38 @@
+// audio_mixer.h
+// Interrupt-driven drum voice mixer on the DAC
+//
+// TIM6 interrupts at the sample rate (highest priority in irq_priority.h) and
+// the handler writes one mixed sample to DAC channel 1. Up to MIXER_VOICES
+// samples sound at once; starting a voice returns immediately, so the sensor
+// and detection path keep running while a drum rings out. When all voices
+// are busy the one that has played longest is replaced.
+
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <stdint.h>
+#include "ramfunc.h"
+
+// Play drums through the mixer (0 = blocking DAC_PlayWAV)
+#ifndef AUDIO_USE_MIXER
+#define AUDIO_USE_MIXER  1
+#endif
+
+// Simultaneous voices (8 fit in the SRAM freed from the SHTP buffers; the
+// render cost per sample grows with the voices that are playing)
+#define MIXER_VOICES  8
+
+// Output sample rate (all samples in wav_arrays/ are 22050 Hz)
+#define MIXER_SAMPLE_RATE  22050
+
+// Function prototypes
+void Mixer_Init(void);
+void Mixer_Play(const int16_t *data, uint32_t length);
+void Mixer_Stop(void);
+uint8_t Mixer_ActiveVoices(void);
+void Mixer_RenderSample(void);
+#if RAMFUNC_BENCHMARK
+void Mixer_RenderSampleFlash(void);
+#endif
+
+#endif // AUDIO_MIXER_H
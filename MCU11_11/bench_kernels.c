@@ -0,0 +1,152 @@
+// bench_kernels.c
+// Workload kernels for on-target and host micro-benchmarks implementation
+
+#include "bench_kernels.h"
+#include "drum_detection.h"
+#include "sh2.h"
+#include "sh2_SensorValue.h"
+#include "wav_arrays/drum_samples.h"
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+// Canned reports per cycle: a slow swing with no hit, so the detector stays
+// on its per-sample path (hits print and would dominate the timing)
+#define BENCH_FRAMES  32
+
+// Samples mixed per mixer kernel call (one TIM6 interrupt each)
+#define BENCH_MIX_SAMPLES  32
+#define BENCH_MIX_VOICES   4
+
+static sh2_SensorEvent_t events[3 * BENCH_FRAMES];
+static sh2_SensorValue_t values[3 * BENCH_FRAMES];
+static uint32_t next = 0;
+
+static DrumHitState_t state;
+
+static const int16_t *mixData[BENCH_MIX_VOICES];
+static uint32_t mixLength[BENCH_MIX_VOICES];
+static uint32_t mixPos[BENCH_MIX_VOICES];
+
+// Results are folded in here so the compiler cannot drop the work
+static volatile uint32_t sink = 0;
+
+static void put16(uint8_t *p, float value, float scale) {
+    int16_t v = (int16_t)lrintf(value * scale);
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+}
+
+// SH2 input report as the BNO085 sends it (quaternion Q14, gyro Q9, accel Q8)
+static void build_event(sh2_SensorEvent_t *ev, uint8_t reportId, uint8_t seq, const float v[4]) {
+    memset(ev, 0, sizeof *ev);
+    ev->reportId = reportId;
+    ev->report[0] = reportId;
+    ev->report[1] = seq;
+    ev->report[2] = 3;  // Status: high accuracy
+    
+    if (reportId == SH2_GAME_ROTATION_VECTOR) {
+        ev->len = 12;
+        for (int i = 0; i < 4; i++) {
+            put16(&ev->report[4 + 2 * i], v[i], 16384.0f);
+        }
+    } else {
+        ev->len = 10;
+        float scale = (reportId == SH2_GYROSCOPE_CALIBRATED) ? 512.0f : 256.0f;
+        for (int i = 0; i < 3; i++) {
+            put16(&ev->report[4 + 2 * i], v[i], scale);
+        }
+    }
+}
+
+// Build the canned inputs and reset the kernel state
+void BenchKernels_Init(void) {
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        float a = 0.25f * sinf(6.2832f * f / BENCH_FRAMES);  // +-0.25 rad yaw swing
+        float quat[4] = { 0.0f, 0.0f, sinf(a / 2.0f), cosf(a / 2.0f) };  // i, j, k, real
+        float gyro[4] = { 0.05f, 0.4f * cosf(6.2832f * f / BENCH_FRAMES), 0.1f, 0.0f };
+        float accel[4] = { 0.2f, -0.1f, 0.3f, 0.0f };
+        
+        build_event(&events[3 * f], SH2_GAME_ROTATION_VECTOR, (uint8_t)f, quat);
+        build_event(&events[3 * f + 1], SH2_GYROSCOPE_CALIBRATED, (uint8_t)f, gyro);
+        build_event(&events[3 * f + 2], SH2_LINEAR_ACCELERATION, (uint8_t)f, accel);
+    }
+    for (int n = 0; n < 3 * BENCH_FRAMES; n++) {
+        sh2_decodeSensorEvent(&values[n], &events[n]);
+    }
+    next = 0;
+    
+    memset(&state, 0, sizeof state);
+    state.lastDrumSound = DRUM_NONE;
+    
+    const int16_t *data[BENCH_MIX_VOICES] = {
+        kick_sample_data, snare_sample_data, hihat_closed_sample_data, crash_sample_data
+    };
+    const uint32_t *length[BENCH_MIX_VOICES] = {
+        &kick_sample_length, &snare_sample_length, &hihat_closed_sample_length, &crash_sample_length
+    };
+    for (int v = 0; v < BENCH_MIX_VOICES; v++) {
+        mixData[v] = data[v];
+        mixLength[v] = *length[v];
+        mixPos[v] = 0;
+    }
+    
+    sink = 0;
+}
+
+// Folded results of all kernel calls (compare host and target runs)
+uint32_t BenchKernels_Checksum(void) {
+    return sink;
+}
+
+// Decode one report
+static void kernel_decode(void) {
+    sh2_SensorValue_t value;
+    sh2_decodeSensorEvent(&value, &events[next]);
+    sink += (uint32_t)value.sequence;
+    next = (next + 1) % (3 * BENCH_FRAMES);
+}
+
+// Run one decoded report through the detector
+static void kernel_detect(void) {
+    uint8_t drumId = DrumDetection_ProcessSensorData(&values[next], &state);
+    sink += drumId;
+    next = (next + 1) % (3 * BENCH_FRAMES);
+}
+
+// Mix BENCH_MIX_SAMPLES output samples from four voices
+// Same arithmetic as the audio_mixer.c render interrupt, minus the DAC write
+static void kernel_mix(void) {
+    uint32_t out = 0;
+    for (int n = 0; n < BENCH_MIX_SAMPLES; n++) {
+        int32_t mix = 0;
+        for (int v = 0; v < BENCH_MIX_VOICES; v++) {
+            uint32_t pos = mixPos[v];
+            mix += mixData[v][pos];
+            mixPos[v] = (pos + 1 < mixLength[v]) ? pos + 1 : 0;
+        }
+        int32_t dac_value = 2048 + (mix >> 4);
+        if (dac_value < 0) dac_value = 0;
+        if (dac_value > 4095) dac_value = 4095;
+        out += (uint32_t)dac_value;
+    }
+    sink += out;
+}
+
+// Convert one quaternion to Euler angles
+static void kernel_euler(void) {
+    const sh2_SensorValue_t *q = &values[3 * (next % BENCH_FRAMES)];
+    float roll, pitch, yaw;
+    DrumDetection_QuaternionToEuler(q->un.gameRotationVector.real, q->un.gameRotationVector.i,
+                                    q->un.gameRotationVector.j, q->un.gameRotationVector.k,
+                                    &roll, &pitch, &yaw);
+    sink += (uint32_t)(int32_t)(yaw * 100.0f);
+    next = (next + 1) % (3 * BENCH_FRAMES);
+}
+
+const BenchKernel_t benchKernels[BENCH_NUM_KERNELS] = {
+    { "decode", kernel_decode },
+    { "detect", kernel_detect },
+    { "mix",    kernel_mix },
+    { "euler",  kernel_euler },
+};
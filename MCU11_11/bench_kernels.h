@@ -0,0 +1,32 @@
+// bench_kernels.h
+// Workload kernels for on-target and host micro-benchmarks
+//
+// Each kernel runs one representative unit of the real-time path on canned
+// inputs: SH2 report decoding, drum detection, voice mixing and the
+// quaternion to Euler conversion. The kernels have no hardware dependencies,
+// so the same code is timed with DWT on the board (flash_bench.c) and with
+// the host clock (host/bench_host.c) to compare builds across commits.
+//
+// The detection kernel drives the real detector state: call
+// DrumDetection_Init() after benchmarking on the board.
+
+#ifndef BENCH_KERNELS_H
+#define BENCH_KERNELS_H
+
+#include <stdint.h>
+
+#define BENCH_NUM_KERNELS  4
+
+// Kernel: one unit of work per call
+typedef struct {
+    const char *name;
+    void (*run)(void);
+} BenchKernel_t;
+
+extern const BenchKernel_t benchKernels[BENCH_NUM_KERNELS];
+
+// Function prototypes
+void BenchKernels_Init(void);
+uint32_t BenchKernels_Checksum(void);
+
+#endif // BENCH_KERNELS_H
@@ -0,0 +1,270 @@
+// binlog.c
+// Deferred binary logging implementation
+
+#include "binlog.h"
+#include "STM32L432KC_RTT.h"
+#include "STM32L432KC_DWT.h"
+#include <stdint.h>
+#include <stddef.h>  // For NULL definition
+
+// Formats and argument counts from the string table (indexed by id)
+#define BINLOG_X_FORMAT(id, level, fmt)  fmt,
+static const char *const formats[BINLOG_NUM_MESSAGES] = {
+    BINLOG_MESSAGES(BINLOG_X_FORMAT)
+};
+
+// The pad marker id must not collide with a message
+typedef char binlog_pad_id_check[(BINLOG_NUM_MESSAGES < BINLOG_PAD_ID) ? 1 : -1];
+
+#if BINLOG_MODE == BINLOG_MODE_BINARY
+#include "irq_priority.h"
+
+// Record ring (head and tail are free-running word counts)
+// Producers in several contexts (thread mode, PendSV, handlers at sensor
+// priority or below) each reserve and fill a whole record with BASEPRI at
+// IRQ_PRIO_SENSOR, and publish head only after its words are in place.
+// BinLog_Drain() is the only consumer. A record never wraps: one that would
+// cross the end of the ring starts at the beginning behind a pad marker, so
+// the drain always stops on a record boundary.
+static uint32_t ring[BINLOG_RING_WORDS];
+static volatile uint32_t head = 0;
+static volatile uint32_t tail = 0;
+static uint8_t seq = 0;
+#endif
+static uint32_t dropped = 0;
+
+// Start the cycle counter used for record timestamps, clear the ring and
+// log the counter rate (SYSCLK) for binlog_decode.py --time
+void BinLog_Init(uint32_t cyclesHz) {
+#if BINLOG_MODE == BINLOG_MODE_BINARY
+    DWT_Init();
+    head = 0;
+    tail = 0;
+    seq = 0;
+#endif
+    dropped = 0;
+    BINLOG(BL_CLOCK, BL_U(cyclesHz));
+}
+
+// Store one record (called through BINLOG())
+void BinLog_Write(uint8_t id, const uint32_t *args, uint32_t count) {
+    if (count > BINLOG_MAX_ARGS) {
+        count = BINLOG_MAX_ARGS;
+    }
+    
+#if BINLOG_MODE == BINLOG_MODE_BINARY
+    uint32_t basepri = irq_mask_sensor();
+    uint32_t h = head;
+    uint8_t s = seq++;
+    uint32_t size = count + 2;
+    
+    // Words left before the end of the ring, skipped if the record does not fit
+    uint32_t pad = BINLOG_RING_WORDS - (h & (BINLOG_RING_WORDS - 1));
+    if (pad >= size) {
+        pad = 0;
+    }
+    
+    if (pad + size > BINLOG_RING_WORDS - (h - tail)) {
+        dropped++;
+        irq_unmask(basepri);
+        return;
+    }
+    
+    if (pad > 0) {
+        ring[h & (BINLOG_RING_WORDS - 1)] = BINLOG_SYNC | ((uint32_t)BINLOG_PAD_ID << 8) | ((pad - 1) << 16);
+        h += pad;
+    }
+    
+    ring[h & (BINLOG_RING_WORDS - 1)] = BINLOG_SYNC | ((uint32_t)id << 8) | (count << 16) | ((uint32_t)s << 24);
+    ring[(h + 1) & (BINLOG_RING_WORDS - 1)] = DWT_GET_CYCLES();
+    for (uint32_t i = 0; i < count; i++) {
+        ring[(h + 2 + i) & (BINLOG_RING_WORDS - 1)] = args[i];
+    }
+    
+    // Words must be written before the consumer can see the new head
+    __asm volatile ("" : : : "memory");
+    head = h + size;
+    irq_unmask(basepri);
+#else
+    char line[128];
+    BinLog_Format(id, args, count, line, sizeof(line));
+    RTT_PrintStr(line);
+    RTT_PrintNewline();
+#endif
+}
+
+// Write pending records to RTT (call when idle)
+void BinLog_Drain(void) {
+#if BINLOG_MODE == BINLOG_MODE_BINARY
+    uint32_t h = head;
+    uint32_t t = tail;
+    if (h == t) {
+        return;
+    }
+    
+    // Ring may wrap: send up to the end of the buffer (a record boundary), then the rest
+    uint32_t start = t & (BINLOG_RING_WORDS - 1);
+    uint32_t pending = h - t;
+    uint32_t first = BINLOG_RING_WORDS - start;
+    if (first > pending) {
+        first = pending;
+    }
+    RTT_Write(&ring[start], first * sizeof(uint32_t));
+    if (pending > first) {
+        RTT_Write(&ring[0], (pending - first) * sizeof(uint32_t));
+    }
+    tail = h;
+#endif
+}
+
+// Records lost to a full ring since init
+uint32_t BinLog_Dropped(void) {
+    return dropped;
+}
+
+// Append a string to the output, keeping room for the terminator
+static uint16_t put_str(char *out, uint16_t at, uint16_t size, const char *s) {
+    while (*s != '\0' && at + 1 < size) {
+        out[at++] = *s++;
+    }
+    return at;
+}
+
+// Append an unsigned number in base 10 or 16
+static uint16_t put_uint(char *out, uint16_t at, uint16_t size, uint32_t v, uint32_t base) {
+    char digits[11];
+    int n = 0;
+    do {
+        digits[n++] = "0123456789abcdef"[v % base];
+        v /= base;
+    } while (v != 0);
+    while (n > 0 && at + 1 < size) {
+        out[at++] = digits[--n];
+    }
+    return at;
+}
+
+// Append a float with a fixed number of decimals (rounded)
+static uint16_t put_float(char *out, uint16_t at, uint16_t size, float f, int decimals) {
+    uint32_t scale = 1;
+    for (int i = 0; i < decimals; i++) {
+        scale *= 10;
+    }
+    if (f < 0.0f) {
+        f = -f;
+        at = put_str(out, at, size, "-");
+    }
+    uint32_t fixed = (uint32_t)(f * (float)scale + 0.5f);
+    at = put_uint(out, at, size, fixed / scale, 10);
+    if (decimals > 0) {
+        at = put_str(out, at, size, ".");
+        uint32_t frac = fixed % scale;
+        for (uint32_t d = scale / 10; d > 0; d /= 10) {
+            if (at + 1 < size) {
+                out[at++] = (char)('0' + (frac / d) % 10);
+            }
+        }
+    }
+    return at;
+}
+
+// Format a record as text (same output as host/binlog_decode.py)
+// Returns the length written, excluding the terminator.
+uint16_t BinLog_Format(uint8_t id, const uint32_t *args, uint32_t count, char *out, uint16_t size) {
+    uint16_t at = 0;
+    uint32_t arg = 0;
+    
+    if (size == 0) {
+        return 0;
+    }
+    if (id >= BINLOG_NUM_MESSAGES) {
+        out[0] = '\0';
+        return 0;
+    }
+    
+    for (const char *p = formats[id]; *p != '\0' && at + 1 < size; p++) {
+        if (*p != '%') {
+            out[at++] = *p;
+            continue;
+        }
+        
+        p++;
+        int decimals = 6;
+        if (*p == '.') {
+            decimals = p[1] - '0';
+            p += 2;
+        }
+        if (*p == '%') {
+            out[at++] = '%';
+            continue;
+        }
+        
+        uint32_t v = (arg < count) ? args[arg] : 0;
+        arg++;
+        if (*p == 'u') {
+            at = put_uint(out, at, size, v, 10);
+        } else if (*p == 'x') {
+            at = put_uint(out, at, size, v, 16);
+        } else if (*p == 'd') {
+            if ((int32_t)v < 0) {
+                at = put_str(out, at, size, "-");
+                v = 0u - v;
+            }
+            at = put_uint(out, at, size, v, 10);
+        } else if (*p == 'f') {
+            union { uint32_t u; float f; } bits;
+            bits.u = v;
+            at = put_float(out, at, size, bits.f, decimals);
+        } else if (*p == '\0') {
+            break;
+        }
+    }
+    out[at] = '\0';
+    return at;
+}
+
+#if BINLOG_BENCHMARK
+// Compare a quaternion record with the RTT text output it replaces (DWT cycles)
+void BinLog_ReportCycles(void) {
+    float q[4] = { 0.707f, 0.012f, -0.034f, 0.706f };
+    uint32_t binlog_total = 0, text_total = 0;
+    const uint32_t calls = 16;
+    
+    DWT_Init();
+    for (uint32_t i = 0; i < calls; i++) {
+        uint32_t start = DWT_GET_CYCLES();
+        BINLOG(BL_SENSOR_QUAT, BL_U(i), BL_F(q[0]), BL_F(q[1]), BL_F(q[2]), BL_F(q[3]),
+               BL_F(1.5f), BL_F(-42.0f), BL_F(93.2f));
+        binlog_total += DWT_GET_CYCLES() - start;
+    }
+    
+    for (uint32_t i = 0; i < calls; i++) {
+        uint32_t start = DWT_GET_CYCLES();
+        DEBUG_PRINT("[Q #");
+        DEBUG_PRINT_INT(i);
+        DEBUG_PRINT("] r=");
+        DEBUG_PRINT_FLOAT(q[0], 3);
+        DEBUG_PRINT(" i=");
+        DEBUG_PRINT_FLOAT(q[1], 3);
+        DEBUG_PRINT(" j=");
+        DEBUG_PRINT_FLOAT(q[2], 3);
+        DEBUG_PRINT(" k=");
+        DEBUG_PRINT_FLOAT(q[3], 3);
+        DEBUG_PRINT(" | Roll=");
+        DEBUG_PRINT_FLOAT(1.5f, 1);
+        DEBUG_PRINT(" Pitch=");
+        DEBUG_PRINT_FLOAT(-42.0f, 1);
+        DEBUG_PRINT(" Yaw=");
+        DEBUG_PRINT_FLOAT(93.2f, 1);
+        DEBUG_PRINT_NEWLINE();
+        text_total += DWT_GET_CYCLES() - start;
+    }
+    
+    BinLog_Drain();
+    DEBUG_PRINT("[BinLog] quaternion record avg cycles: binary=");
+    DEBUG_PRINT_INT(binlog_total / calls);
+    DEBUG_PRINT(" text=");
+    DEBUG_PRINT_INT(text_total / calls);
+    DEBUG_PRINT_NEWLINE();
+}
+#endif
@@ -0,0 +1,106 @@
+// binlog.h
+// Deferred binary logging for hot paths
+//
+// BINLOG(id, args...) stores a record of the message id, a DWT cycle
+// timestamp and the raw 32-bit arguments in a RAM ring, with no formatting.
+// BinLog_Drain() writes the pending records to RTT from the main loop's idle
+// time, and host/binlog_decode.py turns them back into text using the formats
+// in binlog_messages.h. Messages above BINLOG_LEVEL compile to nothing.
+//
+// Arguments are wrapped by type: BL_I() for signed, BL_U() for unsigned and
+// BL_F() for float values, e.g.
+//   BINLOG(BL_SENSOR_ACCEL, BL_U(n), BL_F(x), BL_F(y), BL_F(z));
+//
+// Record layout (32-bit little-endian words):
+//   word 0  0xB1 sync | id << 8 | argument count << 16 | sequence << 24
+//   word 1  DWT_CYCCNT at the call
+//   word 2+ Arguments
+// A record that would cross the end of the ring is moved to its start; the
+// words skipped are covered by a pad marker, word 0 with id BINLOG_PAD_ID
+// and the number of words that follow it as the count (no timestamp).
+// A sequence gap in the decoded stream means records were dropped on a full
+// ring. BINLOG() may be called from thread mode, PendSV and any handler at
+// IRQ_PRIO_SENSOR or below; never from the audio interrupt, which a record
+// write does not mask.
+
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include <stdint.h>
+
+// Message levels (per message, in binlog_messages.h)
+#define BINLOG_LEVEL_OFF    0
+#define BINLOG_LEVEL_ERROR  1
+#define BINLOG_LEVEL_INFO   2
+#define BINLOG_LEVEL_DEBUG  3
+#define BINLOG_LEVEL_TRACE  4  // Every sensor report
+
+// Highest level compiled in
+#ifndef BINLOG_LEVEL
+#define BINLOG_LEVEL  BINLOG_LEVEL_TRACE
+#endif
+
+// Output mode
+#define BINLOG_MODE_BINARY  0  // Deferred binary records, decoded on the host
+#define BINLOG_MODE_TEXT    1  // Format and print at the call (no decoder needed)
+
+#ifndef BINLOG_MODE
+#define BINLOG_MODE  BINLOG_MODE_BINARY
+#endif
+
+// Ring size in 32-bit words (power of 2)
+#ifndef BINLOG_RING_WORDS
+#define BINLOG_RING_WORDS  1024
+#endif
+
+// Measure the cost of a record against the RTT text output at startup
+#ifndef BINLOG_BENCHMARK
+#define BINLOG_BENCHMARK  0
+#endif
+
+#define BINLOG_SYNC      0xB1
+#define BINLOG_MAX_ARGS  8
+#define BINLOG_PAD_ID    0xFF  // Skipped words at the end of the ring
+
+#include "binlog_messages.h"
+
+// Message ids and levels from the string table
+#define BINLOG_X_ID(id, level, fmt)     id,
+#define BINLOG_X_LEVEL(id, level, fmt)  id##_LEVEL = level,
+typedef enum {
+    BINLOG_MESSAGES(BINLOG_X_ID)
+    BINLOG_NUM_MESSAGES
+} BinLogId_t;
+enum {
+    BINLOG_MESSAGES(BINLOG_X_LEVEL)
+};
+
+// Argument wrappers
+static inline uint32_t BinLog_FloatBits(float f) {
+    union { float f; uint32_t u; } v;
+    v.f = f;
+    return v.u;
+}
+#define BL_I(x)  ((uint32_t)(int32_t)(x))
+#define BL_U(x)  ((uint32_t)(x))
+#define BL_F(x)  BinLog_FloatBits((float)(x))
+
+// Log a message (at least one argument); disabled levels keep the arguments
+// type-checked but emit no code
+#define BINLOG(id, ...) \
+    do { \
+        if (id##_LEVEL <= BINLOG_LEVEL) { \
+            BinLog_Write(id, (const uint32_t[]){ __VA_ARGS__ }, \
+                         sizeof((uint32_t[]){ __VA_ARGS__ }) / sizeof(uint32_t)); \
+        } \
+    } while (0)
+
+// Function prototypes
+void BinLog_Init(uint32_t cyclesHz);
+void BinLog_Write(uint8_t id, const uint32_t *args, uint32_t count);
+void BinLog_Drain(void);
+uint32_t BinLog_Dropped(void);
+uint16_t BinLog_Format(uint8_t id, const uint32_t *args, uint32_t count, char *out, uint16_t size);
+void BinLog_ReportCycles(void);
+
+#endif // BINLOG_H
@@ -0,0 +1,35 @@
+// binlog_messages.h
+// String table for the deferred binary log (binlog.h)
+//
+// One X(id, level, format) entry per message. The firmware stores only the
+// id and the raw 32-bit arguments; host/binlog_decode.py reads this file to
+// format records, so an entry's format must match the arguments passed at
+// its BINLOG() call sites. Formats use %u, %d, %x, %.Nf and %%.
+// Append new entries at the end: ids are the table position.
+// Drum and stroke arguments are DRUM_* (drum_detection.h) and STROKE_*
+// (stroke_recognizer.h) ids.
+
+#ifndef BINLOG_MESSAGES_H
+#define BINLOG_MESSAGES_H
+
+#define BINLOG_MESSAGES(X) \
+    X(BL_SENSOR_QUAT,  BINLOG_LEVEL_TRACE, "[Q #%u] r=%.3f i=%.3f j=%.3f k=%.3f | Roll=%.1f Pitch=%.1f Yaw=%.1f") \
+    X(BL_SENSOR_GYRO,  BINLOG_LEVEL_TRACE, "[G #%u] x=%.3f y=%.3f z=%.3f | Raw: x=%d y=%d z=%d") \
+    X(BL_SENSOR_ACCEL, BINLOG_LEVEL_TRACE, "[A #%u] x=%.2f y=%.2f z=%.2f") \
+    X(BL_SENSOR_OTHER, BINLOG_LEVEL_TRACE, "[Sensor #%u] ID=%u") \
+    X(BL_GYRO_CHECK,   BINLOG_LEVEL_DEBUG, "[Gyro Check] gyro_y=%d threshold=%d (%d) | Yaw=%.1f Pitch=%.1f") \
+    X(BL_HIT,          BINLOG_LEVEL_INFO,  "*** HIT DETECTED *** Gyro_y: %d | Yaw: %.1f Pitch: %.1f -> drum %u stroke %u") \
+    X(BL_HIT_UNMAPPED, BINLOG_LEVEL_INFO,  "*** HIT DETECTED *** Gyro_y: %d | Yaw: %.1f Pitch: %.1f -> UNKNOWN ZONE") \
+    X(BL_PLAY,         BINLOG_LEVEL_DEBUG, "Playing: drum %u") \
+    X(BL_PLAY_UNKNOWN, BINLOG_LEVEL_ERROR, "Unknown drum ID: %u") \
+    X(BL_CLOCK,        BINLOG_LEVEL_ERROR, "[BinLog] Timestamps count at %u Hz") \
+    X(BL_SH2_SERVICE,  BINLOG_LEVEL_DEBUG, "[SH2] Service call #%u") \
+    X(BL_SENSOR_QUAT_SUMMARY, BINLOG_LEVEL_INFO, "Quaternion: r=%.3f i=%.3f j=%.3f k=%.3f") \
+    X(BL_SENSOR_GYRO_SUMMARY, BINLOG_LEVEL_INFO, "Gyro: x=%.3f y=%.3f z=%.3f") \
+    X(BL_CALIBRATION_HIT, BINLOG_LEVEL_INFO, "[Calibration] Hit -> cluster %u (n=%u)") \
+    X(BL_SPI_READ,     BINLOG_LEVEL_DEBUG, "[SPI Read] Call #%u | INT=%u | Time=%u ms | Elapsed=%u ms") \
+    X(BL_SPI_INT,      BINLOG_LEVEL_DEBUG, "[SPI Read] INT detected #%u (call #%u)") \
+    X(BL_SPI_NO_DATA,  BINLOG_LEVEL_DEBUG, "[SPI Read] Call #%u - INT still HIGH (no data)") \
+    X(BL_SPI_OVERSIZE, BINLOG_LEVEL_ERROR, "[SPI Read] ERROR: %u-byte transfer > %u-byte buffer, dropped (%u so far)")
+
+#endif // BINLOG_MESSAGES_H
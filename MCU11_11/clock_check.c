@@ -0,0 +1,181 @@
+// clock_check.c
+// Boot-time SYSCLK self-check (see clock_check.h)
+
+#include "clock_check.h"
+#include "STM32L432KC_RCC.h"
+#include "STM32L432KC_TIMER.h"  // For TIM_TypeDef
+#include "STM32L432KC_RTT.h"    // For debug output
+#include <stdint.h>
+
+#if CLOCK_CHECK
+
+// TIM16: general-purpose timer on APB2, TI1 can be remapped to LSI/LSE
+#define TIM16      ((TIM_TypeDef *) 0x40014400UL)
+#define TIM16_OR1  (*((volatile uint32_t*)0x40014450UL))
+#define RCC_APB2ENR_TIM16EN  (1 << 17)
+
+#define TIM16_TI1_RMP_LSI  0b01
+#define TIM16_TI1_RMP_LSE  0b10
+
+// PWR: backup domain write access for LSEON
+#define PWR_CR1  (*((volatile uint32_t*)0x40007000UL))
+#define PWR_CR1_DBP  (1 << 8)
+#define RCC_APB1ENR1_PWREN  (1 << 28)
+
+#define RCC_BDCR_LSEON   (1 << 0)
+#define RCC_BDCR_LSERDY  (1 << 1)
+#define RCC_CSR_LSION    (1 << 0)
+#define RCC_CSR_LSIRDY   (1 << 1)
+
+#define LSE_HZ  32768UL
+#define LSI_HZ  32000UL
+
+// Input capture prescaler: capture every 8th reference edge
+#define CAPTURE_DIV  8
+
+// Poll limits (loop iterations, not time: SYSCLK is what is in doubt)
+#define LSE_START_POLLS   2000000
+#define LSI_START_POLLS   100000
+#define CAPTURE_POLLS     200000
+
+// Start the LSE crystal; false if it does not come up in time
+static int start_lse(void) {
+    if (RCC->BDCR & RCC_BDCR_LSERDY) {
+        return 1;
+    }
+    
+    RCC->APB1ENR1 |= RCC_APB1ENR1_PWREN;
+    PWR_CR1 |= PWR_CR1_DBP;
+    RCC->BDCR |= RCC_BDCR_LSEON;
+    
+    for (uint32_t i = 0; i < LSE_START_POLLS; i++) {
+        if (RCC->BDCR & RCC_BDCR_LSERDY) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int start_lsi(void) {
+    RCC->CSR |= RCC_CSR_LSION;
+    for (uint32_t i = 0; i < LSI_START_POLLS; i++) {
+        if (RCC->CSR & RCC_CSR_LSIRDY) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Wait for the next capture; returns the captured counter or -1 on timeout
+static int32_t next_capture(void) {
+    for (uint32_t i = 0; i < CAPTURE_POLLS; i++) {
+        if (TIM16->SR & (1 << 1)) {  // CC1IF, cleared by reading CCR1
+            return (int32_t)(TIM16->CCR1 & 0xFFFF);
+        }
+    }
+    return -1;
+}
+
+// Count SYSCLK cycles over CLOCK_CHECK_PERIODS * CAPTURE_DIV reference
+// periods. TIM16 runs undivided from SYSCLK, so capture deltas are SYSCLK
+// cycles; one capture interval (8 / 32 kHz = 250 us) is at most 20000
+// cycles at 80MHz, so 16-bit deltas cannot wrap.
+static uint32_t measure_cycles(uint32_t remap) {
+    RCC->APB2ENR |= RCC_APB2ENR_TIM16EN;
+    
+    TIM16->CR1 = 0;
+    TIM16_OR1 = remap;
+    TIM16->PSC = 0;
+    TIM16->ARR = 0xFFFF;
+    TIM16->CCMR1 = (0b01 << 0)    // CC1S: input, IC1 mapped on TI1
+                 | (0b11 << 2);   // IC1PSC: capture every 8 events
+    TIM16->CCER = (1 << 0);       // CC1E: capture enabled, rising edge
+    TIM16->EGR = 1;               // Load PSC
+    TIM16->SR = 0;
+    TIM16->CR1 = 1;               // CEN
+    
+    uint32_t total = 0;
+    int32_t prev = next_capture();  // First capture only sets the phase
+    if (prev >= 0) {
+        for (uint32_t i = 0; i < CLOCK_CHECK_PERIODS; i++) {
+            int32_t now = next_capture();
+            if (now < 0) {
+                total = 0;
+                break;
+            }
+            total += (uint16_t)(now - prev);
+            prev = now;
+        }
+    }
+    
+    TIM16->CR1 = 0;
+    TIM16->CCER = 0;
+    TIM16_OR1 = 0;
+    RCC->APB2ENR &= ~RCC_APB2ENR_TIM16EN;
+    return total;
+}
+
+static const char *source_name(uint32_t sws) {
+    switch (sws) {
+        case RCC_SWS_MSI:   return "MSI";
+        case RCC_SWS_HSI16: return "HSI16";
+        case RCC_SWS_HSE:   return "HSE";
+        default:            return "PLL";
+    }
+}
+
+// Measure SYSCLK, report it and correct RCC_GetSysclkHz() if needed.
+// Returns the measured frequency in Hz, or 0 if no reference was available.
+uint32_t ClockCheck_Run(void) {
+    uint32_t nominal = RCC_GetSysclkHz();
+    uint32_t sws = RCC_GetSysclkSource();
+    
+    int useLse = start_lse();
+    if (!useLse && !start_lsi()) {
+        DEBUG_PRINTLN("[CLK] No LSE/LSI reference, SYSCLK not verified");
+        return 0;
+    }
+    
+    uint32_t refHz = useLse ? LSE_HZ : LSI_HZ;
+    uint32_t cycles = measure_cycles(useLse ? TIM16_TI1_RMP_LSE : TIM16_TI1_RMP_LSI);
+    if (cycles == 0) {
+        DEBUG_PRINTLN("[CLK] Reference capture timed out, SYSCLK not verified");
+        return 0;
+    }
+    
+    uint32_t measured = (uint32_t)(((uint64_t)cycles * refHz)
+                                   / ((uint64_t)CAPTURE_DIV * CLOCK_CHECK_PERIODS));
+    int32_t deviationPct = (int32_t)(((int64_t)measured - (int64_t)nominal) * 100
+                                     / (int64_t)nominal);
+    
+    DEBUG_PRINT("[CLK] SYSCLK source ");
+    DEBUG_PRINT(source_name(sws));
+    DEBUG_PRINT(", measured ");
+    DEBUG_PRINT_INT(measured);
+    DEBUG_PRINT(" Hz against ");
+    DEBUG_PRINT(useLse ? "LSE" : "LSI");
+    DEBUG_PRINT(", nominal ");
+    DEBUG_PRINT_INT(nominal);
+    DEBUG_PRINT(" Hz (");
+    DEBUG_PRINT_INT(deviationPct);
+    DEBUG_PRINT("%)");
+    DEBUG_PRINT_NEWLINE();
+    
+    if (sws != RCC_SWS_PLL) {
+        DEBUG_PRINTLN("[CLK] WARNING: PLL is not the system clock");
+    }
+    
+    // Small errors keep the nominal value so derived dividers stay exact;
+    // anything beyond the reference's own tolerance means the clock tree
+    // is not what configureClock() intended, and the measurement wins
+    int32_t absPct = deviationPct < 0 ? -deviationPct : deviationPct;
+    int32_t tolerancePct = useLse ? CLOCK_CHECK_LSE_TRUST_PCT : CLOCK_CHECK_LSI_TRUST_PCT;
+    if (absPct > tolerancePct) {
+        RCC_SetSysclkHz(measured);
+        DEBUG_PRINTLN("[CLK] WARNING: timing constants derived from measured SYSCLK");
+    }
+    
+    return measured;
+}
+
+#endif
@@ -0,0 +1,42 @@
+// clock_check.h
+// Boot-time SYSCLK self-check against an independent reference clock
+//
+// Every timing path in the firmware (ms_delay, TIM2, SysTick, USART2 baud,
+// the mixer sample clock, DAC_PlayWAV pacing) derives its constants from
+// RCC_GetSysclkHz(). ClockCheck_Run() measures what SYSCLK actually is by
+// timing edges of a 32 kHz reference (LSE crystal, or LSI if the crystal
+// does not start) with TIM16 input capture, reports the result and the
+// clock source the RCC says it switched to, and corrects
+// RCC_GetSysclkHz() when the part is not running at the intended speed.
+// Call it right after configureClock() and before any of the above are
+// initialised.
+
+#ifndef CLOCK_CHECK_H
+#define CLOCK_CHECK_H
+
+#include <stdint.h>
+
+#ifndef CLOCK_CHECK
+#define CLOCK_CHECK 1
+#endif
+
+// Reference edges to average over (each is 8 reference periods, ~244 us)
+#ifndef CLOCK_CHECK_PERIODS
+#define CLOCK_CHECK_PERIODS 32
+#endif
+
+// Deviation (percent) above which the measurement replaces the nominal
+// frequency. LSI is only +/-5% accurate, so smaller errors against it are
+// reported but not acted on; a part left on MSI is off by 95%.
+#ifndef CLOCK_CHECK_LSE_TRUST_PCT
+#define CLOCK_CHECK_LSE_TRUST_PCT 1
+#endif
+
+#ifndef CLOCK_CHECK_LSI_TRUST_PCT
+#define CLOCK_CHECK_LSI_TRUST_PCT 10
+#endif
+
+// Function prototypes
+uint32_t ClockCheck_Run(void);
+
+#endif // CLOCK_CHECK_H
@@ -0,0 +1,396 @@
+// config_store.c
+// Append-only key/value record store implementation (see config_store.h)
+//
+// Offsets are relative to the start of a store page, so the RAM index is
+// the same on target and in host builds (host_shim.h flash image).
+
+#include "config_store.h"
+#include "crc32.h"
+#include "STM32L432KC_RTT.h"  // For debug output (RTT)
+#include <string.h>
+
+#define ERASED_WORD  0xFFFFFFFFUL
+
+// Give up on a staged write after this many flash errors in a row
+#define MAX_WRITE_FAILURES  3
+
+// Write state machine, advanced one flash operation per ConfigStore_Poll()
+typedef enum {
+    WR_IDLE,
+    WR_ERASE,    // Erase the compaction target page
+    WR_COPY,     // Copy live records (staged value instead of its old record)
+    WR_HEADER,   // Stamp the target page header: the target becomes active
+    WR_APPEND    // Append the staged record to the active page
+} WriteState_t;
+
+// Latest record of a key in the active page (offset 0 = no record)
+typedef struct {
+    uint16_t offset;
+    uint16_t len;
+} ConfigIndex_t;
+
+static bool initialised = false;
+static int8_t activePage = -1;       // Ring index, -1 = store never formatted
+static uint32_t activeSeq = 0;
+static uint32_t writeOffset = 0;     // Next free byte in the active page
+static bool sealed = false;          // Active page has a damaged record: compact before writing
+static ConfigIndex_t keyIndex[CONFIG_STORE_MAX_KEYS];
+
+// Staged write (value padded with 0xFF to whole double words)
+static uint32_t staged[(CONFIG_STORE_MAX_VALUE + 7) / 8 * 2];
+static uint16_t stagedKey;
+static uint16_t stagedLen;
+static uint32_t stagedCrc;
+static bool pending = false;
+
+static WriteState_t state = WR_IDLE;
+static uint8_t failures = 0;
+static uint32_t opIndex;             // Double word within the record being written
+
+// Compaction progress
+static uint8_t targetPage;
+static uint32_t targetSeq;
+static uint16_t copyKey;
+static uint32_t dstOffset;
+static ConfigIndex_t newIndex[CONFIG_STORE_MAX_KEYS];
+
+static const uint32_t *page_words(uint8_t ring) {
+    return (const uint32_t *)FLASH_PAGE_ADDR(CONFIG_STORE_FIRST_PAGE + ring);
+}
+
+// Flash bytes taken by a record with a value of len bytes
+static uint32_t record_size(uint32_t len) {
+    return 8 + ((len + 7) & ~7UL);
+}
+
+static uint32_t record_crc(uint32_t word0, const void *value, uint32_t len) {
+    return CRC32_Update(CRC32_Compute(&word0, 4), value, len);
+}
+
+static bool page_blank(uint8_t ring) {
+    const uint32_t *words = page_words(ring);
+    for (uint32_t i = 0; i < FLASH_PAGE_SIZE / 4; i++) {
+        if (words[i] != ERASED_WORD) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int program_dword(uint8_t ring, uint32_t offset, uint32_t word0, uint32_t word1) {
+    FLASH_Unlock();
+    int status = FLASH_ProgramDoubleWord((uint32_t)FLASH_PAGE_ADDR(CONFIG_STORE_FIRST_PAGE + ring) + offset,
+                                         word0, word1);
+    FLASH_Lock();
+    return status;
+}
+
+// Rebuild the RAM index from the records of one page
+// Scanning stops at the first erased double word. A record that does not fit
+// or fails its CRC (write interrupted by a reset) seals the page, since
+// nothing after it can be trusted; the next write compacts.
+static void scan_page(uint8_t ring) {
+    const uint32_t *words = page_words(ring);
+    uint32_t offset = 8;
+    
+    memset(keyIndex, 0, sizeof(keyIndex));
+    sealed = false;
+    
+    while (offset + 8 <= FLASH_PAGE_SIZE) {
+        uint32_t word0 = words[offset / 4];
+        uint32_t crc = words[offset / 4 + 1];
+        if (word0 == ERASED_WORD && crc == ERASED_WORD) {
+            break;
+        }
+        
+        uint16_t key = (uint16_t)(word0 & 0xFFFF);
+        uint16_t len = (uint16_t)(word0 >> 16);
+        uint32_t size = record_size(len);
+        if (len > CONFIG_STORE_MAX_VALUE || offset + size > FLASH_PAGE_SIZE ||
+            record_crc(word0, &words[offset / 4 + 2], len) != crc) {
+            sealed = true;
+            break;
+        }
+        
+        if (key < CONFIG_STORE_MAX_KEYS) {
+            keyIndex[key].offset = (len > 0) ? (uint16_t)offset : 0;
+            keyIndex[key].len = len;
+        }
+        offset += size;
+    }
+    
+    writeOffset = offset;
+}
+
+// Find the active page (valid header, newest sequence) and index it
+void ConfigStore_Init(void) {
+    activePage = -1;
+    for (uint8_t ring = 0; ring < CONFIG_STORE_PAGES; ring++) {
+        const uint32_t *words = page_words(ring);
+        if (words[0] != CONFIG_STORE_MAGIC) {
+            continue;
+        }
+        if (activePage < 0 || (int32_t)(words[1] - activeSeq) > 0) {
+            activePage = (int8_t)ring;
+            activeSeq = words[1];
+        }
+    }
+    
+    if (activePage >= 0) {
+        scan_page((uint8_t)activePage);
+    } else {
+        memset(keyIndex, 0, sizeof(keyIndex));
+        writeOffset = 0;
+        sealed = false;
+    }
+    
+    pending = false;
+    state = WR_IDLE;
+    initialised = true;
+}
+
+// Copy the stored value of a key
+// Returns the value length, or CONFIG_STORE_NOT_FOUND / CONFIG_STORE_TOO_LARGE
+int ConfigStore_Get(uint16_t key, void *value, uint16_t maxLen) {
+    if (!initialised || key >= CONFIG_STORE_MAX_KEYS || keyIndex[key].offset == 0) {
+        return CONFIG_STORE_NOT_FOUND;
+    }
+    if (keyIndex[key].len > maxLen) {
+        return CONFIG_STORE_TOO_LARGE;
+    }
+    
+    const uint8_t *page = (const uint8_t *)page_words((uint8_t)activePage);
+    memcpy(value, page + keyIndex[key].offset + 8, keyIndex[key].len);
+    return keyIndex[key].len;
+}
+
+// Stage a new value for a key; ConfigStore_Poll() writes it
+// A value equal to the stored one is not written again. The live records
+// plus the new one must fit in one page, or compaction could not hold them.
+int ConfigStore_Set(uint16_t key, const void *value, uint16_t len) {
+    if (!initialised || key >= CONFIG_STORE_MAX_KEYS) {
+        return CONFIG_STORE_ERROR;
+    }
+    if (pending) {
+        return CONFIG_STORE_BUSY;
+    }
+    if (len > CONFIG_STORE_MAX_VALUE) {
+        return CONFIG_STORE_TOO_LARGE;
+    }
+    
+    if (len == 0 && keyIndex[key].offset == 0) {
+        return CONFIG_STORE_OK;
+    }
+    if (len > 0 && keyIndex[key].offset != 0 && keyIndex[key].len == len) {
+        const uint8_t *page = (const uint8_t *)page_words((uint8_t)activePage);
+        if (memcmp(page + keyIndex[key].offset + 8, value, len) == 0) {
+            return CONFIG_STORE_OK;
+        }
+    }
+    
+    uint32_t live = 8 + (len > 0 ? record_size(len) : 0);
+    for (uint16_t k = 0; k < CONFIG_STORE_MAX_KEYS; k++) {
+        if (k != key && keyIndex[k].offset != 0) {
+            live += record_size(keyIndex[k].len);
+        }
+    }
+    if (live > FLASH_PAGE_SIZE) {
+        return CONFIG_STORE_TOO_LARGE;
+    }
+    
+    memset(staged, 0xFF, sizeof(staged));
+    if (len > 0) {
+        memcpy(staged, value, len);
+    }
+    stagedKey = key;
+    stagedLen = len;
+    stagedCrc = record_crc(key | ((uint32_t)len << 16), staged, len);
+    failures = 0;
+    pending = true;
+    return CONFIG_STORE_OK;
+}
+
+// Stage removal of a key
+int ConfigStore_Delete(uint16_t key) {
+    return ConfigStore_Set(key, NULL, 0);
+}
+
+// True while a staged write has not reached flash
+bool ConfigStore_Busy(void) {
+    return pending;
+}
+
+// Double word i of the record a key will have after the staged write
+static void record_dword(uint16_t key, uint32_t i, uint32_t *word0, uint32_t *word1) {
+    if (pending && key == stagedKey) {
+        if (i == 0) {
+            *word0 = stagedKey | ((uint32_t)stagedLen << 16);
+            *word1 = stagedCrc;
+        } else {
+            *word0 = staged[(i - 1) * 2];
+            *word1 = staged[(i - 1) * 2 + 1];
+        }
+        return;
+    }
+    
+    const uint32_t *words = page_words((uint8_t)activePage) + keyIndex[key].offset / 4;
+    *word0 = words[i * 2];
+    *word1 = words[i * 2 + 1];
+}
+
+// Value length of a key after the staged write (0 = no record)
+static uint16_t live_len(uint16_t key) {
+    if (pending && key == stagedKey) {
+        return stagedLen;
+    }
+    return (keyIndex[key].offset != 0) ? keyIndex[key].len : 0;
+}
+
+// Begin moving the live records (with the staged value) to the next page
+static void start_compaction(void) {
+    if (activePage < 0) {
+        targetPage = 0;
+        targetSeq = 1;
+    } else {
+        targetPage = (uint8_t)((activePage + 1) % CONFIG_STORE_PAGES);
+        targetSeq = activeSeq + 1;
+    }
+    
+    memset(newIndex, 0, sizeof(newIndex));
+    copyKey = 0;
+    opIndex = 0;
+    dstOffset = 8;
+    state = page_blank(targetPage) ? WR_COPY : WR_ERASE;
+}
+
+// A flash operation failed: retry through a fresh compaction, or give up
+static void write_failed(void) {
+    state = WR_IDLE;
+    sealed = true;  // The active page may now hold a partial record
+    if (++failures >= MAX_WRITE_FAILURES) {
+        pending = false;
+        DEBUG_PRINTLN("[Config] ERROR: flash write failed - value not saved");
+    }
+}
+
+// Advance the staged write by at most one flash operation
+// flashAllowed: a program or erase (flash read stall) may run now; pass false
+// while audio is playing from flash.
+void ConfigStore_Poll(bool flashAllowed) {
+    uint32_t word0, word1;
+    int status;
+    
+    if (!flashAllowed) {
+        return;
+    }
+    
+    switch (state) {
+        case WR_IDLE:
+            if (!pending) {
+                return;
+            }
+            if (activePage < 0 || sealed ||
+                writeOffset + record_size(stagedLen) > FLASH_PAGE_SIZE) {
+                start_compaction();
+            } else {
+                opIndex = 0;
+                state = WR_APPEND;
+            }
+            return;
+        
+        case WR_ERASE:
+            FLASH_Unlock();
+            status = FLASH_ErasePage(CONFIG_STORE_FIRST_PAGE + targetPage);
+            FLASH_Lock();
+            if (status != 0) {
+                write_failed();
+                return;
+            }
+            state = WR_COPY;
+            return;
+        
+        case WR_COPY:
+            while (copyKey < CONFIG_STORE_MAX_KEYS && live_len(copyKey) == 0) {
+                copyKey++;
+            }
+            if (copyKey == CONFIG_STORE_MAX_KEYS) {
+                state = WR_HEADER;
+                return;
+            }
+            
+            record_dword(copyKey, opIndex, &word0, &word1);
+            if (program_dword(targetPage, dstOffset + opIndex * 8, word0, word1) != 0) {
+                write_failed();
+                return;
+            }
+            
+            if (++opIndex * 8 == record_size(live_len(copyKey))) {
+                newIndex[copyKey].offset = (uint16_t)dstOffset;
+                newIndex[copyKey].len = live_len(copyKey);
+                dstOffset += opIndex * 8;
+                opIndex = 0;
+                copyKey++;
+            }
+            return;
+        
+        case WR_HEADER:
+            // Written last, so a reset during compaction leaves the old page active
+            if (program_dword(targetPage, 0, CONFIG_STORE_MAGIC, targetSeq) != 0) {
+                write_failed();
+                return;
+            }
+            activePage = (int8_t)targetPage;
+            activeSeq = targetSeq;
+            memcpy(keyIndex, newIndex, sizeof(keyIndex));
+            writeOffset = dstOffset;
+            sealed = false;
+            pending = false;
+            state = WR_IDLE;
+            return;
+        
+        case WR_APPEND:
+            record_dword(stagedKey, opIndex, &word0, &word1);
+            if (program_dword((uint8_t)activePage, writeOffset + opIndex * 8, word0, word1) != 0) {
+                write_failed();
+                return;
+            }
+            
+            if (++opIndex * 8 == record_size(stagedLen)) {
+                keyIndex[stagedKey].offset = (stagedLen > 0) ? (uint16_t)writeOffset : 0;
+                keyIndex[stagedKey].len = stagedLen;
+                writeOffset += opIndex * 8;
+                pending = false;
+                state = WR_IDLE;
+            }
+            return;
+    }
+}
+
+// Print the active page, its fill level and the stored keys
+void ConfigStore_Report(void) {
+    if (activePage < 0) {
+        DEBUG_PRINTLN("[Config] Store empty");
+        return;
+    }
+    
+    DEBUG_PRINT("[Config] Page ");
+    DEBUG_PRINT_INT(CONFIG_STORE_FIRST_PAGE + activePage);
+    DEBUG_PRINT(" seq ");
+    DEBUG_PRINT_INT(activeSeq);
+    DEBUG_PRINT(", ");
+    DEBUG_PRINT_INT(writeOffset);
+    DEBUG_PRINT("/");
+    DEBUG_PRINT_INT(FLASH_PAGE_SIZE);
+    DEBUG_PRINT(" bytes used");
+    if (sealed) {
+        DEBUG_PRINT(" (damaged record, compacts on next write)");
+    }
+    DEBUG_PRINT(", keys:");
+    for (uint16_t k = 0; k < CONFIG_STORE_MAX_KEYS; k++) {
+        if (keyIndex[k].offset != 0) {
+            DEBUG_PRINT(" ");
+            DEBUG_PRINT_INT(k);
+        }
+    }
+    DEBUG_PRINT_NEWLINE();
+}
@@ -0,0 +1,67 @@
+// config_store.h
+// Append-only key/value record store in the last flash pages
+//
+// Settings that must survive a power cycle (calibrated zone map, detection
+// thresholds) are kept as small records keyed by a CONFIG_KEY_* id. The
+// store is a ring of CONFIG_STORE_PAGES flash pages; one page is active at a
+// time and new values are appended to it, so rewriting a key never erases.
+// When the active page is full, the live records are copied to the next page
+// in the ring (compaction) and that page becomes active, which spreads erases
+// over every page of the ring.
+//
+// Page layout (little-endian double words):
+//   dword 0   CONFIG_STORE_MAGIC | sequence number (written last on compaction)
+//   dword 1+  records
+// Record layout:
+//   dword 0   key | length << 16 | CRC32 of (key/length word + value)
+//   dword 1+  value, padded to 8 bytes with 0xFF
+// A zero-length record deletes its key. At boot the active page is scanned
+// once into a RAM index, so ConfigStore_Get() is a table lookup and a copy.
+//
+// Writes never block the caller: ConfigStore_Set() stages the value in RAM and
+// ConfigStore_Poll(), called from the 1 ms scheduler tick, programs one
+// double word per call. Every flash operation stalls flash reads: a page
+// erase for ~22 ms, a double word program for ~80 us, longer than one mixer
+// render period. Mixer samples play from flash, so the write only advances
+// while the caller says audio is idle, and a save finishes between hits.
+// Only one write is staged at a time.
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "STM32L432KC_FLASH.h"
+
+// Store location: last pages of flash (reserved in STM32L4xx_Flash.icf)
+#define CONFIG_STORE_PAGES      4
+#define CONFIG_STORE_FIRST_PAGE (FLASH_PAGE_COUNT - CONFIG_STORE_PAGES)
+
+#define CONFIG_STORE_MAGIC      0x53474643UL  // "CFGS"
+
+// Largest value (the zone map) and number of keys
+#define CONFIG_STORE_MAX_VALUE  1032
+#define CONFIG_STORE_MAX_KEYS   8
+
+// Keys (stable: they are stored in flash)
+#define CONFIG_KEY_ZONE_MAP     1  // DrumZoneMap_t (drum_calibration.c)
+#define CONFIG_KEY_THRESHOLDS   2  // DrumThresholds_t (drum_detection.c)
+#define CONFIG_KEY_KIT          3  // uint8_t kit number (drum_kit.c)
+
+// Return codes
+#define CONFIG_STORE_OK         0
+#define CONFIG_STORE_NOT_FOUND  -1
+#define CONFIG_STORE_BUSY       -2  // A write is still in progress
+#define CONFIG_STORE_TOO_LARGE  -3  // Value or live set does not fit
+#define CONFIG_STORE_ERROR      -4  // Bad key, or store not initialised
+
+// Function prototypes
+void ConfigStore_Init(void);
+int ConfigStore_Get(uint16_t key, void *value, uint16_t maxLen);
+int ConfigStore_Set(uint16_t key, const void *value, uint16_t len);
+int ConfigStore_Delete(uint16_t key);
+bool ConfigStore_Busy(void);
+void ConfigStore_Poll(bool flashAllowed);
+void ConfigStore_Report(void);
+
+#endif // CONFIG_STORE_H
@@ -0,0 +1,16 @@
+// crc32.h
+// CRC-32 (IEEE 802.3, reflected, poly 0xEDB88320) for integrity checks
+//
+// Matches zlib crc32() / Python binascii.crc32(), so host tools can verify
+// records written by the firmware.
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+
+// Function prototypes
+uint32_t CRC32_Compute(const void *data, uint32_t len);
+uint32_t CRC32_Update(uint32_t crc, const void *data, uint32_t len);
+
+#endif // CRC32_H
@@ -0,0 +1,218 @@
+// drum_calibration.c
+// Learned drum positions implementation
+//
+// Angles are fixed point binary angles (BAM): 65536 = 360 degrees, so yaw wraps
+// for free in uint16_t arithmetic and circular differences are a cast to int16_t.
+
+#include "drum_calibration.h"
+#include "drum_detection.h"
+#include "STM32L432KC_RTT.h"  // For debug output (RTT)
+#include "binlog.h"
+#include <string.h>
+
+#define DEG_TO_BAM  (65536.0f / 360.0f)
+#define BAM_DEG(d)  ((int32_t)((d) * 65536L / 360))
+
+// Pitch bins cover -90..+90 degrees (-16384..16384 BAM)
+#define PITCH_BIN_SHIFT  11
+
+typedef char drum_zone_map_size_check[(sizeof(DrumZoneMap_t) <= CONFIG_STORE_MAX_VALUE) ? 1 : -1];
+
+// One k-means cluster
+typedef struct {
+    uint16_t yaw;    // BAM
+    int16_t  pitch;  // BAM
+    uint16_t count;  // Hits assigned during this calibration
+    uint8_t  drumId;
+} DrumCluster_t;
+
+// Seed positions: centres of the default zones in DrumDetection_ClassifyZone()
+static const DrumCluster_t cluster_seeds[DRUM_CAL_NUM_CLUSTERS] = {
+    { (uint16_t)BAM_DEG(70),  (int16_t)BAM_DEG(0),  0, DRUM_SNARE    },
+    { (uint16_t)BAM_DEG(0),   (int16_t)BAM_DEG(25), 0, DRUM_HIGH_TOM },
+    { (uint16_t)BAM_DEG(0),   (int16_t)BAM_DEG(65), 0, DRUM_CRASH    },
+    { (uint16_t)BAM_DEG(322), (int16_t)BAM_DEG(25), 0, DRUM_MID_TOM  },
+    { (uint16_t)BAM_DEG(322), (int16_t)BAM_DEG(65), 0, DRUM_RIDE     },
+    { (uint16_t)BAM_DEG(252), (int16_t)BAM_DEG(10), 0, DRUM_LOW_TOM  },
+    { (uint16_t)BAM_DEG(252), (int16_t)BAM_DEG(50), 0, DRUM_RIDE     },
+};
+
+static DrumCluster_t clusters[DRUM_CAL_NUM_CLUSTERS];
+static bool calibrating = false;
+
+static DrumZoneMap_t zoneMap;
+static bool zoneMapValid = false;
+
+// Squared distance between a point and a cluster, in BAM^2
+static uint32_t cluster_distance2(const DrumCluster_t *c, uint16_t yaw, int16_t pitch) {
+    int32_t dy = (int16_t)(uint16_t)(yaw - c->yaw);
+    int32_t dp = (int32_t)pitch - c->pitch;
+    return (uint32_t)(dy * dy) + (uint32_t)(dp * dp);
+}
+
+// Load the zone map saved by a previous calibration
+// Returns true if a valid map was found in flash
+bool DrumCalibration_LoadZoneMap(void) {
+    zoneMapValid = false;
+    
+    int len = ConfigStore_Get(CONFIG_KEY_ZONE_MAP, &zoneMap, sizeof(zoneMap));
+    if (len == CONFIG_STORE_NOT_FOUND) {
+        return false;
+    }
+    if (len != (int)sizeof(zoneMap) || zoneMap.version != DRUM_ZONE_MAP_VERSION) {
+        DEBUG_PRINTLN("[Calibration] Saved zone map has an old layout - using default zones");
+        return false;
+    }
+    
+    zoneMapValid = true;
+    return true;
+}
+
+// True when learned zones replace the default zone rules
+bool DrumCalibration_HasZoneMap(void) {
+    return zoneMapValid;
+}
+
+// O(1) zone lookup in the learned map
+// yaw: 0-360 degrees (already offset and normalized), pitch: degrees
+uint8_t DrumCalibration_LookupZone(float yaw, float pitch) {
+    uint16_t yaw_bam = (uint16_t)(int32_t)(yaw * DEG_TO_BAM);
+    int32_t pitch_idx = ((int32_t)(pitch * DEG_TO_BAM) + 16384) >> PITCH_BIN_SHIFT;
+    
+    if (pitch_idx < 0) pitch_idx = 0;
+    if (pitch_idx >= DRUM_ZONE_PITCH_BINS) pitch_idx = DRUM_ZONE_PITCH_BINS - 1;
+    
+    return zoneMap.zones[(yaw_bam >> 10) * DRUM_ZONE_PITCH_BINS + pitch_idx];
+}
+
+// Learned zone map, or NULL while the default zone rules are in use
+const DrumZoneMap_t *DrumCalibration_GetZoneMap(void) {
+    return zoneMapValid ? &zoneMap : NULL;
+}
+
+// Replace the learned map (e.g. one edited on the host) and save it
+// NULL deletes the saved map and returns to the default zones. Mask the
+// sensor task around the call: it looks zones up from the same table.
+// Returns a CONFIG_STORE_* code; on CONFIG_STORE_BUSY the map is in use but
+// not yet saved
+int DrumCalibration_SetZoneMap(const DrumZoneMap_t *map) {
+    if (map == NULL) {
+        zoneMapValid = false;
+        return ConfigStore_Delete(CONFIG_KEY_ZONE_MAP);
+    }
+    if (map->version != DRUM_ZONE_MAP_VERSION) {
+        return CONFIG_STORE_ERROR;
+    }
+    
+    zoneMap = *map;
+    zoneMapValid = true;
+    return ConfigStore_Set(CONFIG_KEY_ZONE_MAP, &zoneMap, sizeof(zoneMap));
+}
+
+// Enter calibration mode
+// Clusters restart from the default kit layout; the current map stays in use
+// until DrumCalibration_Finish() replaces it.
+void DrumCalibration_Start(void) {
+    memcpy(clusters, cluster_seeds, sizeof(clusters));
+    calibrating = true;
+    DEBUG_PRINTLN("[Calibration] Started - hit each drum 3+ times, then hold button 2");
+}
+
+bool DrumCalibration_IsActive(void) {
+    return calibrating;
+}
+
+// Online k-means step (MacQueen): move the nearest cluster toward the hit by 1/n
+void DrumCalibration_AddHit(float yaw, float pitch) {
+    if (!calibrating) {
+        return;
+    }
+    
+    uint16_t yaw_bam = (uint16_t)(int32_t)(yaw * DEG_TO_BAM);
+    int16_t pitch_bam = (int16_t)(pitch * DEG_TO_BAM);
+    
+    int best = 0;
+    uint32_t best_d2 = 0xFFFFFFFF;
+    for (int i = 0; i < DRUM_CAL_NUM_CLUSTERS; i++) {
+        uint32_t d2 = cluster_distance2(&clusters[i], yaw_bam, pitch_bam);
+        if (d2 < best_d2) {
+            best_d2 = d2;
+            best = i;
+        }
+    }
+    
+    DrumCluster_t *c = &clusters[best];
+    if (c->count < 0xFFFF) {
+        c->count++;
+    }
+    int32_t dy = (int16_t)(uint16_t)(yaw_bam - c->yaw);
+    int32_t dp = (int32_t)pitch_bam - c->pitch;
+    c->yaw = (uint16_t)(c->yaw + dy / c->count);
+    c->pitch = (int16_t)(c->pitch + dp / c->count);
+    
+    BINLOG(BL_CALIBRATION_HIT, BL_U(best), BL_U(c->count));
+}
+
+// Leave calibration mode, rasterise the clusters and save the map to flash
+// With no usable clusters the saved map is deleted and the default zones return.
+// The store writes in the background; the new map is used immediately.
+// Returns the number of clusters in the new map, or -1 if it cannot be saved
+int DrumCalibration_Finish(void) {
+    const int32_t max_d2 = BAM_DEG(DRUM_CAL_MAX_RADIUS) * BAM_DEG(DRUM_CAL_MAX_RADIUS);
+    int active = 0;
+    
+    if (!calibrating) {
+        return 0;
+    }
+    calibrating = false;
+    
+    for (int i = 0; i < DRUM_CAL_NUM_CLUSTERS; i++) {
+        if (clusters[i].count >= DRUM_CAL_MIN_HITS) {
+            active++;
+        }
+    }
+    
+    if (active == 0) {
+        DEBUG_PRINTLN("[Calibration] No drum hit enough times - reverting to default zones");
+        zoneMapValid = false;
+        return (ConfigStore_Delete(CONFIG_KEY_ZONE_MAP) == CONFIG_STORE_OK) ? 0 : -1;
+    }
+    
+    // Assign every bin centre to the nearest surviving cluster within range
+    memset(&zoneMap, 0, sizeof(zoneMap));
+    for (int y = 0; y < DRUM_ZONE_YAW_BINS; y++) {
+        uint16_t yaw_bam = (uint16_t)((y << 10) + (1 << 9));
+        for (int p = 0; p < DRUM_ZONE_PITCH_BINS; p++) {
+            int16_t pitch_bam = (int16_t)((p << PITCH_BIN_SHIFT) + (1 << (PITCH_BIN_SHIFT - 1)) - 16384);
+            uint8_t drumId = DRUM_NONE;
+            uint32_t best_d2 = (uint32_t)max_d2;
+            
+            for (int i = 0; i < DRUM_CAL_NUM_CLUSTERS; i++) {
+                if (clusters[i].count < DRUM_CAL_MIN_HITS) {
+                    continue;
+                }
+                uint32_t d2 = cluster_distance2(&clusters[i], yaw_bam, pitch_bam);
+                if (d2 <= best_d2) {
+                    best_d2 = d2;
+                    drumId = clusters[i].drumId;
+                }
+            }
+            zoneMap.zones[y * DRUM_ZONE_PITCH_BINS + p] = drumId;
+        }
+    }
+    
+    zoneMap.version = DRUM_ZONE_MAP_VERSION;
+    zoneMap.clusterCount = (uint16_t)active;
+    zoneMapValid = true;
+    
+    DEBUG_PRINT("[Calibration] Finished with ");
+    DEBUG_PRINT_INT(active);
+    DEBUG_PRINT(" drums");
+    DEBUG_PRINT_NEWLINE();
+    
+    if (ConfigStore_Set(CONFIG_KEY_ZONE_MAP, &zoneMap, sizeof(zoneMap)) != CONFIG_STORE_OK) {
+        DEBUG_PRINTLN("[Calibration] ERROR: config store busy - map kept in RAM only");
+        return -1;
+    }
+    return active;
+}
@@ -0,0 +1,46 @@
+// drum_calibration.h
+// Learned drum positions for invisible drum system
+//
+// Calibration mode: the player hits each drum a few times, the impact yaw/pitch
+// values are clustered with online k-means (fixed point), and the clusters are
+// rasterised into a yaw x pitch lookup table that is saved in the flash
+// config store (config_store.h). Zone lookup is then a single table read.
+
+#ifndef DRUM_CALIBRATION_H
+#define DRUM_CALIBRATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config_store.h"
+
+// Zone map resolution
+#define DRUM_ZONE_YAW_BINS     64   // 5.625 degrees per bin
+#define DRUM_ZONE_PITCH_BINS   16   // 11.25 degrees per bin, -90..+90
+#define DRUM_ZONE_MAP_SIZE     (DRUM_ZONE_YAW_BINS * DRUM_ZONE_PITCH_BINS)
+
+// Calibration parameters
+#define DRUM_CAL_NUM_CLUSTERS  7    // Seeded from the default kit layout
+#define DRUM_CAL_MIN_HITS      3    // Clusters with fewer hits are dropped
+#define DRUM_CAL_MAX_RADIUS    40   // Degrees; farther from every cluster = no drum
+
+#define DRUM_ZONE_MAP_VERSION  1
+
+// Saved zone map (CONFIG_KEY_ZONE_MAP; the store checks the CRC)
+typedef struct {
+    uint16_t version;
+    uint16_t clusterCount;
+    uint8_t  zones[DRUM_ZONE_MAP_SIZE];  // Drum ID per [yaw bin][pitch bin]
+} DrumZoneMap_t;
+
+// Function prototypes
+bool DrumCalibration_LoadZoneMap(void);
+bool DrumCalibration_HasZoneMap(void);
+uint8_t DrumCalibration_LookupZone(float yaw, float pitch);
+const DrumZoneMap_t *DrumCalibration_GetZoneMap(void);
+int DrumCalibration_SetZoneMap(const DrumZoneMap_t *map);
+void DrumCalibration_Start(void);
+void DrumCalibration_AddHit(float yaw, float pitch);
+bool DrumCalibration_IsActive(void);
+int DrumCalibration_Finish(void);
+
+#endif // DRUM_CALIBRATION_H
@@ -0,0 +1,102 @@
+// drum_classifier.c
+// Table-driven hit classifier implementation
+
+#include "drum_classifier.h"
+#include "drum_classifier_model.h"
+#include "drum_detection.h"
+#include "STM32L432KC_DWT.h"
+#include "STM32L432KC_RTT.h"  // For debug output (RTT)
+
+// Walk the tree from the root
+// The loop is bounded by the model depth, so worst-case cost is
+// DRUM_CLASSIFIER_MODEL_DEPTH compare-and-branch steps regardless of the input.
+// A malformed table (cycle or out-of-range index) returns DRUM_NONE.
+uint8_t DrumClassifier_Predict(const int16_t features[DRUM_NUM_FEATURES]) {
+    uint8_t node = 0;
+    
+    for (int step = 0; step <= DRUM_CLASSIFIER_MODEL_DEPTH; step++) {
+        const DrumClassifierNode_t *n = &drum_classifier_nodes[node];
+        
+        if (n->feature == DRUM_CLASSIFIER_LEAF) {
+            return n->left;
+        }
+        
+        node = (features[n->feature] <= n->threshold) ? n->left : n->right;
+        if (node >= DRUM_CLASSIFIER_MODEL_NODES) {
+            break;
+        }
+    }
+    
+    return DRUM_NONE;
+}
+
+// Quantise detector values into the classifier's fixed-point features
+// yaw: 0-360 degrees (already offset and normalized), pitch: degrees
+void DrumClassifier_MakeFeatures(float yaw, float pitch, int16_t gyro_y,
+                                 int16_t features[DRUM_NUM_FEATURES]) {
+    features[DRUM_FEATURE_YAW] = (int16_t)(yaw * 10.0f);
+    features[DRUM_FEATURE_PITCH] = (int16_t)(pitch * 10.0f);
+    features[DRUM_FEATURE_GYRO_Y] = gyro_y;
+}
+
+// Measure classification cost of the tree against the if/else zone rules
+// Sweeps a 5-degree yaw/pitch grid and reports min/avg/max DWT cycles per call,
+// plus how many grid points the two classifiers disagree on.
+void DrumClassifier_ReportCycles(void) {
+    uint32_t tree_min = 0xFFFFFFFF, tree_max = 0, tree_total = 0;
+    uint32_t rule_min = 0xFFFFFFFF, rule_max = 0, rule_total = 0;
+    uint32_t calls = 0;
+    uint32_t disagree = 0;
+    
+    DWT_Init();
+    
+    for (int yaw = 0; yaw < 360; yaw += 5) {
+        for (int pitch = -90; pitch <= 90; pitch += 5) {
+            int16_t features[DRUM_NUM_FEATURES];
+            
+            uint32_t start = DWT_GET_CYCLES();
+            DrumClassifier_MakeFeatures((float)yaw, (float)pitch, GYRO_HIT_THRESHOLD, features);
+            uint8_t tree_id = DrumClassifier_Predict(features);
+            uint32_t tree_cycles = DWT_GET_CYCLES() - start;
+            
+            start = DWT_GET_CYCLES();
+            uint8_t rule_id = DrumDetection_ClassifyZone((float)yaw, (float)pitch);
+            uint32_t rule_cycles = DWT_GET_CYCLES() - start;
+            
+            if (tree_cycles < tree_min) tree_min = tree_cycles;
+            if (tree_cycles > tree_max) tree_max = tree_cycles;
+            if (rule_cycles < rule_min) rule_min = rule_cycles;
+            if (rule_cycles > rule_max) rule_max = rule_cycles;
+            tree_total += tree_cycles;
+            rule_total += rule_cycles;
+            calls++;
+            
+            if (tree_id != rule_id) {
+                disagree++;
+            }
+        }
+    }
+    
+    DEBUG_PRINT("[Classifier] tree cycles min/avg/max=");
+    DEBUG_PRINT_INT(tree_min);
+    DEBUG_PRINT("/");
+    DEBUG_PRINT_INT(tree_total / calls);
+    DEBUG_PRINT("/");
+    DEBUG_PRINT_INT(tree_max);
+    DEBUG_PRINT(" (depth ");
+    DEBUG_PRINT_INT(DRUM_CLASSIFIER_MODEL_DEPTH);
+    DEBUG_PRINT(")");
+    DEBUG_PRINT_NEWLINE();
+    DEBUG_PRINT("[Classifier] rule cycles min/avg/max=");
+    DEBUG_PRINT_INT(rule_min);
+    DEBUG_PRINT("/");
+    DEBUG_PRINT_INT(rule_total / calls);
+    DEBUG_PRINT("/");
+    DEBUG_PRINT_INT(rule_max);
+    DEBUG_PRINT_NEWLINE();
+    DEBUG_PRINT("[Classifier] grid points where tree != rules: ");
+    DEBUG_PRINT_INT(disagree);
+    DEBUG_PRINT(" of ");
+    DEBUG_PRINT_INT(calls);
+    DEBUG_PRINT_NEWLINE();
+}
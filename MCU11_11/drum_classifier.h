@@ -0,0 +1,44 @@
+// drum_classifier.h
+// Table-driven hit classifier for invisible drum system
+//
+// Evaluates a small decision tree that was trained offline (see
+// host/train_classifier.py) and exported as const tables in
+// drum_classifier_model.h. The evaluator is generic: only the tables change
+// when the model is retrained.
+
+#ifndef DRUM_CLASSIFIER_H
+#define DRUM_CLASSIFIER_H
+
+#include <stdint.h>
+
+// Feature indices (all features are fixed-point int16)
+#define DRUM_FEATURE_YAW      0  // Yaw in 0.1 degree units, 0..3599
+#define DRUM_FEATURE_PITCH    1  // Pitch in 0.1 degree units, -900..900
+#define DRUM_FEATURE_GYRO_Y   2  // gyro_y at impact, rad/s * 1000 (same scale as GYRO_HIT_THRESHOLD)
+#define DRUM_NUM_FEATURES     3
+
+// Run DrumClassifier_ReportCycles() once at boot
+#ifndef DRUM_CLASSIFIER_BENCHMARK
+#define DRUM_CLASSIFIER_BENCHMARK  0
+#endif
+
+// Node feature value marking a leaf
+#define DRUM_CLASSIFIER_LEAF  (-1)
+
+// Decision tree node
+// Internal node: go to 'left' if features[feature] <= threshold, else 'right'
+// Leaf node:     feature == DRUM_CLASSIFIER_LEAF, 'left' holds the drum ID
+typedef struct {
+    int8_t  feature;
+    int16_t threshold;
+    uint8_t left;
+    uint8_t right;
+} DrumClassifierNode_t;
+
+// Function prototypes
+uint8_t DrumClassifier_Predict(const int16_t features[DRUM_NUM_FEATURES]);
+void DrumClassifier_MakeFeatures(float yaw, float pitch, int16_t gyro_y,
+                                 int16_t features[DRUM_NUM_FEATURES]);
+void DrumClassifier_ReportCycles(void);
+
+#endif // DRUM_CLASSIFIER_H
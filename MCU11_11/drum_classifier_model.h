@@ -0,0 +1,38 @@
+// drum_classifier_model.h
+// Decision tree tables for drum_classifier.c
+//
+// GENERATED by host/train_classifier.py - do not edit by hand.
+// This default model encodes the hand-tuned yaw/pitch zone rules from
+// DrumDetection_ClassifyZone() (quantised to 0.1 degree), so the tree and the
+// if/else rules agree until a trained model replaces this file.
+
+#ifndef DRUM_CLASSIFIER_MODEL_H
+#define DRUM_CLASSIFIER_MODEL_H
+
+#include "drum_classifier.h"
+#include "drum_detection.h"
+
+// Longest root-to-leaf path (number of comparisons); bounds evaluation time
+#define DRUM_CLASSIFIER_MODEL_DEPTH  6
+#define DRUM_CLASSIFIER_MODEL_NODES  16
+
+static const DrumClassifierNode_t drum_classifier_nodes[DRUM_CLASSIFIER_MODEL_NODES] = {
+    /*  0 */ { DRUM_FEATURE_YAW,    199,  1,  4 },   // yaw < 20: high tom / crash
+    /*  1 */ { DRUM_FEATURE_PITCH,  500,  2,  3 },
+    /*  2 */ { DRUM_CLASSIFIER_LEAF,  0, DRUM_HIGH_TOM, 0 },
+    /*  3 */ { DRUM_CLASSIFIER_LEAF,  0, DRUM_CRASH,    0 },
+    /*  4 */ { DRUM_FEATURE_YAW,   1200,  5,  6 },   // 20 <= yaw <= 120: snare
+    /*  5 */ { DRUM_CLASSIFIER_LEAF,  0, DRUM_SNARE,    0 },
+    /*  6 */ { DRUM_FEATURE_YAW,   1999,  7,  8 },   // 120 < yaw < 200: unmapped
+    /*  7 */ { DRUM_CLASSIFIER_LEAF,  0, DRUM_NONE,     0 },
+    /*  8 */ { DRUM_FEATURE_YAW,   3049,  9, 12 },   // 200 <= yaw < 305: low tom / ride
+    /*  9 */ { DRUM_FEATURE_PITCH,  300, 10, 11 },
+    /* 10 */ { DRUM_CLASSIFIER_LEAF,  0, DRUM_LOW_TOM,  0 },
+    /* 11 */ { DRUM_CLASSIFIER_LEAF,  0, DRUM_RIDE,     0 },
+    /* 12 */ { DRUM_FEATURE_YAW,   3399, 13,  1 },   // 305 <= yaw < 340: mid tom / ride, else high tom / crash
+    /* 13 */ { DRUM_FEATURE_PITCH,  500, 14, 15 },
+    /* 14 */ { DRUM_CLASSIFIER_LEAF,  0, DRUM_MID_TOM,  0 },
+    /* 15 */ { DRUM_CLASSIFIER_LEAF,  0, DRUM_RIDE,     0 },
+};
+
+#endif // DRUM_CLASSIFIER_MODEL_H
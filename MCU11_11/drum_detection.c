@@ -2,17 +2,58 @@
 // Drum hit detection logic implementation
 
 #include "drum_detection.h"
+#include "drum_classifier.h"
+#include "drum_calibration.h"
+#include "stroke_recognizer.h"
+#include "onset_detector.h"
+#include "yaw_drift.h"
+#include "config_store.h"
 #include "STM32L432KC_RTT.h"  // For debug output (RTT)
+#include "binlog.h"
 #include <math.h>
 #include <stddef.h>  // For NULL definition
+#include <string.h>
 
 // Define M_PI if not defined by math.h (some embedded toolchains don't define it)
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-// Yaw offset for calibration
-float yawOffset = 0.0f;
+// The board's detector (thresholds are defaults until loaded from the config store)
+static DrumDetector_t detector;
+
+// Built-in zone layout
+static const DrumZoneLayout_t defaultZones = {
+    .snareYawMin = 20.0f,
+    .snareYawMax = 120.0f,
+    .highTomYawMin = 340.0f,
+    .midTomYawMin = 305.0f,
+    .lowTomYawMin = 200.0f,
+    .cymbalPitch = 50.0f,
+    .lowCymbalPitch = 30.0f,
+};
+
+#if DRUM_ZONE_HYSTERESIS
+// Exit margins per zone, in degrees (indexed by drum ID)
+// A hit must land this far past the edge of the last zone to switch drums.
+// Tuned with host/replay.c --edges so that no zone edge classifies worse
+// than with DRUM_ZONE_HYSTERESIS=0; rerun it after changing these.
+typedef struct {
+    float yawDeg;
+    float pitchDeg;
+} DrumZoneHysteresis_t;
+
+static const DrumZoneHysteresis_t zoneHysteresis[DRUM_LOW_TOM + 1] = {
+    { 3.0f, 0.0f },  // SNARE (yaw edges only)
+    { 0.0f, 0.0f },  // HIHAT (not zone mapped)
+    { 0.0f, 0.0f },  // KICK (not zone mapped)
+    { 2.0f, 2.0f },  // HIGH_TOM
+    { 2.0f, 2.0f },  // MID_TOM
+    { 3.0f, 2.0f },  // CRASH
+    { 3.0f, 2.0f },  // RIDE
+    { 3.0f, 1.0f },  // LOW_TOM
+};
+#endif
 
 // Convert quaternion to Euler angles (roll, pitch, yaw in degrees)
 void DrumDetection_QuaternionToEuler(float q_real, float q_i, float q_j, float q_k, 
@@ -50,25 +91,253 @@ float DrumDetection_NormalizeYaw(float yaw) {
 
 // Set yaw offset for calibration
 void DrumDetection_SetYawOffset(float offset) {
-    yawOffset = offset;
+    detector.yawOffset = offset;
+    detector.lastZone = DRUM_NONE;  // Zones moved; forget the sticky zone
+#if DRUM_YAW_DRIFT_COMPENSATION
+    YawDrift_Reset(&detector.yawDrift);  // Re-learn the resting yaw in the new frame
+#endif
+}
+
+// Current yaw offset (drift compensation keeps adjusting it)
+float DrumDetection_GetYawOffset(void) {
+    return detector.yawOffset;
+}
+
+// Built-in zone layout
+void DrumDetection_DefaultZones(DrumZoneLayout_t *zones) {
+    *zones = defaultZones;
+}
+
+// Map impact orientation to a drum using the hand-tuned zone rules
+// yaw: 0-360 degrees (already offset and normalized), pitch: degrees
+// Single sensor (right hand) zone mapping
+// Returns drum sound ID, or DRUM_NONE if yaw is in an unmapped gap
+uint8_t DrumDetection_ClassifyLayout(const DrumZoneLayout_t *zones, float yaw, float pitch) {
+    if (yaw >= zones->snareYawMin && yaw <= zones->snareYawMax) {
+        // Snare drum
+        return DRUM_SNARE;
+    }
+    else if (yaw >= zones->highTomYawMin || yaw <= zones->snareYawMin) {
+        // High tom or crash cymbal
+        return (pitch > zones->cymbalPitch) ? DRUM_CRASH : DRUM_HIGH_TOM;
+    }
+    else if (yaw >= zones->midTomYawMin && yaw <= zones->highTomYawMin) {
+        // Mid tom or ride cymbal
+        return (pitch > zones->cymbalPitch) ? DRUM_RIDE : DRUM_MID_TOM;
+    }
+    else if (yaw >= zones->lowTomYawMin && yaw <= zones->midTomYawMin) {
+        // Floor tom or ride cymbal
+        return (pitch > zones->lowCymbalPitch) ? DRUM_RIDE : DRUM_LOW_TOM;
+    }
+    
+    return DRUM_NONE;
+}
+
+// Hand-tuned zone rules with the built-in layout
+uint8_t DrumDetection_ClassifyZone(float yaw, float pitch) {
+    return DrumDetection_ClassifyLayout(&defaultZones, yaw, pitch);
+}
+
+// Map impact orientation to a drum with the active zone classifier
+// Learned zones (calibration) take priority over the built-in layout
+static uint8_t classify_zone(const DrumDetector_t *det, float yaw, float pitch) {
+    if (DrumCalibration_HasZoneMap()) {
+        return DrumCalibration_LookupZone(yaw, pitch);
+    }
+#if DRUM_USE_TREE_CLASSIFIER
+    int16_t features[DRUM_NUM_FEATURES];
+    DrumClassifier_MakeFeatures(yaw, pitch, det->lastGyroY, features);
+    return DrumClassifier_Predict(features);
+#else
+    return DrumDetection_ClassifyLayout(&det->zones, yaw, pitch);
+#endif
+}
+
+#if DRUM_ZONE_HYSTERESIS
+// Sticky zone: keep the last zone unless the stick is clearly outside it
+// If the last zone is still reached by moving the impact point back by that
+// zone's exit margin along yaw or pitch, the hit is treated as a near-edge
+// repeat of the last zone. At most four extra classifier calls, so the
+// decision stays O(1) for rules, tree and calibrated map alike.
+static uint8_t apply_zone_hysteresis(const DrumDetector_t *det, uint8_t candidate, float yaw, float pitch) {
+    uint8_t lastZone = det->lastZone;
+    if (lastZone > DRUM_LOW_TOM || candidate == lastZone) {
+        return candidate;
+    }
+    
+    const DrumZoneHysteresis_t *m = &zoneHysteresis[lastZone];
+    
+    if (m->yawDeg > 0.0f &&
+        (classify_zone(det, DrumDetection_NormalizeYaw(yaw + m->yawDeg), pitch) == lastZone ||
+         classify_zone(det, DrumDetection_NormalizeYaw(yaw - m->yawDeg), pitch) == lastZone)) {
+        return lastZone;
+    }
+    
+    if (m->pitchDeg > 0.0f &&
+        (classify_zone(det, yaw, pitch + m->pitchDeg) == lastZone ||
+         classify_zone(det, yaw, pitch - m->pitchDeg) == lastZone)) {
+        return lastZone;
+    }
+    
+    return candidate;
+}
+#endif
+
+// Built-in thresholds
+static void default_thresholds(DrumThresholds_t *thresholds) {
+    thresholds->version = DRUM_THRESHOLDS_VERSION;
+    thresholds->gyroHit = GYRO_HIT_THRESHOLD;
+    OnsetDetector_DefaultParams(&thresholds->onset);
+}
+
+// Load saved thresholds, or the built-in defaults
+static void load_thresholds(DrumThresholds_t *thresholds) {
+    int len = ConfigStore_Get(CONFIG_KEY_THRESHOLDS, thresholds, sizeof(*thresholds));
+    if (len == (int)sizeof(*thresholds) && thresholds->version == DRUM_THRESHOLDS_VERSION) {
+        RTT_PrintStr("Loaded hit thresholds from flash");
+        RTT_PrintNewline();
+        return;
+    }
+    
+    default_thresholds(thresholds);
+}
+
+// Reset a detector instance and give it its parameters
+// Does not touch the config store or the calibrated zone map (which, once
+// loaded, is shared by every instance).
+void DrumDetector_Init(DrumDetector_t *det, const DrumThresholds_t *thresholds, const DrumZoneLayout_t *zones) {
+    memset(det, 0, sizeof(*det));
+    
+    if (thresholds != NULL) {
+        det->thresholds = *thresholds;
+        det->thresholds.version = DRUM_THRESHOLDS_VERSION;
+    } else {
+        default_thresholds(&det->thresholds);
+    }
+    det->zones = (zones != NULL) ? *zones : defaultZones;
+    det->lastZone = DRUM_NONE;
+    
+#if DRUM_YAW_DRIFT_COMPENSATION
+    YawDrift_Reset(&det->yawDrift);
+#endif
+    
+#if DRUM_USE_FUSED_ONSET
+    OnsetDetector_Init(&det->onset);
+    det->onset.params = det->thresholds.onset;
+#if DRUM_USE_STROKE_RECOGNIZER
+    det->strokeAnchorAge = STROKE_WINDOW_SAMPLES;  // No crossing yet
+#endif
+#endif
 }
 
 // Initialize drum detection
 void DrumDetection_Init(void) {
-    yawOffset = 0.0f;
+    DrumThresholds_t saved;
+    load_thresholds(&saved);
+    DrumDetector_Init(&detector, &saved, NULL);
+    
+    // Use learned drum positions from a previous calibration, if any
+    if (DrumCalibration_LoadZoneMap()) {
+        RTT_PrintStr("Loaded calibrated zone map from flash");
+        RTT_PrintNewline();
+    }
+}
+
+// Current hit thresholds
+const DrumThresholds_t *DrumDetection_GetThresholds(void) {
+    return &detector.thresholds;
+}
+
+// Apply new hit thresholds now and save them to the config store
+// Returns a CONFIG_STORE_* code; on CONFIG_STORE_BUSY the new values are
+// in use but not saved.
+int DrumDetection_SetThresholds(const DrumThresholds_t *newThresholds) {
+    detector.thresholds = *newThresholds;
+    detector.thresholds.version = DRUM_THRESHOLDS_VERSION;
+#if DRUM_USE_FUSED_ONSET
+    detector.onset.params = detector.thresholds.onset;
+#endif
+    return ConfigStore_Set(CONFIG_KEY_THRESHOLDS, &detector.thresholds, sizeof(detector.thresholds));
+}
+
+// Classify and report a detected hit
+// Returns drum sound ID, or DRUM_NONE if the stick is in an unmapped zone
+static uint8_t handle_hit(DrumDetector_t *det, DrumHitState_t *state) {
+#if DRUM_USE_STROKE_RECOGNIZER
+    // Classify the stroke shape from the gyro_y samples leading up to the hit
+    int16_t window[STROKE_WINDOW_SAMPLES];
+#if DRUM_USE_FUSED_ONSET
+    // The fused onset fires at the impact, after the gyro_y crossing the
+    // templates end at; a stroke about another axis has no crossing and
+    // gets the window ending now (and usually no match)
+    uint16_t anchorAge = (det->strokeAnchorAge < STROKE_WINDOW_SAMPLES) ? det->strokeAnchorAge : 0;
+    uint16_t windowLen = StrokeHistory_GetWindowAt(&det->gyroHistory, window, STROKE_WINDOW_SAMPLES, anchorAge);
+#else
+    uint16_t windowLen = StrokeHistory_GetWindow(&det->gyroHistory, window, STROKE_WINDOW_SAMPLES);
+#endif
+    state->lastStrokeType = StrokeRecognizer_Classify(window, windowLen, NULL);
+#endif
+    
+#if DRUM_DETECTION_LOG_STROKES
+    // Machine-readable stroke record for host/train_classifier.py
+    // Append the true drum label to each line when recording a training set
+    RTT_PrintStr("STROKE,");
+    RTT_PrintFloat(det->lastYaw, 1);
+    RTT_PrintStr(",");
+    RTT_PrintFloat(det->lastPitch, 1);
+    RTT_PrintStr(",");
+    RTT_PrintInt(det->lastGyroY);
+    RTT_PrintNewline();
+#if DRUM_USE_STROKE_RECOGNIZER
+    // gyro_y window for host/make_stroke_templates.py (append the stroke type)
+    RTT_PrintStr("WINDOW");
+    for (uint16_t i = 0; i < windowLen; i++) {
+        RTT_PrintStr(",");
+        RTT_PrintInt(window[i]);
+    }
+    RTT_PrintNewline();
+#endif
+#endif
+    
+    state->hitGyroY = det->lastGyroY;
+    state->hitYaw = det->lastYaw;
+    state->hitPitch = det->lastPitch;
+#if DRUM_USE_FUSED_ONSET
+    state->hitStrength = det->onset.hitSwing;
+#else
+    state->hitStrength = (det->lastGyroY < 0) ? -(int32_t)det->lastGyroY : det->lastGyroY;
+#endif
+    
+    // Feed the impact orientation to the zone learner while calibrating
+    if (DrumCalibration_IsActive()) {
+        DrumCalibration_AddHit(det->lastYaw, det->lastPitch);
+    }
+    
+    // Determine which drum based on yaw/pitch at impact
+    uint8_t drumId = classify_zone(det, det->lastYaw, det->lastPitch);
+#if DRUM_ZONE_HYSTERESIS
+    drumId = apply_zone_hysteresis(det, drumId, det->lastYaw, det->lastPitch);
+#endif
+    
+    if (drumId <= DRUM_LOW_TOM) {
+        det->lastZone = drumId;
+        state->lastDrumSound = drumId;
+        BINLOG(BL_HIT, BL_I(det->lastGyroY), BL_F(det->lastYaw), BL_F(det->lastPitch),
+               BL_U(drumId), BL_U(state->lastStrokeType));
+        return drumId;
+    }
+    
+    BINLOG(BL_HIT_UNMAPPED, BL_I(det->lastGyroY), BL_F(det->lastYaw), BL_F(det->lastPitch));
+    return DRUM_NONE;
 }
 
 // Process sensor data and detect drum hits
 // Returns drum sound ID if hit detected, DRUM_NONE otherwise
-uint8_t DrumDetection_ProcessSensorData(sh2_SensorValue_t *sensorValue, DrumHitState_t *state) {
+uint8_t DrumDetector_Process(DrumDetector_t *det, sh2_SensorValue_t *sensorValue, DrumHitState_t *state) {
     if (sensorValue == NULL || state == NULL) {
         return DRUM_NONE;
     }
     
-    static float last_yaw = 0.0f;
-    static float last_pitch = 0.0f;
-    static int16_t last_gyro_y = 0;
-    
     // Check if we have Game Rotation Vector data
     if (sensorValue->sensorId == SH2_GAME_ROTATION_VECTOR) {
         // Extract quaternion
@@ -82,12 +351,31 @@ uint8_t DrumDetection_ProcessSensorData(sh2_SensorValue_t *sensorValue, DrumHitS
         DrumDetection_QuaternionToEuler(q_real, q_i, q_j, q_k, &roll, &pitch, &yaw);
         
         // Adjust yaw by offset and normalize
-        yaw = DrumDetection_NormalizeYaw(yaw - yawOffset);
+        yaw = DrumDetection_NormalizeYaw(yaw - det->yawOffset);
+        
+        det->lastYaw = yaw;
+        det->lastPitch = pitch;
         
-        last_yaw = yaw;
-        last_pitch = pitch;
+#if DRUM_YAW_DRIFT_COMPENSATION
+        // Slowly pull the resting yaw back to where it was when yaw was zeroed
+        det->yawOffset += YawDrift_AddYaw(&det->yawDrift, yaw);
+#endif
     }
     
+#if DRUM_USE_FUSED_ONSET
+    // Check if we have Linear Acceleration data (m/s^2, gravity removed)
+    if (sensorValue->sensorId == SH2_LINEAR_ACCELERATION) {
+        int16_t accel_x = (int16_t)(sensorValue->un.linearAcceleration.x * 100.0f);
+        int16_t accel_y = (int16_t)(sensorValue->un.linearAcceleration.y * 100.0f);
+        int16_t accel_z = (int16_t)(sensorValue->un.linearAcceleration.z * 100.0f);
+        
+        if (OnsetDetector_AddAccel(&det->onset, accel_x, accel_y, accel_z)) {
+            state->hitDetected = true;
+            return handle_hit(det, state);
+        }
+    }
+#endif
+    
     // Check if we have Gyroscope data
     if (sensorValue->sensorId == SH2_GYROSCOPE_CALIBRATED) {
         // Extract gyroscope data (in rad/s, convert to similar scale as original)
@@ -96,106 +384,73 @@ uint8_t DrumDetection_ProcessSensorData(sh2_SensorValue_t *sensorValue, DrumHitS
         float gyro_y_rads = sensorValue->un.gyroscope.y;
         int16_t gyro_y = (int16_t)(gyro_y_rads * 1000.0f);  // Approximate conversion
         
-        last_gyro_y = gyro_y;
+        det->lastGyroY = gyro_y;
+        
+#if DRUM_USE_STROKE_RECOGNIZER
+        StrokeHistory_Push(&det->gyroHistory, gyro_y);
+#if DRUM_USE_FUSED_ONSET
+        // Track the gyro_y threshold crossing the stroke window ends at
+        if (gyro_y < det->thresholds.gyroHit) {
+            if (!det->belowGyroHit) {
+                det->belowGyroHit = true;
+                det->strokeAnchorAge = 0;
+            } else if (det->strokeAnchorAge < STROKE_WINDOW_SAMPLES) {
+                det->strokeAnchorAge++;
+            }
+        } else {
+            det->belowGyroHit = false;
+            if (det->strokeAnchorAge < STROKE_WINDOW_SAMPLES) {
+                det->strokeAnchorAge++;
+            }
+        }
+#endif
+#endif
+        
+#if DRUM_USE_FUSED_ONSET || DRUM_YAW_DRIFT_COMPENSATION
+        int16_t gyro_x = (int16_t)(sensorValue->un.gyroscope.x * 1000.0f);
+        int16_t gyro_z = (int16_t)(sensorValue->un.gyroscope.z * 1000.0f);
+#endif
+        
+#if DRUM_YAW_DRIFT_COMPENSATION
+        YawDrift_AddGyro(&det->yawDrift, gyro_x, gyro_y, gyro_z);
+#endif
         
         // Debug: Always show gyro_y value and threshold comparison
-        static uint32_t gyro_debug_count = 0;
-        gyro_debug_count++;
-        if (gyro_debug_count % 10 == 0) {  // Print every 10th sample to avoid spam
-            RTT_PrintStr("[Gyro Check] gyro_y=");
-            RTT_PrintInt(gyro_y);
-            RTT_PrintStr(" threshold=");
-            RTT_PrintInt(GYRO_HIT_THRESHOLD);
-            RTT_PrintStr(" (");
-            RTT_PrintInt(gyro_y < GYRO_HIT_THRESHOLD ? 1 : 0);
-            RTT_PrintStr(") | Yaw=");
-            RTT_PrintFloat(last_yaw, 1);
-            RTT_PrintStr(" Pitch=");
-            RTT_PrintFloat(last_pitch, 1);
-            RTT_PrintNewline();
+        det->gyroDebugCount++;
+        if (det->gyroDebugCount % 10 == 0) {  // Print every 10th sample to avoid spam
+            BINLOG(BL_GYRO_CHECK, BL_I(gyro_y), BL_I(det->thresholds.gyroHit), BL_I(gyro_y < det->thresholds.gyroHit ? 1 : 0),
+                   BL_F(det->lastYaw), BL_F(det->lastPitch));
+        }
+        
+#if DRUM_USE_FUSED_ONSET
+        // Fused onset: angular deceleration on any axis plus a jerk spike
+        if (OnsetDetector_AddGyro(&det->onset, gyro_x, gyro_y, gyro_z)) {
+            state->hitDetected = true;
+            return handle_hit(det, state);
         }
         
+        if (det->onset.armed) {
+            state->hitDetected = false;
+        }
+#else
         // Hit detection logic for single sensor (right hand)
         // Check if gyro_y indicates a hit
-        if (gyro_y < GYRO_HIT_THRESHOLD && !state->printedForGyro) {
+        if (gyro_y < det->thresholds.gyroHit && !state->printedForGyro) {
             state->hitDetected = true;
             state->printedForGyro = true;
-            
-            // Enhanced debug output
-            RTT_PrintStr("*** HIT DETECTED *** Gyro_y: ");
-            RTT_PrintInt(gyro_y);
-            RTT_PrintStr(" (threshold: ");
-            RTT_PrintInt(GYRO_HIT_THRESHOLD);
-            RTT_PrintStr(") | Yaw: ");
-            RTT_PrintFloat(last_yaw, 1);
-            RTT_PrintStr(" Pitch: ");
-            RTT_PrintFloat(last_pitch, 1);
-            RTT_PrintStr(" -> ");
-            
-            // Determine which drum based on yaw angle
-            // Single sensor (right hand) zone mapping
-            if (last_yaw >= 20.0f && last_yaw <= 120.0f) {
-                // Snare drum
-                state->lastDrumSound = DRUM_SNARE;
-                RTT_PrintStr("SNARE (yaw zone: 20-120)");
-                RTT_PrintNewline();
-                return DRUM_SNARE;
-            }
-            else if (last_yaw >= 340.0f || last_yaw <= 20.0f) {
-                // High tom or crash cymbal
-                if (last_pitch > 50.0f) {
-                    state->lastDrumSound = DRUM_CRASH;
-                    RTT_PrintStr("CRASH (yaw: 340-360/0-20, pitch>50)");
-                    RTT_PrintNewline();
-                    return DRUM_CRASH;
-                } else {
-                    state->lastDrumSound = DRUM_HIGH_TOM;
-                    RTT_PrintStr("HIGH_TOM (yaw: 340-360/0-20, pitch<=50)");
-                    RTT_PrintNewline();
-                    return DRUM_HIGH_TOM;
-                }
-            }
-            else if (last_yaw >= 305.0f && last_yaw <= 340.0f) {
-                // Mid tom or ride cymbal
-                if (last_pitch > 50.0f) {
-                    state->lastDrumSound = DRUM_RIDE;
-                    RTT_PrintStr("RIDE (yaw: 305-340, pitch>50)");
-                    RTT_PrintNewline();
-                    return DRUM_RIDE;
-                } else {
-                    state->lastDrumSound = DRUM_MID_TOM;
-                    RTT_PrintStr("MID_TOM (yaw: 305-340, pitch<=50)");
-                    RTT_PrintNewline();
-                    return DRUM_MID_TOM;
-                }
-            }
-            else if (last_yaw >= 200.0f && last_yaw <= 305.0f) {
-                // Floor tom or ride cymbal
-                if (last_pitch > 30.0f) {
-                    state->lastDrumSound = DRUM_RIDE;
-                    RTT_PrintStr("RIDE (yaw: 200-305, pitch>30)");
-                    RTT_PrintNewline();
-                    return DRUM_RIDE;
-                } else {
-                    state->lastDrumSound = DRUM_LOW_TOM;
-                    RTT_PrintStr("LOW_TOM (yaw: 200-305, pitch<=30)");
-                    RTT_PrintNewline();
-                    return DRUM_LOW_TOM;
-                }
-            }
-            else {
-                RTT_PrintStr("UNKNOWN ZONE (yaw=");
-                RTT_PrintFloat(last_yaw, 1);
-                RTT_PrintStr(")");
-                RTT_PrintNewline();
-            }
-        } else if (gyro_y >= GYRO_HIT_THRESHOLD && state->printedForGyro) {
+            return handle_hit(det, state);
+        } else if (gyro_y >= det->thresholds.gyroHit && state->printedForGyro) {
             // Reset debounce flag when gyro returns to normal
             state->printedForGyro = false;
             state->hitDetected = false;
         }
+#endif
     }
     
     return DRUM_NONE;
 }
 
+// Process sensor data with the board's detector
+uint8_t DrumDetection_ProcessSensorData(sh2_SensorValue_t *sensorValue, DrumHitState_t *state) {
+    return DrumDetector_Process(&detector, sensorValue, state);
+}
\ No newline at end of file
@@ -2,7 +2,7 @@
 // Drum hit detection logic for invisible drum system
 //
 // Detects drum hits based on single BNO085 sensor data (right hand)
-// Uses quaternion (Game Rotation Vector) and gyroscope data
+// Uses quaternion (Game Rotation Vector), gyroscope and linear acceleration data
 
 #ifndef DRUM_DETECTION_H
 #define DRUM_DETECTION_H
@@ -10,7 +10,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "sh2_SensorValue.h"
-#include "sh2.h"  // For SH2_GAME_ROTATION_VECTOR and SH2_GYROSCOPE_CALIBRATED definitions
+#include "sh2.h"  // For SH2_GAME_ROTATION_VECTOR, SH2_GYROSCOPE_CALIBRATED and SH2_LINEAR_ACCELERATION definitions
+#include "onset_detector.h"
+#include "stroke_recognizer.h"
+#include "yaw_drift.h"
 
 // Drum sound IDs (matching original code)
 #define DRUM_SNARE       0
@@ -23,26 +26,127 @@
 #define DRUM_LOW_TOM     7
 #define DRUM_NONE        255
 
-// Hit detection threshold
+// Hit detection threshold (default; the runtime value is in DrumThresholds_t)
 #define GYRO_HIT_THRESHOLD  -2500  // gyro_y threshold for hit detection
 
-// Yaw offset for calibration
-extern float yawOffset;
+// Zone classifier selection
+// 0: hand-tuned if/else yaw/pitch rules (DrumDetection_ClassifyZone)
+// 1: offline-trained decision tree tables (drum_classifier_model.h)
+#ifndef DRUM_USE_TREE_CLASSIFIER
+#define DRUM_USE_TREE_CLASSIFIER  0
+#endif
+
+// Sticky zones: hits near a zone edge keep the previous drum unless the stick
+// clearly crossed over (per-zone exit margins in drum_detection.c)
+#ifndef DRUM_ZONE_HYSTERESIS
+#define DRUM_ZONE_HYSTERESIS  1
+#endif
+
+// Re-centre yawOffset from the learned resting yaw to cancel Game Rotation
+// Vector yaw drift (yaw_drift.c); button 2 re-zeroes and re-learns
+#ifndef DRUM_YAW_DRIFT_COMPENSATION
+#define DRUM_YAW_DRIFT_COMPENSATION  1
+#endif
+
+// Print a "STROKE,yaw,pitch,gyro_y" line on every hit for recording training data
+#ifndef DRUM_DETECTION_LOG_STROKES
+#define DRUM_DETECTION_LOG_STROKES  0
+#endif
+
+// Hit onset detection
+// 0: gyro_y threshold crossing (GYRO_HIT_THRESHOLD)
+// 1: fused angular deceleration + linear-acceleration jerk (onset_detector.c),
+//    needs SH2_LINEAR_ACCELERATION reports enabled
+#ifndef DRUM_USE_FUSED_ONSET
+#define DRUM_USE_FUSED_ONSET  1
+#endif
+
+// Match the gyro_y history before each hit against stroke templates
+// (accent/rimshot/ghost, see stroke_recognizer.c); result in lastStrokeType
+// The window always ends where gyro_y crossed gyroHit, the point the
+// templates are aligned to, also when the fused onset fires later.
+#ifndef DRUM_USE_STROKE_RECOGNIZER
+#define DRUM_USE_STROKE_RECOGNIZER  1
+#endif
 
 // Hit detection state
 typedef struct {
     bool hitDetected;
     bool printedForGyro;  // Debounce flag
     uint8_t lastDrumSound;
+    uint8_t lastStrokeType;  // STROKE_* of the last hit (STROKE_UNKNOWN if no match)
+    int16_t hitGyroY;        // gyro_y, yaw and pitch at the last hit
+    float hitYaw;
+    float hitPitch;
+    int32_t hitStrength;     // Swing speed of the last hit (rad/s * 1000), for velocity
 } DrumHitState_t;
 
+// Hit detection thresholds, kept in the config store (CONFIG_KEY_THRESHOLDS)
+// so tuned values survive a reboot
+#define DRUM_THRESHOLDS_VERSION  1
+
+typedef struct {
+    uint16_t version;
+    int16_t gyroHit;        // gyro_y threshold (DRUM_USE_FUSED_ONSET 0)
+    OnsetParams_t onset;    // Fused onset thresholds (DRUM_USE_FUSED_ONSET 1)
+} DrumThresholds_t;
+
+// Hand-tuned zone layout (DrumDetection_ClassifyZone), in degrees
+// Yaw is 0..360 after the offset; the high tom/crash zone wraps through 0.
+typedef struct {
+    float snareYawMin;     // Snare: snareYawMin..snareYawMax
+    float snareYawMax;
+    float highTomYawMin;   // High tom/crash: highTomYawMin..360 and 0..snareYawMin
+    float midTomYawMin;    // Mid tom/ride: midTomYawMin..highTomYawMin
+    float lowTomYawMin;    // Low tom/ride: lowTomYawMin..midTomYawMin
+    float cymbalPitch;     // Above this pitch the high/mid tom zones play crash/ride
+    float lowCymbalPitch;  // Above this pitch the low tom zone plays ride
+} DrumZoneLayout_t;
+
+// One detector instance: everything a hit decision depends on
+// The DrumDetection_* functions run the board's single instance; host tools
+// (host/sweep) run one DrumDetector_t per thread with their own parameters.
+typedef struct {
+    DrumThresholds_t thresholds;
+    DrumZoneLayout_t zones;
+    float yawOffset;         // Yaw calibration offset (drift compensation moves it)
+    float lastYaw;           // Orientation and gyro_y at the most recent samples
+    float lastPitch;
+    int16_t lastGyroY;
+    uint8_t lastZone;        // Zone of the last mapped hit (for hysteresis)
+    uint32_t gyroDebugCount;
+#if DRUM_YAW_DRIFT_COMPENSATION
+    YawDrift_t yawDrift;     // Resting-yaw drift estimator
+#endif
+#if DRUM_USE_FUSED_ONSET
+    OnsetDetector_t onset;   // Gyro + linear acceleration onset detector
+#endif
+#if DRUM_USE_STROKE_RECOGNIZER
+    StrokeHistory_t gyroHistory;  // Recent gyro_y samples for stroke-shape recognition
+#if DRUM_USE_FUSED_ONSET
+    uint16_t strokeAnchorAge;     // Gyro samples since gyro_y last crossed gyroHit
+    bool belowGyroHit;            // gyro_y is past gyroHit (crossing already counted)
+#endif
+#endif
+} DrumDetector_t;
+
 // Function prototypes
 void DrumDetection_Init(void);
+const DrumThresholds_t *DrumDetection_GetThresholds(void);
+int DrumDetection_SetThresholds(const DrumThresholds_t *thresholds);
 uint8_t DrumDetection_ProcessSensorData(sh2_SensorValue_t *sensorValue, DrumHitState_t *state);
 void DrumDetection_QuaternionToEuler(float q_real, float q_i, float q_j, float q_k, 
                                      float *roll, float *pitch, float *yaw);
 float DrumDetection_NormalizeYaw(float yaw);
+uint8_t DrumDetection_ClassifyZone(float yaw, float pitch);
 void DrumDetection_SetYawOffset(float offset);
+float DrumDetection_GetYawOffset(void);
+void DrumDetection_DefaultZones(DrumZoneLayout_t *zones);
+uint8_t DrumDetection_ClassifyLayout(const DrumZoneLayout_t *zones, float yaw, float pitch);
+
+// Detector instances (thresholds and zones NULL = built-in defaults)
+void DrumDetector_Init(DrumDetector_t *det, const DrumThresholds_t *thresholds, const DrumZoneLayout_t *zones);
+uint8_t DrumDetector_Process(DrumDetector_t *det, sh2_SensorValue_t *sensorValue, DrumHitState_t *state);
 
 #endif // DRUM_DETECTION_H
 
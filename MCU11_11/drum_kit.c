@@ -0,0 +1,105 @@
+// drum_kit.c
+// Drum kit selection implementation
+
+#include "drum_kit.h"
+#include "drum_detection.h"  // For the DRUM_* ids
+#include "config_store.h"
+#include "stroke_recognizer.h"  // For STROKE_RIMSHOT
+#include "STM32L432KC_RTT.h"  // For debug output (RTT)
+#include "wav_arrays/drum_samples.h"
+#include <stdint.h>
+#include <stddef.h>  // For NULL definition
+
+#define KIT_SAMPLE(name)  { name##_data, &name##_length, &name##_sample_rate }
+
+// Samples per kit, indexed by drum ID (DRUM_SNARE .. DRUM_LOW_TOM)
+static const DrumKitSample_t kits[DRUM_KIT_COUNT][DRUM_LOW_TOM + 1] = {
+    [DRUM_KIT_STANDARD] = {
+        [DRUM_SNARE]    = KIT_SAMPLE(snare_sample),
+        [DRUM_HIHAT]    = KIT_SAMPLE(hihat_closed_sample),
+        [DRUM_KICK]     = KIT_SAMPLE(kick_sample),
+        [DRUM_HIGH_TOM] = KIT_SAMPLE(tom_high_sample),
+        [DRUM_MID_TOM]  = KIT_SAMPLE(tom_high_sample),
+        [DRUM_CRASH]    = KIT_SAMPLE(crash_sample),
+        [DRUM_RIDE]     = KIT_SAMPLE(ride_sample),
+        [DRUM_LOW_TOM]  = KIT_SAMPLE(tom_low_sample),
+    },
+    [DRUM_KIT_OPEN] = {
+        [DRUM_SNARE]    = KIT_SAMPLE(snare_sample),
+        [DRUM_HIHAT]    = KIT_SAMPLE(hihat_open_sample),
+        [DRUM_KICK]     = KIT_SAMPLE(kick_sample),
+        [DRUM_HIGH_TOM] = KIT_SAMPLE(tom_high_sample),
+        [DRUM_MID_TOM]  = KIT_SAMPLE(tom_low_sample),
+        [DRUM_CRASH]    = KIT_SAMPLE(crash_sample),
+        [DRUM_RIDE]     = KIT_SAMPLE(crash_sample),
+        [DRUM_LOW_TOM]  = KIT_SAMPLE(tom_low_sample),
+    },
+};
+
+// General MIDI percussion notes (channel 10), indexed like the samples
+static const uint8_t midiNotes[DRUM_KIT_COUNT][DRUM_LOW_TOM + 1] = {
+    [DRUM_KIT_STANDARD] = {
+        [DRUM_SNARE] = 38, [DRUM_HIHAT] = 42, [DRUM_KICK] = 36, [DRUM_HIGH_TOM] = 50,
+        [DRUM_MID_TOM] = 47, [DRUM_CRASH] = 49, [DRUM_RIDE] = 51, [DRUM_LOW_TOM] = 43,
+    },
+    [DRUM_KIT_OPEN] = {
+        [DRUM_SNARE] = 38, [DRUM_HIHAT] = 46, [DRUM_KICK] = 36, [DRUM_HIGH_TOM] = 50,
+        [DRUM_MID_TOM] = 45, [DRUM_CRASH] = 49, [DRUM_RIDE] = 57, [DRUM_LOW_TOM] = 43,
+    },
+};
+
+// A rimshot on the snare plays the side stick note instead
+#define MIDI_NOTE_SIDE_STICK  37
+
+static const char *const kitNames[DRUM_KIT_COUNT] = { "standard", "open" };
+
+static volatile uint8_t currentKit = DRUM_KIT_STANDARD;
+
+// Restore the saved kit (config store must be initialised)
+void DrumKit_Init(void) {
+    uint8_t kit;
+    currentKit = DRUM_KIT_STANDARD;
+    if (ConfigStore_Get(CONFIG_KEY_KIT, &kit, sizeof(kit)) == (int)sizeof(kit) && kit < DRUM_KIT_COUNT) {
+        currentKit = kit;
+    }
+    DEBUG_PRINT("[Kit] ");
+    DEBUG_PRINTLN(kitNames[currentKit]);
+}
+
+uint8_t DrumKit_Current(void) {
+    return currentKit;
+}
+
+// Switch kits now and save the choice
+// Returns a CONFIG_STORE_* code (CONFIG_STORE_ERROR for an unknown kit);
+// on CONFIG_STORE_BUSY the kit is in use but not yet saved
+int DrumKit_Select(uint8_t kit) {
+    if (kit >= DRUM_KIT_COUNT) {
+        return CONFIG_STORE_ERROR;
+    }
+    currentKit = kit;
+    return ConfigStore_Set(CONFIG_KEY_KIT, &kit, sizeof(kit));
+}
+
+const char *DrumKit_Name(uint8_t kit) {
+    return (kit < DRUM_KIT_COUNT) ? kitNames[kit] : "?";
+}
+
+// Sample for a drum in the current kit, or NULL for an unknown drum ID
+const DrumKitSample_t *DrumKit_Sample(uint8_t drumId) {
+    if (drumId > DRUM_LOW_TOM) {
+        return NULL;
+    }
+    return &kits[currentKit][drumId];
+}
+
+// MIDI note for a drum in the current kit (0 for an unknown drum ID)
+uint8_t DrumKit_MidiNote(uint8_t drumId, uint8_t strokeType) {
+    if (drumId > DRUM_LOW_TOM) {
+        return 0;
+    }
+    if (drumId == DRUM_SNARE && strokeType == STROKE_RIMSHOT) {
+        return MIDI_NOTE_SIDE_STICK;
+    }
+    return midiNotes[currentKit][drumId];
+}
@@ -0,0 +1,33 @@
+// drum_kit.h
+// Drum kits: which sample each drum ID plays
+//
+// A kit maps the eight DRUM_* ids to samples in wav_arrays/ and to General
+// MIDI percussion notes for the MIDI output (midi_out.c). The selected
+// kit is kept in the config store (CONFIG_KEY_KIT) and can be changed at run
+// time over the serial link.
+
+#ifndef DRUM_KIT_H
+#define DRUM_KIT_H
+
+#include <stdint.h>
+
+#define DRUM_KIT_COUNT     2
+#define DRUM_KIT_STANDARD  0  // Closed hi-hat, high tom doubles as mid tom
+#define DRUM_KIT_OPEN      1  // Open hi-hat, low tom as mid tom, crash on ride
+
+// One sample (lengths are extern consts in wav_arrays/, so held by pointer)
+typedef struct {
+    const int16_t *data;
+    const uint32_t *length;
+    const uint32_t *sampleRate;
+} DrumKitSample_t;
+
+// Function prototypes
+void DrumKit_Init(void);
+uint8_t DrumKit_Current(void);
+int DrumKit_Select(uint8_t kit);
+const char *DrumKit_Name(uint8_t kit);
+const DrumKitSample_t *DrumKit_Sample(uint8_t drumId);
+uint8_t DrumKit_MidiNote(uint8_t drumId, uint8_t strokeType);
+
+#endif // DRUM_KIT_H
@@ -0,0 +1,101 @@
+// flash_bench.c
+// Flash accelerator (ART) tuning from measured kernel timings implementation
+
+#include "flash_bench.h"
+#include "bench_kernels.h"
+#include "STM32L432KC_FLASH.h"
+#include "STM32L432KC_DWT.h"
+#include "STM32L432KC_RTT.h"  // For debug output (RTT)
+#include <stdint.h>
+
+#define ART_BITS  (FLASH_ACR_ICEN | FLASH_ACR_DCEN | FLASH_ACR_PRFTEN)
+#define NUM_CONFIGS  8
+
+// Set the ART bits of FLASH_ACR (latency untouched) and start from cold caches
+static void apply_config(uint32_t bits) {
+    FLASH->ACR = (FLASH->ACR & ~ART_BITS) | bits;
+    FLASH_ResetCaches();
+}
+
+// ART bits for configuration c (bit 0 = ICEN, bit 1 = DCEN, bit 2 = PRFTEN)
+static uint32_t config_bits(int c) {
+    return ((c & 1) ? FLASH_ACR_ICEN : 0) |
+           ((c & 2) ? FLASH_ACR_DCEN : 0) |
+           ((c & 4) ? FLASH_ACR_PRFTEN : 0);
+}
+
+// Average cycles per call of one kernel, including the cold first call
+static uint32_t time_kernel(const BenchKernel_t *kernel) {
+    uint32_t start = DWT_GET_CYCLES();
+    for (int i = 0; i < FLASH_BENCH_CALLS; i++) {
+        kernel->run();
+    }
+    return (DWT_GET_CYCLES() - start) / FLASH_BENCH_CALLS;
+}
+
+// Time every kernel under every ART configuration, apply the fastest
+// Returns the ART bits left in FLASH_ACR. Run after DrumDetection_Init()
+// and call it again afterwards (the detect kernel moves detector state).
+uint32_t FlashBench_Run(void) {
+    uint32_t best = 0;
+    uint32_t bestTotal = 0xFFFFFFFF;
+    uint32_t original = FLASH->ACR & ART_BITS;
+    
+    DWT_Init();
+    
+    DEBUG_PRINT("[FlashBench] cycles/call over ");
+    DEBUG_PRINT_INT(FLASH_BENCH_CALLS);
+    DEBUG_PRINT(" calls: IC DC PF");
+    for (int k = 0; k < BENCH_NUM_KERNELS; k++) {
+        DEBUG_PRINT(" | ");
+        DEBUG_PRINT(benchKernels[k].name);
+    }
+    DEBUG_PRINT(" | total");
+    DEBUG_PRINT_NEWLINE();
+    
+    for (int c = 0; c < NUM_CONFIGS; c++) {
+        uint32_t bits = config_bits(c);
+        uint32_t total = 0;
+        
+        BenchKernels_Init();
+        apply_config(bits);
+        
+        DEBUG_PRINT("[FlashBench] ");
+        DEBUG_PRINT((c & 1) ? " 1" : " 0");
+        DEBUG_PRINT((c & 2) ? "  1" : "  0");
+        DEBUG_PRINT((c & 4) ? "  1" : "  0");
+        for (int k = 0; k < BENCH_NUM_KERNELS; k++) {
+            uint32_t cycles = time_kernel(&benchKernels[k]);
+            total += cycles;
+            DEBUG_PRINT(" | ");
+            DEBUG_PRINT_INT(cycles);
+        }
+        DEBUG_PRINT(" | ");
+        DEBUG_PRINT_INT(total);
+        DEBUG_PRINT_NEWLINE();
+        
+        if (total < bestTotal) {
+            bestTotal = total;
+            best = bits;
+        }
+    }
+    
+    apply_config(best);
+    
+    DEBUG_PRINT("[FlashBench] applied IC=");
+    DEBUG_PRINT_INT((best & FLASH_ACR_ICEN) ? 1 : 0);
+    DEBUG_PRINT(" DC=");
+    DEBUG_PRINT_INT((best & FLASH_ACR_DCEN) ? 1 : 0);
+    DEBUG_PRINT(" PF=");
+    DEBUG_PRINT_INT((best & FLASH_ACR_PRFTEN) ? 1 : 0);
+    DEBUG_PRINT(" (was IC=");
+    DEBUG_PRINT_INT((original & FLASH_ACR_ICEN) ? 1 : 0);
+    DEBUG_PRINT(" DC=");
+    DEBUG_PRINT_INT((original & FLASH_ACR_DCEN) ? 1 : 0);
+    DEBUG_PRINT(" PF=");
+    DEBUG_PRINT_INT((original & FLASH_ACR_PRFTEN) ? 1 : 0);
+    DEBUG_PRINT(")");
+    DEBUG_PRINT_NEWLINE();
+    
+    return best;
+}
@@ -0,0 +1,29 @@
+// flash_bench.h
+// Flash accelerator (ART) tuning from measured kernel timings
+//
+// configureFlash() sets the 4 wait states the 80MHz clock needs. Which of the
+// ART instruction cache, data cache and prefetch buffer then help depends on
+// the code, so FlashBench_Run() measures instead of guessing: for each of the
+// 8 ICEN/DCEN/PRFTEN combinations it times the bench_kernels.h workloads with
+// the DWT cycle counter, prints cycles per call over RTT, and leaves the
+// configuration with the lowest total in FLASH_ACR.
+
+#ifndef FLASH_BENCH_H
+#define FLASH_BENCH_H
+
+#include <stdint.h>
+
+// Measure and apply the best ART configuration at boot (opt-in: it adds
+// the timing runs and their RTT table to every boot)
+#ifndef FLASH_BENCH
+#define FLASH_BENCH  0
+#endif
+
+// Calls per kernel and configuration; the first starts from the cold caches
+// apply_config() leaves, and is averaged in
+#define FLASH_BENCH_CALLS  64
+
+// Function prototypes
+uint32_t FlashBench_Run(void);
+
+#endif // FLASH_BENCH_H
@@ -0,0 +1,143 @@
+// bench_host.c
+// Host runner for the bench_kernels.h micro-benchmarks
+//
+// Times the same decode/detect/mix/Euler kernels that flash_bench.c times on
+// the board, with the host monotonic clock. Each kernel runs in batches of
+// --calls calls; the median batch gives ns per call. --save writes the
+// results as CSV and --compare prints the change against such a file, so a
+// result from one commit can be checked against another. The checksum folds
+// every kernel result; it differs between builds only if the computation did.
+//
+// Build (from this folder):
+//   gcc -std=c99 -O2 -I.. -include host_shim.h -o bench_host bench_host.c host_stubs.c ../bench_kernels.c ../drum_detection.c ../drum_classifier.c ../drum_calibration.c ../crc32.c ../stroke_recognizer.c ../onset_detector.c ../yaw_drift.c ../binlog.c ../sh2_SensorValue.c ../sh2_util.c ../wav_arrays/*.c -lm
+//
+// Run:
+//   ./bench_host [--calls n] [--batches n] [--save results.csv] [--compare baseline.csv]
+// Exit status 2 when --max-regress P is given and a kernel is more than P
+// percent slower than the baseline.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench_kernels.h"
+#include "drum_detection.h"
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Median ns per call of one kernel
+static double time_kernel(const BenchKernel_t *kernel, int calls, int batches) {
+    double *ns = malloc((size_t)batches * sizeof *ns);
+    
+    kernel->run();  // Warm-up
+    for (int b = 0; b < batches; b++) {
+        uint64_t t0 = now_ns();
+        for (int i = 0; i < calls; i++) {
+            kernel->run();
+        }
+        ns[b] = (double)(now_ns() - t0) / calls;
+    }
+    qsort(ns, (size_t)batches, sizeof *ns, cmp_double);
+    double median = ns[batches / 2];
+    free(ns);
+    return median;
+}
+
+// Baseline ns per call for a kernel name, or a negative value
+static double baseline_ns(const char *path, const char *name) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return -1.0;
+    }
+    char line[128], kname[64];
+    double ns, found = -1.0;
+    while (fgets(line, sizeof line, f)) {
+        if (sscanf(line, "%63[^,],%lf", kname, &ns) == 2 && strcmp(kname, name) == 0) {
+            found = ns;
+        }
+    }
+    fclose(f);
+    return found;
+}
+
+int main(int argc, char **argv) {
+    const char *savePath = NULL, *comparePath = NULL;
+    int calls = 1000, batches = 31;
+    double maxRegress = -1.0;
+    
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--calls") == 0 && a + 1 < argc) {
+            calls = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--batches") == 0 && a + 1 < argc) {
+            batches = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--save") == 0 && a + 1 < argc) {
+            savePath = argv[++a];
+        } else if (strcmp(argv[a], "--compare") == 0 && a + 1 < argc) {
+            comparePath = argv[++a];
+        } else if (strcmp(argv[a], "--max-regress") == 0 && a + 1 < argc) {
+            maxRegress = atof(argv[++a]);
+        } else {
+            fprintf(stderr, "usage: %s [--calls n] [--batches n] [--save results.csv]\n"
+                            "       [--compare baseline.csv] [--max-regress P]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (calls < 1) calls = 1;
+    if (batches < 1) batches = 1;
+    
+    HostStubs_Init();
+    DrumDetection_Init();
+    BenchKernels_Init();
+    
+    FILE *save = NULL;
+    if (savePath) {
+        save = fopen(savePath, "w");
+        if (!save) {
+            perror(savePath);
+            return 1;
+        }
+        fprintf(save, "kernel,ns_per_call\n");
+    }
+    
+    int regressed = 0;
+    printf("%-8s %10s", "kernel", "ns/call");
+    if (comparePath) printf(" %10s %8s", "baseline", "change");
+    printf("\n");
+    
+    for (int k = 0; k < BENCH_NUM_KERNELS; k++) {
+        double ns = time_kernel(&benchKernels[k], calls, batches);
+        printf("%-8s %10.1f", benchKernels[k].name, ns);
+        if (comparePath) {
+            double base = baseline_ns(comparePath, benchKernels[k].name);
+            if (base > 0.0) {
+                double change = 100.0 * (ns - base) / base;
+                printf(" %10.1f %+7.1f%%", base, change);
+                if (maxRegress >= 0.0 && change > maxRegress) {
+                    printf("  REGRESSED");
+                    regressed = 1;
+                }
+            } else {
+                printf(" %10s %8s", "-", "-");
+            }
+        }
+        printf("\n");
+        if (save) {
+            fprintf(save, "%s,%.1f\n", benchKernels[k].name, ns);
+        }
+    }
+    printf("checksum %08X\n", (unsigned)BenchKernels_Checksum());
+    
+    if (save) {
+        fclose(save);
+    }
+    return regressed ? 2 : 0;
+}
@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+# binlog_decode.py
+# Decodes deferred binary log records (binlog.h) in an RTT log back to text
+#
+# The firmware writes BINLOG() records as binary among the ordinary RTT text.
+# This tool copies the text through unchanged and replaces every record with
+# the line its format in binlog_messages.h produces, so the output reads like
+# the old printf log (and host/replay.c --log still parses it). SHTP capture
+# frames (shtp_capture.h) are passed through untouched.
+#
+# Usage:
+#   python3 binlog_decode.py rtt_log.bin [-o decoded.txt] [--time [--cpu-hz 80e6]] [--stats]
+#
+# --time prefixes every record with its DWT timestamp in ms, converted at the
+# rate in the BL_CLOCK record BinLog_Init() logs at boot (the measured
+# SYSCLK); --cpu-hz overrides it for logs without one. The counter wraps
+# every 2^32 cycles (~53 s at 80MHz). --stats prints records per message
+# and the number lost to a full ring (sequence gaps) to stderr.
+#
+# SHTP capture frames are recognised up to the largest transfer the SPI HAL
+# buffers hold, read from sh2_hal.h.
+#
+# No third-party packages required.
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+BINLOG_SYNC = 0xB1
+BINLOG_PAD_ID = 0xFF
+CAPTURE_SYNC = 0xA5
+CAPTURE_HDR_LEN = 8
+CAPTURE_WRITE = 0x8000
+NOMINAL_CPU_HZ = 80e6
+
+MESSAGES_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "binlog_messages.h")
+SH2_HAL_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "sh2_hal.h")
+DEFINE_RE = re.compile(r"^#define\s+(\w+)\s+(.+)$")
+ENTRY_RE = re.compile(r'X\(\s*(\w+)\s*,\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+SPEC_RE = re.compile(r"%(?:\.\d)?([udxf%])")
+
+
+def load_messages(path):
+    """Return [(name, format, [conversion per argument])] in id order."""
+    with open(path) as f:
+        text = f.read()
+    messages = []
+    for name, _level, fmt in ENTRY_RE.findall(text):
+        convs = [c for c in SPEC_RE.findall(fmt) if c != "%"]
+        messages.append((name, fmt, convs))
+    return messages
+
+
+def load_defines(path):
+    """Return {name: expression} for the #defines of a header."""
+    with open(path) as f:
+        text = f.read().replace("\\\n", " ")
+    defines = {}
+    for line in text.splitlines():
+        m = DEFINE_RE.match(line.split("//")[0].strip())
+        if m:
+            defines[m.group(1)] = m.group(2)
+    return defines
+
+
+def define_value(defines, name):
+    """Evaluate an integer #define built from +, -, * and other #defines."""
+    expr = re.sub(r"[A-Za-z_]\w*", lambda m: str(define_value(defines, m.group(0))), defines[name])
+    return int(eval(expr, {"__builtins__": {}}))
+
+
+def max_transfer(path):
+    """Largest SHTP transfer in either direction, as sh2_hal.h sizes the HAL buffers."""
+    defines = load_defines(path)
+    payload_in = max(define_value(defines, "SH2_ADVERT_PAYLOAD_MAX"),
+                     define_value(defines, "SH2_INPUT_PAYLOAD_MAX"))
+    return max(4 + payload_in, define_value(defines, "SH2_HAL_MAX_TRANSFER_OUT"))
+
+
+def format_record(message, words):
+    _name, fmt, convs = message
+    args = []
+    for conv, word in zip(convs, words):
+        if conv == "f":
+            args.append(struct.unpack("<f", struct.pack("<I", word))[0])
+        elif conv == "d":
+            args.append(word - (1 << 32) if word & 0x80000000 else word)
+        else:
+            args.append(word)
+    return fmt % tuple(args)
+
+
+def capture_frame_len(data, i, limit):
+    """Length of a valid SHTP capture frame at i, or 0."""
+    if i + CAPTURE_HDR_LEN + 4 > len(data):
+        return 0
+    n = (data[i + 2] | (data[i + 3] << 8)) & ~CAPTURE_WRITE
+    if n < 4 or n > limit or i + CAPTURE_HDR_LEN + n > len(data):
+        return 0
+    body = i + CAPTURE_HDR_LEN
+    if ((data[body] | (data[body + 1] << 8)) & 0x7FFF) != n:
+        return 0
+    return CAPTURE_HDR_LEN + n
+
+
+def decode(data, messages, show_time, transfer_limit, cpu_hz=None):
+    """Return the decoded log and the (id, seq) of every record.
+
+    Timestamps use cpu_hz if given, else the latest BL_CLOCK record.
+    """
+    out = bytearray()
+    records = []
+    clock_hz = cpu_hz
+    warned = False
+    i = 0
+    while i < len(data):
+        b = data[i]
+        if b == BINLOG_SYNC and i + 4 <= len(data) and data[i + 1] == BINLOG_PAD_ID and data[i + 3] == 0:
+            # Unused words at the end of the firmware's ring
+            end = i + 4 + 4 * data[i + 2]
+            if end <= len(data):
+                i = end
+                continue
+        if b == BINLOG_SYNC and i + 8 <= len(data):
+            msg_id, count, seq = data[i + 1], data[i + 2], data[i + 3]
+            end = i + 8 + 4 * count
+            if msg_id < len(messages) and count == len(messages[msg_id][2]) and end <= len(data):
+                cycles = struct.unpack_from("<I", data, i + 4)[0]
+                words = struct.unpack_from("<%dI" % count, data, i + 8)
+                if messages[msg_id][0] == "BL_CLOCK" and cpu_hz is None:
+                    clock_hz = words[0]
+                line = format_record(messages[msg_id], words)
+                if show_time:
+                    if not clock_hz:
+                        if not warned:
+                            print("no BL_CLOCK record before the first timestamp, assuming %.0f MHz "
+                                  "(use --cpu-hz)" % (NOMINAL_CPU_HZ / 1e6), file=sys.stderr)
+                            warned = True
+                        clock_hz = NOMINAL_CPU_HZ
+                    line = "%10.3f %s" % (cycles / float(clock_hz) * 1000.0, line)
+                out += line.encode() + b"\r\n"
+                records.append((msg_id, seq))
+                i = end
+                continue
+        if b == CAPTURE_SYNC:
+            n = capture_frame_len(data, i, transfer_limit)
+            if n:
+                out += data[i:i + n]
+                i += n
+                continue
+        out.append(b)
+        i += 1
+    return bytes(out), records
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Decode binlog records in an RTT log")
+    ap.add_argument("log", help="RTT log with binary records")
+    ap.add_argument("-o", "--output", help="decoded log (default: stdout)")
+    ap.add_argument("--time", action="store_true", help="prefix records with the DWT time in ms")
+    ap.add_argument("--cpu-hz", type=float, help="DWT clock for --time (default: the BL_CLOCK record)")
+    ap.add_argument("--stats", action="store_true", help="print record counts and losses to stderr")
+    ap.add_argument("--messages", default=MESSAGES_H, help="string table (binlog_messages.h)")
+    ap.add_argument("--hal", default=SH2_HAL_H, help="SPI HAL buffer sizes (sh2_hal.h)")
+    args = ap.parse_args()
+
+    messages = load_messages(args.messages)
+    with open(args.log, "rb") as f:
+        data = f.read()
+    out, records = decode(data, messages, args.time, max_transfer(args.hal), args.cpu_hz)
+
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(out)
+    else:
+        sys.stdout.buffer.write(out)
+
+    if args.stats:
+        counts = [0] * len(messages)
+        lost = 0
+        for k, (msg_id, seq) in enumerate(records):
+            counts[msg_id] += 1
+            if k > 0:
+                lost += (seq - records[k - 1][1] - 1) & 0xFF
+        for (name, _fmt, _convs), n in zip(messages, counts):
+            if n:
+                print("%-16s %8d" % (name, n), file=sys.stderr)
+        print("%-16s %8d" % ("lost", lost), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+# capture.py
+# Full-rate binary sensor capture: recorder and converters
+#
+# Records the batched capture stream of the serial link (sensor_capture.h)
+# into a .dcap file and converts it for analysis. A .dcap file is the
+# 44-byte LinkCaptureHeader_t (magic "DCAP", sensor ids, Q points and report
+# intervals) followed by 16-byte LinkCaptureRecord_t records: timestamp,
+# sensor id, status, hub sequence and four raw int16 values. NumPy reads it
+# directly:
+#   rec = np.fromfile("s.dcap", offset=44, dtype=[("t", "<u4"), ("id", "u1"),
+#                     ("status", "u1"), ("seq", "u1"), ("pad", "u1"), ("v", "<i2", 4)])
+#
+# Usage:
+#   python3 capture.py record /dev/ttyACM0 session.dcap [--seconds 60]
+#   python3 capture.py info session.dcap
+#   python3 capture.py csv session.dcap session.csv [--replay]
+#   python3 capture.py npy session.dcap session_npy/
+#   python3 capture.py session session.dcap session.dses [--labels labels.csv]
+#
+# record prints the rate per sensor every two seconds, with the records lost
+# on the link (batch index gaps) and before it (hub sequence gaps). csv writes
+# t_us,sensor,status,seq,v0..v3 in physical units; --replay writes the
+# t_ms,Q|G|A,... trace format of host/replay.c instead. npy writes one .npy
+# file per column and sensor (grv_t_us.npy, grv_v.npy, grv_status.npy, ...).
+# session converts to the columnar .dses format (session/session_format.h):
+# one row per gyro report with the latest quaternion and acceleration, and
+# labels (replay.c format: ms from the first record, drum name or number) on
+# the first row at or after each label time. record --session FILE appends
+# the same rows while recording.
+#
+# No third-party packages required.
+
+import argparse
+import os
+import struct
+import sys
+import time
+
+from drumlink import (CAPTURE_BATCHED, CAPTURE_HEADER_SIZE, CAPTURE_OFF, CAPTURE_RECORD,
+                      DRUM_NAMES, SENSOR_NAMES, DrumLink, LinkError, decode_capture_header,
+                      decode_event)
+from session_file import RowBuilder, SessionWriter
+
+REPLAY_KINDS = {0x08: "Q", 0x02: "G", 0x04: "A"}
+VALUE_COUNTS = {0x08: 4}  # Others have x, y, z
+
+
+def sensor_name(sid):
+    return SENSOR_NAMES.get(sid, "s%02x" % sid)
+
+
+class Recorder:
+    def __init__(self, out, rows=None):
+        self.out = out
+        self.rows = rows  # RowBuilder for --session
+        self.scale = {}
+        self.wraps = 0
+        self.last_t = None
+        self.header = None
+        self.expected = 0
+        self.records = 0
+        self.link_lost = 0
+        self.hub_lost = 0
+        self.last_seq = {}
+        self.counts = {}
+
+    def on_event(self, kind, f):
+        if kind == "capture_header":
+            if self.header is None:
+                self.header = f
+                self.out.write(f["raw"])
+                self.scale = {s["sensorId"]: 2.0 ** -s["qPoint"] for s in f["sensors"]}
+            return
+        if kind != "capture" or self.header is None:
+            return
+        if f["firstRecord"] > self.expected:
+            self.link_lost += f["firstRecord"] - self.expected
+            self.last_seq = {}  # Hub sequence gaps across the hole are link losses
+        self.expected = f["firstRecord"] + f["count"]
+        self.out.write(f["records"])
+        self.records += f["count"]
+        for t, sid, _status, seq, *raw in CAPTURE_RECORD.iter_unpack(f["records"]):
+            if sid in self.last_seq:
+                self.hub_lost += (seq - self.last_seq[sid] - 1) & 0xFF
+            self.last_seq[sid] = seq
+            self.counts[sid] = self.counts.get(sid, 0) + 1
+            if self.rows:
+                if self.last_t is not None and t < self.last_t and self.last_t - t > 0x80000000:
+                    self.wraps += 1
+                self.last_t = t
+                k = self.scale.get(sid, 1.0)
+                self.rows.add((self.wraps << 32) | t, sid, [v * k for v in raw])
+
+    def progress(self, elapsed):
+        rates = " ".join("%s %.0f/s" % (sensor_name(s), n / elapsed) for s, n in sorted(self.counts.items()))
+        return "%6.1f s  %d records  %s  lost: link %d hub %d" % (
+            elapsed, self.records, rates, self.link_lost, self.hub_lost)
+
+
+def cmd_record(args):
+    try:
+        link = DrumLink(args.port, args.baud)
+    except (OSError, LinkError) as e:
+        sys.exit("%s: %s" % (args.port, e))
+    session = SessionWriter(args.session) if args.session else None
+    rec = Recorder(open(args.file, "wb"), RowBuilder(session) if session else None)
+    start = time.monotonic()
+    next_report = start + 2.0
+    try:
+        link.set_streams(0, CAPTURE_BATCHED)
+        for kind, f in link.events():
+            rec.on_event(kind, f)
+            now = time.monotonic()
+            if now >= next_report:
+                print(rec.progress(now - start), flush=True)
+                next_report = now + 2.0
+            if args.seconds and now - start >= args.seconds:
+                break
+    except KeyboardInterrupt:
+        pass
+    except LinkError as e:
+        print(e, file=sys.stderr)
+    finally:
+        try:
+            link.set_streams(0, CAPTURE_OFF)
+            # The final partial batch arrives with the reply
+            for msg_type, body in link.pending:
+                event = decode_event(msg_type, body)
+                if event:
+                    rec.on_event(*event)
+        except LinkError:
+            pass
+        link.close()
+        rec.out.close()
+        if session:
+            session.close()
+    if rec.header is None:
+        sys.exit("no capture header received (firmware without batched capture?)")
+    print(rec.progress(max(time.monotonic() - start, 1e-3)))
+
+
+def load(path):
+    """Return (header dict, list of (t_us unwrapped, sensorId, status, seq, values))."""
+    with open(path, "rb") as f:
+        data = f.read()
+    header = decode_capture_header(data)
+    if header["recordSize"] != CAPTURE_RECORD.size:
+        raise ValueError("record size %d, expected %d" % (header["recordSize"], CAPTURE_RECORD.size))
+    scale = {s["sensorId"]: 2.0 ** -s["qPoint"] for s in header["sensors"]}
+    body = data[CAPTURE_HEADER_SIZE:]
+    body = body[:len(body) - len(body) % CAPTURE_RECORD.size]
+    records = []
+    wraps, last = 0, None
+    for t, sid, status, seq, *raw in CAPTURE_RECORD.iter_unpack(body):
+        if last is not None and t < last and last - t > 0x80000000:
+            wraps += 1
+        last = t
+        k = scale.get(sid, 1.0)
+        values = [v * k for v in raw[:VALUE_COUNTS.get(sid, 3)]]
+        records.append(((wraps << 32) | t, sid, status, seq, values))
+    return header, records
+
+
+def cmd_info(args):
+    header, records = load(args.file)
+    print("version %d, %d records" % (header["version"], len(records)))
+    for s in header["sensors"]:
+        times = [r[0] for r in records if r[1] == s["sensorId"]]
+        span = (times[-1] - times[0]) / 1e6 if len(times) > 1 else 0.0
+        rate = (len(times) - 1) / span if span > 0 else 0.0
+        print("  %-7s Q%-2d interval %6d us  %7d records  %.1f Hz measured" % (
+            sensor_name(s["sensorId"]), s["qPoint"], s["intervalUs"], len(times), rate))
+
+
+def cmd_csv(args):
+    _header, records = load(args.file)
+    t0 = records[0][0] if records else 0
+    with open(args.out, "w") as out:
+        if not args.replay:
+            out.write("t_us,sensor,status,seq,v0,v1,v2,v3\n")
+        for t, sid, status, seq, values in records:
+            if args.replay:
+                if sid not in REPLAY_KINDS:
+                    continue
+                out.write("%d,%s,%s\n" % ((t - t0) // 1000, REPLAY_KINDS[sid],
+                                          ",".join("%.7g" % v for v in values)))
+            else:
+                padded = values + [0.0] * (4 - len(values))
+                out.write("%d,%s,%d,%d,%s\n" % (t, sensor_name(sid), status, seq,
+                                                ",".join("%.7g" % v for v in padded)))
+
+
+def write_npy(path, dtype, shape, data):
+    # NPY format 1.0: magic, header dict padded to 64 bytes, raw little-endian data
+    header = "{'descr': '%s', 'fortran_order': False, 'shape': %s, }" % (dtype, repr(shape))
+    pad = 64 - (10 + len(header) + 1) % 64
+    header += " " * pad + "\n"
+    with open(path, "wb") as f:
+        f.write(b"\x93NUMPY\x01\x00" + struct.pack("<H", len(header)) + header.encode("latin-1"))
+        f.write(data)
+
+
+def cmd_npy(args):
+    header, records = load(args.file)
+    os.makedirs(args.outdir, exist_ok=True)
+    for s in header["sensors"]:
+        sid = s["sensorId"]
+        rows = [r for r in records if r[1] == sid]
+        name = sensor_name(sid)
+        width = VALUE_COUNTS.get(sid, 3)
+        base = os.path.join(args.outdir, name)
+        write_npy(base + "_t_us.npy", "<u8", (len(rows),),
+                  struct.pack("<%dQ" % len(rows), *(r[0] for r in rows)))
+        write_npy(base + "_v.npy", "<f4", (len(rows), width),
+                  struct.pack("<%df" % (len(rows) * width), *(v for r in rows for v in r[4])))
+        write_npy(base + "_status.npy", "|u1", (len(rows),), bytes(r[2] for r in rows))
+        print("%s: %d rows" % (base, len(rows)))
+
+
+def load_labels(path, t0_us):
+    """replay.c label file to [(t_us, drum)]; times are ms from the first record."""
+    labels = []
+    with open(path) as f:
+        for n, line in enumerate(f, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            t_ms, _, drum = line.partition(",")
+            drum = drum.strip()
+            if drum.upper() in DRUM_NAMES:
+                drum_id = DRUM_NAMES.index(drum.upper())
+            elif drum.isdigit() and int(drum) < len(DRUM_NAMES):
+                drum_id = int(drum)
+            else:
+                print("%s:%d: bad label, skipped" % (path, n), file=sys.stderr)
+                continue
+            labels.append((t0_us + int(t_ms) * 1000, drum_id))
+    return labels
+
+
+def cmd_session(args):
+    _header, records = load(args.file)
+    writer = SessionWriter(args.out, args.chunk_rows)
+    rows = RowBuilder(writer)
+    if args.labels and records:
+        rows.add_labels(load_labels(args.labels, records[0][0]))
+    for t, sid, _status, _seq, values in records:
+        rows.add(t, sid, values)
+    writer.close()
+    print("%s: %d rows" % (args.out, writer.rows))
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Full-rate binary sensor capture")
+    sub = ap.add_subparsers(dest="command", required=True)
+    p = sub.add_parser("record", help="record the capture stream to a .dcap file")
+    p.add_argument("port")
+    p.add_argument("file")
+    p.add_argument("--baud", type=int, default=1000000, help="SERIAL_LINK_BAUD (default 1000000)")
+    p.add_argument("--seconds", type=float, default=0.0, help="stop after this long (default: Ctrl-C)")
+    p.add_argument("--session", help="also append rows to a .dses session file")
+    p = sub.add_parser("info", help="sensors, record counts and measured rates")
+    p.add_argument("file")
+    p = sub.add_parser("csv", help="convert to CSV")
+    p.add_argument("file")
+    p.add_argument("out")
+    p.add_argument("--replay", action="store_true", help="host/replay.c trace format")
+    p = sub.add_parser("npy", help="convert to .npy columns")
+    p.add_argument("file")
+    p.add_argument("outdir")
+    p = sub.add_parser("session", help="convert to a columnar .dses session")
+    p.add_argument("file")
+    p.add_argument("out")
+    p.add_argument("--labels", help="t_ms,DRUM label file (replay.c format)")
+    p.add_argument("--chunk-rows", type=int, default=65536)
+    args = ap.parse_args()
+
+    try:
+        {"record": cmd_record, "info": cmd_info, "csv": cmd_csv, "npy": cmd_npy,
+         "session": cmd_session}[args.command](args)
+    except (OSError, ValueError) as e:
+        sys.exit(str(e))
+
+
+if __name__ == "__main__":
+    main()
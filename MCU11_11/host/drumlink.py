@@ -0,0 +1,443 @@
+#!/usr/bin/env python3
+# drumlink.py
+# Host side of the USART2 serial link (serial_link.h, serial_link_protocol.h)
+#
+# Library and command-line tool. Frames are COBS(type, seq, payload, CRC32)
+# followed by 0x00; the message ids and payload layouts below mirror
+# serial_link_protocol.h and must change with it.
+#
+# Usage:
+#   python3 drumlink.py /dev/ttyACM0 ping
+#   python3 drumlink.py /dev/ttyACM0 monitor [--telemetry 100] [--capture] [--csv out.csv]
+#   python3 drumlink.py /dev/ttyACM0 thresholds [scoreMin=5000 jerkMin=900 ...]
+#   python3 drumlink.py /dev/ttyACM0 zones get zones.bin | zones set zones.bin | zones clear
+#   python3 drumlink.py /dev/ttyACM0 kit [N]
+#
+# As a library:
+#   link = DrumLink("/dev/ttyACM0")
+#   t = link.get_thresholds(); t["scoreMin"] = 5000; link.set_thresholds(t)
+#   for kind, fields in link.events(): ...
+#
+# The port is opened with termios (Linux/macOS), so no third-party packages
+# are required. --baud must match SERIAL_LINK_BAUD (default 1000000).
+
+import argparse
+import binascii
+import os
+import select
+import struct
+import sys
+import time
+
+# Commands, replies and events (serial_link_protocol.h)
+CMD_PING = 0x01
+CMD_GET_THRESHOLDS = 0x02
+CMD_SET_THRESHOLDS = 0x03
+CMD_GET_ZONE_MAP = 0x04
+CMD_SET_ZONE_MAP = 0x05
+CMD_GET_KIT = 0x06
+CMD_SET_KIT = 0x07
+CMD_SET_STREAMS = 0x08
+REPLY = 0x80
+EV_HIT = 0xC0
+EV_TELEMETRY = 0xC1
+EV_SENSOR = 0xC2
+EV_CAPTURE_HEADER = 0xC3
+EV_CAPTURE = 0xC4
+
+# LinkStreams_t.capture
+CAPTURE_OFF = 0
+CAPTURE_REPORTS = 1
+CAPTURE_BATCHED = 2
+
+STATUS_NAMES = {0: "ok", 1: "unknown command", 2: "bad length", 3: "bad value",
+                4: "busy (applied, not yet saved)", 5: "error"}
+
+# Payload layouts (little-endian, no padding)
+HIT = struct.Struct("<IffhBBB3x")
+HIT_FIELDS = ("timeUs", "yaw", "pitch", "gyroY", "drumId", "strokeType", "velocity")
+TELEMETRY = struct.Struct("<I9fIIBBBB")
+SENSOR = struct.Struct("<IBBH4f")
+STREAMS = struct.Struct("<HBB")
+# Batched capture: LinkCaptureHeader_t (sensors: LinkCaptureSensor_t),
+# LinkCaptureBatch_t, LinkCaptureRecord_t
+CAPTURE_MAGIC = 0x50414344
+CAPTURE_HEADER = struct.Struct("<IHHB3x")
+CAPTURE_SENSOR = struct.Struct("<BbHI")
+CAPTURE_MAX_SENSORS = 4
+CAPTURE_HEADER_SIZE = CAPTURE_HEADER.size + CAPTURE_MAX_SENSORS * CAPTURE_SENSOR.size
+CAPTURE_BATCH = struct.Struct("<IHH")
+CAPTURE_RECORD = struct.Struct("<IBBBx4h")
+KIT = struct.Struct("<BB")
+# DrumThresholds_t (drum_detection.h) with OnsetParams_t (onset_detector.h)
+THRESHOLDS = struct.Struct("<Hh5iB3x")
+THRESHOLD_FIELDS = ("version", "gyroHit", "swingMin", "decelMin", "jerkMin",
+                    "scoreMin", "rearmSpeed", "holdoffSamples")
+# DrumZoneMap_t (drum_calibration.h)
+ZONE_MAP = struct.Struct("<HH1024s")
+ZONE_MAP_VERSION = 1
+
+DRUM_NAMES = ["SNARE", "HIHAT", "KICK", "HIGH_TOM", "MID_TOM", "CRASH", "RIDE", "LOW_TOM"]
+SENSOR_NAMES = {0x08: "grv", 0x02: "gyro", 0x04: "linacc"}
+
+BAUD_CONSTANTS = ("B115200", "B230400", "B460800", "B921600", "B1000000", "B2000000")
+
+
+class LinkError(Exception):
+    pass
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_pos, code = 0, 1
+    for b in data:
+        if b == 0:
+            out[code_pos] = code
+            code_pos, code = len(out), 1
+            out.append(0)
+            continue
+        out.append(b)
+        code += 1
+        if code == 0xFF:
+            out[code_pos] = code
+            code_pos, code = len(out), 1
+            out.append(0)
+    out[code_pos] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad COBS block")
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def build_frame(msg_type, seq, payload=b""):
+    body = bytes([msg_type, seq & 0xFF]) + bytes(payload)
+    return cobs_encode(body + struct.pack("<I", binascii.crc32(body))) + b"\x00"
+
+
+def parse_frame(encoded):
+    """Return (type, seq, payload) or None if the frame is damaged."""
+    try:
+        raw = cobs_decode(encoded)
+    except ValueError:
+        return None
+    if len(raw) < 6 or binascii.crc32(raw[:-4]) != struct.unpack("<I", raw[-4:])[0]:
+        return None
+    return raw[0], raw[1], raw[2:-4]
+
+
+def decode_event(msg_type, payload):
+    """Return (kind, dict) for a device event, or None."""
+    if msg_type == EV_HIT and len(payload) == HIT.size:
+        return "hit", dict(zip(HIT_FIELDS, HIT.unpack(payload)))
+    if msg_type == EV_TELEMETRY and len(payload) == TELEMETRY.size:
+        v = TELEMETRY.unpack(payload)
+        return "telemetry", {"timeMs": v[0], "roll": v[1], "pitch": v[2], "yaw": v[3],
+                             "gyro": v[4:7], "linAccel": v[7:10], "hits": v[10],
+                             "txDropped": v[11], "activeVoices": v[12], "kit": v[13],
+                             "flags": v[14]}
+    if msg_type == EV_SENSOR and len(payload) == SENSOR.size:
+        v = SENSOR.unpack(payload)
+        return "sensor", {"timeUs": v[0], "sensorId": v[1], "status": v[2], "v": v[4:8]}
+    if msg_type == EV_CAPTURE_HEADER and len(payload) == CAPTURE_HEADER_SIZE:
+        return "capture_header", decode_capture_header(payload)
+    if msg_type == EV_CAPTURE and len(payload) >= CAPTURE_BATCH.size:
+        first, count, _ = CAPTURE_BATCH.unpack_from(payload)
+        records = payload[CAPTURE_BATCH.size:]
+        if len(records) == count * CAPTURE_RECORD.size:
+            return "capture", {"firstRecord": first, "count": count, "records": records}
+    return None
+
+
+def decode_capture_header(data):
+    """LinkCaptureHeader_t bytes (also the start of a .dcap file) to a dict."""
+    magic, version, record_size, count = CAPTURE_HEADER.unpack_from(data)
+    if magic != CAPTURE_MAGIC:
+        raise ValueError("not a capture header")
+    sensors = []
+    for i in range(min(count, CAPTURE_MAX_SENSORS)):
+        sid, q, _, interval = CAPTURE_SENSOR.unpack_from(data, CAPTURE_HEADER.size + i * CAPTURE_SENSOR.size)
+        sensors.append({"sensorId": sid, "qPoint": q, "intervalUs": interval})
+    return {"version": version, "recordSize": record_size, "sensors": sensors,
+            "raw": bytes(data[:CAPTURE_HEADER_SIZE])}
+
+
+class FrameReader:
+    """Splits a byte stream at 0x00 delimiters and decodes the frames."""
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.bad = 0
+
+    def feed(self, data):
+        self.buf += data
+        frames = []
+        while True:
+            end = self.buf.find(0)
+            if end < 0:
+                break
+            chunk = bytes(self.buf[:end])
+            del self.buf[:end + 1]
+            if not chunk:
+                continue
+            frame = parse_frame(chunk)
+            if frame is None:
+                self.bad += 1
+            else:
+                frames.append(frame)
+        return frames
+
+
+def open_port(path, baud):
+    import termios
+    import tty
+    name = "B%d" % baud
+    if not hasattr(termios, name):
+        raise LinkError("baud rate %d not supported here (try one of %s)"
+                        % (baud, ", ".join(b[1:] for b in BAUD_CONSTANTS if hasattr(termios, b))))
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    attrs[4] = attrs[5] = getattr(termios, name)
+    attrs[2] |= termios.CLOCAL | termios.CREAD
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    termios.tcflush(fd, termios.TCIOFLUSH)
+    return fd
+
+
+class DrumLink:
+    """Command/event client for one device."""
+
+    def __init__(self, port, baud=1000000, timeout=0.5, retries=3):
+        self.fd = open_port(port, baud)
+        self.timeout = timeout
+        self.retries = retries
+        self.reader = FrameReader()
+        self.seq = 0
+        self.pending = []        # Events received while waiting for a reply
+        self.last_event_seq = None
+        self.event_gaps = 0
+
+    def close(self):
+        os.close(self.fd)
+
+    def _read(self, timeout):
+        ready, _, _ = select.select([self.fd], [], [], timeout)
+        if not ready:
+            return []
+        return self.reader.feed(os.read(self.fd, 4096))
+
+    def _track_event(self, seq):
+        if self.last_event_seq is not None:
+            self.event_gaps += (seq - self.last_event_seq - 1) & 0xFF
+        self.last_event_seq = seq
+
+    def request(self, cmd, payload=b""):
+        """Send a command and return the reply payload (retries on timeout)."""
+        for _attempt in range(self.retries):
+            self.seq = (self.seq + 1) & 0xFF
+            os.write(self.fd, build_frame(cmd, self.seq, payload))
+            deadline = time.monotonic() + self.timeout
+            while time.monotonic() < deadline:
+                for msg_type, seq, body in self._read(deadline - time.monotonic()):
+                    if msg_type == (cmd | REPLY) and seq == self.seq:
+                        return body
+                    if msg_type >= EV_HIT:
+                        self._track_event(seq)
+                        self.pending.append((msg_type, body))
+        raise LinkError("no reply to command 0x%02X" % cmd)
+
+    def _set(self, cmd, payload):
+        reply = self.request(cmd, payload)
+        status = reply[0] if reply else 5
+        if status not in (0, 4):
+            raise LinkError("command 0x%02X: %s" % (cmd, STATUS_NAMES.get(status, status)))
+        return status
+
+    def ping(self, data=b"drum"):
+        t0 = time.monotonic()
+        if self.request(CMD_PING, data) != data:
+            raise LinkError("ping echo mismatch")
+        return time.monotonic() - t0
+
+    def get_thresholds(self):
+        return dict(zip(THRESHOLD_FIELDS, THRESHOLDS.unpack(self.request(CMD_GET_THRESHOLDS))))
+
+    def set_thresholds(self, fields):
+        return self._set(CMD_SET_THRESHOLDS, THRESHOLDS.pack(*(fields[f] for f in THRESHOLD_FIELDS)))
+
+    def get_zone_map(self):
+        """Return (clusterCount, 1024 zone bytes), or None if no map is learned."""
+        reply = self.request(CMD_GET_ZONE_MAP)
+        if not reply:
+            return None
+        _version, clusters, zones = ZONE_MAP.unpack(reply)
+        return clusters, zones
+
+    def set_zone_map(self, zones, clusters=0):
+        """zones: 1024 drum ids ([yaw bin][pitch bin]); None reverts to the default zones."""
+        if zones is None:
+            return self._set(CMD_SET_ZONE_MAP, b"")
+        return self._set(CMD_SET_ZONE_MAP, ZONE_MAP.pack(ZONE_MAP_VERSION, clusters, bytes(zones)))
+
+    def get_kit(self):
+        return KIT.unpack(self.request(CMD_GET_KIT))
+
+    def set_kit(self, kit):
+        return self._set(CMD_SET_KIT, bytes([kit]))
+
+    def set_streams(self, telemetry_ms=0, capture=CAPTURE_OFF):
+        """capture: CAPTURE_* (True = CAPTURE_REPORTS)."""
+        return self._set(CMD_SET_STREAMS, STREAMS.pack(telemetry_ms, int(capture), 0))
+
+    def events(self):
+        """Yield (kind, fields) for every device event, forever."""
+        while True:
+            while self.pending:
+                event = decode_event(*self.pending.pop(0))
+                if event:
+                    yield event
+            for msg_type, seq, body in self._read(1.0):
+                if msg_type >= EV_HIT:
+                    self._track_event(seq)
+                    self.pending.append((msg_type, body))
+
+
+def format_event(kind, f):
+    if kind == "hit":
+        name = DRUM_NAMES[f["drumId"]] if f["drumId"] < len(DRUM_NAMES) else str(f["drumId"])
+        return "HIT %10d us %-8s yaw %6.1f pitch %6.1f gyro_y %6d stroke %d vel %3d" % (
+            f["timeUs"], name, f["yaw"], f["pitch"], f["gyroY"], f["strokeType"], f["velocity"])
+    if kind == "telemetry":
+        return ("TEL %10d ms rpy %6.1f %6.1f %6.1f hits %d voices %d kit %d flags 0x%X dropped %d"
+                % (f["timeMs"], f["roll"], f["pitch"], f["yaw"], f["hits"], f["activeVoices"],
+                   f["kit"], f["flags"], f["txDropped"]))
+    if kind == "capture_header":
+        return "CAP header, sensors %s" % " ".join(
+            "%s@%dus" % (SENSOR_NAMES.get(s["sensorId"], s["sensorId"]), s["intervalUs"]) for s in f["sensors"])
+    if kind == "capture":
+        return "CAP records %d..%d" % (f["firstRecord"], f["firstRecord"] + f["count"] - 1)
+    return "SEN %10d us %-6s %s" % (f["timeUs"], SENSOR_NAMES.get(f["sensorId"], f["sensorId"]),
+                                    " ".join("%9.4f" % x for x in f["v"]))
+
+
+def cmd_monitor(link, args):
+    link.set_streams(args.telemetry, args.capture)
+    out = open(args.csv, "w") if args.csv else None
+    if out:
+        out.write("kind,time,a,b,c,d,e,f\n")
+    try:
+        for kind, f in link.events():
+            print(format_event(kind, f))
+            if out and kind == "hit":
+                out.write("hit,%d,%d,%.2f,%.2f,%d,%d,%d\n" % (f["timeUs"], f["drumId"], f["yaw"],
+                                                              f["pitch"], f["gyroY"], f["strokeType"],
+                                                              f["velocity"]))
+            elif out and kind == "sensor":
+                out.write("sensor,%d,%d,%s\n" % (f["timeUs"], f["sensorId"],
+                                                 ",".join("%.5f" % x for x in f["v"])))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        link.set_streams(0, False)
+        if out:
+            out.close()
+        print("event sequence gaps: %d, damaged frames: %d" % (link.event_gaps, link.reader.bad),
+              file=sys.stderr)
+
+
+def cmd_thresholds(link, args):
+    t = link.get_thresholds()
+    if args.values:
+        for item in args.values:
+            name, _, value = item.partition("=")
+            if name not in THRESHOLD_FIELDS[1:]:
+                sys.exit("unknown threshold %s (one of %s)" % (name, ", ".join(THRESHOLD_FIELDS[1:])))
+            t[name] = int(value)
+        status = link.set_thresholds(t)
+        print(STATUS_NAMES[status])
+    for name in THRESHOLD_FIELDS[1:]:
+        print("%-15s %d" % (name, t[name]))
+
+
+def cmd_zones(link, args):
+    if args.action == "get":
+        zm = link.get_zone_map()
+        if zm is None:
+            sys.exit("no learned zone map (default zones in use)")
+        with open(args.file, "wb") as f:
+            f.write(zm[1])
+        print("%d clusters, 1024 bins written to %s" % (zm[0], args.file))
+    elif args.action == "set":
+        with open(args.file, "rb") as f:
+            zones = f.read()
+        if len(zones) != 1024:
+            sys.exit("%s: need 1024 bytes (64 yaw x 16 pitch bins)" % args.file)
+        clusters = len(set(z for z in zones if z < len(DRUM_NAMES)))
+        print(STATUS_NAMES[link.set_zone_map(zones, clusters)])
+    else:
+        print(STATUS_NAMES[link.set_zone_map(None)])
+
+
+def cmd_kit(link, args):
+    if args.kit is not None:
+        print(STATUS_NAMES[link.set_kit(args.kit)])
+    kit, count = link.get_kit()
+    print("kit %d of %d" % (kit, count))
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Serial link client for the drum firmware")
+    ap.add_argument("port", help="serial device (e.g. /dev/ttyACM0)")
+    ap.add_argument("--baud", type=int, default=1000000, help="SERIAL_LINK_BAUD (default 1000000)")
+    sub = ap.add_subparsers(dest="command", required=True)
+    sub.add_parser("ping", help="round-trip time")
+    p = sub.add_parser("monitor", help="print events until Ctrl-C")
+    p.add_argument("--telemetry", type=int, default=100, metavar="MS", help="telemetry period (0 = off)")
+    p.add_argument("--capture", action="store_true", help="stream every sensor report")
+    p.add_argument("--csv", help="also write hits and sensor reports to a CSV file")
+    p = sub.add_parser("thresholds", help="show or change detection thresholds")
+    p.add_argument("values", nargs="*", metavar="name=value")
+    p = sub.add_parser("zones", help="read, write or clear the learned zone map")
+    p.add_argument("action", choices=("get", "set", "clear"))
+    p.add_argument("file", nargs="?", help="1024-byte zone file for get/set")
+    p = sub.add_parser("kit", help="show or select the drum kit")
+    p.add_argument("kit", nargs="?", type=int)
+    args = ap.parse_args()
+
+    if args.command == "zones" and args.action != "clear" and not args.file:
+        ap.error("zones %s needs a file" % args.action)
+
+    try:
+        link = DrumLink(args.port, args.baud)
+    except (OSError, LinkError) as e:
+        sys.exit("%s: %s" % (args.port, e))
+    try:
+        if args.command == "ping":
+            print("reply in %.1f ms" % (link.ping() * 1000.0))
+        elif args.command == "monitor":
+            cmd_monitor(link, args)
+        elif args.command == "thresholds":
+            cmd_thresholds(link, args)
+        elif args.command == "zones":
+            cmd_zones(link, args)
+        elif args.command == "kit":
+            cmd_kit(link, args)
+    except LinkError as e:
+        sys.exit(str(e))
+    finally:
+        link.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+# hit_feed.py
+# Synthetic device hit stream on a pseudo-terminal, for drumplay without a board
+#
+# Opens a pty, prints the path to pass to drumplay, and writes LINK_EV_HIT
+# frames (drumlink.py encoding) for a steady groove. Each frame is held back
+# by a random transport delay before it is written, the way detection, the
+# UART and the USB virtual COM port delay real hits, while the device
+# timestamps inside stay on the beat. Played through drumplay with a large
+# enough --jitter-ms, the hits come out on the beat again.
+#
+# Usage:
+#   python3 hit_feed.py [--bpm 120] [--jitter-ms 4] [--spike-ms 0] [--seconds 10] [--delay 2]
+#   ./playback/drumplay /dev/pts/N --sink wav:groove.wav     (in a second shell)
+#
+# --spike-ms adds that much extra delay to one hit in twenty. --log FILE
+# writes device_us,drum,velocity for every hit sent, for checking a recording.
+#
+# No third-party packages required.
+
+import argparse
+import os
+import random
+import struct
+import time
+import tty
+
+from drumlink import EV_HIT, HIT, build_frame
+
+# Eighth-note groove: (drum, velocity) per step; drum ids from drum_detection.h
+GROOVE = [(2, 110), (1, 70), (1, 50), (1, 70), (0, 120), (1, 70), (1, 50), (1, 70),
+          (2, 100), (1, 70), (2, 90), (1, 70), (0, 120), (1, 70), (1, 50), (5, 127)]
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Synthetic hit stream on a pty")
+    ap.add_argument("--bpm", type=float, default=120.0)
+    ap.add_argument("--jitter-ms", type=float, default=4.0, help="transport delay spread")
+    ap.add_argument("--spike-ms", type=float, default=0.0, help="extra delay of one hit in 20")
+    ap.add_argument("--seconds", type=float, default=10.0)
+    ap.add_argument("--delay", type=float, default=2.0, help="seconds before the first hit")
+    ap.add_argument("--seed", type=int, default=1)
+    ap.add_argument("--log", help="write device_us,drum,velocity per hit")
+    args = ap.parse_args()
+
+    rng = random.Random(args.seed)
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    print(os.ttyname(slave), flush=True)
+    time.sleep(args.delay)
+
+    step_us = int(60e6 / args.bpm / 2)
+    device_start_us = 123456789  # Arbitrary sensor hub clock at the first hit
+    host_start = time.monotonic()
+    log = open(args.log, "w") if args.log else None
+    seq = 0
+    step = 0
+    while step * step_us < args.seconds * 1e6:
+        drum, velocity = GROOVE[step % len(GROOVE)]
+        device_us = (device_start_us + step * step_us) & 0xFFFFFFFF
+        delay = rng.uniform(0, args.jitter_ms) / 1000.0
+        if args.spike_ms and rng.random() < 0.05:
+            delay += args.spike_ms / 1000.0
+        due = host_start + step * step_us / 1e6 + delay
+        time.sleep(max(0.0, due - time.monotonic()))
+
+        payload = HIT.pack(device_us, 0.0, 0.0, 0, drum, 0, velocity)
+        os.write(master, build_frame(EV_HIT, seq, payload))
+        if log:
+            log.write("%d,%d,%d\n" % (device_us, drum, velocity))
+        seq = (seq + 1) & 0xFF
+        step += 1
+
+    if log:
+        log.close()
+    time.sleep(0.5)
+    os.close(master)
+
+
+if __name__ == "__main__":
+    main()
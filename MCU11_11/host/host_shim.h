@@ -0,0 +1,40 @@
+// host_shim.h
+// Host replacements for STM32 headers pulled in by the detection sources
+//
+// Force-included (gcc -include host_shim.h) when building firmware sources on
+// a PC. It takes the place of STM32L432KC_FLASH.h so that flash reads go to a
+// RAM image (host_stubs.c) instead of 0x08000000. The include guard below
+// matches the firmware header, which is then skipped.
+
+#ifndef HOST_SHIM_H
+#define HOST_SHIM_H
+
+// Included before any system header, so feature macros take effect here
+#define _POSIX_C_SOURCE 199309L  // clock_gettime
+
+#include <stdint.h>
+
+#define STM32L4_FLASH_H
+
+// Main flash geometry (same as STM32L432KC_FLASH.h)
+#define FLASH_PAGE_SIZE   (2048UL)
+#define FLASH_PAGE_COUNT  (128UL)
+
+// Flash image in RAM, erased (0xFF) by HostStubs_Init()
+extern uint8_t hostFlash[FLASH_PAGE_COUNT * FLASH_PAGE_SIZE];
+#define FLASH_PAGE_ADDR(page) ((uintptr_t)hostFlash + (uint32_t)(page) * FLASH_PAGE_SIZE)
+
+void configureFlash(void);
+void FLASH_Unlock(void);
+void FLASH_Lock(void);
+int FLASH_ErasePage(uint32_t page);
+int FLASH_ProgramDoubleWord(uint32_t address, uint32_t word0, uint32_t word1);
+
+// Debug log records are formatted at the call and go to the RTT stubs
+#define BINLOG_MODE  1  // BINLOG_MODE_TEXT
+
+// Host stub control
+void HostStubs_Init(void);
+void HostStubs_SetLog(void *file);  // FILE * for firmware RTT output, NULL to drop it
+
+#endif // HOST_SHIM_H
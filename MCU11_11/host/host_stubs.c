@@ -0,0 +1,95 @@
+// host_stubs.c
+// PC implementations of the board services used by the detection sources
+//
+// RTT output goes to a FILE (or nowhere), DWT_Init does nothing, and flash
+// erase/program work on the RAM image declared in host_shim.h. Build with
+// host_shim.h force-included, see replay.c.
+
+#include <stdio.h>
+#include <string.h>
+#include "STM32L432KC_RTT.h"
+#include "STM32L432KC_DWT.h"
+
+uint8_t hostFlash[FLASH_PAGE_COUNT * FLASH_PAGE_SIZE];
+
+static FILE *logFile = NULL;
+
+void HostStubs_Init(void) {
+    memset(hostFlash, 0xFF, sizeof hostFlash);
+    logFile = NULL;
+}
+
+void HostStubs_SetLog(void *file) {
+    logFile = (FILE *)file;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// RTT
+///////////////////////////////////////////////////////////////////////////////
+
+void RTT_Init(void) {
+}
+
+void RTT_PrintChar(char c) {
+    if (logFile) fputc(c, logFile);
+}
+
+void RTT_PrintStr(const char *str) {
+    if (logFile) fputs(str, logFile);
+}
+
+void RTT_PrintInt(int32_t num) {
+    if (logFile) fprintf(logFile, "%d", (int)num);
+}
+
+void RTT_PrintFloat(float num, int decimals) {
+    if (logFile) fprintf(logFile, "%.*f", decimals, (double)num);
+}
+
+void RTT_PrintHex(uint32_t num) {
+    if (logFile) fprintf(logFile, "0x%08X", (unsigned)num);
+}
+
+void RTT_PrintNewline(void) {
+    if (logFile) fputc('\n', logFile);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// DWT (benchmarks are not run on the host)
+///////////////////////////////////////////////////////////////////////////////
+
+void DWT_Init(void) {
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Flash
+///////////////////////////////////////////////////////////////////////////////
+
+void configureFlash(void) {
+}
+
+void FLASH_Unlock(void) {
+}
+
+void FLASH_Lock(void) {
+}
+
+int FLASH_ErasePage(uint32_t page) {
+    if (page >= FLASH_PAGE_COUNT) {
+        return -1;
+    }
+    memset(&hostFlash[page * FLASH_PAGE_SIZE], 0xFF, FLASH_PAGE_SIZE);
+    return 0;
+}
+
+// Firmware code keeps addresses in uint32_t, so only the low 32 bits of the
+// host pointer survive; the offset into the image is recovered modulo 2^32.
+int FLASH_ProgramDoubleWord(uint32_t address, uint32_t word0, uint32_t word1) {
+    uint32_t offset = address - (uint32_t)(uintptr_t)hostFlash;
+    if ((offset & 7) != 0 || offset > sizeof hostFlash - 8) {
+        return -1;
+    }
+    memcpy(&hostFlash[offset], &word0, 4);
+    memcpy(&hostFlash[offset + 4], &word1, 4);
+    return 0;
+}
@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+# make_stroke_templates.py
+# Builds stroke_templates.h for the DTW stroke recognizer (stroke_recognizer.c)
+#
+# Reads labelled gyro_y windows, resamples each to STROKE_TEMPLATE_LEN points
+# exactly as the firmware does, averages them per stroke type, reports
+# leave-one-out accuracy of the banded DTW match, and writes the templates.
+#
+# Input: one window per line
+#   WINDOW,<gyro_y>,<gyro_y>,...,<label>      (firmware log with
+#                                             DRUM_DETECTION_LOG_STROKES=1,
+#                                             label appended while recording)
+# gyro_y in rad/s * 1000, oldest first; label NORMAL, ACCENT, RIMSHOT or GHOST.
+#
+# Usage:
+#   python3 make_stroke_templates.py windows.txt [--out ../stroke_templates.h]
+#
+# No third-party packages required.
+
+import argparse
+import sys
+
+STROKE_NAMES = ["NORMAL", "ACCENT", "RIMSHOT", "GHOST"]
+
+# Must match stroke_recognizer.h
+TEMPLATE_LEN = 16
+DTW_BAND = 3
+DTW_MAX_DISTANCE = 20000
+
+
+def c_div(a, b):
+    # C integer division truncates toward zero
+    q = abs(a) // abs(b)
+    return q if (a >= 0) == (b > 0) else -q
+
+
+def resample(window):
+    # Python copy of StrokeRecognizer_Resample()
+    n = len(window)
+    if n == 0:
+        return [0] * TEMPLATE_LEN
+    out = []
+    for k in range(TEMPLATE_LEN):
+        start = k * n // TEMPLATE_LEN
+        end = (k + 1) * n // TEMPLATE_LEN
+        if end <= start:
+            out.append(window[start])
+        else:
+            out.append(c_div(sum(window[start:end]), end - start))
+    return out
+
+
+def dtw(a, b, band=DTW_BAND):
+    # Python copy of StrokeRecognizer_Distance() without early abandoning
+    inf = float("inf")
+    prev = [inf] * TEMPLATE_LEN
+    for i in range(TEMPLATE_LEN):
+        curr = [inf] * TEMPLATE_LEN
+        for j in range(max(0, i - band), min(TEMPLATE_LEN - 1, i + band) + 1):
+            if i == 0 and j == 0:
+                best = 0
+            else:
+                best = min(prev[j] if i > 0 else inf,
+                           curr[j - 1] if j > 0 else inf,
+                           prev[j - 1] if i > 0 and j > 0 else inf)
+            curr[j] = best + abs(a[i] - b[j])
+        prev = curr
+    return prev[-1]
+
+
+def classify(window, templates):
+    best_type, best = None, DTW_MAX_DISTANCE
+    for stroke_type, samples in templates:
+        d = dtw(window, samples)
+        if d < best:
+            best_type, best = stroke_type, d
+    return best_type
+
+
+def load_windows(path):
+    windows = []
+    with open(path) as f:
+        for line in f:
+            fields = [x.strip() for x in line.strip().split(",")]
+            if len(fields) < 3 or fields[0].upper() != "WINDOW":
+                continue
+            label = fields[-1].upper()
+            if label not in STROKE_NAMES:
+                continue  # unlabelled window
+            try:
+                samples = [int(x) for x in fields[1:-1]]
+            except ValueError:
+                continue
+            windows.append((resample(samples), STROKE_NAMES.index(label)))
+    return windows
+
+
+def average(windows, stroke_type):
+    rows = [w for w, t in windows if t == stroke_type]
+    return [c_div(sum(col), len(rows)) for col in zip(*rows)]
+
+
+def write_header(path, templates, source, counts):
+    lines = [
+        "// stroke_templates.h",
+        "// Stroke templates for stroke_recognizer.c",
+        "//",
+        "// GENERATED by host/make_stroke_templates.py - do not edit by hand.",
+        "// Averaged from %s (%s)" % (source, ", ".join(
+            "%d %s" % (counts[t], STROKE_NAMES[t].lower()) for t, _ in templates)),
+        "",
+        "#ifndef STROKE_TEMPLATES_H",
+        "#define STROKE_TEMPLATES_H",
+        "",
+        '#include "stroke_recognizer.h"',
+        "",
+        "#define STROKE_NUM_TEMPLATES  %d" % len(templates),
+        "",
+        "static const StrokeTemplate_t stroke_templates[STROKE_NUM_TEMPLATES] = {",
+    ]
+    for stroke_type, samples in templates:
+        half = TEMPLATE_LEN // 2
+        lines.append("    { STROKE_%s, { %s," % (STROKE_NAMES[stroke_type],
+                                              ",".join("%5d" % v for v in samples[:half])))
+        lines.append("        %s } }," % ",".join("%5d" % v for v in samples[half:]))
+    lines += ["};", "", "#endif // STROKE_TEMPLATES_H", ""]
+    with open(path, "w") as f:
+        f.write("\n".join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build DTW stroke templates")
+    parser.add_argument("windows")
+    parser.add_argument("--out", help="write stroke_templates.h here")
+    args = parser.parse_args()
+
+    windows = load_windows(args.windows)
+    counts = {t: sum(1 for _, l in windows if l == t) for t in range(len(STROKE_NAMES))}
+    present = [t for t in range(len(STROKE_NAMES)) if counts[t] > 0]
+    if not present:
+        sys.exit("no labelled WINDOW lines in %s" % args.windows)
+
+    # Leave-one-out: score each window against templates averaged without it
+    correct = 0
+    for i, (window, label) in enumerate(windows):
+        rest = windows[:i] + windows[i + 1:]
+        templates = [(t, average(rest, t)) for t in present if any(l == t for _, l in rest)]
+        if classify(window, templates) == label:
+            correct += 1
+
+    templates = [(t, average(windows, t)) for t in present]
+
+    print("Windows: %d (%s)" % (len(windows), ", ".join(
+        "%s %d" % (STROKE_NAMES[t], counts[t]) for t in present)))
+    print("Leave-one-out DTW accuracy: %.1f%%" % (100.0 * correct / len(windows)))
+
+    if args.out:
+        write_header(args.out, templates, args.windows, counts)
+        print("Wrote %s" % args.out)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,240 @@
+// onset_harness.c
+// Host harness for the fused onset detector (onset_detector.c)
+//
+// Synthesises 100Hz gyro + linear-acceleration streams containing labelled
+// events (hits about the gyro y axis, wrist-flick hits about z, flourishes
+// that spin the stick without hitting, and rests) and runs both the fused
+// detector and the gyro_y-only threshold path from drum_detection.c over them.
+// Reports precision, recall and detection lead time relative to the true
+// impact sample for each path. A positive lead is not a gain: nothing can
+// sense an impact before it happens, so a detection ahead of the impact
+// came from the swing itself (the gyro-only path fires mid-swing, which is
+// also why it fires on flourishes). A sound-accurate detector fires on the
+// impact sample, at most one report interval after the stick stops.
+//
+// Build and run (from this folder):
+//   gcc -std=c99 -O2 -I.. onset_harness.c ../onset_detector.c -lm -o onset_harness
+//   ./onset_harness [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "onset_detector.h"
+#include "drum_detection.h"  // For GYRO_HIT_THRESHOLD
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define RATE_HZ          100
+#define SAMPLE_MS        (1000 / RATE_HZ)
+#define SESSION_SAMPLES  (RATE_HZ * 600)  // 10 minutes
+#define MAX_EVENTS       2000
+
+// A detection matches a true hit if it falls in [impact - EARLY, impact + LATE]
+#define MATCH_EARLY_SAMPLES  15
+#define MATCH_LATE_SAMPLES    5
+
+#define STICK_RADIUS_M  0.3f  // Hand to stick tip
+
+enum { EV_HIT_Y, EV_HIT_Z, EV_FLOURISH, EV_NUM_TYPES };
+static const char *eventNames[EV_NUM_TYPES] = { "hit (y axis)", "hit (z axis)", "flourish" };
+
+typedef struct {
+    int type;
+    int impact;  // Sample index of the impact (or flourish midpoint)
+} Event_t;
+
+// Synthetic sensor streams (float, same units as sh2_SensorValue_t)
+static float gyro[SESSION_SAMPLES][3];   // rad/s
+static float accel[SESSION_SAMPLES][3];  // m/s^2, gravity removed
+static Event_t events[MAX_EVENTS];
+static int eventCount;
+
+static float frand(float lo, float hi) {
+    return lo + (hi - lo) * (float)rand() / (float)RAND_MAX;
+}
+
+// Downswing accelerating to peak speed at the impact, abrupt stop, small rebound
+static void add_hit(int axis, int impact, float peak) {
+    int swing = 12;  // 120 ms downswing
+    for (int k = 0; k <= swing; k++) {
+        int i = impact - swing + k;
+        float w = -peak * sinf(0.5f * (float)M_PI * (float)k / (float)swing);
+        float dw = -peak * 0.5f * (float)M_PI / (swing * 0.01f) * cosf(0.5f * (float)M_PI * (float)k / (float)swing);
+        gyro[i][axis] += w;
+        accel[i][0] += dw * STICK_RADIUS_M;   // Tangential
+        accel[i][2] += w * w * STICK_RADIUS_M; // Centripetal
+    }
+    
+    // Impact: angular speed collapses, linear acceleration spikes
+    gyro[impact + 1][axis] += -0.15f * peak;
+    gyro[impact + 2][axis] += 0.10f * peak;
+    gyro[impact + 3][axis] += 0.04f * peak;
+    accel[impact + 1][0] += 8.0f * peak;
+    accel[impact + 2][0] += -2.5f * peak;
+    accel[impact + 1][1] += frand(-1.0f, 1.0f) * peak;
+}
+
+// One smooth twirl: fast rotation that eases in and out, no impact
+static void add_flourish(int mid, float amp, int period) {
+    float last = 0.0f;
+    for (int k = 0; k <= period; k++) {
+        int i = mid - period / 2 + k;
+        float phase = 2.0f * (float)M_PI * (float)k / (float)period;
+        float w = amp * sinf(phase) * 0.5f * (1.0f - cosf(phase));
+        gyro[i][0] += w;
+        gyro[i][1] += -0.6f * w;  // Enough y component to cross the gyro-only threshold
+        accel[i][0] += (w - last) / 0.01f * STICK_RADIUS_M;  // Tangential
+        accel[i][2] += w * w * STICK_RADIUS_M;               // Centripetal
+        last = w;
+    }
+}
+
+static void build_session(void) {
+    eventCount = 0;
+    int i = 50;
+    while (eventCount < MAX_EVENTS) {
+        i += (int)frand(25.0f, 80.0f);  // 250-800 ms between events
+        if (i + 60 >= SESSION_SAMPLES) {
+            break;
+        }
+        
+        Event_t *ev = &events[eventCount++];
+        ev->type = rand() % EV_NUM_TYPES;
+        ev->impact = i + 1;  // Hits stop on the sample after the swing peak
+        if (ev->type == EV_HIT_Y) {
+            add_hit(1, i, frand(3.0f, 12.0f));
+        } else if (ev->type == EV_HIT_Z) {
+            add_hit(2, i, frand(3.0f, 8.0f));
+        } else {
+            add_flourish(i + 1, frand(5.0f, 12.0f), (int)frand(30.0f, 50.0f));
+        }
+        i += 30;
+    }
+    
+    // Sensor noise
+    for (int s = 0; s < SESSION_SAMPLES; s++) {
+        for (int a = 0; a < 3; a++) {
+            gyro[s][a] += frand(-0.05f, 0.05f);
+            accel[s][a] += frand(-0.3f, 0.3f);
+        }
+    }
+}
+
+typedef struct {
+    int detections;
+    int truePos[EV_NUM_TYPES];   // Events with a matching detection
+    int falsePos;
+    int leadSum;                 // ms, positive = before the impact
+    int leadMin, leadMax;
+} Score_t;
+
+// Match detections against events; each event takes at most one detection
+static void score(const int *det, int nDet, Score_t *sc) {
+    static char used[MAX_EVENTS];
+    for (int e = 0; e < eventCount; e++) used[e] = 0;
+    
+    *sc = (Score_t){0};
+    sc->detections = nDet;
+    sc->leadMin = 100000;
+    sc->leadMax = -100000;
+    
+    for (int d = 0; d < nDet; d++) {
+        int matched = 0;
+        for (int e = 0; e < eventCount; e++) {
+            int lead = events[e].impact - det[d];
+            if (used[e] || lead > MATCH_EARLY_SAMPLES || lead < -MATCH_LATE_SAMPLES) {
+                continue;
+            }
+            used[e] = 1;
+            matched = 1;
+            sc->truePos[events[e].type]++;
+            if (events[e].type != EV_FLOURISH) {
+                int ms = lead * SAMPLE_MS;
+                sc->leadSum += ms;
+                if (ms < sc->leadMin) sc->leadMin = ms;
+                if (ms > sc->leadMax) sc->leadMax = ms;
+            }
+            break;
+        }
+        if (!matched) {
+            sc->falsePos++;
+        }
+    }
+}
+
+static void report(const char *name, const Score_t *sc) {
+    int counts[EV_NUM_TYPES] = {0};
+    for (int e = 0; e < eventCount; e++) counts[events[e].type]++;
+    
+    int hits = counts[EV_HIT_Y] + counts[EV_HIT_Z];
+    int tp = sc->truePos[EV_HIT_Y] + sc->truePos[EV_HIT_Z];
+    int fp = sc->falsePos + sc->truePos[EV_FLOURISH];  // A flourish detection is a false hit
+    
+    printf("%s\n", name);
+    printf("  precision %.1f%%  recall %.1f%%  (%d detections)\n",
+           sc->detections ? 100.0 * tp / (tp + fp) : 0.0, 100.0 * tp / hits, sc->detections);
+    for (int t = 0; t < EV_NUM_TYPES; t++) {
+        printf("  %-14s %4d / %4d detected\n", eventNames[t], sc->truePos[t], counts[t]);
+    }
+    printf("  stray detections %d\n", sc->falsePos);
+    if (tp > 0) {
+        printf("  lead time vs impact (>0 = fired before the stop): mean %.1f ms, min %d ms, max %d ms\n",
+               (double)sc->leadSum / tp, sc->leadMin, sc->leadMax);
+    }
+}
+
+int main(int argc, char **argv) {
+    static int fusedDet[SESSION_SAMPLES];
+    static int gyroDet[SESSION_SAMPLES];
+    int nFused = 0, nGyro = 0;
+    
+    srand(argc > 1 ? (unsigned)atoi(argv[1]) : 1);
+    build_session();
+    
+    OnsetDetector_t det;
+    OnsetDetector_Init(&det);
+    int printedForGyro = 0;
+    
+    for (int s = 0; s < SESSION_SAMPLES; s++) {
+        // Same fixed-point conversion as drum_detection.c
+        int16_t gx = (int16_t)(gyro[s][0] * 1000.0f);
+        int16_t gy = (int16_t)(gyro[s][1] * 1000.0f);
+        int16_t gz = (int16_t)(gyro[s][2] * 1000.0f);
+        int16_t ax = (int16_t)(accel[s][0] * 100.0f);
+        int16_t ay = (int16_t)(accel[s][1] * 100.0f);
+        int16_t az = (int16_t)(accel[s][2] * 100.0f);
+        
+        // Reports arrive in either order within a sample period
+        int fired;
+        if (rand() & 1) {
+            fired = OnsetDetector_AddGyro(&det, gx, gy, gz);
+            fired |= OnsetDetector_AddAccel(&det, ax, ay, az);
+        } else {
+            fired = OnsetDetector_AddAccel(&det, ax, ay, az);
+            fired |= OnsetDetector_AddGyro(&det, gx, gy, gz);
+        }
+        if (fired) {
+            fusedDet[nFused++] = s;
+        }
+        
+        // Gyro-only path (DrumDetection_ProcessSensorData threshold logic)
+        if (gy < GYRO_HIT_THRESHOLD && !printedForGyro) {
+            printedForGyro = 1;
+            gyroDet[nGyro++] = s;
+        } else if (gy >= GYRO_HIT_THRESHOLD && printedForGyro) {
+            printedForGyro = 0;
+        }
+    }
+    
+    Score_t fused, gyroOnly;
+    score(fusedDet, nFused, &fused);
+    score(gyroDet, nGyro, &gyroOnly);
+    
+    printf("%d events over %d s at %d Hz\n\n", eventCount, SESSION_SAMPLES / RATE_HZ, RATE_HZ);
+    report("Gyro-only (gyro_y < GYRO_HIT_THRESHOLD)", &gyroOnly);
+    printf("\n");
+    report("Fused onset (angular deceleration + jerk)", &fused);
+    return 0;
+}
@@ -0,0 +1,202 @@
+// audio_sink.cpp
+// Pluggable audio outputs for the playback engine
+
+#include "audio_sink.hpp"
+#include "link_reader.hpp"  // For nowNs
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <thread>
+#include <unistd.h>
+
+namespace drumplay {
+
+void toS16(const float *in, int16_t *out, unsigned samples) {
+    for (unsigned i = 0; i < samples; i++) {
+        float v = in[i] * 32767.0f;
+        if (v > 32767.0f) v = 32767.0f;
+        if (v < -32768.0f) v = -32768.0f;
+        out[i] = (int16_t)v;
+    }
+}
+
+// Frames the modelled device has played by host time now
+int64_t ClockedSink::played(int64_t now) const {
+    return (now - startNs_) * rate_ / 1000000000;
+}
+
+bool ClockedSink::write(const float *frames, unsigned count) {
+    (void)frames;
+    int64_t now = nowNs();
+    if (!started_) {
+        started_ = true;
+        startNs_ = now;
+    }
+
+    // Ran dry: the device would have played silence; restart from now
+    if (played(now) > written_) {
+        xruns_++;
+        startNs_ = now - written_ * 1000000000 / rate_;
+    }
+
+    // Wait until the block fits in the device buffer
+    int64_t room = written_ + count - bufferFrames_;
+    if (room > played(now)) {
+        int64_t wakeNs = startNs_ + room * 1000000000 / rate_;
+        std::this_thread::sleep_for(std::chrono::nanoseconds(wakeNs - now));
+    }
+    written_ += count;
+    return true;
+}
+
+unsigned ClockedSink::queuedFrames() {
+    if (!started_) {
+        return 0;
+    }
+    int64_t queued = written_ - played(nowNs());
+    return (queued > 0) ? (unsigned)queued : 0;
+}
+
+bool WavSink::open(const std::string &path, std::string &err) {
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        err = path + ": " + std::strerror(errno);
+        return false;
+    }
+    uint8_t header[44] = {0};
+    std::fwrite(header, 1, sizeof(header), file_);  // Filled in by close()
+    return true;
+}
+
+bool WavSink::write(const float *frames, unsigned count) {
+    int16_t pcm[2 * 1024];
+    for (unsigned done = 0; done < count; ) {
+        unsigned n = count - done;
+        if (n > 1024) {
+            n = 1024;
+        }
+        toS16(frames + 2 * done, pcm, 2 * n);
+        if (std::fwrite(pcm, 4, n, file_) != n) {
+            return false;
+        }
+        dataBytes_ += 4 * n;
+        done += n;
+    }
+    return ClockedSink::write(frames, count);
+}
+
+static void put_le(uint8_t *p, uint32_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+void WavSink::close() {
+    if (!file_) {
+        return;
+    }
+    uint8_t h[44];
+    std::memcpy(h, "RIFF", 4);
+    put_le(h + 4, 36 + dataBytes_, 4);
+    std::memcpy(h + 8, "WAVEfmt ", 8);
+    put_le(h + 16, 16, 4);
+    put_le(h + 20, 1, 2);          // PCM
+    put_le(h + 22, 2, 2);          // Stereo
+    put_le(h + 24, rate_, 4);
+    put_le(h + 28, rate_ * 4, 4);  // Byte rate
+    put_le(h + 32, 4, 2);          // Block align
+    put_le(h + 34, 16, 2);         // Bits per sample
+    std::memcpy(h + 36, "data", 4);
+    put_le(h + 40, dataBytes_, 4);
+    std::fseek(file_, 0, SEEK_SET);
+    std::fwrite(h, 1, sizeof(h), file_);
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+bool PipeSink::open(const std::string &path, std::string &err) {
+    if (path.empty()) {
+        fd_ = STDOUT_FILENO;
+        return true;
+    }
+    fd_ = ::open(path.c_str(), O_WRONLY);
+    if (fd_ < 0) {
+        err = path + ": " + std::strerror(errno);
+        return false;
+    }
+    ownFd_ = true;
+    return true;
+}
+
+bool PipeSink::write(const float *frames, unsigned count) {
+    int16_t pcm[2 * 1024];
+    for (unsigned done = 0; done < count; ) {
+        unsigned n = count - done;
+        if (n > 1024) {
+            n = 1024;
+        }
+        toS16(frames + 2 * done, pcm, 2 * n);
+        const uint8_t *p = reinterpret_cast<const uint8_t *>(pcm);
+        size_t left = 4 * n;
+        while (left > 0) {
+            ssize_t w = ::write(fd_, p, left);
+            if (w < 0 && errno == EINTR) {
+                continue;
+            }
+            if (w <= 0) {
+                return false;
+            }
+            p += w;
+            left -= w;
+        }
+        done += n;
+    }
+    return ClockedSink::write(frames, count);
+}
+
+// Audio ahead of real time, plus what the reader has not yet taken
+unsigned PipeSink::queuedFrames() {
+    int bytes = 0;
+    if (ioctl(fd_, FIONREAD, &bytes) != 0) {
+        bytes = 0;
+    }
+    return ClockedSink::queuedFrames() + bytes / 4;
+}
+
+void PipeSink::close() {
+    if (ownFd_ && fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+}
+
+std::unique_ptr<AudioSink> makeSink(const std::string &spec, unsigned rate, unsigned bufferFrames,
+                                    std::string &err) {
+    std::string kind = spec.substr(0, spec.find(':'));
+    std::string arg = (spec.find(':') != std::string::npos) ? spec.substr(spec.find(':') + 1) : "";
+
+    if (kind == "null") {
+        return std::unique_ptr<AudioSink>(new ClockedSink(rate, bufferFrames));
+    }
+    if (kind == "wav" && !arg.empty()) {
+        std::unique_ptr<WavSink> sink(new WavSink(rate, bufferFrames));
+        if (!sink->open(arg, err)) {
+            return nullptr;
+        }
+        return std::unique_ptr<AudioSink>(sink.release());
+    }
+    if (kind == "pipe") {
+        std::unique_ptr<PipeSink> sink(new PipeSink(rate, bufferFrames));
+        if (!sink->open(arg, err)) {
+            return nullptr;
+        }
+        return std::unique_ptr<AudioSink>(sink.release());
+    }
+    err = "unknown sink '" + spec + "' (null, wav:FILE, pipe[:PATH])";
+    return nullptr;
+}
+
+}  // namespace drumplay
@@ -0,0 +1,103 @@
+// audio_sink.hpp
+// Pluggable audio outputs for the playback engine
+//
+// The render thread hands each block to AudioSink::write(), which blocks
+// until the output can take it; that is what paces rendering. queuedFrames()
+// is the audio written but not yet heard, which places the next block on
+// the host clock. Sinks are chosen by name with makeSink():
+//
+//   null         a clocked device model that discards the audio: a buffer of
+//                bufferMs drained in real time, with an xrun counted whenever
+//                the renderer lets it run dry
+//   wav:FILE     the same model, with everything it plays written to a
+//                16-bit stereo WAV file (check hit timing without a sound card)
+//   pipe[:PATH]  raw S16_LE stereo to stdout or a FIFO, paced like null (so
+//                the reader is kept bufferMs ahead, not flooded) and by the
+//                reader, e.g. | aplay -f S16_LE -c 2 -r 48000 --buffer-time=20000
+
+#ifndef AUDIO_SINK_HPP
+#define AUDIO_SINK_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace drumplay {
+
+class AudioSink {
+public:
+    virtual ~AudioSink() = default;
+
+    // Interleaved stereo; false on a fatal output error
+    virtual bool write(const float *frames, unsigned count) = 0;
+
+    // Frames written but not yet audible
+    virtual unsigned queuedFrames() = 0;
+
+    // Output underruns since start
+    virtual uint64_t xruns() const { return 0; }
+
+    virtual void close() {}
+};
+
+// Real-time device model (the null sink)
+class ClockedSink : public AudioSink {
+public:
+    ClockedSink(unsigned rate, unsigned bufferFrames) : rate_(rate), bufferFrames_(bufferFrames) {}
+
+    bool write(const float *frames, unsigned count) override;
+    unsigned queuedFrames() override;
+    uint64_t xruns() const override { return xruns_; }
+
+private:
+    int64_t played(int64_t now) const;
+
+    unsigned rate_;
+    unsigned bufferFrames_;
+    bool started_ = false;
+    int64_t startNs_ = 0;     // Host time at which frame 0 played
+    int64_t written_ = 0;
+    uint64_t xruns_ = 0;
+};
+
+class WavSink : public ClockedSink {
+public:
+    WavSink(unsigned rate, unsigned bufferFrames) : ClockedSink(rate, bufferFrames), rate_(rate) {}
+    ~WavSink() override { close(); }
+
+    bool open(const std::string &path, std::string &err);
+    bool write(const float *frames, unsigned count) override;
+    void close() override;
+
+private:
+    unsigned rate_;
+    FILE *file_ = nullptr;
+    uint32_t dataBytes_ = 0;
+};
+
+class PipeSink : public ClockedSink {
+public:
+    PipeSink(unsigned rate, unsigned bufferFrames) : ClockedSink(rate, bufferFrames) {}
+    ~PipeSink() override { close(); }
+
+    bool open(const std::string &path, std::string &err);
+    bool write(const float *frames, unsigned count) override;
+    unsigned queuedFrames() override;
+    void close() override;
+
+private:
+    int fd_ = -1;
+    bool ownFd_ = false;
+};
+
+// "null", "wav:FILE" or "pipe[:PATH]"; nullptr with err set on failure
+std::unique_ptr<AudioSink> makeSink(const std::string &spec, unsigned rate, unsigned bufferFrames,
+                                    std::string &err);
+
+// Float to 16-bit with clipping
+void toS16(const float *in, int16_t *out, unsigned samples);
+
+}  // namespace drumplay
+
+#endif  // AUDIO_SINK_HPP
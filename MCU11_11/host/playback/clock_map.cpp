@@ -0,0 +1,40 @@
+// clock_map.cpp
+// Jitter buffer: maps device hit times to host playback times
+
+#include "clock_map.hpp"
+
+#include <cstdlib>
+
+namespace drumplay {
+
+static const int64_t RESYNC_NS = 1000000000;
+
+int64_t ClockMap::map(uint64_t deviceUs, int64_t arrivalNs) {
+    int64_t deviceNs = (int64_t)deviceUs * 1000;
+    int64_t offset = arrivalNs - deviceNs;
+
+    if (!window_.empty() && std::llabs(offset - window_.front().offsetNs) > RESYNC_NS) {
+        window_.clear();
+    }
+    while (!window_.empty() && window_.front().arrivalNs < arrivalNs - windowNs_) {
+        window_.pop_front();
+    }
+    // Monotonic deque: samples with a larger offset than this one can never
+    // be the minimum again
+    while (!window_.empty() && window_.back().offsetNs >= offset) {
+        window_.pop_back();
+    }
+    window_.push_back({arrivalNs, offset});
+
+    int64_t base = window_.front().offsetNs;
+    delays_.push_back(offset - base);
+    return deviceNs + base + jitterNs_;
+}
+
+std::vector<int64_t> ClockMap::takeDelays() {
+    std::vector<int64_t> out;
+    out.swap(delays_);
+    return out;
+}
+
+}  // namespace drumplay
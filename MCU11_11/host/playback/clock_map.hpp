@@ -0,0 +1,56 @@
+// clock_map.hpp
+// Jitter buffer: maps device hit times to host playback times
+//
+// A hit reaches the host after the sensor report that triggered it plus a
+// variable delay: detection in the sensor task, the transmit ring, the UART
+// and the USB virtual COM port, which polls every millisecond. Playing each
+// hit on arrival turns that variation straight into timing error.
+//
+// Instead, offset = arrival - device time is measured for every hit. Its
+// minimum over a sliding window is the least-delayed path; that minimum
+// plus a fixed jitter allowance gives the host time at which every hit is
+// played. Hits keep the spacing the drummer played as long as their extra
+// delay stays within the allowance; a hit that arrives later than that is
+// played immediately and counted as late by the engine.
+//
+// The window lets the map follow drift between the sensor hub and host
+// clocks (100 ppm is 1 ms over the default 10 s window). A jump of more
+// than a second, such as a device reset, restarts it.
+
+#ifndef CLOCK_MAP_HPP
+#define CLOCK_MAP_HPP
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace drumplay {
+
+class ClockMap {
+public:
+    ClockMap(int64_t jitterNs, int64_t windowNs) : jitterNs_(jitterNs), windowNs_(windowNs) {}
+
+    // Add a hit and return its host playback time
+    int64_t map(uint64_t deviceUs, int64_t arrivalNs);
+
+    int64_t jitterNs() const { return jitterNs_; }
+
+    // Delay of each hit beyond the window minimum since the last call
+    // (what the jitter allowance has to cover), then cleared
+    std::vector<int64_t> takeDelays();
+
+private:
+    struct Sample {
+        int64_t arrivalNs;
+        int64_t offsetNs;
+    };
+
+    int64_t jitterNs_;
+    int64_t windowNs_;
+    std::deque<Sample> window_;  // Increasing offsets: front is the minimum
+    std::vector<int64_t> delays_;
+};
+
+}  // namespace drumplay
+
+#endif  // CLOCK_MAP_HPP
@@ -0,0 +1,196 @@
+// drumplay.cpp
+// Host playback of the device's hit stream with jitter compensation
+//
+// Reads LINK_EV_HIT events from the serial link, maps each hit's sensor hub
+// timestamp to a host playback time (clock_map.hpp) and plays the kit's
+// sample at the hit's velocity through the chosen audio sink
+// (playback_engine.hpp, audio_sink.hpp). Replaces the pygame play_sound.py
+// for the binary link: sample-accurate timing, velocity, no busy loop.
+//
+// Usage:
+//   ./drumplay /dev/ttyACM0 [--sink null|wav:FILE|pipe[:PATH]] [--jitter-ms 8]
+//              [--buffer-ms 10] [--rate 48000] [--block 64] [--samples DIR]
+//              [--sample ID=FILE ...] [--gain 0.7] [--report-s 5] [--seconds N]
+//
+// Every --report-s seconds (and at exit) it prints the hits played, how
+// many arrived too late for the jitter allowance, the delay spread the
+// allowance has to cover, arrival-to-audible latency, the sink buffer and
+// its xruns.
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "audio_sink.hpp"
+#include "clock_map.hpp"
+#include "link_reader.hpp"
+#include "playback_engine.hpp"
+#include "sample_bank.hpp"
+
+using namespace drumplay;
+
+static std::atomic<bool> quit{false};
+static FILE *log_out = stdout;
+
+static void on_signal(int) {
+    quit = true;
+}
+
+static void usage() {
+    std::fprintf(stderr,
+        "usage: drumplay PORT [--baud 1000000] [--sink null|wav:FILE|pipe[:PATH]]\n"
+        "                [--jitter-ms 8] [--window-s 10] [--buffer-ms 10] [--rate 48000]\n"
+        "                [--block 64] [--samples DIR] [--sample ID=FILE ...] [--gain 0.7]\n"
+        "                [--report-s 5] [--seconds N]\n");
+    std::exit(1);
+}
+
+static double percentile_ms(std::vector<int64_t> &v, double p) {
+    if (v.empty()) {
+        return 0.0;
+    }
+    size_t i = (size_t)(p * (v.size() - 1) + 0.5);
+    std::nth_element(v.begin(), v.begin() + i, v.end());
+    return v[i] / 1e6;
+}
+
+static void report(PlaybackEngine &engine, ClockMap &clock, const LinkReader &reader, double seconds) {
+    EngineStats s = engine.takeStats();
+    std::vector<int64_t> delays = clock.takeDelays();
+    double p50 = percentile_ms(delays, 0.50);
+    double p95 = percentile_ms(delays, 0.95);
+    double max = percentile_ms(delays, 1.0);
+
+    std::fprintf(log_out, "[%6.1f s] hits %llu late %llu dropped %llu | delay spread p50 %.2f p95 %.2f max %.2f ms"
+                " (allowance %.1f) | arrival->audio mean %.2f max %.2f ms | sink %.1f ms, xruns %llu,"
+                " voices %u | link bad %u gaps %u\n",
+                seconds, (unsigned long long)s.hits, (unsigned long long)s.late,
+                (unsigned long long)s.dropped, p50, p95, max, clock.jitterNs() / 1e6,
+                s.hits ? s.latencySumNs / 1e6 / s.hits : 0.0, s.latencyMaxNs / 1e6,
+                s.sinkMs, (unsigned long long)s.xruns, s.voices, reader.badFrames(), reader.eventGaps());
+    std::fflush(log_out);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argv[1][0] == '-') {
+        usage();
+    }
+    std::string port = argv[1];
+    std::string sinkSpec = "null";
+    std::string samplesDir = "../../Code_for_C_imp/SAMPLES";
+    std::vector<std::string> overrides;
+    int baud = 1000000;
+    double jitterMs = 8.0, windowS = 10.0, bufferMs = 10.0, reportS = 5.0, seconds = 0.0;
+    EngineConfig config;
+
+    for (int i = 2; i < argc; i++) {
+        std::string opt = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+        }
+        const char *val = argv[++i];
+        if (opt == "--baud") baud = std::atoi(val);
+        else if (opt == "--sink") sinkSpec = val;
+        else if (opt == "--jitter-ms") jitterMs = std::atof(val);
+        else if (opt == "--window-s") windowS = std::atof(val);
+        else if (opt == "--buffer-ms") bufferMs = std::atof(val);
+        else if (opt == "--rate") config.rate = (unsigned)std::atoi(val);
+        else if (opt == "--block") config.blockFrames = (unsigned)std::atoi(val);
+        else if (opt == "--samples") samplesDir = val;
+        else if (opt == "--sample") overrides.push_back(val);
+        else if (opt == "--gain") config.gain = (float)std::atof(val);
+        else if (opt == "--report-s") reportS = std::atof(val);
+        else if (opt == "--seconds") seconds = std::atof(val);
+        else usage();
+    }
+    if (config.rate == 0 || config.blockFrames == 0) {
+        usage();
+    }
+
+    // When the sink writes to stdout, reports go to stderr
+    if (sinkSpec == "pipe") {
+        log_out = stderr;
+    }
+
+    std::string err;
+    SampleBank bank(config.rate);
+    if (!bank.loadDefaultKit(samplesDir, err)) {
+        std::fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    for (const std::string &o : overrides) {
+        size_t eq = o.find('=');
+        if (eq == std::string::npos || !bank.load(std::atoi(o.c_str()), o.substr(eq + 1), err)) {
+            std::fprintf(stderr, "--sample %s: %s\n", o.c_str(), err.empty() ? "expected ID=FILE" : err.c_str());
+            return 1;
+        }
+    }
+
+    unsigned bufferFrames = (unsigned)(bufferMs * config.rate / 1000.0);
+    if (bufferFrames < config.blockFrames) {
+        bufferFrames = config.blockFrames;
+    }
+    config.outputNs = (int64_t)bufferFrames * 1000000000 / config.rate;
+    std::unique_ptr<AudioSink> sink = makeSink(sinkSpec, config.rate, bufferFrames, err);
+    if (!sink) {
+        std::fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+
+    LinkReader reader;
+    if (!reader.open(port, baud, err)) {
+        std::fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    ClockMap clock((int64_t)(jitterMs * 1e6), (int64_t)(windowS * 1e9));
+    PlaybackEngine engine(bank, *sink, config);
+    engine.start();
+
+    // Once the input ends, play out what is scheduled (allowance, sink
+    // buffer and the longest sample tail) before stopping
+    const int64_t drainNs = (int64_t)((jitterMs + bufferMs) * 1e6) + 2000000000;
+    int64_t start = nowNs();
+    int64_t nextReport = start + (int64_t)(reportS * 1e9);
+    int64_t endNs = 0;
+    std::vector<LinkFrame> frames;
+    while (!quit && engine.running()) {
+        frames.clear();
+        if (endNs == 0) {
+            if (!reader.poll(50, frames)) {
+                endNs = nowNs() + drainNs;
+            }
+        } else {
+            usleep(20000);
+        }
+        for (const LinkFrame &f : frames) {
+            HitEvent hit;
+            if (reader.decodeHit(f, hit)) {
+                engine.schedule({clock.map(hit.deviceUs, hit.arrivalNs), hit.arrivalNs, hit.drumId, hit.velocity});
+            }
+        }
+
+        int64_t now = nowNs();
+        if ((endNs != 0 && now >= endNs) || (seconds > 0 && now - start >= (int64_t)(seconds * 1e9))) {
+            break;
+        }
+        if (now >= nextReport) {
+            report(engine, clock, reader, (now - start) / 1e9);
+            nextReport = now + (int64_t)(reportS * 1e9);
+        }
+    }
+
+    engine.stop();
+    report(engine, clock, reader, (nowNs() - start) / 1e9);
+    sink->close();
+    return engine.running() ? 0 : 1;
+}
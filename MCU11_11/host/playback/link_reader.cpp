@@ -0,0 +1,179 @@
+// link_reader.cpp
+// Frame reader for the device's serial link
+
+#include "link_reader.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+extern "C" {
+#include "crc32.h"
+}
+
+namespace drumplay {
+
+static_assert(sizeof(LinkHit_t) == 20, "LinkHit_t layout differs from the firmware");
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static speed_t baud_constant(int baud) {
+    switch (baud) {
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+#ifdef B460800
+        case 460800:  return B460800;
+        case 921600:  return B921600;
+        case 1000000: return B1000000;
+        case 2000000: return B2000000;
+#endif
+        default:      return 0;
+    }
+}
+
+LinkReader::~LinkReader() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool LinkReader::open(const std::string &path, int baud, std::string &err) {
+    fd_ = ::open(path.c_str(), O_RDONLY | O_NOCTTY);
+    if (fd_ < 0) {
+        err = path + ": " + std::strerror(errno);
+        return false;
+    }
+    if (isatty(fd_)) {
+        struct termios tio;
+        speed_t speed = baud_constant(baud);
+        if (speed == 0) {
+            err = "unsupported baud rate " + std::to_string(baud);
+            return false;
+        }
+        if (tcgetattr(fd_, &tio) != 0) {
+            err = path + ": " + std::strerror(errno);
+            return false;
+        }
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd_, TCSANOW, &tio);
+        tcflush(fd_, TCIFLUSH);
+    }
+    return true;
+}
+
+bool LinkReader::poll(int timeoutMs, std::vector<LinkFrame> &out) {
+    struct pollfd p = {fd_, POLLIN, 0};
+    int n = ::poll(&p, 1, timeoutMs);
+    if (n < 0) {
+        return errno == EINTR;
+    }
+    if (n == 0) {
+        return true;
+    }
+
+    uint8_t buf[4096];
+    ssize_t got = ::read(fd_, buf, sizeof(buf));
+    if (got < 0 && errno == EINTR) {
+        return true;
+    }
+    if (got <= 0) {
+        return false;  // EOF, or EIO when the other end of a pty closes
+    }
+
+    int64_t arrival = nowNs();
+    for (ssize_t i = 0; i < got; i++) {
+        if (buf[i] == 0) {
+            finishFrame(arrival, out);
+            encoded_.clear();
+        } else if (encoded_.size() < LINK_COBS_MAX(LINK_MAX_RAW)) {
+            encoded_.push_back(buf[i]);
+        }
+    }
+    return true;
+}
+
+void LinkReader::finishFrame(int64_t arrivalNs, std::vector<LinkFrame> &out) {
+    if (encoded_.empty()) {
+        return;
+    }
+
+    // COBS decode: each code byte gives the distance to the next zero
+    std::vector<uint8_t> raw;
+    raw.reserve(encoded_.size());
+    size_t i = 0;
+    while (i < encoded_.size()) {
+        uint8_t code = encoded_[i++];
+        if (i + code - 1 > encoded_.size()) {
+            bad_++;
+            return;
+        }
+        raw.insert(raw.end(), encoded_.begin() + i, encoded_.begin() + i + code - 1);
+        i += code - 1;
+        if (code != 0xFF && i < encoded_.size()) {
+            raw.push_back(0);
+        }
+    }
+
+    if (raw.size() < LINK_HDR_LEN + LINK_CRC_LEN) {
+        bad_++;
+        return;
+    }
+    size_t body = raw.size() - LINK_CRC_LEN;
+    uint32_t crc;
+    std::memcpy(&crc, &raw[body], sizeof(crc));
+    if (CRC32_Compute(raw.data(), (uint32_t)body) != crc) {
+        bad_++;
+        return;
+    }
+
+    LinkFrame frame;
+    frame.type = raw[0];
+    frame.seq = raw[1];
+    frame.payload.assign(raw.begin() + LINK_HDR_LEN, raw.begin() + body);
+    frame.arrivalNs = arrivalNs;
+
+    // Device events carry a running sequence number
+    if (frame.type >= LINK_EV_HIT) {
+        if (lastEventSeq_ >= 0 && frame.seq != (uint8_t)(lastEventSeq_ + 1)) {
+            gaps_++;
+        }
+        lastEventSeq_ = frame.seq;
+    }
+    out.push_back(std::move(frame));
+}
+
+bool LinkReader::decodeHit(const LinkFrame &frame, HitEvent &hit) {
+    if (frame.type != LINK_EV_HIT || frame.payload.size() != sizeof(LinkHit_t)) {
+        return false;
+    }
+    LinkHit_t h;
+    std::memcpy(&h, frame.payload.data(), sizeof(h));
+
+    // The sensor hub clock is sent as 32-bit microseconds (wraps every 71 min)
+    if (haveDeviceUs_ && h.timeUs < lastDeviceUs_ && lastDeviceUs_ - h.timeUs > 0x80000000u) {
+        deviceWraps_++;
+    }
+    lastDeviceUs_ = h.timeUs;
+    haveDeviceUs_ = true;
+
+    hit.deviceUs = (deviceWraps_ << 32) | h.timeUs;
+    hit.arrivalNs = frame.arrivalNs;
+    hit.drumId = h.drumId;
+    hit.strokeType = h.strokeType;
+    hit.velocity = h.velocity;
+    return true;
+}
+
+}  // namespace drumplay
@@ -0,0 +1,78 @@
+// link_reader.hpp
+// Frame reader for the device's serial link (serial_link_protocol.h)
+//
+// Opens a serial port (configured raw at the link baud rate), a pty or a
+// FIFO, splits the byte stream at the 0x00 delimiters, undoes the COBS
+// encoding and checks the CRC32. Every good frame is stamped with the host
+// steady_clock time of the read that completed it; that arrival time is
+// what the clock map (clock_map.hpp) compares with the device timestamp.
+
+#ifndef LINK_READER_HPP
+#define LINK_READER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "serial_link_protocol.h"
+}
+
+namespace drumplay {
+
+// One decoded frame
+struct LinkFrame {
+    uint8_t type;
+    uint8_t seq;
+    std::vector<uint8_t> payload;
+    int64_t arrivalNs;  // Host steady_clock
+};
+
+// One hit event (LINK_EV_HIT) with the device time unwrapped to 64 bits
+struct HitEvent {
+    uint64_t deviceUs;
+    int64_t arrivalNs;
+    uint8_t drumId;
+    uint8_t strokeType;
+    uint8_t velocity;
+};
+
+class LinkReader {
+public:
+    LinkReader() = default;
+    ~LinkReader();
+    LinkReader(const LinkReader &) = delete;
+    LinkReader &operator=(const LinkReader &) = delete;
+
+    // baud applies only when path is a terminal
+    bool open(const std::string &path, int baud, std::string &err);
+
+    // Wait up to timeoutMs for input and append the frames it completes.
+    // Returns false at end of input or on a read error.
+    bool poll(int timeoutMs, std::vector<LinkFrame> &out);
+
+    // LINK_EV_HIT frame to a hit event; false for any other frame
+    bool decodeHit(const LinkFrame &frame, HitEvent &hit);
+
+    uint32_t badFrames() const { return bad_; }
+    uint32_t eventGaps() const { return gaps_; }
+
+private:
+    void finishFrame(int64_t arrivalNs, std::vector<LinkFrame> &out);
+
+    int fd_ = -1;
+    std::vector<uint8_t> encoded_;  // Bytes since the last delimiter
+    uint32_t bad_ = 0;
+    uint32_t gaps_ = 0;
+    int lastEventSeq_ = -1;
+    uint32_t lastDeviceUs_ = 0;
+    uint64_t deviceWraps_ = 0;
+    bool haveDeviceUs_ = false;
+};
+
+// Host steady_clock in nanoseconds
+int64_t nowNs();
+
+}  // namespace drumplay
+
+#endif  // LINK_READER_HPP
@@ -0,0 +1,162 @@
+// playback_engine.cpp
+// Real-time sample playback of scheduled hits
+
+#include "playback_engine.hpp"
+#include "link_reader.hpp"  // For nowNs
+
+#include <cstdlib>
+#include <vector>
+
+namespace drumplay {
+
+// Re-anchor the block clock when the estimate and the sink disagree by more
+// than this; smaller errors (clock drift, wake-up jitter) are followed slowly
+static const int64_t REANCHOR_NS = 2000000;
+
+void PlaybackEngine::start() {
+    stop_ = false;
+    thread_ = std::thread(&PlaybackEngine::run, this);
+}
+
+void PlaybackEngine::stop() {
+    stop_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool PlaybackEngine::schedule(const ScheduledHit &hit) {
+    if (!ring_.push(hit)) {
+        dropped_++;
+        return false;
+    }
+    return true;
+}
+
+EngineStats PlaybackEngine::takeStats() {
+    EngineStats s;
+    s.hits = hits_.exchange(0);
+    s.late = late_.exchange(0);
+    s.dropped = dropped_.exchange(0);
+    s.latencySumNs = latencySumNs_.exchange(0);
+    s.latencyMaxNs = latencyMaxNs_.exchange(0);
+    s.xruns = sink_.xruns();
+    s.sinkMs = sinkFrames_.load() * 1000.0 / config_.rate;
+    s.voices = voicesActive_.load();
+    return s;
+}
+
+void PlaybackEngine::startVoice(const ScheduledHit &hit, unsigned offset) {
+    const Sample *sample = bank_.get(hit.drumId);
+    if (!sample) {
+        return;
+    }
+
+    // Steal the voice that has played longest when all are busy
+    int slot = voiceCount_;
+    if (voiceCount_ == MAX_VOICES) {
+        slot = 0;
+        for (int i = 1; i < MAX_VOICES; i++) {
+            if (voices_[i].pos > voices_[slot].pos) {
+                slot = i;
+            }
+        }
+    } else {
+        voiceCount_++;
+    }
+
+    // Velocity curve: amplitude (v/127)^2, about 40 dB from 1 to 127
+    float v = hit.velocity / 127.0f;
+    voices_[slot] = {sample, 0, offset, config_.gain * v * v};
+}
+
+void PlaybackEngine::mix(float *out) {
+    unsigned n = config_.blockFrames;
+    for (unsigned i = 0; i < 2 * n; i++) {
+        out[i] = 0.0f;
+    }
+
+    for (int v = 0; v < voiceCount_; ) {
+        Voice &voice = voices_[v];
+        const float *src = &voice.sample->data[2 * voice.pos];
+        unsigned frames = n - voice.offset;
+        if (frames > voice.sample->frames - voice.pos) {
+            frames = (unsigned)(voice.sample->frames - voice.pos);
+        }
+        float *dst = out + 2 * voice.offset;
+        for (unsigned i = 0; i < 2 * frames; i++) {
+            dst[i] += voice.gain * src[i];
+        }
+        voice.pos += frames;
+        voice.offset = 0;
+
+        if (voice.pos >= voice.sample->frames) {
+            voices_[v] = voices_[--voiceCount_];  // Finished: swap in the last voice
+        } else {
+            v++;
+        }
+    }
+}
+
+void PlaybackEngine::run() {
+    const unsigned n = config_.blockFrames;
+    const int64_t blockNs = (int64_t)n * 1000000000 / config_.rate;
+    std::vector<float> block(2 * n);  // Allocated once, before the first block
+    bool anchored = false;
+    int64_t predicted = 0;
+
+    while (!stop_) {
+        // Host time at which the first frame of this block will be heard
+        unsigned queued = sink_.queuedFrames();
+        int64_t measured = nowNs() + (int64_t)queued * 1000000000 / config_.rate;
+        int64_t blockStart;
+        if (!anchored || std::llabs(measured - predicted) > REANCHOR_NS) {
+            blockStart = measured;
+            anchored = true;
+        } else {
+            blockStart = predicted + (measured - predicted) / 64;
+        }
+        sinkFrames_ = queued;
+
+        ScheduledHit hit;
+        while (ring_.pop(hit)) {
+            if (pendingCount_ < MAX_PENDING) {
+                pending_[pendingCount_++] = hit;
+            } else {
+                dropped_++;
+            }
+        }
+
+        // Start the hits that fall in this block
+        for (int i = 0; i < pendingCount_; ) {
+            int64_t offset = (pending_[i].playNs + config_.outputNs - blockStart) * config_.rate / 1000000000;
+            if (offset >= n) {
+                i++;
+                continue;
+            }
+            if (offset < 0) {
+                offset = 0;
+                late_++;
+            }
+            startVoice(pending_[i], (unsigned)offset);
+
+            int64_t latency = blockStart + offset * 1000000000 / config_.rate - pending_[i].arrivalNs;
+            latencySumNs_ += latency;
+            if (latency > latencyMaxNs_.load()) {
+                latencyMaxNs_ = latency;
+            }
+            hits_++;
+            pending_[i] = pending_[--pendingCount_];
+        }
+
+        mix(block.data());
+        voicesActive_ = voiceCount_;
+        if (!sink_.write(block.data(), n)) {
+            failed_ = true;
+            break;
+        }
+        predicted = blockStart + blockNs;
+    }
+}
+
+}  // namespace drumplay
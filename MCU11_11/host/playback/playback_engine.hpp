@@ -0,0 +1,114 @@
+// playback_engine.hpp
+// Real-time sample playback of scheduled hits
+//
+// schedule() is called from the reader thread with a hit and the host time
+// it should sound at (clock_map.hpp). It only pushes onto a lock-free ring;
+// the render thread drains the ring every block, so neither side waits for
+// the other and the render thread never locks or allocates.
+//
+// Each block's host time is the current time plus the audio the sink has
+// queued. Every hit is delayed by the nominal sink buffer (outputNs), which
+// the render thread has to stay ahead by anyway. A hit starts at the sample
+// offset of its playback time within the block that contains it, so hits
+// keep their spacing to the sample rather than to the block. A hit whose
+// time has passed starts at the top of the next block and counts as late.
+
+#ifndef PLAYBACK_ENGINE_HPP
+#define PLAYBACK_ENGINE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "audio_sink.hpp"
+#include "sample_bank.hpp"
+#include "spsc_ring.hpp"
+
+namespace drumplay {
+
+struct EngineConfig {
+    unsigned rate = 48000;
+    unsigned blockFrames = 64;   // 1.3 ms at 48 kHz
+    float gain = 0.7f;           // Master gain (velocity 127)
+    int64_t outputNs = 0;        // Sink buffer added to every playback time
+};
+
+struct ScheduledHit {
+    int64_t playNs;      // Host time to sound at
+    int64_t arrivalNs;   // Host time the event was read
+    uint8_t drumId;
+    uint8_t velocity;
+};
+
+// Counters since the previous takeStats() (xruns and voices are current)
+struct EngineStats {
+    uint64_t hits = 0;
+    uint64_t late = 0;
+    uint64_t dropped = 0;          // Hit ring or pending list full
+    int64_t latencySumNs = 0;      // Arrival to audible
+    int64_t latencyMaxNs = 0;
+    uint64_t xruns = 0;
+    double sinkMs = 0;             // Audio queued in the sink
+    unsigned voices = 0;
+};
+
+class PlaybackEngine {
+public:
+    PlaybackEngine(const SampleBank &bank, AudioSink &sink, const EngineConfig &config)
+        : bank_(bank), sink_(sink), config_(config) {}
+    ~PlaybackEngine() { stop(); }
+
+    void start();
+    void stop();
+
+    // Reader thread; false if the hit ring is full
+    bool schedule(const ScheduledHit &hit);
+
+    // False once the sink has failed
+    bool running() const { return !failed_.load(); }
+
+    EngineStats takeStats();
+
+private:
+    static const int MAX_VOICES = 32;
+    static const int MAX_PENDING = 64;
+
+    struct Voice {
+        const Sample *sample;
+        size_t pos;         // Next frame of the sample
+        unsigned offset;    // First frame in the current block
+        float gain;
+    };
+
+    void run();
+    void startVoice(const ScheduledHit &hit, unsigned offset);
+    void mix(float *out);
+
+    const SampleBank &bank_;
+    AudioSink &sink_;
+    EngineConfig config_;
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> failed_{false};
+
+    SpscRing<ScheduledHit, 256> ring_;
+
+    // Render thread only
+    ScheduledHit pending_[MAX_PENDING];
+    int pendingCount_ = 0;
+    Voice voices_[MAX_VOICES];
+    int voiceCount_ = 0;
+
+    // Render thread to takeStats()
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> late_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<int64_t> latencySumNs_{0};
+    std::atomic<int64_t> latencyMaxNs_{0};
+    std::atomic<unsigned> sinkFrames_{0};
+    std::atomic<unsigned> voicesActive_{0};
+};
+
+}  // namespace drumplay
+
+#endif  // PLAYBACK_ENGINE_HPP
@@ -0,0 +1,144 @@
+// sample_bank.cpp
+// Drum samples loaded from WAV files, converted for the render thread
+
+#include "sample_bank.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace drumplay {
+
+#define WAVE_FORMAT_PCM         1
+#define WAVE_FORMAT_FLOAT       3
+#define WAVE_FORMAT_EXTENSIBLE  0xFFFE
+
+static const char *const DEFAULT_KIT[MAX_DRUMS] = {
+    "SNARES/07_Snare_16_SP.wav",     // DRUM_SNARE
+    "HIHATS/Boom-Bap Hat CL 53.wav", // DRUM_HIHAT
+    "KICKS/Boom-Bap Kick 53.wav",    // DRUM_KICK
+    "TOMS/TOM.wav",                  // DRUM_HIGH_TOM
+    "TOMS/Acoustic Mid Tom 06.wav",  // DRUM_MID_TOM
+    "CYMBALS/07_Perc_05_SP.wav",     // DRUM_CRASH
+    "CYMBALS/MachineRide.wav",       // DRUM_RIDE
+    "TOMS/Tomm1.wav",                // DRUM_LOW_TOM
+};
+
+static uint32_t le16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static uint32_t le32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+// One sample value as -1..1
+static float decode_value(const uint8_t *p, unsigned format, unsigned bits) {
+    if (format == WAVE_FORMAT_FLOAT) {
+        float f;
+        std::memcpy(&f, p, sizeof(f));
+        return f;
+    }
+    switch (bits) {
+        case 8:  return (p[0] - 128) / 128.0f;
+        case 16: return (int16_t)le16(p) / 32768.0f;
+        case 24: return (int32_t)((p[0] << 8) | (p[1] << 16) | ((uint32_t)p[2] << 24)) / 2147483648.0f;
+        default: return (int32_t)le32(p) / 2147483648.0f;
+    }
+}
+
+bool SampleBank::load(int drumId, const std::string &path, std::string &err) {
+    if (drumId < 0 || drumId >= MAX_DRUMS) {
+        err = "drum id " + std::to_string(drumId) + " out of range";
+        return false;
+    }
+    std::ifstream in(path, std::ios::binary);
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (!in.good() && !in.eof()) {
+        err = path + ": cannot read";
+        return false;
+    }
+    if (file.size() < 12 || std::memcmp(&file[0], "RIFF", 4) != 0 || std::memcmp(&file[8], "WAVE", 4) != 0) {
+        err = path + ": not a WAV file";
+        return false;
+    }
+
+    unsigned format = 0, channels = 0, rate = 0, bits = 0;
+    const uint8_t *data = nullptr;
+    size_t dataLen = 0;
+    size_t pos = 12;
+    while (pos + 8 <= file.size()) {
+        const uint8_t *chunk = &file[pos];
+        size_t len = le32(chunk + 4);
+        size_t avail = file.size() - pos - 8;
+        if (len > avail) {
+            len = avail;  // Truncated file: use what is there
+        }
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && len >= 16) {
+            format = le16(chunk + 8);
+            channels = le16(chunk + 10);
+            rate = le32(chunk + 12);
+            bits = le16(chunk + 22);
+            if (format == WAVE_FORMAT_EXTENSIBLE && len >= 26) {
+                format = le16(chunk + 32);  // First two bytes of the subformat GUID
+            }
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            data = chunk + 8;
+            dataLen = len;
+        }
+        pos += 8 + len + (len & 1);
+    }
+
+    bool pcm = (format == WAVE_FORMAT_PCM && (bits == 8 || bits == 16 || bits == 24 || bits == 32));
+    bool flt = (format == WAVE_FORMAT_FLOAT && bits == 32);
+    if (!data || channels == 0 || rate == 0 || !(pcm || flt)) {
+        err = path + ": unsupported WAV format";
+        return false;
+    }
+
+    // Decode to stereo at the file rate (mono is duplicated, extra channels dropped)
+    unsigned bytes = bits / 8;
+    size_t inFrames = dataLen / (bytes * channels);
+    std::vector<float> stereo(inFrames * 2);
+    for (size_t f = 0; f < inFrames; f++) {
+        const uint8_t *p = data + f * bytes * channels;
+        float l = decode_value(p, format, bits);
+        float r = (channels > 1) ? decode_value(p + bytes, format, bits) : l;
+        stereo[2 * f] = l;
+        stereo[2 * f + 1] = r;
+    }
+
+    // Linear resampling to the engine rate
+    Sample &s = samples_[drumId];
+    if (rate == rate_) {
+        s.data.swap(stereo);
+        s.frames = inFrames;
+        return true;
+    }
+    double step = (double)rate / rate_;
+    s.frames = (inFrames > 1) ? (size_t)((inFrames - 1) / step) + 1 : inFrames;
+    s.data.assign(s.frames * 2, 0.0f);
+    for (size_t f = 0; f < s.frames; f++) {
+        double x = f * step;
+        size_t i = (size_t)x;
+        float frac = (float)(x - i);
+        size_t j = (i + 1 < inFrames) ? i + 1 : i;
+        for (int c = 0; c < 2; c++) {
+            s.data[2 * f + c] = stereo[2 * i + c] + frac * (stereo[2 * j + c] - stereo[2 * i + c]);
+        }
+    }
+    return true;
+}
+
+bool SampleBank::loadDefaultKit(const std::string &dir, std::string &err) {
+    for (int d = 0; d < MAX_DRUMS; d++) {
+        if (!load(d, dir + "/" + DEFAULT_KIT[d], err)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const Sample *SampleBank::get(int drumId) const {
+    if (drumId < 0 || drumId >= MAX_DRUMS || samples_[drumId].frames == 0) {
+        return nullptr;
+    }
+    return &samples_[drumId];
+}
+
+}  // namespace drumplay
@@ -0,0 +1,45 @@
+// sample_bank.hpp
+// Drum samples loaded from WAV files, converted for the render thread
+//
+// Every sample is decoded once at start-up (PCM 8/16/24/32-bit or 32-bit
+// float, any channel count), mixed to stereo and resampled to the engine
+// rate, so the render thread only adds floats.
+
+#ifndef SAMPLE_BANK_HPP
+#define SAMPLE_BANK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace drumplay {
+
+// Drum ids as in drum_detection.h (DRUM_SNARE .. DRUM_LOW_TOM)
+static const int MAX_DRUMS = 8;
+
+struct Sample {
+    std::vector<float> data;  // Interleaved stereo
+    size_t frames = 0;
+};
+
+class SampleBank {
+public:
+    explicit SampleBank(unsigned rate) : rate_(rate) {}
+
+    bool load(int drumId, const std::string &path, std::string &err);
+
+    // The default kit of play_sound.py, relative to the SAMPLES directory
+    bool loadDefaultKit(const std::string &dir, std::string &err);
+
+    // nullptr when no sample is loaded for the drum
+    const Sample *get(int drumId) const;
+
+private:
+    unsigned rate_;
+    Sample samples_[MAX_DRUMS];
+};
+
+}  // namespace drumplay
+
+#endif  // SAMPLE_BANK_HPP
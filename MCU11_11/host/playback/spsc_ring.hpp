@@ -0,0 +1,51 @@
+// spsc_ring.hpp
+// Lock-free single-producer single-consumer ring
+//
+// One thread calls push(), one other thread calls pop(); neither blocks or
+// allocates, so the audio render thread can drain it every block. Indices are
+// free-running counters; N must be a power of 2.
+
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+
+namespace drumplay {
+
+template <typename T, size_t N>
+class SpscRing {
+    static_assert((N & (N - 1)) == 0, "SpscRing size must be a power of 2");
+
+public:
+    // Producer: false when the ring is full
+    bool push(const T &item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == N) {
+            return false;
+        }
+        buf_[head & (N - 1)] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: false when the ring is empty
+    bool pop(T &item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = buf_[tail & (N - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T buf_[N];
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
+
+}  // namespace drumplay
+
+#endif  // SPSC_RING_HPP
@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+# ram_map.py
+# Static RAM use per module from the SEGGER linker map file
+#
+# Reads the "Memory use by input file" table of the .map file the Embedded
+# Studio build writes (Output/<config>/Exe/MCU_11_11.map) and prints RAM per
+# object file (initialised RW data + zero-initialised ZI data), largest first.
+# --symbols also lists the largest RAM variables from the section detail, so
+# a module's total can be traced to its buffers.
+#
+# Usage:
+#   python3 ram_map.py ../Output/Debug/Exe/MCU_11_11.map [--symbols 15]
+#   python3 ram_map.py MCU_11_11.map --save ram_base.csv
+#   python3 ram_map.py MCU_11_11.map --compare ram_base.csv [--budget 40000]
+#
+# --compare prints the change per module against a --save file. --budget
+# exits with status 2 when total static RAM exceeds the given bytes, for use
+# as a build gate. The stack and heap are linker blocks, not modules; they
+# are listed from the "Memory use by linker" table as [block 'stack'] and
+# count towards the total, which then matches the map's own RW + ZI total.
+#
+# No third-party packages required.
+
+import argparse
+import csv
+import re
+import sys
+
+NUM = re.compile(r'^\d{1,3}( \d{3})*$')
+
+
+def parse_num(text):
+    text = text.strip()
+    return int(text.replace(' ', '')) if text else 0
+
+
+def column_spans(dashes):
+    # Column extents from the "-----  -----" rule under a table header
+    return [(m.start(), m.end()) for m in re.finditer(r'-+', dashes)]
+
+
+def parse_table(lines, title):
+    # Rows of the table under title as [(name, (code, rodata, rwdata, zidata))],
+    # summary rows included; long names wrap onto their own line
+    rows = []
+    for i, line in enumerate(lines):
+        if line.strip() != title:
+            continue
+        j = i + 1
+        while j < len(lines) and 'ZI Data' not in lines[j]:
+            j += 1
+        if j + 1 >= len(lines) or not lines[j + 1].strip().startswith('---'):
+            break
+        spans = column_spans(lines[j + 1])
+        name_end = spans[0][1]
+        pending = None
+        for row in lines[j + 2:]:
+            if not row.strip():
+                break
+            if row.strip().startswith(('---', '===')):
+                continue
+            if len(row.split()) == 1 and not NUM.match(row.strip()):
+                pending = row.strip()  # May run past the name column
+                continue
+            name = row[:name_end].strip()
+            fields = [row[s:e + 1] if e < len(row) else row[s:] for s, e in spans[1:]]
+            values = [f.strip() for f in fields]
+            if not all(v == '' or NUM.match(v) for v in values):
+                continue
+            if not name and pending:
+                name = pending
+            pending = None
+            rows.append((name, tuple(parse_num(v) for v in values)))
+        break
+    return rows
+
+
+def parse_module_table(lines):
+    # Returns {module: (code, rodata, rwdata, zidata)} for object files,
+    # archives and linker-created blocks (the stack, the heap), and the
+    # map's own (rwdata, zidata) total for a cross-check. The summary rows
+    # (Subtotal, Objects, Archives, Linker created, Total) are not modules.
+    modules = {}
+    total = None
+    for name, values in parse_table(lines, 'Memory use by input file:'):
+        if name.endswith(('.o', '.a')):
+            modules[name] = values
+        elif name.startswith('Total'):
+            total = (values[2], values[3])
+    for name, values in parse_table(lines, 'Memory use by linker:'):
+        if name.startswith('Memory for block'):
+            modules['[' + name[len('Memory for '):] + ']'] = values
+    return modules, total
+
+
+def parse_ram_symbols(lines):
+    # RAM variables (Ac RW or ZI) from the section detail: (size, name, object)
+    symbols = []
+    row = re.compile(r'^\s+(?:[0-9a-f]{8}-[0-9a-f]{8}\s+(\S+))?\s*'
+                     r'(\d{1,3}(?: \d{3})*)\s+\d+\s+(Zero|Init|Data)\s+(RW|ZI)\s+(.+)$')
+    last_name = None
+    for line in lines:
+        head = re.match(r'^\s+[0-9a-f]{8}-[0-9a-f]{8}\s+(\S+)\s*$', line)
+        if head:
+            last_name = head.group(1)  # Size is on the next line
+            continue
+        m = row.match(line)
+        if m:
+            name = m.group(1) or last_name or '?'
+            symbols.append((parse_num(m.group(2)), name, m.group(5).strip()))
+        last_name = None
+    return symbols
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Static RAM per module from a SEGGER .map file')
+    ap.add_argument('map', help='linker map file')
+    ap.add_argument('--symbols', type=int, default=0, metavar='N',
+                    help='also list the N largest RAM variables')
+    ap.add_argument('--save', metavar='CSV', help='write module,rw,zi for --compare')
+    ap.add_argument('--compare', metavar='CSV', help='show the change against a saved report')
+    ap.add_argument('--budget', type=int, metavar='BYTES',
+                    help='exit 2 if total static RAM is above BYTES')
+    args = ap.parse_args()
+
+    with open(args.map, encoding='latin-1') as f:
+        lines = f.read().splitlines()
+
+    modules, map_total = parse_module_table(lines)
+    if not modules:
+        sys.exit('%s: no "Memory use by input file" table found' % args.map)
+
+    ram = {name: v[2] + v[3] for name, v in modules.items()}
+    base = {}
+    if args.compare:
+        with open(args.compare, newline='') as f:
+            for r in csv.DictReader(f):
+                base[r['module']] = int(r['rw']) + int(r['zi'])
+
+    print('%-56s %8s %8s %8s%s' % ('Module', 'RW', 'ZI', 'RAM', '   change' if base else ''))
+    for name in sorted(ram, key=lambda n: (-ram[n], n)):
+        if ram[name] == 0 and name not in base:
+            continue
+        line = '%-56s %8d %8d %8d' % (name[:56], modules[name][2], modules[name][3], ram[name])
+        if base:
+            line += ' %+9d' % (ram[name] - base.get(name, 0))
+        print(line)
+    for name in sorted(set(base) - set(ram)):
+        print('%-56s %8s %8s %8d %+9d' % (name[:56], '-', '-', 0, -base[name]))
+
+    total = sum(ram.values())
+    line = '%-56s %8d %8d %8d' % ('Total', sum(v[2] for v in modules.values()),
+                                   sum(v[3] for v in modules.values()), total)
+    if base:
+        line += ' %+9d' % (total - sum(base.values()))
+    print(line)
+    if map_total is not None and map_total[0] + map_total[1] != total:
+        print('warning: the map\'s total is %d bytes of RAM; some rows were not read'
+              % (map_total[0] + map_total[1]), file=sys.stderr)
+
+    if args.symbols:
+        print()
+        print('Largest RAM variables')
+        for size, name, obj in sorted(parse_ram_symbols(lines), reverse=True)[:args.symbols]:
+            print('  %8d  %-40s %s' % (size, name, obj))
+
+    if args.save:
+        with open(args.save, 'w', newline='') as f:
+            w = csv.writer(f)
+            w.writerow(['module', 'rw', 'zi'])
+            for name in sorted(modules):
+                w.writerow([name, modules[name][2], modules[name][3]])
+
+    if args.budget is not None and total > args.budget:
+        print('FAIL: %d bytes of static RAM, budget %d' % (total, args.budget), file=sys.stderr)
+        sys.exit(2)
+
+
+if __name__ == '__main__':
+    main()
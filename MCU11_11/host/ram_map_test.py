@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+# ram_map_test.py
+# Checks ram_map.py against the map file checked in with the Debug build
+#
+# The module table must hold only object files, archives and linker blocks,
+# and their RW + ZI must add up to the linker's own totals. The summary rows
+# of the three tables (Subtotal, Objects, Archives, Linker created, Total)
+# are not modules.
+#
+# Usage:
+#   python3 ram_map_test.py [../Output/Debug/Exe/MCU_11_11.map]
+#
+# The exit status is 1 on any failure.
+#
+# No third-party packages required.
+
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import ram_map  # noqa: E402
+
+DEFAULT_MAP = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                           '..', 'Output', 'Debug', 'Exe', 'MCU_11_11.map')
+
+failures = 0
+
+
+def check(ok, what):
+    global failures
+    print('  %-52s %s' % (what, 'ok' if ok else 'FAIL'))
+    if not ok:
+        failures += 1
+
+
+def main():
+    path = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_MAP
+    with open(path, encoding='latin-1') as f:
+        lines = f.read().splitlines()
+    print('ram_map.py on %s' % path)
+
+    modules, total = ram_map.parse_module_table(lines)
+    rw = sum(v[2] for v in modules.values())
+    zi = sum(v[3] for v in modules.values())
+
+    check(total is not None, 'map Total row found')
+    check(total is not None and (rw, zi) == total,
+          'RW/ZI sum matches the map (%d/%d vs %s)' % (rw, zi, total))
+    check(all(n.endswith(('.o', '.a')) or n.startswith('[block ') for n in modules),
+          'only objects, archives and linker blocks')
+    check(not any(n.startswith(('Subtotal', 'Objects', 'Archives', 'Linker', 'Total'))
+                  for n in modules), 'no summary rows')
+    check(not any(n.endswith(')') for n in modules), 'archive members not counted twice')
+    check(any(n.startswith('[block ') for n in modules), 'stack block listed')
+
+    # Rows whose name wraps onto its own line
+    archives = [n for n in modules if n.endswith('.a')]
+    check(len(archives) > 0 and all(modules[n][0] > 0 for n in archives),
+          'wrapped archive rows read (%d archives)' % len(archives))
+
+    print('\n%s (%d failures)' % ('FAILED' if failures else 'PASSED', failures))
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,849 @@
+// replay.c
+// Host replay harness for the drum detection pipeline
+//
+// Streams recorded or synthetic sensor sequences through the unmodified
+// firmware sources: each sample is encoded as an SH2 sensor report, decoded
+// by sh2_decodeSensorEvent() (sh2_SensorValue.c) and passed to
+// DrumDetection_ProcessSensorData() (drum_detection.c), exactly as
+// sensorHandler and the main loop do on the board.
+//
+// Prints every detected hit with its timestamp, the host cost of each decode
+// and detection call (p50/p99/max ns), and, given ground-truth labels, the
+// misses, extra hits and wrong drums with precision/recall. The --min-* gates
+// make it usable as an accuracy regression check (exit status 2 on failure).
+//
+// Input trace, one sample per line (either format, lines may be mixed):
+//   CSV:  t_ms,Q,real,i,j,k   t_ms,G,x,y,z (rad/s)   t_ms,A,x,y,z (m/s^2)
+//   RTT:  the "[Q #n]", "[G #n]" and "[A #n]" lines printed by sensorHandler
+//         in main.c (time advances 10 ms per gyro line)
+// Labels, one hit per line: t_ms,DRUM (name such as SNARE, or drum ID)
+// Lines starting with '#' are ignored in both.
+//
+// Build (from this folder):
+//   gcc -std=c99 -O2 -I.. -include host_shim.h -o replay replay.c host_stubs.c ../drum_detection.c ../drum_classifier.c ../drum_calibration.c ../crc32.c ../config_store.c ../stroke_recognizer.c ../onset_detector.c ../yaw_drift.c ../binlog.c ../sh2_SensorValue.c ../sh2_util.c -lm
+//
+// Run:
+//   ./replay trace.csv [--labels labels.csv] [options]
+//   ./replay --synth seconds [--seed n] [--dump prefix] [options]
+//   ./replay --edges strokes [--jitter deg] [--seed n] [options]
+// Options:
+//   --window early late   Match a hit up to early ms before / late ms after a label (100 50)
+//   --min-recall P        Fail if recall is below P percent
+//   --min-precision P     Fail if precision is below P percent
+//   --min-drum P          Fail if matched hits with the right drum are below P percent
+//   --min-stroke TYPE P   Fail if hits recognised as TYPE (NORMAL, GHOST...) are below P percent
+//   --min-edge P          Fail if any zone edge's drum accuracy is below P percent (--edges)
+//   --log                 Print the firmware RTT output to stderr
+//   --quiet               Only print the summary
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include "drum_detection.h"
+#include "stroke_recognizer.h"
+#include "sh2_SensorValue.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define SAMPLE_MS  10  // 100Hz reports
+
+static const char *drumNames[] = {
+    "SNARE", "HIHAT", "KICK", "HIGH_TOM", "MID_TOM", "CRASH", "RIDE", "LOW_TOM"
+};
+#define NUM_DRUMS  (DRUM_LOW_TOM + 1)
+
+// One sensor sample, in sh2_SensorValue_t units
+typedef struct {
+    uint32_t t_ms;
+    char kind;     // 'Q' (real, i, j, k), 'G' (x, y, z), 'A' (x, y, z)
+    float v[4];
+} Sample_t;
+
+typedef struct {
+    uint32_t t_ms;
+    uint8_t drum;
+    int8_t edge;   // zoneEdges[] index of an --edges stroke, -1 otherwise
+} Label_t;
+
+typedef struct {
+    uint32_t t_ms;
+    uint8_t drum;
+    uint8_t stroke;
+} Hit_t;
+
+// Growable arrays
+static Sample_t *samples;
+static int sampleCount, sampleCap;
+static Label_t *labels;
+static int labelCount, labelCap;
+static Hit_t *hits;
+static int hitCount, hitCap;
+
+#define PUSH(arr, count, cap, item) do { \
+        if ((count) == (cap)) { \
+            (cap) = (cap) ? (cap) * 2 : 1024; \
+            (arr) = realloc((arr), (size_t)(cap) * sizeof *(arr)); \
+            if ((arr) == NULL) { perror("realloc"); exit(1); } \
+        } \
+        (arr)[(count)++] = (item); \
+    } while (0)
+
+static void add_sample(uint32_t t_ms, char kind, float a, float b, float c, float d) {
+    Sample_t s = { t_ms, kind, { a, b, c, d } };
+    PUSH(samples, sampleCount, sampleCap, s);
+}
+
+static void add_label(uint32_t t_ms, uint8_t drum, int8_t edge) {
+    Label_t l = { t_ms, drum, edge };
+    PUSH(labels, labelCount, labelCap, l);
+}
+
+static int parse_drum(const char *s) {
+    while (*s == ' ') s++;
+    for (int d = 0; d < NUM_DRUMS; d++) {
+        size_t n = strlen(drumNames[d]);
+        if (strncmp(s, drumNames[d], n) == 0 && (s[n] == '\0' || strchr(" \t\r\n", s[n]))) {
+            return d;
+        }
+    }
+    if (*s >= '0' && *s <= '9') {
+        int d = atoi(s);
+        return d < NUM_DRUMS ? d : -1;
+    }
+    return -1;
+}
+
+// Stroke type by name (STROKE_* or STROKE_UNKNOWN), -1 if not a stroke name
+static int parse_stroke(const char *s) {
+    for (int t = 0; t < STROKE_NUM_TYPES; t++) {
+        if (strcmp(s, StrokeRecognizer_Name((uint8_t)t)) == 0) {
+            return t;
+        }
+    }
+    return strcmp(s, "UNKNOWN") == 0 ? STROKE_UNKNOWN : -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Input
+///////////////////////////////////////////////////////////////////////////////
+
+// Value after "key" in an RTT line (0 if missing)
+static float field(const char *line, const char *key) {
+    const char *p = strstr(line, key);
+    return p ? strtof(p + strlen(key), NULL) : 0.0f;
+}
+
+static int load_trace(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    
+    char line[512];
+    uint32_t rttTime = 0;
+    int lineNo = 0;
+    while (fgets(line, sizeof line, f) != NULL) {
+        lineNo++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+        
+        if (strncmp(line, "[Q #", 4) == 0) {
+            add_sample(rttTime, 'Q', field(line, "r="), field(line, " i="), field(line, " j="), field(line, " k="));
+        } else if (strncmp(line, "[G #", 4) == 0) {
+            rttTime += SAMPLE_MS;
+            add_sample(rttTime, 'G', field(line, "x="), field(line, "y="), field(line, "z="), 0.0f);
+        } else if (strncmp(line, "[A #", 4) == 0) {
+            add_sample(rttTime, 'A', field(line, "x="), field(line, "y="), field(line, "z="), 0.0f);
+        } else {
+            unsigned t;
+            char kind;
+            float v[4] = { 0 };
+            int n = sscanf(line, "%u,%c,%f,%f,%f,%f", &t, &kind, &v[0], &v[1], &v[2], &v[3]);
+            if (n >= 5 && (kind == 'Q' || kind == 'G' || kind == 'A') && (kind != 'Q' || n == 6)) {
+                add_sample(t, kind, v[0], v[1], v[2], v[3]);
+            } else if (n >= 2 && isdigit((unsigned char)line[0])) {
+                fprintf(stderr, "%s:%d: unrecognised sample, skipped\n", path, lineNo);
+            }
+            // Any other RTT output in a log is ignored
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+static int load_labels(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    
+    char line[256];
+    int lineNo = 0;
+    while (fgets(line, sizeof line, f) != NULL) {
+        lineNo++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+        char *comma = strchr(line, ',');
+        int drum = comma ? parse_drum(comma + 1) : -1;
+        if (drum < 0) {
+            fprintf(stderr, "%s:%d: bad label, skipped\n", path, lineNo);
+            continue;
+        }
+        add_label((uint32_t)strtoul(line, NULL, 10), (uint8_t)drum, -1);
+    }
+    fclose(f);
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Synthetic session
+///////////////////////////////////////////////////////////////////////////////
+
+// Impact orientation of each zone-mapped drum (centre of the default zones)
+typedef struct {
+    uint8_t drum;
+    float yaw, pitch;  // Degrees, yaw in the firmware's 0-360 frame
+} SynthTarget_t;
+
+static const SynthTarget_t synthTargets[] = {
+    { DRUM_SNARE,     70.0f,  5.0f },
+    { DRUM_HIGH_TOM,   0.0f, 25.0f },
+    { DRUM_CRASH,      0.0f, 65.0f },
+    { DRUM_MID_TOM,  322.0f, 25.0f },
+    { DRUM_RIDE,     322.0f, 65.0f },
+    { DRUM_LOW_TOM,  250.0f, 10.0f },
+    { DRUM_RIDE,     250.0f, 45.0f },
+};
+#define NUM_SYNTH_TARGETS  (int)(sizeof synthTargets / sizeof synthTargets[0])
+
+#define STICK_RADIUS_M  0.3f  // Hand to stick tip
+#define SWING_SAMPLES   12    // 120 ms downswing
+
+// Edges of the default zone rules (drum_detection.c), for --edges
+// A pitch edge only exists over its yaw span.
+typedef struct {
+    const char *name;
+    char axis;             // 'y' (yaw edge) or 'p' (pitch edge)
+    float value;           // Degrees
+    float yawLo, yawHi;    // Yaw span of a pitch edge
+} ZoneEdge_t;
+
+static const ZoneEdge_t zoneEdges[] = {
+    { "yaw 20 snare|high tom",   'y',  20.0f,   0.0f,   0.0f },
+    { "yaw 120 snare|gap",       'y', 120.0f,   0.0f,   0.0f },
+    { "yaw 200 gap|low tom",     'y', 200.0f,   0.0f,   0.0f },
+    { "yaw 305 low tom|mid tom", 'y', 305.0f,   0.0f,   0.0f },
+    { "yaw 340 mid tom|high tom",'y', 340.0f,   0.0f,   0.0f },
+    { "pitch 50 high tom|crash", 'p',  50.0f, 340.0f,  20.0f },
+    { "pitch 50 mid tom|ride",   'p',  50.0f, 305.0f, 340.0f },
+    { "pitch 30 low tom|ride",   'p',  30.0f, 200.0f, 305.0f },
+};
+#define NUM_ZONE_EDGES  (int)(sizeof zoneEdges / sizeof zoneEdges[0])
+
+#define EDGE_INSIDE_DEG  5.0f  // Strokes aim this far inside an edge
+
+// One planned stroke of an --edges session
+typedef struct {
+    uint8_t drum;
+    float yaw, pitch;      // Impact orientation, jitter included
+    int8_t edge;
+} SynthStroke_t;
+
+static SynthStroke_t *plan;
+static int planCount;
+
+static float frand(float lo, float hi) {
+    return lo + (hi - lo) * (float)rand() / (float)RAND_MAX;
+}
+
+// Normal deviate (Box-Muller)
+static float grand(float sigma) {
+    float u = ((float)rand() + 1.0f) / ((float)RAND_MAX + 2.0f);
+    float v = (float)rand() / (float)RAND_MAX;
+    return sigma * sqrtf(-2.0f * logf(u)) * cosf(2.0f * (float)M_PI * v);
+}
+
+static float wrap180(float deg) {
+    while (deg > 180.0f) deg -= 360.0f;
+    while (deg < -180.0f) deg += 360.0f;
+    return deg;
+}
+
+// Game Rotation Vector for a yaw/pitch orientation with zero roll
+// (inverse of DrumDetection_QuaternionToEuler)
+static void euler_to_quat(float yawDeg, float pitchDeg, float q[4]) {
+    float hy = yawDeg * (float)M_PI / 360.0f;
+    float hp = pitchDeg * (float)M_PI / 360.0f;
+    q[0] = cosf(hp) * cosf(hy);   // real
+    q[1] = -sinf(hp) * sinf(hy);  // i
+    q[2] = sinf(hp) * cosf(hy);   // j
+    q[3] = cosf(hp) * sinf(hy);   // k
+}
+
+// Runs of 4-12 strokes aimed just inside alternating sides of each zone edge,
+// perSide strokes per side, with jitter degrees of spread. The label is the
+// zone of the aim point; sides in the unmapped gap are skipped, since nobody
+// aims there.
+static void build_edge_plan(int perSide, float jitter) {
+    plan = calloc((size_t)(NUM_ZONE_EDGES * 2 * perSide), sizeof *plan);
+    if (plan == NULL) {
+        perror("calloc");
+        exit(1);
+    }
+    planCount = 0;
+    
+    for (int e = 0; e < NUM_ZONE_EDGES; e++) {
+        const ZoneEdge_t *edge = &zoneEdges[e];
+        float aim[2][2];
+        uint8_t drum[2];
+        int sides = 0;
+        for (int side = -1; side <= 1; side += 2) {
+            float yaw, pitch;
+            if (edge->axis == 'y') {
+                yaw = DrumDetection_NormalizeYaw(edge->value + side * EDGE_INSIDE_DEG);
+                pitch = 15.0f;
+            } else {
+                float span = DrumDetection_NormalizeYaw(edge->yawHi - edge->yawLo);
+                yaw = DrumDetection_NormalizeYaw(edge->yawLo + span / 2.0f);
+                pitch = edge->value + side * EDGE_INSIDE_DEG;
+            }
+            uint8_t d = DrumDetection_ClassifyZone(yaw, pitch);
+            if (d != DRUM_NONE) {
+                aim[sides][0] = yaw;
+                aim[sides][1] = pitch;
+                drum[sides++] = d;
+            }
+        }
+        
+        int remaining = perSide * sides;
+        for (int side = 0; remaining > 0; side = (side + 1) % sides) {
+            int run = 4 + rand() % 9;
+            for (int k = 0; k < run && remaining > 0; k++, remaining--) {
+                SynthStroke_t *st = &plan[planCount++];
+                st->drum = drum[side];
+                st->yaw = DrumDetection_NormalizeYaw(aim[side][0] + grand(jitter));
+                st->pitch = aim[side][1] + grand(jitter);
+                st->edge = (int8_t)e;
+            }
+        }
+    }
+}
+
+// Strokes at random drums with smooth moves between them, plus the odd
+// flourish (fast twirl with no impact, must not be detected), or the
+// planned --edges strokes in order
+// Same swing and impact model as onset_harness.c.
+static void build_synth(int seconds) {
+    int total = seconds * 1000 / SAMPLE_MS;
+    float (*orient)[2] = calloc((size_t)total, sizeof *orient);  // yaw, pitch
+    float (*gyro)[3] = calloc((size_t)total, sizeof *gyro);
+    float (*accel)[3] = calloc((size_t)total, sizeof *accel);
+    if (orient == NULL || gyro == NULL || accel == NULL) {
+        perror("calloc");
+        exit(1);
+    }
+    
+    float yaw = synthTargets[0].yaw, pitch = synthTargets[0].pitch;
+    int held = 0;  // Orientation is final up to this sample
+    int i = 50;
+    int planned = 0;
+    
+    for (;;) {
+        i += (int)frand(25.0f, 80.0f);  // 250-800 ms between strokes
+        if (i + 60 >= total || (planCount > 0 && planned == planCount)) {
+            break;
+        }
+        
+        if (planCount == 0 && rand() % 10 == 0) {
+            // Flourish in place
+            int period = (int)frand(30.0f, 50.0f);
+            float amp = frand(5.0f, 12.0f), last = 0.0f;
+            for (int k = 0; k <= period; k++) {
+                int s = i - period / 2 + k;
+                float phase = 2.0f * (float)M_PI * (float)k / (float)period;
+                float w = amp * sinf(phase) * 0.5f * (1.0f - cosf(phase));
+                gyro[s][0] += w;
+                gyro[s][1] += -0.6f * w;
+                accel[s][0] += (w - last) / 0.01f * STICK_RADIUS_M;
+                accel[s][2] += w * w * STICK_RADIUS_M;
+                last = w;
+            }
+            i += 30;
+            continue;
+        }
+        
+        uint8_t drum;
+        int8_t edge = -1;
+        float tYaw, tPitch;
+        if (planCount > 0) {
+            const SynthStroke_t *st = &plan[planned++];
+            drum = st->drum;
+            edge = st->edge;
+            tYaw = st->yaw;
+            tPitch = st->pitch;
+        } else {
+            const SynthTarget_t *tgt = &synthTargets[rand() % NUM_SYNTH_TARGETS];
+            drum = tgt->drum;
+            tYaw = tgt->yaw + frand(-8.0f, 8.0f);
+            tPitch = tgt->pitch + frand(-5.0f, 5.0f);
+        }
+        float peak = frand(3.0f, 12.0f);
+        
+        // Downswing about gyro y, ending on the drum at sample i
+        float w[SWING_SAMPLES + 1];
+        float lift = 0.0f;  // Degrees the stick is raised at swing start
+        for (int k = 0; k <= SWING_SAMPLES; k++) {
+            w[k] = -peak * sinf(0.5f * (float)M_PI * (float)k / (float)SWING_SAMPLES);
+            if (k > 0) lift -= w[k] * SAMPLE_MS * 0.001f * 180.0f / (float)M_PI;
+        }
+        
+        // Move from the last drum to the raised stick above the new one
+        int start = held, end = i - SWING_SAMPLES;
+        float dYaw = wrap180(tYaw - yaw), dPitch = tPitch + lift - pitch;
+        for (int s = start; s < end; s++) {
+            float u = (end - start > 1) ? (float)(s - start) / (float)(end - start - 1) : 1.0f;
+            float e = 0.5f - 0.5f * cosf((float)M_PI * u);
+            float rate = 0.5f * (float)M_PI * sinf((float)M_PI * u) / ((end - start) * SAMPLE_MS * 0.001f);
+            orient[s][0] = yaw + dYaw * e;
+            orient[s][1] = pitch + dPitch * e;
+            gyro[s][2] += dYaw * rate * (float)M_PI / 180.0f;
+            gyro[s][1] += dPitch * rate * (float)M_PI / 180.0f;
+        }
+        
+        float remaining = lift;
+        for (int k = 0; k <= SWING_SAMPLES; k++) {
+            int s = i - SWING_SAMPLES + k;
+            if (k > 0) remaining += w[k] * SAMPLE_MS * 0.001f * 180.0f / (float)M_PI;
+            float dw = -peak * 0.5f * (float)M_PI / (SWING_SAMPLES * 0.01f) *
+                       cosf(0.5f * (float)M_PI * (float)k / (float)SWING_SAMPLES);
+            orient[s][0] = tYaw;
+            orient[s][1] = tPitch + remaining;
+            gyro[s][1] += w[k];
+            accel[s][0] += dw * STICK_RADIUS_M;
+            accel[s][2] += w[k] * w[k] * STICK_RADIUS_M;
+        }
+        
+        // Impact: angular speed collapses, linear acceleration spikes
+        gyro[i + 1][1] += -0.15f * peak;
+        gyro[i + 2][1] += 0.10f * peak;
+        gyro[i + 3][1] += 0.04f * peak;
+        accel[i + 1][0] += 8.0f * peak;
+        accel[i + 2][0] += -2.5f * peak;
+        accel[i + 1][1] += frand(-1.0f, 1.0f) * peak;
+        
+        // Rest on the drum for 100 ms after the impact
+        yaw = tYaw;
+        pitch = tPitch;
+        for (int s = i + 1; s <= i + 10; s++) {
+            orient[s][0] = yaw;
+            orient[s][1] = pitch;
+        }
+        held = i + 11;
+        
+        add_label((uint32_t)((i + 1) * SAMPLE_MS), drum, edge);
+        i += 30;
+    }
+    for (int s = held; s < total; s++) {
+        orient[s][0] = yaw;
+        orient[s][1] = pitch;
+    }
+    
+    // Reports in the order the BNO085 batches them, with sensor noise
+    for (int s = 0; s < total; s++) {
+        uint32_t t = (uint32_t)(s * SAMPLE_MS);
+        float q[4];
+        euler_to_quat(orient[s][0] + frand(-0.3f, 0.3f), orient[s][1] + frand(-0.3f, 0.3f), q);
+        add_sample(t, 'Q', q[0], q[1], q[2], q[3]);
+        add_sample(t, 'G', gyro[s][0] + frand(-0.05f, 0.05f), gyro[s][1] + frand(-0.05f, 0.05f),
+                   gyro[s][2] + frand(-0.05f, 0.05f), 0.0f);
+        add_sample(t, 'A', accel[s][0] + frand(-0.3f, 0.3f), accel[s][1] + frand(-0.3f, 0.3f),
+                   accel[s][2] + frand(-0.3f, 0.3f), 0.0f);
+    }
+    
+    free(orient);
+    free(gyro);
+    free(accel);
+}
+
+static void dump_synth(const char *prefix) {
+    char path[512];
+    snprintf(path, sizeof path, "%s.csv", prefix);
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        perror(path);
+        exit(1);
+    }
+    fprintf(f, "# t_ms,Q,real,i,j,k | t_ms,G,x,y,z | t_ms,A,x,y,z\n");
+    for (int n = 0; n < sampleCount; n++) {
+        const Sample_t *s = &samples[n];
+        if (s->kind == 'Q') {
+            fprintf(f, "%u,Q,%.5f,%.5f,%.5f,%.5f\n", s->t_ms, s->v[0], s->v[1], s->v[2], s->v[3]);
+        } else {
+            fprintf(f, "%u,%c,%.4f,%.4f,%.4f\n", s->t_ms, s->kind, s->v[0], s->v[1], s->v[2]);
+        }
+    }
+    fclose(f);
+    
+    snprintf(path, sizeof path, "%s_labels.csv", prefix);
+    f = fopen(path, "w");
+    if (f == NULL) {
+        perror(path);
+        exit(1);
+    }
+    for (int n = 0; n < labelCount; n++) {
+        fprintf(f, "%u,%s\n", labels[n].t_ms, drumNames[labels[n].drum]);
+    }
+    fclose(f);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Replay
+///////////////////////////////////////////////////////////////////////////////
+
+static void write16(uint8_t *p, float value, float scale) {
+    float raw = roundf(value * scale);
+    if (raw > 32767.0f) raw = 32767.0f;
+    if (raw < -32768.0f) raw = -32768.0f;
+    int16_t v = (int16_t)raw;
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+}
+
+// Build the SH2 input report the BNO085 would send for a sample
+// (fixed point: quaternion Q14, gyro Q9, linear acceleration Q8)
+static void encode_event(const Sample_t *s, uint8_t seq, sh2_SensorEvent_t *ev) {
+    memset(ev, 0, sizeof *ev);
+    ev->timestamp_uS = (uint64_t)s->t_ms * 1000;
+    ev->report[1] = seq;
+    ev->report[2] = 3;  // Status: high accuracy
+    
+    if (s->kind == 'Q') {
+        ev->reportId = SH2_GAME_ROTATION_VECTOR;
+        ev->len = 12;
+        write16(&ev->report[4], s->v[1], 16384.0f);
+        write16(&ev->report[6], s->v[2], 16384.0f);
+        write16(&ev->report[8], s->v[3], 16384.0f);
+        write16(&ev->report[10], s->v[0], 16384.0f);
+    } else {
+        ev->reportId = (s->kind == 'G') ? SH2_GYROSCOPE_CALIBRATED : SH2_LINEAR_ACCELERATION;
+        ev->len = 10;
+        float scale = (s->kind == 'G') ? 512.0f : 256.0f;
+        write16(&ev->report[4], s->v[0], scale);
+        write16(&ev->report[6], s->v[1], scale);
+        write16(&ev->report[8], s->v[2], scale);
+    }
+    ev->report[0] = ev->reportId;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Per-call cost, by report type
+enum { COST_DECODE, COST_DETECT_Q, COST_DETECT_G, COST_DETECT_A, NUM_COSTS };
+static const char *costNames[NUM_COSTS] = {
+    "sh2_decodeSensorEvent", "ProcessSensorData (GRV)", "ProcessSensorData (gyro)", "ProcessSensorData (accel)"
+};
+static uint32_t *costs[NUM_COSTS];
+static int costCount[NUM_COSTS];
+
+static void run_replay(int quiet) {
+    DrumHitState_t state = { 0 };
+    state.lastDrumSound = DRUM_NONE;
+    state.lastStrokeType = STROKE_UNKNOWN;
+    DrumDetection_Init();
+    
+    for (int c = 0; c < NUM_COSTS; c++) {
+        costs[c] = malloc((size_t)(sampleCount ? sampleCount : 1) * sizeof **costs);
+        costCount[c] = 0;
+    }
+    
+    uint8_t seq[3] = { 0 };
+    for (int n = 0; n < sampleCount; n++) {
+        const Sample_t *s = &samples[n];
+        int k = (s->kind == 'Q') ? 0 : (s->kind == 'G') ? 1 : 2;
+        sh2_SensorEvent_t ev;
+        sh2_SensorValue_t value;
+        encode_event(s, seq[k]++, &ev);
+        
+        uint64_t t0 = now_ns();
+        sh2_decodeSensorEvent(&value, &ev);
+        uint64_t t1 = now_ns();
+        uint8_t drumId = DrumDetection_ProcessSensorData(&value, &state);
+        uint64_t t2 = now_ns();
+        
+        costs[COST_DECODE][costCount[COST_DECODE]++] = (uint32_t)(t1 - t0);
+        costs[COST_DETECT_Q + k][costCount[COST_DETECT_Q + k]++] = (uint32_t)(t2 - t1);
+        
+        if (drumId != DRUM_NONE) {
+            Hit_t h = { s->t_ms, drumId, state.lastStrokeType };
+            PUSH(hits, hitCount, hitCap, h);
+            if (!quiet) {
+                printf("HIT %8u ms  %-8s %s\n", h.t_ms, drumNames[drumId], StrokeRecognizer_Name(h.stroke));
+            }
+        }
+    }
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void report_costs(void) {
+    printf("\nPer-call host cost (ns)          calls      p50      p99      max\n");
+    for (int c = 0; c < NUM_COSTS; c++) {
+        int n = costCount[c];
+        if (n == 0) {
+            continue;
+        }
+        qsort(costs[c], (size_t)n, sizeof **costs, cmp_u32);
+        printf("  %-28s %8d %8u %8u %8u\n", costNames[c], n,
+               costs[c][(n - 1) / 2], costs[c][(n * 99 + 99) / 100 - 1], costs[c][n - 1]);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Scoring
+///////////////////////////////////////////////////////////////////////////////
+
+// Strokes at one zone edge: right drum, and flips (a stroke that got a
+// different drum than the edge's previous stroke at the same drum)
+typedef struct {
+    int n, rightDrum, flips;
+} EdgeScore_t;
+
+typedef struct {
+    int matched, rightDrum, missed, extra;
+    EdgeScore_t edges[NUM_ZONE_EDGES];
+} Score_t;
+
+// Tally a labelled --edges stroke and the drum it got (DRUM_NONE if missed)
+static void score_edge(Score_t *sc, const Label_t *lab, uint8_t got) {
+    static int lastDrum[NUM_ZONE_EDGES], lastGot[NUM_ZONE_EDGES];
+    EdgeScore_t *es = &sc->edges[lab->edge];
+    if (es->n == 0) {
+        lastDrum[lab->edge] = -1;
+    }
+    es->n++;
+    es->rightDrum += got == lab->drum;
+    es->flips += lastDrum[lab->edge] == lab->drum && lastGot[lab->edge] != got;
+    lastDrum[lab->edge] = lab->drum;
+    lastGot[lab->edge] = got;
+}
+
+// Pair labels and hits in time order; a hit matches the first unmatched label
+// it falls within [label - early, label + late] of
+static void score(int early, int late, int quiet, Score_t *sc) {
+    char *used = calloc((size_t)(hitCount ? hitCount : 1), 1);
+    memset(sc, 0, sizeof *sc);
+    int first = 0;
+    
+    for (int l = 0; l < labelCount; l++) {
+        const Label_t *lab = &labels[l];
+        while (first < hitCount && hits[first].t_ms + (uint32_t)early < lab->t_ms) {
+            first++;
+        }
+        int match = -1;
+        for (int h = first; h < hitCount && hits[h].t_ms <= lab->t_ms + (uint32_t)late; h++) {
+            if (!used[h]) {
+                match = h;
+                break;
+            }
+        }
+        
+        if (lab->edge >= 0) {
+            score_edge(sc, lab, match < 0 ? DRUM_NONE : hits[match].drum);
+        }
+        if (match < 0) {
+            sc->missed++;
+            if (!quiet) printf("MISS  %8u ms  %-8s\n", lab->t_ms, drumNames[lab->drum]);
+            continue;
+        }
+        used[match] = 1;
+        sc->matched++;
+        if (hits[match].drum == lab->drum) {
+            sc->rightDrum++;
+        } else if (!quiet) {
+            printf("WRONG %8u ms  %-8s got %s at %u ms\n", lab->t_ms, drumNames[lab->drum],
+                   drumNames[hits[match].drum], hits[match].t_ms);
+        }
+    }
+    
+    for (int h = 0; h < hitCount; h++) {
+        if (!used[h]) {
+            sc->extra++;
+            if (!quiet) printf("EXTRA %8u ms  %-8s\n", hits[h].t_ms, drumNames[hits[h].drum]);
+        }
+    }
+    free(used);
+}
+
+static int gate(const char *name, double value, double min) {
+    if (min >= 0.0 && value < min) {
+        printf("GATE FAIL: %s %.1f%% < %.1f%%\n", name, value, min);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *tracePath = NULL, *labelPath = NULL, *dumpPrefix = NULL;
+    int synthSeconds = 0, seed = 1, early = 100, late = 50, quiet = 0;
+    double minRecall = -1.0, minPrecision = -1.0, minDrum = -1.0, minStroke = -1.0, minEdge = -1.0;
+    int gateStroke = -1, edgeStrokes = 0;
+    float jitter = 4.0f;
+    
+    HostStubs_Init();
+    
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--synth") == 0 && a + 1 < argc) {
+            synthSeconds = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--edges") == 0 && a + 1 < argc) {
+            edgeStrokes = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--jitter") == 0 && a + 1 < argc) {
+            jitter = (float)atof(argv[++a]);
+        } else if (strcmp(argv[a], "--seed") == 0 && a + 1 < argc) {
+            seed = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--dump") == 0 && a + 1 < argc) {
+            dumpPrefix = argv[++a];
+        } else if (strcmp(argv[a], "--labels") == 0 && a + 1 < argc) {
+            labelPath = argv[++a];
+        } else if (strcmp(argv[a], "--window") == 0 && a + 2 < argc) {
+            early = atoi(argv[++a]);
+            late = atoi(argv[++a]);
+        } else if (strcmp(argv[a], "--min-recall") == 0 && a + 1 < argc) {
+            minRecall = atof(argv[++a]);
+        } else if (strcmp(argv[a], "--min-precision") == 0 && a + 1 < argc) {
+            minPrecision = atof(argv[++a]);
+        } else if (strcmp(argv[a], "--min-drum") == 0 && a + 1 < argc) {
+            minDrum = atof(argv[++a]);
+        } else if (strcmp(argv[a], "--min-stroke") == 0 && a + 2 < argc) {
+            gateStroke = parse_stroke(argv[++a]);
+            minStroke = atof(argv[++a]);
+            if (gateStroke < 0) {
+                fprintf(stderr, "unknown stroke type %s\n", argv[a - 1]);
+                return 1;
+            }
+        } else if (strcmp(argv[a], "--min-edge") == 0 && a + 1 < argc) {
+            minEdge = atof(argv[++a]);
+        } else if (strcmp(argv[a], "--log") == 0) {
+            HostStubs_SetLog(stderr);
+        } else if (strcmp(argv[a], "--quiet") == 0) {
+            quiet = 1;
+        } else if (argv[a][0] != '-' && tracePath == NULL) {
+            tracePath = argv[a];
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[a]);
+            return 1;
+        }
+    }
+    
+    if (edgeStrokes > 0) {
+        srand((unsigned)seed);
+        build_edge_plan(edgeStrokes, jitter);
+        build_synth(planCount * 11 / 10 + 2);  // At most 1.1 s per stroke
+        printf("Zone edge session (seed %d, %.1f deg jitter): %d samples, %d labelled hits\n",
+               seed, (double)jitter, sampleCount, labelCount);
+        if (dumpPrefix) {
+            dump_synth(dumpPrefix);
+        }
+    } else if (synthSeconds > 0) {
+        srand((unsigned)seed);
+        build_synth(synthSeconds);
+        printf("Synthetic %d s session (seed %d): %d samples, %d labelled hits\n",
+               synthSeconds, seed, sampleCount, labelCount);
+        if (dumpPrefix) {
+            dump_synth(dumpPrefix);
+        }
+    } else if (tracePath != NULL) {
+        if (load_trace(tracePath) != 0 || (labelPath && load_labels(labelPath) != 0)) {
+            return 1;
+        }
+        printf("%s: %d samples", tracePath, sampleCount);
+        if (labelPath) printf(", %d labelled hits", labelCount);
+        printf("\n");
+    } else {
+        fprintf(stderr, "usage: %s trace.csv [--labels labels.csv] | --synth seconds [--seed n] [--dump prefix]\n"
+                        "       | --edges strokes [--jitter deg] [--seed n]\n"
+                        "       [--window early_ms late_ms] [--min-recall P] [--min-precision P] [--min-drum P]\n"
+                        "       [--min-stroke TYPE P] [--min-edge P]\n"
+                        "       [--log] [--quiet]\n", argv[0]);
+        return 1;
+    }
+    
+    run_replay(quiet);
+    report_costs();
+    
+    printf("\n%d hits detected\n", hitCount);
+    int perDrum[NUM_DRUMS] = { 0 };
+    for (int h = 0; h < hitCount; h++) perDrum[hits[h].drum]++;
+    for (int d = 0; d < NUM_DRUMS; d++) {
+        if (perDrum[d]) printf("  %-8s %5d\n", drumNames[d], perDrum[d]);
+    }
+    
+    // Stroke types, STROKE_UNKNOWN counted last
+    int perStroke[STROKE_NUM_TYPES + 1] = { 0 };
+    for (int h = 0; h < hitCount; h++) {
+        perStroke[hits[h].stroke < STROKE_NUM_TYPES ? hits[h].stroke : STROKE_NUM_TYPES]++;
+    }
+    printf("\nStroke types\n");
+    for (int t = 0; t <= STROKE_NUM_TYPES; t++) {
+        if (perStroke[t]) {
+            printf("  %-8s %5d  %5.1f%%\n", StrokeRecognizer_Name(t < STROKE_NUM_TYPES ? (uint8_t)t : STROKE_UNKNOWN),
+                   perStroke[t], 100.0 * perStroke[t] / hitCount);
+        }
+    }
+    
+    int failed = 0;
+    if (gateStroke >= 0) {
+        int n = perStroke[gateStroke < STROKE_NUM_TYPES ? gateStroke : STROKE_NUM_TYPES];
+        char name[32];
+        snprintf(name, sizeof name, "%s strokes", StrokeRecognizer_Name((uint8_t)gateStroke));
+        failed += gate(name, hitCount ? 100.0 * n / hitCount : 0.0, minStroke);
+    }
+    
+    if (labelCount == 0) {
+        return failed ? 2 : 0;
+    }
+    
+    Score_t sc;
+    score(early, late, quiet, &sc);
+    double recall = 100.0 * sc.matched / labelCount;
+    double precision = hitCount ? 100.0 * sc.matched / hitCount : 0.0;
+    double drumAcc = sc.matched ? 100.0 * sc.rightDrum / sc.matched : 0.0;
+    printf("\nvs %d labels (window -%d/+%d ms): %d matched, %d missed, %d extra, %d wrong drum\n",
+           labelCount, early, late, sc.matched, sc.missed, sc.extra, sc.matched - sc.rightDrum);
+    printf("precision %.1f%%  recall %.1f%%  drum accuracy %.1f%%\n", precision, recall, drumAcc);
+    
+    failed += gate("recall", recall, minRecall) + gate("precision", precision, minPrecision) +
+              gate("drum accuracy", drumAcc, minDrum);
+    
+    // Zone edges (--edges sessions), with DRUM_ZONE_HYSTERESIS as built
+    if (edgeStrokes > 0) {
+        printf("\n%-32s %7s %9s %6s\n",
+               DRUM_ZONE_HYSTERESIS ? "Zone edges (hysteresis on)" : "Zone edges (hysteresis off)",
+               "strokes", "drum acc", "flips");
+        for (int e = 0; e < NUM_ZONE_EDGES; e++) {
+            const EdgeScore_t *es = &sc.edges[e];
+            if (es->n == 0) {
+                continue;
+            }
+            double acc = 100.0 * es->rightDrum / es->n;
+            printf("  %-30s %7d %8.1f%% %6d\n", zoneEdges[e].name, es->n, acc, es->flips);
+            failed += gate(zoneEdges[e].name, acc, minEdge);
+        }
+    }
+    return failed ? 2 : 0;
+}
@@ -0,0 +1,438 @@
+// serial_link_test.c
+// Host test of the serial link frame codec (serial_link.c, host/drumlink.py)
+//
+// Builds the unmodified serial_link.c against RAM stand-ins for USART2, DMA1,
+// RCC and GPIOA. Frames queued with SerialLink_Send() are taken from the
+// transmit ring one DMA run at a time, and received bytes are put in the
+// circular receive buffer for SerialLink_Service(), so both directions run
+// the firmware's COBS and CRC32 code. Payloads cover zero runs, 254-byte
+// COBS blocks and the largest payload. Damaged streams check that a bad CRC,
+// a truncated frame, a receiver joining mid-frame and an over-long frame are
+// each counted once and that the next frame decodes.
+//
+// The same frames then go through drumlink.py: the Python encoder must
+// produce the firmware's bytes, and its FrameReader must decode the C stream,
+// damaged parts included, to the frames and bad count the firmware saw.
+//
+// Build and run (from this folder):
+//   gcc -std=c99 -O2 -Wall -I.. -o serial_link_test serial_link_test.c ../crc32.c
+//   ./serial_link_test [--no-python]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Register blocks serial_link.c programs, in RAM instead of at their addresses
+#include "STM32L432KC_USART.h"
+#include "STM32L432KC_DMA.h"
+#include "STM32L432KC_RCC.h"
+#include "STM32L432KC_TIMER.h"
+
+static USART_TypeDef hostUsart2;
+static DMA_TypeDef hostDma1;
+static RCC_TypeDef hostRcc;
+static GPIO_TypeDef hostGpioa;
+
+#undef USART2
+#undef DMA1
+#undef RCC
+#undef GPIOA
+#define USART2  (&hostUsart2)
+#define DMA1    (&hostDma1)
+#define RCC     (&hostRcc)
+#define GPIOA   (&hostGpioa)
+
+// No interrupts on the host: the sensor mask is a no-op
+#define IRQ_PRIORITY_H
+static inline uint32_t irq_mask_sensor(void) { return 0; }
+static inline void irq_unmask(uint32_t basepri) { (void)basepri; }
+
+// The DMA address registers are 32 bits; the test reads the rings directly
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpointer-to-int-cast"
+#include "../serial_link.c"
+#pragma GCC diagnostic pop
+
+void DMA1_Enable(void) {}
+void DMA1_SelectRequest(uint8_t channel, uint8_t request) { (void)channel; (void)request; }
+void NVIC_EnableIRQ(uint8_t irqn) { (void)irqn; }
+uint32_t RCC_GetSysclkHz(void) { return 80000000UL; }
+void RTT_PrintStr(const char *str) { (void)str; }
+void RTT_PrintInt(int32_t num) { (void)num; }
+void RTT_PrintNewline(void) {}
+
+#define MAX_FRAMES  64
+#define WIRE_LEN    65536
+
+typedef struct {
+    const char *name;
+    uint8_t type;
+    uint8_t seq;
+    uint16_t len;
+    uint8_t payload[LINK_MAX_PAYLOAD];
+} Frame_t;
+
+static Frame_t cases[MAX_FRAMES];
+static int caseCount;
+
+// Frames the firmware handler received
+static Frame_t received[MAX_FRAMES];
+static int receivedCount;
+
+static int failures;
+
+static void check(bool ok, const char *what) {
+    printf("  %-52s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) failures++;
+}
+
+static void on_frame(uint8_t type, uint8_t seq, const uint8_t *payload, uint16_t len) {
+    if (receivedCount >= MAX_FRAMES) return;
+    Frame_t *f = &received[receivedCount++];
+    f->type = type;
+    f->seq = seq;
+    f->len = len;
+    memcpy(f->payload, payload, len);
+}
+
+static bool same_frame(const Frame_t *a, const Frame_t *b) {
+    return a->type == b->type && a->seq == b->seq && a->len == b->len &&
+           memcmp(a->payload, b->payload, a->len) == 0;
+}
+
+// Run the transmit DMA to completion, appending what it sends to out
+static uint32_t drain_tx(uint8_t *out) {
+    uint32_t n = 0;
+    while (txInFlight != 0) {
+        uint32_t start = txTail & TX_MASK;
+        memcpy(out + n, &txRing[start], txInFlight);
+        n += txInFlight;
+        DMA1_Channel7_IRQHandler();
+    }
+    return n;
+}
+
+// Deliver bytes through the circular receive DMA buffer, servicing it
+// before it can overrun
+static void feed_rx(const uint8_t *data, uint32_t len) {
+    static uint32_t dmaPos = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        rxDma[dmaPos] = data[i];
+        dmaPos = (dmaPos + 1) & RX_MASK;
+        RX_DMA->CNDTR = SERIAL_LINK_RX_DMA_LEN - dmaPos;
+        if ((i & 0xFF) == 0xFF || i + 1 == len) {
+            SerialLink_Service();
+        }
+    }
+}
+
+// Encode one frame with the firmware, appending its bytes to out
+static uint32_t encode(const Frame_t *f, uint8_t *out) {
+    if (!SerialLink_Send(f->type, f->seq, f->payload, f->len)) {
+        return 0;
+    }
+    return drain_tx(out);
+}
+
+static uint32_t lcg = 12345;
+
+static uint8_t next_random(void) {
+    lcg = lcg * 1103515245u + 12345u;
+    return (uint8_t)(lcg >> 16);
+}
+
+static Frame_t *add_case(const char *name, uint8_t type, uint8_t seq, uint16_t len) {
+    Frame_t *f = &cases[caseCount++];
+    f->name = name;
+    f->type = type;
+    f->seq = seq;
+    f->len = len;
+    memset(f->payload, 0, sizeof f->payload);
+    return f;
+}
+
+static void fill_nonzero(Frame_t *f) {
+    for (uint16_t i = 0; i < f->len; i++) {
+        f->payload[i] = (uint8_t)(1 + i % 255);
+    }
+}
+
+static void make_cases(void) {
+    Frame_t *f;
+    
+    add_case("empty payload", LINK_CMD_GET_KIT, 1, 0);
+    f = add_case("ping", LINK_CMD_PING, 0x22, 4);
+    memcpy(f->payload, "drum", 4);
+    add_case("zero run (300 zeros, seq 0)", LINK_EV_TELEMETRY, 0, 300);
+    f = add_case("254-byte block less 4", LINK_CMD_PING | LINK_REPLY, 2, 250);
+    fill_nonzero(f);
+    f = add_case("254-byte block less 1", LINK_CMD_PING | LINK_REPLY, 3, 253);
+    fill_nonzero(f);
+    f = add_case("254-byte block", LINK_CMD_PING | LINK_REPLY, 4, 254);
+    fill_nonzero(f);
+    f = add_case("254-byte block plus 1", LINK_CMD_PING | LINK_REPLY, 5, 255);
+    fill_nonzero(f);
+    f = add_case("two 254-byte blocks", LINK_CMD_PING | LINK_REPLY, 6, 508);
+    fill_nonzero(f);
+    f = add_case("zeros at block edges", LINK_EV_SENSOR, 7, 600);
+    fill_nonzero(f);
+    f->payload[251] = f->payload[252] = f->payload[253] = 0;
+    f->payload[505] = f->payload[506] = 0;
+    f = add_case("all 0xFF", LINK_EV_HIT, 8, 254);
+    memset(f->payload, 0xFF, f->len);
+    f = add_case("largest payload, no zeros", LINK_CMD_SET_ZONE_MAP, 9, LINK_MAX_PAYLOAD);
+    fill_nonzero(f);
+    f = add_case("largest payload, random", LINK_EV_CAPTURE, 10, LINK_MAX_PAYLOAD);
+    for (uint16_t i = 0; i < f->len; i++) {
+        f->payload[i] = next_random();
+    }
+}
+
+static uint8_t goodWire[WIRE_LEN];
+static uint32_t goodLen;
+static uint32_t frameStart[MAX_FRAMES];
+static uint32_t frameLen[MAX_FRAMES];
+
+// Encode every case with the firmware and decode it back
+static void run_round_trip(void) {
+    char what[96];
+    
+    printf("C encoder -> C decoder\n");
+    goodLen = 0;
+    for (int c = 0; c < caseCount; c++) {
+        uint32_t n = encode(&cases[c], goodWire + goodLen);
+        frameStart[c] = goodLen;
+        frameLen[c] = n;
+    
+        bool delimitedOnce = n > 0 && goodWire[goodLen + n - 1] == 0x00 &&
+                             memchr(goodWire + goodLen, 0x00, n - 1) == NULL;
+        bool bounded = n <= LINK_COBS_MAX(LINK_HDR_LEN + cases[c].len + LINK_CRC_LEN);
+    
+        receivedCount = 0;
+        uint32_t bad = rxBadFrames;
+        feed_rx(goodWire + goodLen, n);
+        goodLen += n;
+    
+        snprintf(what, sizeof what, "%s (%u bytes on the wire)", cases[c].name, (unsigned)n);
+        check(delimitedOnce && bounded && receivedCount == 1 && rxBadFrames == bad &&
+              same_frame(&received[0], &cases[c]), what);
+    }
+}
+
+// Damaged streams built from the encoded cases, appended to wire
+static uint32_t damagedLen;
+static uint32_t damagedBad;
+static int damagedFrames;
+static Frame_t damagedExpect[MAX_FRAMES];
+
+static uint32_t put(uint8_t *wire, uint32_t n, const uint8_t *data, uint32_t len) {
+    memcpy(wire + n, data, len);
+    return n + len;
+}
+
+// Feed one damaged stream and check it costs exactly the expected frames
+static void check_damaged(const char *what, const uint8_t *data, uint32_t len,
+                          uint32_t badFrames, int goodFrames, int lastCase) {
+    receivedCount = 0;
+    uint32_t bad = rxBadFrames;
+    feed_rx(data, len);
+    check(rxBadFrames - bad == badFrames && receivedCount == goodFrames &&
+          same_frame(&received[goodFrames - 1], &cases[lastCase]), what);
+}
+
+static void run_damaged(uint8_t *wire) {
+    uint8_t buf[4096];
+    uint32_t n;
+    const int ping = 1, zeros = 2, block = 5, large = 11;
+    
+    printf("Damaged streams (C decoder)\n");
+    damagedLen = 0;
+    damagedBad = 0;
+    damagedFrames = 0;
+    
+    // Bad CRC: change the seq byte (the ping's first block has no zeros)
+    n = put(buf, 0, goodWire + frameStart[ping], frameLen[ping]);
+    buf[2] ^= 0x40;
+    n = put(buf, n, goodWire + frameStart[block], frameLen[block]);
+    check_damaged("bad CRC dropped, next frame decodes", buf, n, 1, 1, block);
+    damagedLen = put(wire, damagedLen, buf, n);
+    damagedExpect[damagedFrames++] = cases[block];
+    damagedBad++;
+    
+    // Truncated frame, its delimiter still received
+    n = put(buf, 0, goodWire + frameStart[large], frameLen[large] / 2);
+    buf[n++] = 0x00;
+    n = put(buf, n, goodWire + frameStart[zeros], frameLen[zeros]);
+    check_damaged("truncated frame dropped, next frame decodes", buf, n, 1, 1, zeros);
+    damagedLen = put(wire, damagedLen, buf, n);
+    damagedExpect[damagedFrames++] = cases[zeros];
+    damagedBad++;
+    
+    // Receiver joins mid-frame
+    n = put(buf, 0, goodWire + frameStart[large] + frameLen[large] / 3,
+            frameLen[large] - frameLen[large] / 3);
+    n = put(buf, n, goodWire + frameStart[ping], frameLen[ping]);
+    check_damaged("joined mid-frame, next frame decodes", buf, n, 1, 1, ping);
+    damagedLen = put(wire, damagedLen, buf, n);
+    damagedExpect[damagedFrames++] = cases[ping];
+    damagedBad++;
+    
+    // Truncated frame that lost its delimiter: it runs into the next frame,
+    // and only the one after that survives
+    n = put(buf, 0, goodWire + frameStart[block], frameLen[block] / 2);
+    n = put(buf, n, goodWire + frameStart[ping], frameLen[ping]);
+    n = put(buf, n, goodWire + frameStart[zeros], frameLen[zeros]);
+    check_damaged("lost delimiter costs one frame, then resyncs", buf, n, 1, 1, zeros);
+    damagedLen = put(wire, damagedLen, buf, n);
+    damagedExpect[damagedFrames++] = cases[zeros];
+    damagedBad++;
+    
+    // Over-long frame (zero bytes beyond LINK_MAX_RAW) is discarded
+    memset(buf, 0x01, LINK_MAX_RAW + 100);
+    n = LINK_MAX_RAW + 100;
+    buf[n++] = 0x00;
+    n = put(buf, n, goodWire + frameStart[ping], frameLen[ping]);
+    check_damaged("over-long frame dropped, next frame decodes", buf, n, 1, 1, ping);
+    damagedLen = put(wire, damagedLen, buf, n);
+    damagedExpect[damagedFrames++] = cases[ping];
+    damagedBad++;
+    
+    // Idle delimiters between frames are not frames
+    n = 0;
+    buf[n++] = 0x00;
+    buf[n++] = 0x00;
+    n = put(buf, n, goodWire + frameStart[block], frameLen[block]);
+    buf[n++] = 0x00;
+    check_damaged("idle delimiters ignored", buf, n, 0, 1, block);
+    damagedLen = put(wire, damagedLen, buf, n);
+    damagedExpect[damagedFrames++] = cases[block];
+}
+
+// drumlink.py half: encode the cases and decode the firmware's stream
+static const char *pythonScript =
+    "import struct, sys\n"
+    "sys.path.insert(0, sys.argv[1])\n"
+    "import drumlink\n"
+    "data = open(sys.argv[2], 'rb').read()\n"
+    "i = 0\n"
+    "with open(sys.argv[4], 'wb') as f:\n"
+    "    while i < len(data):\n"
+    "        t, s, n = struct.unpack_from('<BBH', data, i)\n"
+    "        f.write(drumlink.build_frame(t, s, data[i + 4:i + 4 + n]))\n"
+    "        i += 4 + n\n"
+    "reader = drumlink.FrameReader()\n"
+    "frames = reader.feed(open(sys.argv[3], 'rb').read())\n"
+    "with open(sys.argv[5], 'wb') as f:\n"
+    "    f.write(struct.pack('<HH', len(frames), reader.bad))\n"
+    "    for t, s, p in frames:\n"
+    "        f.write(struct.pack('<BBH', t, s, len(p)) + p)\n";
+
+static uint8_t *read_file(const char *path, uint32_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) return NULL;
+    uint8_t *data = malloc(WIRE_LEN * 2);
+    *len = (uint32_t)fread(data, 1, WIRE_LEN * 2, f);
+    fclose(f);
+    return data;
+}
+
+static void run_python(const uint8_t *wire, uint32_t wireLen) {
+    const char *casesPath = "serial_link_test_cases.bin";
+    const char *cWirePath = "serial_link_test_c.bin";
+    const char *pyWirePath = "serial_link_test_py.bin";
+    const char *decodedPath = "serial_link_test_decoded.bin";
+    const char *scriptPath = "serial_link_test_check.py";
+    char cmd[512];
+    
+    printf("drumlink.py\n");
+    FILE *f = fopen(casesPath, "wb");
+    for (int c = 0; c < caseCount; c++) {
+        uint8_t hdr[4] = { cases[c].type, cases[c].seq, (uint8_t)cases[c].len, (uint8_t)(cases[c].len >> 8) };
+        fwrite(hdr, 1, 4, f);
+        fwrite(cases[c].payload, 1, cases[c].len, f);
+    }
+    fclose(f);
+    f = fopen(cWirePath, "wb");
+    fwrite(wire, 1, wireLen, f);
+    fclose(f);
+    f = fopen(scriptPath, "w");
+    fputs(pythonScript, f);
+    fclose(f);
+    
+    snprintf(cmd, sizeof cmd, "python3 %s . %s %s %s %s", scriptPath, casesPath, cWirePath,
+             pyWirePath, decodedPath);
+    int status = system(cmd);
+    check(status == 0, "drumlink.py ran");
+    
+    uint32_t pyLen = 0, decodedLen = 0;
+    uint8_t *pyWire = (status == 0) ? read_file(pyWirePath, &pyLen) : NULL;
+    uint8_t *decoded = (status == 0) ? read_file(decodedPath, &decodedLen) : NULL;
+    
+    // Python encoder: same bytes, and the firmware decodes them
+    check(pyWire != NULL && pyLen == goodLen && memcmp(pyWire, goodWire, goodLen) == 0,
+          "build_frame() bytes match the firmware's");
+    if (pyWire != NULL) {
+        receivedCount = 0;
+        uint32_t bad = rxBadFrames;
+        feed_rx(pyWire, pyLen);
+        bool all = receivedCount == caseCount && rxBadFrames == bad;
+        for (int c = 0; all && c < caseCount; c++) {
+            all = same_frame(&received[c], &cases[c]);
+        }
+        check(all, "firmware decodes every build_frame() frame");
+    }
+    
+    // Python decoder on the firmware stream, good frames then damaged
+    bool frames = false, badCount = false;
+    if (decoded != NULL && decodedLen >= 4) {
+        int count = decoded[0] | (decoded[1] << 8);
+        int bad = decoded[2] | (decoded[3] << 8);
+        badCount = (uint32_t)bad == damagedBad;
+        frames = count == caseCount + damagedFrames;
+        uint32_t i = 4;
+        for (int k = 0; frames && k < count; k++) {
+            const Frame_t *want = (k < caseCount) ? &cases[k] : &damagedExpect[k - caseCount];
+            Frame_t got;
+            got.type = decoded[i];
+            got.seq = decoded[i + 1];
+            got.len = decoded[i + 2] | (decoded[i + 3] << 8);
+            memcpy(got.payload, decoded + i + 4, got.len);
+            i += 4 + got.len;
+            frames = same_frame(&got, want);
+        }
+    }
+    check(frames, "FrameReader decodes the firmware's frames");
+    check(badCount, "FrameReader counts the damaged frames as bad");
+    
+    free(pyWire);
+    free(decoded);
+    remove(casesPath);
+    remove(cWirePath);
+    remove(pyWirePath);
+    remove(decodedPath);
+    remove(scriptPath);
+}
+
+int main(int argc, char **argv) {
+    static uint8_t wire[WIRE_LEN * 2];
+    bool python = !(argc > 1 && strcmp(argv[1], "--no-python") == 0);
+    
+    SerialLink_Init(on_frame, NULL);
+    make_cases();
+    
+    run_round_trip();
+    run_damaged(wire);
+    
+    // Python sees the good frames first, then the damaged streams
+    memmove(wire + goodLen, wire, damagedLen);
+    memcpy(wire, goodWire, goodLen);
+    
+    if (python) {
+        run_python(wire, goodLen + damagedLen);
+    }
+    
+    printf("\n%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,268 @@
+// session_file.cpp
+// Memory-mapped reader and appending writer for .dses sessions
+
+#include "session_file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace drumsession {
+
+static_assert(sizeof(SessionHeader_t) == 64, "SessionHeader_t layout");
+static_assert(sizeof(SessionChunk_t) == SESSION_ALIGN, "SessionChunk_t layout");
+static_assert(sizeof(SessionIndexEntry_t) == 40, "SessionIndexEntry_t layout");
+static_assert(sizeof(Quat) == 16 && sizeof(Vec3) == 12, "column element layout");
+
+static const size_t COL_ELEM[SESSION_NUM_COLS] = {
+    sizeof(int64_t), sizeof(Quat), sizeof(Vec3), sizeof(Vec3), sizeof(uint8_t)
+};
+
+static uint64_t align_up(uint64_t n) {
+    return (n + SESSION_ALIGN - 1) & ~(uint64_t)(SESSION_ALIGN - 1);
+}
+
+uint64_t chunkLayout(uint32_t rows, uint32_t colOffset[SESSION_NUM_COLS]) {
+    uint64_t pos = sizeof(SessionChunk_t);
+    for (int c = 0; c < SESSION_NUM_COLS; c++) {
+        colOffset[c] = (uint32_t)pos;
+        pos = align_up(pos + (uint64_t)rows * COL_ELEM[c]);
+    }
+    return pos;
+}
+
+// ---- Reader ----
+
+bool SessionReader::open(const std::string &path, std::string &err) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        err = path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || (size_t)st.st_size < sizeof(SessionHeader_t)) {
+        err = path + ": not a session file";
+        close();
+        return false;
+    }
+    size_ = (size_t)st.st_size;
+    void *m = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (m == MAP_FAILED) {
+        err = path + ": mmap: " + std::strerror(errno);
+        close();
+        return false;
+    }
+    map_ = static_cast<const uint8_t *>(m);
+    header_ = reinterpret_cast<const SessionHeader_t *>(map_);
+
+    if (header_->magic != SESSION_MAGIC || header_->version != SESSION_VERSION || header_->chunkRows == 0) {
+        err = path + ": not a version " + std::to_string(SESSION_VERSION) + " session file";
+        close();
+        return false;
+    }
+    bool ok = (header_->indexOffset != 0) ? load_index(err) : walk_chunks(err);
+    if (!ok) {
+        err = path + ": " + err;
+        close();
+        return false;
+    }
+    rows_ = 0;
+    for (const SessionIndexEntry_t &e : index_) {
+        rows_ += e.rows;
+    }
+    return true;
+}
+
+void SessionReader::close() {
+    if (map_) {
+        munmap(const_cast<uint8_t *>(map_), size_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+    map_ = nullptr;
+    header_ = nullptr;
+    size_ = 0;
+    index_.clear();
+    rows_ = 0;
+}
+
+bool SessionReader::load_index(std::string &err) {
+    uint64_t bytes = (uint64_t)header_->chunkCount * sizeof(SessionIndexEntry_t);
+    if (header_->indexOffset > size_ || bytes > size_ - header_->indexOffset) {
+        err = "index past the end of the file";
+        return false;
+    }
+    index_.resize(header_->chunkCount);
+    std::memcpy(index_.data(), map_ + header_->indexOffset, bytes);
+    for (const SessionIndexEntry_t &e : index_) {
+        uint32_t col[SESSION_NUM_COLS];
+        if (e.offset > size_ || chunkLayout(e.rows, col) > size_ - e.offset) {
+            err = "chunk past the end of the file";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Unfinished session: rebuild the index from the chunk headers
+bool SessionReader::walk_chunks(std::string &err) {
+    uint64_t pos = align_up(sizeof(SessionHeader_t));
+    while (pos + sizeof(SessionChunk_t) <= size_) {
+        const SessionChunk_t *ch = reinterpret_cast<const SessionChunk_t *>(map_ + pos);
+        uint32_t col[SESSION_NUM_COLS];
+        if (ch->magic != SESSION_CHUNK_MAGIC || ch->size != chunkLayout(ch->rows, col) ||
+            ch->size > size_ - pos) {
+            break;  // Torn write at the end: keep what is complete
+        }
+        index_.push_back({pos, ch->firstRow, ch->tFirstUs, ch->tLastUs, ch->rows, 0});
+        pos += ch->size;
+    }
+    (void)err;
+    return true;
+}
+
+void SessionReader::adviseSequential() {
+    madvise(const_cast<uint8_t *>(map_), size_, MADV_SEQUENTIAL);
+}
+
+void SessionReader::adviseRandom() {
+    madvise(const_cast<uint8_t *>(map_), size_, MADV_RANDOM);
+}
+
+ChunkView SessionReader::chunk(size_t c) const {
+    const SessionIndexEntry_t &e = index_[c];
+    const uint8_t *base = map_ + e.offset;
+    uint32_t col[SESSION_NUM_COLS];
+    chunkLayout(e.rows, col);
+
+    ChunkView v;
+    v.firstRow = e.firstRow;
+    v.rows = e.rows;
+    v.t = {reinterpret_cast<const int64_t *>(base + col[SESSION_COL_TIME]), e.rows};
+    v.quat = {reinterpret_cast<const Quat *>(base + col[SESSION_COL_QUAT]), e.rows};
+    v.gyro = {reinterpret_cast<const Vec3 *>(base + col[SESSION_COL_GYRO]), e.rows};
+    v.accel = {reinterpret_cast<const Vec3 *>(base + col[SESSION_COL_ACCEL]), e.rows};
+    v.label = {base + col[SESSION_COL_LABEL], e.rows};
+    return v;
+}
+
+size_t SessionReader::chunkOfRow(uint64_t r) const {
+    auto it = std::upper_bound(index_.begin(), index_.end(), r,
+                               [](uint64_t row, const SessionIndexEntry_t &e) { return row < e.firstRow; });
+    return (size_t)(it - index_.begin()) - 1;
+}
+
+size_t SessionReader::chunkAtTime(int64_t tUs) const {
+    auto it = std::lower_bound(index_.begin(), index_.end(), tUs,
+                               [](const SessionIndexEntry_t &e, int64_t t) { return e.tLastUs < t; });
+    return (size_t)(it - index_.begin());
+}
+
+// ---- Writer ----
+
+bool SessionWriter::open(const std::string &path, uint32_t chunkRows, std::string &err) {
+    if (chunkRows == 0) {
+        err = "chunk rows must be positive";
+        return false;
+    }
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        err = path + ": " + std::strerror(errno);
+        return false;
+    }
+    chunkRows_ = chunkRows;
+    pending_.reserve(chunkRows);
+
+    SessionHeader_t h;
+    std::memset(&h, 0, sizeof(h));
+    h.magic = SESSION_MAGIC;
+    h.version = SESSION_VERSION;
+    h.headerSize = sizeof(h);
+    h.chunkRows = chunkRows;
+    uint8_t pad[SESSION_ALIGN] = {0};
+    std::fwrite(&h, sizeof(h), 1, file_);
+    std::fwrite(pad, align_up(sizeof(h)) - sizeof(h), 1, file_);
+    offset_ = align_up(sizeof(h));
+    return !std::ferror(file_);
+}
+
+bool SessionWriter::append(const SessionRow &row) {
+    pending_.push_back(row);
+    return (pending_.size() < chunkRows_) || write_chunk();
+}
+
+// Transpose the pending rows into columns and write them as one chunk
+bool SessionWriter::write_chunk() {
+    uint32_t rows = (uint32_t)pending_.size();
+    if (rows == 0) {
+        return true;
+    }
+
+    SessionChunk_t ch;
+    std::memset(&ch, 0, sizeof(ch));
+    ch.magic = SESSION_CHUNK_MAGIC;
+    ch.rows = rows;
+    ch.firstRow = firstRow_;
+    ch.size = chunkLayout(rows, ch.colOffset);
+    ch.tFirstUs = pending_.front().tUs;
+    ch.tLastUs = pending_.back().tUs;
+
+    buf_.assign(ch.size, 0);
+    std::memcpy(buf_.data(), &ch, sizeof(ch));
+    uint8_t *col[SESSION_NUM_COLS];
+    for (int c = 0; c < SESSION_NUM_COLS; c++) {
+        col[c] = buf_.data() + ch.colOffset[c];
+    }
+    for (uint32_t i = 0; i < rows; i++) {
+        const SessionRow &r = pending_[i];
+        std::memcpy(col[SESSION_COL_TIME] + i * sizeof(int64_t), &r.tUs, sizeof(int64_t));
+        std::memcpy(col[SESSION_COL_QUAT] + i * sizeof(Quat), &r.quat, sizeof(Quat));
+        std::memcpy(col[SESSION_COL_GYRO] + i * sizeof(Vec3), &r.gyro, sizeof(Vec3));
+        std::memcpy(col[SESSION_COL_ACCEL] + i * sizeof(Vec3), &r.accel, sizeof(Vec3));
+        col[SESSION_COL_LABEL][i] = r.label;
+    }
+    if (std::fwrite(buf_.data(), ch.size, 1, file_) != 1) {
+        return false;
+    }
+    std::fflush(file_);
+
+    index_.push_back({offset_, firstRow_, ch.tFirstUs, ch.tLastUs, rows, 0});
+    offset_ += ch.size;
+    firstRow_ += rows;
+    pending_.clear();
+    return true;
+}
+
+bool SessionWriter::close() {
+    if (!file_) {
+        return true;
+    }
+    bool ok = write_chunk();
+
+    SessionHeader_t h;
+    std::memset(&h, 0, sizeof(h));
+    h.magic = SESSION_MAGIC;
+    h.version = SESSION_VERSION;
+    h.headerSize = sizeof(h);
+    h.chunkRows = chunkRows_;
+    h.chunkCount = (uint32_t)index_.size();
+    h.rowCount = firstRow_;
+    h.indexOffset = offset_;
+    h.tFirstUs = index_.empty() ? 0 : index_.front().tFirstUs;
+    h.tLastUs = index_.empty() ? 0 : index_.back().tLastUs;
+
+    ok = ok && std::fwrite(index_.data(), sizeof(SessionIndexEntry_t), index_.size(), file_) == index_.size();
+    ok = ok && std::fseek(file_, 0, SEEK_SET) == 0 && std::fwrite(&h, sizeof(h), 1, file_) == 1;
+    ok = (std::fclose(file_) == 0) && ok;
+    file_ = nullptr;
+    return ok;
+}
+
+}  // namespace drumsession
@@ -0,0 +1,148 @@
+// session_file.hpp
+// Memory-mapped reader and appending writer for .dses sessions
+//
+// SessionReader maps the whole file read-only and parses only the header and
+// the chunk index, so opening does not depend on the session's size. Each
+// chunk's columns come back as Span views straight into the mapping: no
+// copy, and the kernel pages in only what a scan touches.
+//
+//   drumsession::SessionReader r;
+//   r.open("session.dses", err);
+//   for (size_t c = 0; c < r.chunkCount(); c++) {
+//       drumsession::ChunkView v = r.chunk(c);
+//       for (size_t i = 0; i < v.rows; i++) peak = std::max(peak, std::fabs(v.gyro[i].y));
+//   }
+//
+// SessionWriter appends rows and writes each chunk as it fills; close()
+// writes the last partial chunk and the index. A session whose writer never
+// closed is still readable up to its last full chunk.
+
+#ifndef SESSION_FILE_HPP
+#define SESSION_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "session_format.h"
+}
+
+namespace drumsession {
+
+struct Quat {
+    float w, x, y, z;  // real, i, j, k
+};
+
+struct Vec3 {
+    float x, y, z;
+};
+
+// Read-only view of a contiguous array
+template <typename T>
+struct Span {
+    const T *ptr = nullptr;
+    size_t len = 0;
+
+    const T &operator[](size_t i) const { return ptr[i]; }
+    const T *begin() const { return ptr; }
+    const T *end() const { return ptr + len; }
+    size_t size() const { return len; }
+    Span sub(size_t first, size_t count) const { return Span{ptr + first, count}; }
+};
+
+// The columns of one chunk
+struct ChunkView {
+    uint64_t firstRow = 0;
+    size_t rows = 0;
+    Span<int64_t> t;
+    Span<Quat> quat;
+    Span<Vec3> gyro;
+    Span<Vec3> accel;
+    Span<uint8_t> label;
+};
+
+// One row, for writing
+struct SessionRow {
+    int64_t tUs;
+    Quat quat;
+    Vec3 gyro;
+    Vec3 accel;
+    uint8_t label;
+};
+
+class SessionReader {
+public:
+    SessionReader() = default;
+    ~SessionReader() { close(); }
+    SessionReader(const SessionReader &) = delete;
+    SessionReader &operator=(const SessionReader &) = delete;
+
+    bool open(const std::string &path, std::string &err);
+    void close();
+
+    // Hint the expected access pattern to the kernel (madvise)
+    void adviseSequential();
+    void adviseRandom();
+
+    size_t chunkCount() const { return index_.size(); }
+    uint64_t rowCount() const { return rows_; }
+    uint32_t chunkRows() const { return header_->chunkRows; }
+    bool complete() const { return header_->indexOffset != 0; }
+    int64_t tFirstUs() const { return index_.empty() ? 0 : index_.front().tFirstUs; }
+    int64_t tLastUs() const { return index_.empty() ? 0 : index_.back().tLastUs; }
+    size_t fileSize() const { return size_; }
+
+    ChunkView chunk(size_t c) const;
+
+    // Chunk holding row r (r < rowCount())
+    size_t chunkOfRow(uint64_t r) const;
+
+    // First chunk whose last timestamp is at or after tUs (chunkCount() if none)
+    size_t chunkAtTime(int64_t tUs) const;
+
+private:
+    bool load_index(std::string &err);
+    bool walk_chunks(std::string &err);
+
+    int fd_ = -1;
+    const uint8_t *map_ = nullptr;
+    size_t size_ = 0;
+    const SessionHeader_t *header_ = nullptr;
+    std::vector<SessionIndexEntry_t> index_;
+    uint64_t rows_ = 0;
+};
+
+class SessionWriter {
+public:
+    SessionWriter() = default;
+    ~SessionWriter() { close(); }
+    SessionWriter(const SessionWriter &) = delete;
+    SessionWriter &operator=(const SessionWriter &) = delete;
+
+    bool open(const std::string &path, uint32_t chunkRows, std::string &err);
+    bool append(const SessionRow &row);
+    bool close();
+
+    uint64_t rowCount() const { return firstRow_ + pending_.size(); }
+
+private:
+    bool write_chunk();
+
+    FILE *file_ = nullptr;
+    uint32_t chunkRows_ = 0;
+    uint64_t offset_ = 0;
+    uint64_t firstRow_ = 0;
+    std::vector<SessionRow> pending_;
+    std::vector<SessionIndexEntry_t> index_;
+    std::vector<uint8_t> buf_;
+};
+
+// Byte offsets of the columns in a chunk of n rows; returns the chunk size
+uint64_t chunkLayout(uint32_t rows, uint32_t colOffset[SESSION_NUM_COLS]);
+
+}  // namespace drumsession
+
+#endif  // SESSION_FILE_HPP
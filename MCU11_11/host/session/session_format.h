@@ -0,0 +1,77 @@
+// session_format.h
+// On-disk layout of a recorded session (.dses)
+//
+// A session is a table with one row per gyroscope report (the rate detection
+// runs at), holding the latest quaternion and linear acceleration and an
+// optional drum label. Rows are stored in chunks of up to chunkRows rows;
+// inside a chunk every column is contiguous and 64-byte aligned, so a
+// reader that maps the file can hand out each column as an array without
+// copying, and a scan over one column touches nothing else.
+//
+//   SessionHeader_t                    at offset 0
+//   chunk 0: SessionChunk_t, columns   at SESSION_ALIGN boundaries
+//   chunk 1 ...
+//   SessionIndexEntry_t[chunkCount]    at header.indexOffset
+//
+// Writers append chunks as they fill and write the index when the session is
+// closed. indexOffset stays 0 until then; a reader of an unfinished file
+// (a capture still running, or one that was killed) walks the chunk headers
+// instead, each of which carries the magic and its own size.
+//
+// All fields are little-endian. host/session/session_file.hpp reads and
+// writes this format in C++, host/session_file.py in Python.
+
+#ifndef SESSION_FORMAT_H
+#define SESSION_FORMAT_H
+
+#include <stdint.h>
+
+#define SESSION_MAGIC        0x53455344  // "DSES"
+#define SESSION_CHUNK_MAGIC  0x4B4E4843  // "CHNK"
+#define SESSION_VERSION      1
+#define SESSION_ALIGN        64
+
+// Column order within a chunk
+#define SESSION_COL_TIME     0  // int64 t_us (sensor hub time, unwrapped)
+#define SESSION_COL_QUAT     1  // float32[4] real, i, j, k
+#define SESSION_COL_GYRO     2  // float32[3] rad/s
+#define SESSION_COL_ACCEL    3  // float32[3] m/s^2 (linear acceleration)
+#define SESSION_COL_LABEL    4  // uint8 DRUM_* of a hit at this row, 255 = none
+#define SESSION_NUM_COLS     5
+
+#define SESSION_LABEL_NONE   255
+
+typedef struct {
+    uint32_t magic;          // SESSION_MAGIC
+    uint16_t version;        // SESSION_VERSION
+    uint16_t headerSize;     // sizeof(SessionHeader_t)
+    uint32_t chunkRows;      // Row capacity of a full chunk
+    uint32_t chunkCount;     // Valid when indexOffset != 0
+    uint64_t rowCount;       // Valid when indexOffset != 0
+    uint64_t indexOffset;    // 0 while the session is being written
+    int64_t tFirstUs;        // Valid when indexOffset != 0
+    int64_t tLastUs;
+    uint8_t reserved[16];
+} SessionHeader_t;
+
+typedef struct {
+    uint32_t magic;          // SESSION_CHUNK_MAGIC
+    uint32_t rows;
+    uint64_t firstRow;
+    uint64_t size;           // Bytes from this header to the next chunk
+    int64_t tFirstUs;
+    int64_t tLastUs;
+    uint32_t colOffset[SESSION_NUM_COLS];  // From the start of this header
+    uint8_t reserved[4];
+} SessionChunk_t;
+
+typedef struct {
+    uint64_t offset;         // Of the SessionChunk_t
+    uint64_t firstRow;
+    int64_t tFirstUs;
+    int64_t tLastUs;
+    uint32_t rows;
+    uint32_t reserved;
+} SessionIndexEntry_t;
+
+#endif // SESSION_FORMAT_H
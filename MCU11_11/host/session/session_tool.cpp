@@ -0,0 +1,224 @@
+// session_tool.cpp
+// Inspect, scan and generate .dses session files
+//
+// Usage:
+//   ./session_tool info session.dses
+//   ./session_tool scan session.dses
+//   ./session_tool rows session.dses T0_MS T1_MS
+//   ./session_tool synth session.dses HOURS [RATE_HZ]
+//
+// info opens the file and prints its shape with the time the open took
+// (header and index only, whatever the file size). scan reads the gyro,
+// accel and label columns of every chunk, once cold and once warm, and
+// prints peaks, labelled hits and the scan rate in GB/s. rows prints the
+// rows between two times (ms from the session start) as CSV. synth writes a
+// synthetic session of the given length for trying the above on
+// multi-GB files.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "session_file.hpp"
+
+using namespace drumsession;
+
+static double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static int usage() {
+    std::fprintf(stderr,
+        "usage: session_tool info FILE\n"
+        "       session_tool scan FILE\n"
+        "       session_tool rows FILE T0_MS T1_MS\n"
+        "       session_tool synth FILE HOURS [RATE_HZ]\n");
+    return 1;
+}
+
+// Whole argument as a finite number; prints what was wrong otherwise
+static bool parse_number(const char *arg, const char *name, double &value) {
+    char *end = nullptr;
+    value = std::strtod(arg, &end);
+    if (end == arg || *end != '\0' || !std::isfinite(value)) {
+        std::fprintf(stderr, "%s: not a number: %s\n", name, arg);
+        return false;
+    }
+    return true;
+}
+
+static int open_or_fail(SessionReader &r, const char *path) {
+    std::string err;
+    if (!r.open(path, err)) {
+        std::fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+static int cmd_info(const char *path) {
+    auto t0 = std::chrono::steady_clock::now();
+    SessionReader r;
+    if (open_or_fail(r, path)) {
+        return 1;
+    }
+    double openMs = seconds_since(t0) * 1e3;
+    double span = (r.tLastUs() - r.tFirstUs()) / 1e6;
+    std::printf("%s: %.2f GB, %s\n", path, r.fileSize() / 1e9,
+                r.complete() ? "complete" : "unfinished (index rebuilt from chunk headers)");
+    std::printf("  %llu rows in %zu chunks of up to %u\n", (unsigned long long)r.rowCount(),
+                r.chunkCount(), r.chunkRows());
+    std::printf("  %.1f s of data (%.0f rows/s)\n", span, (span > 0) ? (r.rowCount() - 1) / span : 0.0);
+    std::printf("  opened in %.3f ms\n", openMs);
+    return 0;
+}
+
+// Peak gyro and accel magnitude and label count over one pass
+struct ScanResult {
+    float gyroPeak = 0;
+    float accelPeak = 0;
+    uint64_t labels = 0;
+    uint64_t bytes = 0;
+};
+
+static ScanResult scan(const SessionReader &r) {
+    ScanResult s;
+    for (size_t c = 0; c < r.chunkCount(); c++) {
+        ChunkView v = r.chunk(c);
+        float g = s.gyroPeak, a = s.accelPeak;
+        for (const Vec3 &x : v.gyro) {
+            float m = x.x * x.x + x.y * x.y + x.z * x.z;
+            g = (m > g) ? m : g;
+        }
+        for (const Vec3 &x : v.accel) {
+            float m = x.x * x.x + x.y * x.y + x.z * x.z;
+            a = (m > a) ? m : a;
+        }
+        for (uint8_t l : v.label) {
+            s.labels += (l != SESSION_LABEL_NONE);
+        }
+        s.gyroPeak = g;
+        s.accelPeak = a;
+        s.bytes += v.rows * (sizeof(Vec3) * 2 + 1);
+    }
+    s.gyroPeak = std::sqrt(s.gyroPeak);
+    s.accelPeak = std::sqrt(s.accelPeak);
+    return s;
+}
+
+static int cmd_scan(const char *path) {
+    SessionReader r;
+    if (open_or_fail(r, path)) {
+        return 1;
+    }
+    r.adviseSequential();
+    for (const char *pass : {"cold", "warm"}) {
+        auto t0 = std::chrono::steady_clock::now();
+        ScanResult s = scan(r);
+        double secs = seconds_since(t0);
+        std::printf("%s: gyro peak %.2f rad/s, accel peak %.2f m/s^2, %llu labelled rows,"
+                    " %.2f GB in %.3f s = %.2f GB/s\n", pass, s.gyroPeak, s.accelPeak,
+                    (unsigned long long)s.labels, s.bytes / 1e9, secs, s.bytes / 1e9 / secs);
+    }
+    return 0;
+}
+
+static int cmd_rows(const char *path, double t0Ms, double t1Ms) {
+    SessionReader r;
+    if (open_or_fail(r, path)) {
+        return 1;
+    }
+    r.adviseRandom();
+    int64_t t0 = r.tFirstUs() + (int64_t)(t0Ms * 1000);
+    int64_t t1 = r.tFirstUs() + (int64_t)(t1Ms * 1000);
+    std::printf("t_us,qr,qi,qj,qk,gx,gy,gz,ax,ay,az,label\n");
+    for (size_t c = r.chunkAtTime(t0); c < r.chunkCount(); c++) {
+        ChunkView v = r.chunk(c);
+        if (v.t[0] > t1) {
+            break;
+        }
+        for (size_t i = 0; i < v.rows; i++) {
+            if (v.t[i] < t0 || v.t[i] > t1) {
+                continue;
+            }
+            const Quat &q = v.quat[i];
+            const Vec3 &g = v.gyro[i], &a = v.accel[i];
+            std::printf("%lld,%.5f,%.5f,%.5f,%.5f,%.4f,%.4f,%.4f,%.3f,%.3f,%.3f,%d\n", (long long)v.t[i],
+                        q.w, q.x, q.y, q.z, g.x, g.y, g.z, a.x, a.y, a.z,
+                        v.label[i] == SESSION_LABEL_NONE ? -1 : v.label[i]);
+        }
+    }
+    return 0;
+}
+
+// Wrist rotation with a stroke every half second
+static int cmd_synth(const char *path, double hours, double rateHz) {
+    SessionWriter w;
+    std::string err;
+    if (!w.open(path, 65536, err)) {
+        std::fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    uint64_t rows = (uint64_t)(hours * 3600 * rateHz);
+    int64_t stepUs = (int64_t)(1e6 / rateHz);
+    uint64_t strokeRows = (uint64_t)(0.5 * rateHz);
+    for (uint64_t i = 0; i < rows; i++) {
+        double t = i / rateHz;
+        float phase = (float)((i % strokeRows) / (double)strokeRows);
+        float swing = (phase < 0.1f) ? -12.0f * std::sin(phase * 31.4159f) : 0.0f;
+        float half = (float)(0.3 * std::sin(t * 0.5));
+        SessionRow row = {
+            (int64_t)i * stepUs,
+            {std::cos(half), 0.0f, 0.0f, std::sin(half)},
+            {0.1f, swing, 0.05f},
+            {0.0f, 0.0f, (phase > 0.1f && phase < 0.12f) ? 30.0f : 0.2f},
+            (i % strokeRows == strokeRows / 10) ? (uint8_t)((i / strokeRows) % 8) : (uint8_t)SESSION_LABEL_NONE,
+        };
+        if (!w.append(row)) {
+            std::fprintf(stderr, "%s: write failed\n", path);
+            return 1;
+        }
+    }
+    if (!w.close()) {
+        std::fprintf(stderr, "%s: write failed\n", path);
+        return 1;
+    }
+    std::printf("%s: %llu rows\n", path, (unsigned long long)rows);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        return usage();
+    }
+    std::string cmd = argv[1];
+    if (cmd == "info") {
+        return cmd_info(argv[2]);
+    }
+    if (cmd == "scan") {
+        return cmd_scan(argv[2]);
+    }
+    if (cmd == "rows" && argc == 5) {
+        double t0, t1;
+        if (!parse_number(argv[3], "T0_MS", t0) || !parse_number(argv[4], "T1_MS", t1)) {
+            return 1;
+        }
+        return cmd_rows(argv[2], t0, t1);
+    }
+    if (cmd == "synth" && (argc == 4 || argc == 5)) {
+        double hours, rateHz = 1000.0;
+        if (!parse_number(argv[3], "HOURS", hours) ||
+            (argc == 5 && !parse_number(argv[4], "RATE_HZ", rateHz))) {
+            return 1;
+        }
+        // A stroke every half second needs at least one row per stroke
+        if (hours <= 0.0 || rateHz < 2.0) {
+            std::fprintf(stderr, "synth: HOURS must be > 0 and RATE_HZ >= 2\n");
+            return 1;
+        }
+        return cmd_synth(argv[2], hours, rateHz);
+    }
+    return usage();
+}
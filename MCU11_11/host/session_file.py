@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+# session_file.py
+# Appending writer for .dses session files (session/session_format.h)
+#
+# The layout is described in session/session_format.h; the C++ reader in
+# session/session_file.hpp maps the result. Rows are buffered per chunk and
+# written as columns when the chunk fills, so a capture can append for hours
+# with bounded memory. close() writes the last chunk and the index; a file
+# that was never closed is still readable up to its last full chunk.
+#
+# Usage (library):
+#   w = SessionWriter("session.dses")
+#   w.append(t_us, (qr, qi, qj, qk), (gx, gy, gz), (ax, ay, az), label=LABEL_NONE)
+#   w.close()
+#
+# RowBuilder turns per-sensor reports (capture.py records) into rows: one
+# per gyroscope report, holding the latest quaternion and acceleration.
+#
+# No third-party packages required.
+
+import struct
+from array import array
+
+MAGIC = 0x53455344
+CHUNK_MAGIC = 0x4B4E4843
+VERSION = 1
+ALIGN = 64
+LABEL_NONE = 255
+
+HEADER = struct.Struct("<IHHIIQQqq16x")
+CHUNK = struct.Struct("<IIQQqq5I4x")
+INDEX_ENTRY = struct.Struct("<QQqqII")
+COL_ELEM = (8, 16, 12, 12, 1)  # time, quat, gyro, accel, label
+
+SENSOR_GRV = 0x08
+SENSOR_GYRO = 0x02
+SENSOR_ACCEL = 0x04
+
+
+def align_up(n):
+    return (n + ALIGN - 1) & ~(ALIGN - 1)
+
+
+def chunk_layout(rows):
+    """Column offsets and total size of a chunk of rows rows."""
+    offsets = []
+    pos = CHUNK.size
+    for elem in COL_ELEM:
+        offsets.append(pos)
+        pos = align_up(pos + rows * elem)
+    return offsets, pos
+
+
+class SessionWriter:
+    def __init__(self, path, chunk_rows=65536):
+        self.f = open(path, "wb")
+        self.chunk_rows = chunk_rows
+        self.offset = align_up(HEADER.size)
+        self.first_row = 0
+        self.index = []
+        self._reset()
+        self.f.write(HEADER.pack(MAGIC, VERSION, HEADER.size, chunk_rows, 0, 0, 0, 0, 0))
+        self.f.write(bytes(self.offset - HEADER.size))
+
+    def _reset(self):
+        self.t = array("q")
+        self.quat = array("f")
+        self.gyro = array("f")
+        self.accel = array("f")
+        self.label = bytearray()
+
+    def append(self, t_us, quat, gyro, accel, label=LABEL_NONE):
+        self.t.append(t_us)
+        self.quat.extend(quat)
+        self.gyro.extend(gyro)
+        self.accel.extend(accel)
+        self.label.append(label)
+        if len(self.t) >= self.chunk_rows:
+            self._write_chunk()
+
+    def _write_chunk(self):
+        rows = len(self.t)
+        if rows == 0:
+            return
+        offsets, size = chunk_layout(rows)
+        buf = bytearray(size)
+        buf[:CHUNK.size] = CHUNK.pack(CHUNK_MAGIC, rows, self.first_row, size, self.t[0], self.t[-1], *offsets)
+        for off, col in zip(offsets, (self.t, self.quat, self.gyro, self.accel, self.label)):
+            data = col.tobytes() if isinstance(col, array) else bytes(col)
+            buf[off:off + len(data)] = data
+        self.f.write(buf)
+        self.f.flush()
+        self.index.append((self.offset, self.first_row, self.t[0], self.t[-1], rows, 0))
+        self.offset += size
+        self.first_row += rows
+        self._reset()
+
+    @property
+    def rows(self):
+        return self.first_row + len(self.t)
+
+    def close(self):
+        self._write_chunk()
+        for entry in self.index:
+            self.f.write(INDEX_ENTRY.pack(*entry))
+        t_first = self.index[0][2] if self.index else 0
+        t_last = self.index[-1][3] if self.index else 0
+        self.f.seek(0)
+        self.f.write(HEADER.pack(MAGIC, VERSION, HEADER.size, self.chunk_rows, len(self.index),
+                                 self.first_row, self.offset, t_first, t_last))
+        self.f.close()
+
+
+class RowBuilder:
+    """Per-sensor reports in, one row per gyroscope report out."""
+
+    def __init__(self, writer):
+        self.writer = writer
+        self.quat = (1.0, 0.0, 0.0, 0.0)
+        self.accel = (0.0, 0.0, 0.0)
+        self.labels = []  # (t_us, drum), ascending
+
+    def add_labels(self, labels):
+        self.labels = sorted(labels) + self.labels
+
+    def add(self, t_us, sensor_id, values):
+        if sensor_id == SENSOR_GRV:
+            self.quat = tuple(values[:4])
+        elif sensor_id == SENSOR_ACCEL:
+            self.accel = tuple(values[:3])
+        elif sensor_id == SENSOR_GYRO:
+            label = LABEL_NONE
+            # A label goes on the first row at or after its time
+            if self.labels and self.labels[0][0] <= t_us:
+                label = self.labels.pop(0)[1]
+            self.writer.append(t_us, self.quat, values[:3], self.accel, label)
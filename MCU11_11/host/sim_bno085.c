@@ -0,0 +1,731 @@
+// sim_bno085.c
+// Simulated BNO085 sensor hub implementation
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "sim_bno085.h"
+#include "shtp_capture.h"  // Capture frame format
+
+// SHTP channels as advertised below (same numbering as the real BNO085)
+#define CHAN_COMMAND       0
+#define CHAN_EXECUTABLE    1
+#define CHAN_CONTROL       2
+#define CHAN_INPUT_NORMAL  3
+#define CHAN_INPUT_WAKE    4
+#define CHAN_INPUT_GYRO_RV 5
+
+#define SHTP_HDR_LEN  4
+
+// SHTP advertisement tags (shtp.h) and sensorhub app tags (sh2.c)
+#define TAG_GUID                         1
+#define TAG_MAX_CARGO_PLUS_HEADER_WRITE  2
+#define TAG_MAX_CARGO_PLUS_HEADER_READ   3
+#define TAG_MAX_TRANSFER_WRITE           4
+#define TAG_MAX_TRANSFER_READ            5
+#define TAG_NORMAL_CHANNEL               6
+#define TAG_WAKE_CHANNEL                 7
+#define TAG_APP_NAME                     8
+#define TAG_CHANNEL_NAME                 9
+#define TAG_SHTP_VERSION                 0x80
+#define TAG_SH2_VERSION                  0x80
+#define TAG_SH2_REPORT_LENGTHS           0x81
+
+// Control channel report IDs (SH-2 Reference Manual)
+#define RPT_FLUSH_COMPLETED   0xEF
+#define RPT_FORCE_FLUSH       0xF0
+#define RPT_COMMAND_RESP      0xF1
+#define RPT_COMMAND_REQ       0xF2
+#define RPT_PROD_ID_RESP      0xF8
+#define RPT_PROD_ID_REQ       0xF9
+#define RPT_BASE_TIMESTAMP    0xFB
+#define RPT_GET_FEATURE_RESP  0xFC
+#define RPT_SET_FEATURE_CMD   0xFD
+#define RPT_GET_FEATURE_REQ   0xFE
+
+#define CMD_INITIALIZE_UNSOLICITED  0x84
+
+// Report lengths advertised to sh2.c (report ID, length)
+static const uint8_t reportLengths[][2] = {
+    { 0xF1, 16 }, { 0xF3, 16 }, { 0xF5, 16 }, { 0xF8, 16 }, { 0xFA, 5 }, { 0xFB, 5 },
+    { 0xFC, 17 }, { 0xEF, 2 },
+    { 0x01, 10 }, { 0x02, 10 }, { 0x03, 10 }, { 0x04, 10 }, { 0x05, 14 }, { 0x06, 10 },
+    { 0x07, 16 }, { 0x08, 12 }, { 0x09, 14 }, { 0x14, 16 }, { 0x15, 16 }, { 0x16, 14 },
+};
+#define NUM_REPORT_LENGTHS  (int)(sizeof reportLengths / sizeof reportLengths[0])
+
+// Product ID responses (four entries, as the BNO085 sends)
+static const uint32_t prodPartNumbers[4] = { 10003608, 10003606, 10004135, 10004149 };
+
+static uint8_t report_len(uint8_t reportId) {
+    for (int n = 0; n < NUM_REPORT_LENGTHS; n++) {
+        if (reportLengths[n][0] == reportId) {
+            return reportLengths[n][1];
+        }
+    }
+    return 0;
+}
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    put16(p, (uint16_t)(v & 0xFFFF));
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void putq(uint8_t *p, float value, int qpoint) {
+    float raw = roundf(value * (float)(1 << qpoint));
+    if (raw > 32767.0f) raw = 32767.0f;
+    if (raw < -32768.0f) raw = -32768.0f;
+    put16(p, (uint16_t)(int16_t)raw);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Transfers to the host
+///////////////////////////////////////////////////////////////////////////////
+
+// Queue one SHTP payload, split into transfers of at most maxTransferIn bytes
+static void send_payload(SimBno085_t *sim, uint8_t chan, const uint8_t *payload, uint16_t len) {
+    uint16_t maxData = (uint16_t)(sim->maxTransferIn - SHTP_HDR_LEN);
+    uint16_t cursor = 0;
+    bool continuation = false;
+    
+    do {
+        uint16_t next = (uint16_t)((sim->head + 1) % SIM_QUEUE_LEN);
+        if (next == sim->tail) {
+            sim->queueOverflows++;  // Host is not reading fast enough
+            return;
+        }
+        
+        uint16_t remaining = (uint16_t)(len - cursor);
+        uint16_t chunk = remaining < maxData ? remaining : maxData;
+        SimTransfer_t *t = &sim->queue[sim->head];
+        put16(t->data, (uint16_t)((remaining + SHTP_HDR_LEN) | (continuation ? 0x8000 : 0)));
+        t->data[2] = chan;
+        t->data[3] = sim->outSeq[chan]++;
+        memcpy(t->data + SHTP_HDR_LEN, payload + cursor, chunk);
+        t->len = (uint16_t)(chunk + SHTP_HDR_LEN);
+        sim->head = next;
+        
+        cursor = (uint16_t)(cursor + chunk);
+        continuation = true;
+    } while (cursor < len);
+}
+
+// Queue one captured transfer as it was read by the firmware
+static void send_raw(SimBno085_t *sim, const uint8_t *data, uint16_t len) {
+    uint16_t next = (uint16_t)((sim->head + 1) % SIM_QUEUE_LEN);
+    if (next == sim->tail) {
+        sim->queueOverflows++;
+        return;
+    }
+    SimTransfer_t *t = &sim->queue[sim->head];
+    memcpy(t->data, data, len);
+    t->len = len;
+    sim->head = next;
+}
+
+// Write one transfer to the record file as a capture frame
+static void record_frame(SimBno085_t *sim, bool write, const uint8_t *data, uint16_t len) {
+    uint8_t hdr[SHTP_CAPTURE_HDR_LEN];
+    
+    hdr[0] = SHTP_CAPTURE_SYNC;
+    hdr[1] = sim->recordSeq++;
+    put16(hdr + 2, (uint16_t)(len | (write ? SHTP_CAPTURE_WRITE : 0)));
+    put32(hdr + 4, sim->now_us);
+    fwrite(hdr, 1, sizeof hdr, sim->record);
+    fwrite(data, 1, len, sim->record);
+}
+
+// Append a tag/length/value entry to an advertisement
+static uint16_t tlv(uint8_t *buf, uint16_t at, uint8_t tag, const void *val, uint8_t len) {
+    buf[at++] = tag;
+    buf[at++] = len;
+    memcpy(buf + at, val, len);
+    return (uint16_t)(at + len);
+}
+
+static uint16_t tlv_u8(uint8_t *buf, uint16_t at, uint8_t tag, uint8_t v) {
+    return tlv(buf, at, tag, &v, 1);
+}
+
+static uint16_t tlv_u16(uint8_t *buf, uint16_t at, uint8_t tag, uint16_t v) {
+    uint8_t b[2];
+    put16(b, v);
+    return tlv(buf, at, tag, b, 2);
+}
+
+static uint16_t tlv_u32(uint8_t *buf, uint16_t at, uint8_t tag, uint32_t v) {
+    uint8_t b[4];
+    put32(b, v);
+    return tlv(buf, at, tag, b, 4);
+}
+
+static uint16_t tlv_str(uint8_t *buf, uint16_t at, uint8_t tag, const char *s) {
+    return tlv(buf, at, tag, s, (uint8_t)(strlen(s) + 1));
+}
+
+// Advertisement: SHTP, executable and sensorhub apps with their channels
+static void send_advert(SimBno085_t *sim) {
+    uint8_t buf[512];
+    uint16_t n = 0;
+    
+    buf[n++] = 0;  // Advertise response
+    n = tlv_u32(buf, n, TAG_GUID, 0);
+    n = tlv_u16(buf, n, TAG_MAX_CARGO_PLUS_HEADER_WRITE, 256);
+    n = tlv_u16(buf, n, TAG_MAX_CARGO_PLUS_HEADER_READ, 512);
+    n = tlv_u16(buf, n, TAG_MAX_TRANSFER_WRITE, 256);
+    n = tlv_u16(buf, n, TAG_MAX_TRANSFER_READ, sim->maxTransferIn);
+    n = tlv_u8(buf, n, TAG_NORMAL_CHANNEL, CHAN_COMMAND);
+    n = tlv_str(buf, n, TAG_APP_NAME, "SHTP");
+    n = tlv_str(buf, n, TAG_CHANNEL_NAME, "command");
+    n = tlv_str(buf, n, TAG_SHTP_VERSION, "1.0.1");
+    
+    n = tlv_u32(buf, n, TAG_GUID, 1);
+    n = tlv_u8(buf, n, TAG_NORMAL_CHANNEL, CHAN_EXECUTABLE);
+    n = tlv_str(buf, n, TAG_APP_NAME, "executable");
+    n = tlv_str(buf, n, TAG_CHANNEL_NAME, "device");
+    
+    n = tlv_u32(buf, n, TAG_GUID, 2);
+    n = tlv_str(buf, n, TAG_APP_NAME, "sensorhub");
+    n = tlv_str(buf, n, TAG_SH2_VERSION, "3.2.7");
+    n = tlv(buf, n, TAG_SH2_REPORT_LENGTHS, reportLengths, (uint8_t)sizeof reportLengths);
+    n = tlv_u8(buf, n, TAG_NORMAL_CHANNEL, CHAN_CONTROL);
+    n = tlv_str(buf, n, TAG_CHANNEL_NAME, "control");
+    n = tlv_u8(buf, n, TAG_NORMAL_CHANNEL, CHAN_INPUT_NORMAL);
+    n = tlv_str(buf, n, TAG_CHANNEL_NAME, "inputNormal");
+    n = tlv_u8(buf, n, TAG_WAKE_CHANNEL, CHAN_INPUT_WAKE);
+    n = tlv_str(buf, n, TAG_CHANNEL_NAME, "inputWake");
+    n = tlv_u8(buf, n, TAG_NORMAL_CHANNEL, CHAN_INPUT_GYRO_RV);
+    n = tlv_str(buf, n, TAG_CHANNEL_NAME, "inputGyroRv");
+    
+    send_payload(sim, CHAN_COMMAND, buf, n);
+}
+
+// Reset: all sensors off, then advertisement, reset complete and the
+// unsolicited initialize response, in the order the hub sends them
+static void do_reset(SimBno085_t *sim) {
+    memset(sim->sensor, 0, sizeof sim->sensor);
+    memset(sim->outSeq, 0, sizeof sim->outSeq);
+    sim->traceStarted = false;
+    sim->traceNext = 0;
+    
+    send_advert(sim);
+    
+    uint8_t resetComplete = 1;
+    send_payload(sim, CHAN_EXECUTABLE, &resetComplete, 1);
+    
+    uint8_t init[16] = { RPT_COMMAND_RESP, 0, CMD_INITIALIZE_UNSOLICITED, 0, 0, 0, 1 };
+    send_payload(sim, CHAN_CONTROL, init, sizeof init);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Input reports
+///////////////////////////////////////////////////////////////////////////////
+
+// Default generator: slow rotation with a little motion on every axis
+static void default_sample(void *cookie, uint8_t sensorId, uint32_t t_us, float v[4]) {
+    (void)cookie;
+    float t = (float)t_us * 1e-6f;
+    if (sensorId == 0x05 || sensorId == 0x08) {
+        float h = 0.25f * t;  // Half-angle about z
+        v[0] = 0.0f;
+        v[1] = 0.0f;
+        v[2] = sinf(h);
+        v[3] = cosf(h);
+    } else {
+        v[0] = sinf(2.0f * t);
+        v[1] = cosf(3.0f * t);
+        v[2] = 0.5f * sinf(5.0f * t);
+        v[3] = 0.0f;
+    }
+}
+
+// Encode one input report (id, seq, status/delay, values in Q format)
+static uint16_t encode_report(SimSensor_t *s, uint8_t sensorId, const float v[4], uint8_t *out) {
+    uint8_t len = report_len(sensorId);
+    memset(out, 0, len);
+    out[0] = sensorId;
+    out[1] = s->seq++;
+    out[2] = 3;  // Status: high accuracy, delay 0
+    out[3] = 0;
+    
+    switch (sensorId) {
+        case 0x05:  // Rotation vector (+ accuracy estimate)
+            putq(&out[12], 0.05f, 12);
+            // fall through
+        case 0x08:  // Game rotation vector: i, j, k, real
+            for (int a = 0; a < 4; a++) putq(&out[4 + 2 * a], v[a], 14);
+            break;
+        case 0x02:  // Calibrated gyroscope
+            for (int a = 0; a < 3; a++) putq(&out[4 + 2 * a], v[a], 9);
+            break;
+        case 0x03:  // Calibrated magnetic field
+            for (int a = 0; a < 3; a++) putq(&out[4 + 2 * a], v[a], 4);
+            break;
+        default:    // Accelerometer, linear acceleration, gravity
+            for (int a = 0; a < 3; a++) putq(&out[4 + 2 * a], v[a], 8);
+            break;
+    }
+    return len;
+}
+
+// Start an input payload with a base timestamp reference (report at interrupt time)
+static uint16_t begin_batch(uint8_t *buf) {
+    buf[0] = RPT_BASE_TIMESTAMP;
+    put32(&buf[1], 0);
+    return 5;
+}
+
+// Queue generated reports that fell due up to the current time
+// Reports due at the same instant share one input payload.
+static void update_streams(SimBno085_t *sim) {
+    uint8_t buf[5 + SIM_MAX_BATCH * 16];
+    
+    for (;;) {
+        uint32_t due = 0;
+        bool any = false;
+        for (int id = 1; id < SIM_MAX_SENSORS; id++) {
+            SimSensor_t *s = &sim->sensor[id];
+            if (s->interval_us == 0 || (int32_t)(s->next_us - sim->now_us) > 0) continue;
+            if (!any || (int32_t)(s->next_us - due) < 0) due = s->next_us;
+            any = true;
+        }
+        if (!any) {
+            return;
+        }
+        
+        uint16_t n = begin_batch(buf);
+        int batched = 0;
+        for (int id = 1; id < SIM_MAX_SENSORS && batched < SIM_MAX_BATCH; id++) {
+            SimSensor_t *s = &sim->sensor[id];
+            if (s->interval_us == 0 || s->next_us != due) continue;
+            
+            float v[4] = { 0 };
+            sim->sampleFn(sim->sampleCookie, (uint8_t)id, due, v);
+            n = (uint16_t)(n + encode_report(s, (uint8_t)id, v, buf + n));
+            s->next_us += s->interval_us;
+            batched++;
+        }
+        send_payload(sim, CHAN_INPUT_NORMAL, buf, n);
+        sim->reportsOut += (uint32_t)batched;
+    }
+}
+
+// Queue trace samples up to the current time (trace time starts at the first
+// Set Feature); samples with the same timestamp share one input payload
+static void update_trace(SimBno085_t *sim) {
+    uint8_t buf[5 + SIM_MAX_BATCH * 16];
+    
+    if (!sim->traceStarted) {
+        return;
+    }
+    while (sim->traceNext < sim->traceCount &&
+           (int32_t)(sim->traceStart_us + sim->trace[sim->traceNext].t_us - sim->now_us) <= 0) {
+        uint32_t t = sim->trace[sim->traceNext].t_us;
+        uint16_t n = begin_batch(buf);
+        int batched = 0;
+        while (sim->traceNext < sim->traceCount && sim->trace[sim->traceNext].t_us == t &&
+               batched < SIM_MAX_BATCH) {
+            const SimTraceSample_t *ts = &sim->trace[sim->traceNext++];
+            SimSensor_t *s = &sim->sensor[ts->sensorId];
+            if (s->interval_us == 0) continue;  // Not enabled by the host
+            n = (uint16_t)(n + encode_report(s, ts->sensorId, ts->v, buf + n));
+            batched++;
+        }
+        if (batched > 0) {
+            send_payload(sim, CHAN_INPUT_NORMAL, buf, n);
+            sim->reportsOut += (uint32_t)batched;
+        }
+    }
+}
+
+// Queue captured reads up to the current time (capture time starts at open)
+static void update_capture(SimBno085_t *sim) {
+    while (sim->captureNextRead < sim->captureCount) {
+        const SimCaptureFrame_t *f = &sim->capture[sim->captureNextRead];
+        if (f->write) {
+            sim->captureNextRead++;
+            continue;
+        }
+        if ((int32_t)(sim->captureStart_us + f->t_us - sim->now_us) > 0) {
+            break;
+        }
+        send_raw(sim, sim->captureData + f->offset, f->len);
+        sim->captureNextRead++;
+    }
+}
+
+static void update(SimBno085_t *sim) {
+    if (!sim->isOpen) {
+        return;
+    }
+    if (sim->capture != NULL) {
+        update_capture(sim);
+    } else if (sim->trace != NULL) {
+        update_trace(sim);
+    } else {
+        update_streams(sim);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Requests from the host
+///////////////////////////////////////////////////////////////////////////////
+
+static void send_feature(SimBno085_t *sim, uint8_t sensorId) {
+    uint8_t r[17] = { 0 };
+    const SimSensor_t *s = &sim->sensor[sensorId < SIM_MAX_SENSORS ? sensorId : 0];
+    r[0] = RPT_GET_FEATURE_RESP;
+    r[1] = sensorId;
+    r[2] = s->flags;
+    put16(&r[3], s->changeSensitivity);
+    put32(&r[5], s->interval_us);
+    put32(&r[9], s->batch_us);
+    put32(&r[13], s->sensorSpecific);
+    send_payload(sim, CHAN_CONTROL, r, sizeof r);
+}
+
+static void handle_control(SimBno085_t *sim, const uint8_t *p, uint16_t len) {
+    switch (p[0]) {
+        case RPT_PROD_ID_REQ: {
+            uint8_t r[4 * 16] = { 0 };
+            for (int e = 0; e < 4; e++) {
+                uint8_t *q = &r[e * 16];
+                q[0] = RPT_PROD_ID_RESP;
+                q[1] = (e == 0) ? 1 : 0;  // Reset cause: power on
+                q[2] = 3;
+                q[3] = 2;
+                put32(&q[4], prodPartNumbers[e]);
+                put32(&q[8], 400 + e);
+                put16(&q[12], 7);
+            }
+            send_payload(sim, CHAN_CONTROL, r, sizeof r);
+            break;
+        }
+        
+        case RPT_GET_FEATURE_REQ:
+            if (len >= 2) send_feature(sim, p[1]);
+            break;
+        
+        case RPT_SET_FEATURE_CMD:
+            if (len >= 17 && p[1] < SIM_MAX_SENSORS) {
+                SimSensor_t *s = &sim->sensor[p[1]];
+                s->flags = p[2];
+                s->changeSensitivity = (uint16_t)(p[3] | (p[4] << 8));
+                s->interval_us = get32(&p[5]);
+                s->batch_us = get32(&p[9]);
+                s->sensorSpecific = get32(&p[13]);
+                // The hub samples on its own clock: same-rate sensors fall due together
+                s->next_us = s->interval_us ? (sim->now_us / s->interval_us + 1) * s->interval_us : 0;
+                if (sim->trace != NULL && !sim->traceStarted && s->interval_us != 0) {
+                    sim->traceStarted = true;
+                    sim->traceStart_us = sim->now_us;
+                }
+                send_feature(sim, p[1]);  // The hub confirms with a Get Feature Response
+            }
+            break;
+        
+        case RPT_COMMAND_REQ:
+            if (len >= 3) {
+                // Generic success response echoing the command and its sequence number
+                uint8_t r[16] = { RPT_COMMAND_RESP, 0, p[2], p[1], 0 };
+                send_payload(sim, CHAN_CONTROL, r, sizeof r);
+            }
+            break;
+        
+        case RPT_FORCE_FLUSH:
+            if (len >= 2) {
+                uint8_t r[2] = { RPT_FLUSH_COMPLETED, p[1] };
+                send_payload(sim, CHAN_INPUT_NORMAL, r, sizeof r);
+            }
+            break;
+        
+        default:
+            sim->badWrites++;
+            break;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// sh2_Hal_t
+///////////////////////////////////////////////////////////////////////////////
+
+static int sim_open(sh2_Hal_t *self) {
+    SimBno085_t *sim = (SimBno085_t *)self;
+    sim->head = sim->tail = 0;
+    sim->isOpen = true;
+    if (sim->capture != NULL) {
+        // The capture holds the hub's own reset traffic
+        sim->captureStart_us = sim->now_us;
+        sim->captureNextRead = 0;
+        sim->captureNextWrite = 0;
+        return 0;
+    }
+    do_reset(sim);
+    return 0;
+}
+
+static void sim_close(sh2_Hal_t *self) {
+    SimBno085_t *sim = (SimBno085_t *)self;
+    sim->isOpen = false;
+    sim->head = sim->tail = 0;
+}
+
+static int sim_read(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint32_t *t_us) {
+    SimBno085_t *sim = (SimBno085_t *)self;
+    
+    update(sim);
+    if (sim->head == sim->tail) {
+        return 0;  // H_INTN not asserted
+    }
+    
+    SimTransfer_t *t = &sim->queue[sim->tail];
+    unsigned n = t->len < len ? t->len : len;
+    memcpy(pBuffer, t->data, n);
+    sim->tail = (uint16_t)((sim->tail + 1) % SIM_QUEUE_LEN);
+    
+    sim->transfersOut++;
+    sim->bytesOut += n;
+    if (sim->record != NULL) {
+        record_frame(sim, false, pBuffer, (uint16_t)n);
+    }
+    if (t_us) {
+        *t_us = sim->now_us;
+    }
+    return (int)n;
+}
+
+static int sim_write(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len) {
+    SimBno085_t *sim = (SimBno085_t *)self;
+    
+    // Hub not ready: shtp retries after servicing reads
+    if (sim->busyLeft > 0) {
+        sim->busyLeft--;
+        return 0;
+    }
+    sim->busyLeft = sim->writeBusy;
+    
+    uint16_t lenField = (uint16_t)((pBuffer[0] | (pBuffer[1] << 8)) & 0x7FFF);
+    if (len < SHTP_HDR_LEN + 1 || lenField != len) {
+        sim->badWrites++;
+        return (int)len;
+    }
+    sim->commandsIn++;
+    if (sim->record != NULL) {
+        record_frame(sim, true, pBuffer, (uint16_t)len);
+    }
+    
+    if (sim->capture != NULL) {
+        // Compare with the next write the firmware made; the responses are
+        // already in the capture
+        while (sim->captureNextWrite < sim->captureCount &&
+               !sim->capture[sim->captureNextWrite].write) {
+            sim->captureNextWrite++;
+        }
+        if (sim->captureNextWrite >= sim->captureCount) {
+            sim->captureWriteMismatches++;
+            return (int)len;
+        }
+        const SimCaptureFrame_t *f = &sim->capture[sim->captureNextWrite++];
+        // The SHTP sequence byte depends on how many writes came before
+        if (f->len != len || memcmp(sim->captureData + f->offset, pBuffer, 3) != 0 ||
+            memcmp(sim->captureData + f->offset + SHTP_HDR_LEN, pBuffer + SHTP_HDR_LEN,
+                   len - SHTP_HDR_LEN) != 0) {
+            sim->captureWriteMismatches++;
+        }
+        return (int)len;
+    }
+    
+    uint8_t chan = pBuffer[2];
+    const uint8_t *p = pBuffer + SHTP_HDR_LEN;
+    uint16_t n = (uint16_t)(len - SHTP_HDR_LEN);
+    
+    if (chan == CHAN_COMMAND && p[0] == 0) {
+        send_advert(sim);
+    } else if (chan == CHAN_EXECUTABLE && p[0] == 1) {
+        do_reset(sim);
+    } else if (chan == CHAN_CONTROL) {
+        handle_control(sim, p, n);
+    } else {
+        sim->badWrites++;
+    }
+    return (int)len;
+}
+
+static uint32_t sim_getTimeUs(sh2_Hal_t *self) {
+    SimBno085_t *sim = (SimBno085_t *)self;
+    sim->now_us += sim->usPerPoll;
+    return sim->now_us;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Public functions
+///////////////////////////////////////////////////////////////////////////////
+
+// Set up the HAL function pointers and default behaviour
+void SimBno085_Init(SimBno085_t *sim) {
+    memset(sim, 0, sizeof *sim);
+    sim->hal.open = sim_open;
+    sim->hal.close = sim_close;
+    sim->hal.read = sim_read;
+    sim->hal.write = sim_write;
+    sim->hal.getTimeUs = sim_getTimeUs;
+    sim->maxTransferIn = SH2_HAL_MAX_TRANSFER_IN;
+    sim->usPerPoll = 10;
+    sim->sampleFn = default_sample;
+}
+
+// Free a loaded trace (the simulator can then be initialised again)
+void SimBno085_Release(SimBno085_t *sim) {
+    free(sim->trace);
+    sim->trace = NULL;
+    sim->traceCount = 0;
+    free(sim->capture);
+    free(sim->captureData);
+    sim->capture = NULL;
+    sim->captureData = NULL;
+    sim->captureCount = 0;
+}
+
+// Move the virtual clock forward and queue the reports that fell due
+void SimBno085_Advance(SimBno085_t *sim, uint32_t us) {
+    sim->now_us += us;
+    update(sim);
+}
+
+// Transfers waiting for the host
+uint16_t SimBno085_Pending(const SimBno085_t *sim) {
+    return (uint16_t)((sim->head + SIM_QUEUE_LEN - sim->tail) % SIM_QUEUE_LEN);
+}
+
+// Replay a CSV trace (t_ms,Q|G|A,...) instead of the generator
+// Q feeds the game rotation vector, G the calibrated gyro and A linear
+// acceleration; each only while the host has that sensor enabled.
+int SimBno085_LoadTrace(SimBno085_t *sim, const char *path) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    
+    char line[256];
+    int cap = 0;
+    sim->traceCount = 0;
+    while (fgets(line, sizeof line, f) != NULL) {
+        unsigned t;
+        char kind;
+        float v[4] = { 0 };
+        int n = sscanf(line, "%u,%c,%f,%f,%f,%f", &t, &kind, &v[0], &v[1], &v[2], &v[3]);
+        if (n < 5) continue;
+        
+        SimTraceSample_t s = { t * 1000u, 0, { v[0], v[1], v[2], v[3] } };
+        if (kind == 'Q') {
+            // Trace order is real, i, j, k; reports carry i, j, k, real
+            s.sensorId = 0x08;
+            s.v[0] = v[1];
+            s.v[1] = v[2];
+            s.v[2] = v[3];
+            s.v[3] = v[0];
+        } else if (kind == 'G') {
+            s.sensorId = 0x02;
+        } else if (kind == 'A') {
+            s.sensorId = 0x04;
+        } else {
+            continue;
+        }
+        
+        if (sim->traceCount == cap) {
+            cap = cap ? cap * 2 : 4096;
+            sim->trace = realloc(sim->trace, (size_t)cap * sizeof *sim->trace);
+            if (sim->trace == NULL) {
+                perror("realloc");
+                exit(1);
+            }
+        }
+        sim->trace[sim->traceCount++] = s;
+    }
+    fclose(f);
+    sim->traceNext = 0;
+    sim->traceStarted = false;
+    return sim->traceCount;
+}
+
+// Replay a raw transfer capture (shtp_capture.h frames) instead of emulating
+// the hub. The file may be an RTT log with the frames among the debug text:
+// a frame is taken at a sync byte only if its length is plausible and the
+// SHTP header inside repeats it.
+int SimBno085_LoadCapture(SimBno085_t *sim, const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *buf = malloc(size > 0 ? (size_t)size : 1);
+    if (buf == NULL || fread(buf, 1, (size_t)size, f) != (size_t)size) {
+        perror(path);
+        exit(1);
+    }
+    fclose(f);
+    
+    int cap = 0;
+    int lastSeq = -1;
+    uint32_t t0 = 0;
+    sim->captureCount = 0;
+    sim->captureGaps = 0;
+    sim->captureWriteMismatches = 0;
+    
+    long i = 0;
+    while (i + SHTP_CAPTURE_HDR_LEN + SHTP_HDR_LEN <= size) {
+        const uint8_t *p = buf + i;
+        uint16_t lenField = (uint16_t)(p[2] | (p[3] << 8));
+        uint16_t len = lenField & (uint16_t)~SHTP_CAPTURE_WRITE;
+        const uint8_t *data = p + SHTP_CAPTURE_HDR_LEN;
+        if (p[0] != SHTP_CAPTURE_SYNC || len < SHTP_HDR_LEN || len > SH2_HAL_MAX_TRANSFER_IN ||
+            i + SHTP_CAPTURE_HDR_LEN + len > size ||
+            (uint16_t)((data[0] | (data[1] << 8)) & 0x7FFF) != len) {
+            i++;
+            continue;
+        }
+        
+        if (sim->captureCount == cap) {
+            cap = cap ? cap * 2 : 4096;
+            sim->capture = realloc(sim->capture, (size_t)cap * sizeof *sim->capture);
+            if (sim->capture == NULL) {
+                perror("realloc");
+                exit(1);
+            }
+        }
+        if (sim->captureCount == 0) {
+            t0 = get32(p + 4);
+        }
+        if (lastSeq >= 0 && p[1] != (uint8_t)(lastSeq + 1)) {
+            sim->captureGaps++;
+        }
+        lastSeq = p[1];
+        
+        SimCaptureFrame_t *fr = &sim->capture[sim->captureCount++];
+        fr->t_us = get32(p + 4) - t0;
+        fr->offset = (uint32_t)(data - buf);
+        fr->len = len;
+        fr->write = (lenField & SHTP_CAPTURE_WRITE) != 0;
+        i += SHTP_CAPTURE_HDR_LEN + len;
+    }
+    
+    free(sim->captureData);
+    sim->captureData = buf;
+    sim->captureNextRead = 0;
+    sim->captureNextWrite = 0;
+    return sim->captureCount;
+}
@@ -0,0 +1,122 @@
+// sim_bno085.h
+// Simulated BNO085 sensor hub behind an sh2_Hal_t, for host testing
+//
+// Emulates the hub's side of SHTP so the unmodified sh2.c/shtp.c can run on
+// a PC: reset advertisement and reset-complete on open, responses to product
+// ID, get/set feature, command and flush requests, and input report streams
+// at the configured rates. Transfers longer than maxTransferIn are split into
+// SHTP continuation fragments. Report values come from a generator callback,
+// from a CSV trace in the host/replay.c format, or a raw transfer capture
+// from the firmware (shtp_capture.h) is played back byte for byte.
+//
+// Time is virtual: every getTimeUs() call advances it by usPerPoll, and
+// SimBno085_Advance() moves it forward explicitly. Reports that fall due are
+// queued as the clock passes them.
+
+#ifndef SIM_BNO085_H
+#define SIM_BNO085_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "sh2_hal.h"
+
+#define SIM_MAX_SENSORS    0x30  // Sensor IDs handled (0x01 .. 0x2F)
+#define SIM_QUEUE_LEN      1024  // Pending transfers to the host
+#define SIM_MAX_BATCH      16    // Reports per input payload at one instant
+
+// Values of one sensor sample, in sh2_SensorValue_t units
+// (x, y, z[, w]; rotation vectors are i, j, k, real)
+typedef void (SimSampleFn_t)(void *cookie, uint8_t sensorId, uint32_t t_us, float v[4]);
+
+// One SHTP transfer queued for the host
+typedef struct {
+    uint16_t len;
+    uint8_t data[SH2_HAL_MAX_TRANSFER_IN];
+} SimTransfer_t;
+
+// One replayed trace sample
+typedef struct {
+    uint32_t t_us;
+    uint8_t sensorId;
+    float v[4];  // Report order (rotation vectors i, j, k, real)
+} SimTraceSample_t;
+
+// One transfer of a firmware capture (data in SimBno085_t.captureData)
+typedef struct {
+    uint32_t t_us;
+    uint32_t offset;
+    uint16_t len;
+    bool write;  // Host to hub
+} SimCaptureFrame_t;
+
+// Per-sensor stream state
+typedef struct {
+    uint32_t interval_us;  // 0 = disabled
+    uint32_t batch_us;
+    uint32_t sensorSpecific;
+    uint16_t changeSensitivity;
+    uint8_t flags;
+    uint8_t seq;
+    uint32_t next_us;      // Time of the next sample
+} SimSensor_t;
+
+typedef struct {
+    sh2_Hal_t hal;  // Must be first: sh2/shtp hand back this pointer
+
+    // Configuration (set before sh2_open, may change at any time)
+    uint16_t maxTransferIn;  // Largest transfer to the host incl. header (>= 8)
+    uint32_t usPerPoll;      // Virtual time per getTimeUs() call
+    uint16_t writeBusy;      // write() returns 0 this many times before accepting
+    SimSampleFn_t *sampleFn;
+    void *sampleCookie;
+
+    // Virtual clock
+    uint32_t now_us;
+
+    // Streams
+    SimSensor_t sensor[SIM_MAX_SENSORS];
+
+    // Replayed trace (NULL = use sampleFn); time starts at the first Set Feature
+    SimTraceSample_t *trace;
+    int traceCount, traceNext;
+    uint32_t traceStart_us;
+    bool traceStarted;
+
+    // Replayed firmware capture (NULL = emulate the hub); time starts at open
+    SimCaptureFrame_t *capture;
+    uint8_t *captureData;
+    int captureCount, captureNextRead, captureNextWrite;
+    uint32_t captureStart_us;
+    uint32_t captureGaps;            // Sequence gaps (frames the firmware dropped)
+    uint32_t captureWriteMismatches; // Host writes that differ from the captured ones
+
+    // Record transfers in the capture format (NULL = off)
+    FILE *record;
+    uint8_t recordSeq;
+
+    // Transfers to the host
+    SimTransfer_t queue[SIM_QUEUE_LEN];
+    uint16_t head, tail;
+    uint8_t outSeq[8];  // SHTP sequence per channel
+
+    // Stats
+    uint32_t transfersOut;
+    uint32_t bytesOut;
+    uint32_t reportsOut;
+    uint32_t commandsIn;
+    uint32_t queueOverflows;
+    uint32_t badWrites;
+    uint16_t busyLeft;
+    bool isOpen;
+} SimBno085_t;
+
+// Function prototypes
+void SimBno085_Init(SimBno085_t *sim);
+void SimBno085_Release(SimBno085_t *sim);
+void SimBno085_Advance(SimBno085_t *sim, uint32_t us);
+uint16_t SimBno085_Pending(const SimBno085_t *sim);
+int SimBno085_LoadTrace(SimBno085_t *sim, const char *path);
+int SimBno085_LoadCapture(SimBno085_t *sim, const char *path);
+
+#endif // SIM_BNO085_H
@@ -0,0 +1,414 @@
+// sim_stack_test.c
+// Host test and benchmark of the unmodified SH2/SHTP stack (sh2.c, shtp.c)
+// against the simulated BNO085 (sim_bno085.c)
+//
+// Runs the same bring-up as main.c (sh2_open, sensor callback, Set Feature
+// for the game rotation vector, calibrated gyro and linear acceleration) and
+// checks reset/advertisement handling, product IDs, config readback, report
+// delivery, sequence continuity and decoded values. The same checks are
+// repeated with small SHTP fragments and a hub that is busy on writes. A
+// final benchmark streams several sensors at 1 kHz and prints the host time
+// per report and per transfer, the transfer rate the HAL has to sustain and
+// the SPI1 bus load that traffic implies at 1.25MHz.
+//
+// Build and run (from this folder):
+//   gcc -std=c99 -O2 -I.. -o sim_stack_test sim_stack_test.c sim_bno085.c ../sh2.c ../shtp.c ../sh2_util.c ../sh2_SensorValue.c -lm
+//   ./sim_stack_test [seconds] [trace.csv] [--record capture.bin]
+//   ./sim_stack_test --capture capture.bin
+// With a trace (host/replay.c CSV format) the stream checks use its samples.
+// --record first runs the main.c bring-up alone and writes its transfers in
+// the firmware capture format (shtp_capture.h); --capture replays such a
+// capture, or an RTT log holding one, through the stack with the same
+// bring-up, so the host writes of a round trip match the captured ones.
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "sim_bno085.h"
+#include "sh2.h"
+#include "sh2_err.h"
+#include "sh2_SensorValue.h"
+
+#define MAX_SENSOR_ID  0x30
+
+// SPI1 clock of BNO085_SPI_HAL.c (fPCLK/64 at 80MHz), for bus load estimates
+#define SPI_CLOCK_HZ  1250000
+
+static SimBno085_t sim;
+
+// Values generated per sensor, indexed by report sequence number
+static float sent[MAX_SENSOR_ID][256][4];
+static uint8_t sentSeq[MAX_SENSOR_ID];
+
+// Received events per sensor
+typedef struct {
+    uint32_t count;
+    uint32_t seqGaps;
+    uint32_t badValues;
+    uint32_t backwardsTime;
+    int lastSeq;
+    uint64_t lastTimestamp;
+} RxStats_t;
+
+static RxStats_t rx[MAX_SENSOR_ID];
+static bool resetSeen;
+static bool checkValues;
+static int failures;
+static FILE *recordFile;
+
+static void check(bool ok, const char *what) {
+    printf("  %-52s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) failures++;
+}
+
+// Generator that remembers what it sent so decoded values can be checked
+static void sample_fn(void *cookie, uint8_t sensorId, uint32_t t_us, float v[4]) {
+    (void)cookie;
+    float t = (float)t_us * 1e-6f;
+    if (sensorId == SH2_GAME_ROTATION_VECTOR || sensorId == SH2_ROTATION_VECTOR) {
+        float h = 0.3f * t;
+        v[0] = 0.1f * sinf(t);
+        v[1] = 0.0f;
+        v[2] = sinf(h) * sqrtf(0.99f);
+        v[3] = cosf(h) * sqrtf(0.99f);
+    } else {
+        v[0] = 3.0f * sinf(7.0f * t + sensorId);
+        v[1] = 2.0f * cosf(11.0f * t);
+        v[2] = -1.0f + sinf(3.0f * t);
+        v[3] = 0.0f;
+    }
+    memcpy(sent[sensorId][sentSeq[sensorId]++], v, sizeof(float) * 4);
+}
+
+static void event_cb(void *cookie, sh2_AsyncEvent_t *event) {
+    (void)cookie;
+    if (event->eventId == SH2_RESET) {
+        resetSeen = true;
+    }
+}
+
+static void sensor_cb(void *cookie, sh2_SensorEvent_t *event) {
+    (void)cookie;
+    uint8_t id = event->reportId;
+    if (id >= MAX_SENSOR_ID) return;
+    RxStats_t *r = &rx[id];
+    
+    uint8_t seq = event->report[1];
+    if (r->count > 0 && seq != (uint8_t)(r->lastSeq + 1)) r->seqGaps++;
+    if (r->count > 0 && event->timestamp_uS < r->lastTimestamp) r->backwardsTime++;
+    r->lastSeq = seq;
+    r->lastTimestamp = event->timestamp_uS;
+    r->count++;
+    
+    if (!checkValues) return;
+    
+    sh2_SensorValue_t value;
+    sh2_decodeSensorEvent(&value, event);
+    const float *v = sent[id][seq];
+    float got[4] = { 0 }, tol = 0.01f;
+    if (id == SH2_GAME_ROTATION_VECTOR) {
+        got[0] = value.un.gameRotationVector.i;
+        got[1] = value.un.gameRotationVector.j;
+        got[2] = value.un.gameRotationVector.k;
+        got[3] = value.un.gameRotationVector.real;
+        tol = 1.0f / 16384.0f;
+    } else if (id == SH2_GYROSCOPE_CALIBRATED) {
+        got[0] = value.un.gyroscope.x;
+        got[1] = value.un.gyroscope.y;
+        got[2] = value.un.gyroscope.z;
+        tol = 1.0f / 512.0f;
+    } else if (id == SH2_LINEAR_ACCELERATION || id == SH2_ACCELEROMETER) {
+        got[0] = value.un.linearAcceleration.x;  // Same layout as accelerometer
+        got[1] = value.un.linearAcceleration.y;
+        got[2] = value.un.linearAcceleration.z;
+        tol = 1.0f / 256.0f;
+    } else {
+        return;
+    }
+    for (int a = 0; a < 4; a++) {
+        if (fabsf(got[a] - v[a]) > tol) {
+            r->badValues++;
+            break;
+        }
+    }
+}
+
+// Service the stack until the simulated hub has nothing left to send
+static void drain(void) {
+    do {
+        sh2_service();
+    } while (SimBno085_Pending(&sim) > 0);
+}
+
+static int enable(sh2_SensorId_t id, uint32_t interval_us) {
+    sh2_SensorConfig_t config;
+    memset(&config, 0, sizeof config);
+    config.reportInterval_us = interval_us;
+    return sh2_setSensorConfig(id, &config);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Open the stack against a fresh simulated hub
+static int open_stack(uint16_t maxTransferIn, uint16_t writeBusy, const char *tracePath) {
+    SimBno085_Release(&sim);
+    SimBno085_Init(&sim);
+    sim.maxTransferIn = maxTransferIn;
+    sim.writeBusy = writeBusy;
+    sim.sampleFn = sample_fn;
+    sim.record = recordFile;
+    recordFile = NULL;  // First run only
+    if (tracePath != NULL && SimBno085_LoadTrace(&sim, tracePath) <= 0) {
+        return -1;
+    }
+    
+    memset(rx, 0, sizeof rx);
+    memset(sentSeq, 0, sizeof sentSeq);
+    resetSeen = false;
+    
+    int status = sh2_open(&sim.hal, event_cb, NULL);
+    sh2_setSensorCallback(sensor_cb, NULL);
+    return status;
+}
+
+// The requests main.c makes after sh2_open (no product ID or config reads)
+static void enable_main_sensors(void) {
+    const sh2_SensorId_t sensors[3] = { SH2_GAME_ROTATION_VECTOR, SH2_GYROSCOPE_CALIBRATED, SH2_LINEAR_ACCELERATION };
+    for (int s = 0; s < 3; s++) {
+        enable(sensors[s], 10000);
+    }
+}
+
+// Record the main.c bring-up and stream as a firmware capture (run first, so
+// open_stack hands it the record file)
+static void run_record(int seconds, const char *tracePath) {
+    printf("Recording (main.c bring-up, %d s)\n", seconds);
+    
+    int status = open_stack(SH2_HAL_MAX_TRANSFER_IN, 0, tracePath);
+    check(status == SH2_OK && resetSeen, "sh2_open: advertisement and reset complete");
+    enable_main_sensors();
+    checkValues = false;
+    for (int ms = 0; ms < seconds * 1000; ms++) {
+        SimBno085_Advance(&sim, 1000);
+        drain();
+    }
+    
+    sh2_close();
+    if (sim.record != NULL) {
+        fclose(sim.record);
+        sim.record = NULL;
+    }
+    printf("\n");
+}
+
+// Bring-up and streaming checks, as main.c uses the stack
+static void run_functional(const char *name, uint16_t maxTransferIn, uint16_t writeBusy,
+                           int seconds, const char *tracePath) {
+    printf("%s (transfers <= %u bytes, write busy x%u)\n", name, maxTransferIn, writeBusy);
+    
+    int status = open_stack(maxTransferIn, writeBusy, tracePath);
+    check(status == SH2_OK && resetSeen, "sh2_open: advertisement and reset complete");
+    
+    sh2_ProductIds_t ids;
+    memset(&ids, 0, sizeof ids);
+    status = sh2_getProdIds(&ids);
+    check(status == SH2_OK && ids.numEntries == 4 && ids.entry[0].swPartNumber == 10003608,
+          "sh2_getProdIds: 4 entries");
+    
+    const sh2_SensorId_t sensors[3] = { SH2_GAME_ROTATION_VECTOR, SH2_GYROSCOPE_CALIBRATED, SH2_LINEAR_ACCELERATION };
+    bool configOk = true;
+    for (int s = 0; s < 3; s++) {
+        configOk &= (enable(sensors[s], 10000) == SH2_OK);
+    }
+    check(configOk, "sh2_setSensorConfig: GRV, gyro, linear accel at 100Hz");
+    
+    sh2_SensorConfig_t readback;
+    memset(&readback, 0, sizeof readback);
+    status = sh2_getSensorConfig(SH2_GYROSCOPE_CALIBRATED, &readback);
+    check(status == SH2_OK && readback.reportInterval_us == 10000, "sh2_getSensorConfig: interval read back");
+    
+    // Stream, servicing every millisecond like the main loop
+    checkValues = (tracePath == NULL);
+    memset(rx, 0, sizeof rx);
+    for (int ms = 0; ms < seconds * 1000; ms++) {
+        SimBno085_Advance(&sim, 1000);
+        drain();
+    }
+    
+    uint32_t expected = (uint32_t)seconds * 100;
+    bool countOk = true, seqOk = true, valuesOk = true, timeOk = true;
+    for (int s = 0; s < 3; s++) {
+        const RxStats_t *r = &rx[sensors[s]];
+        if (tracePath == NULL) {
+            countOk &= (r->count + 2 >= expected && r->count <= expected + 2);
+        } else {
+            countOk &= (r->count > 0);
+        }
+        seqOk &= (r->seqGaps == 0);
+        valuesOk &= (r->badValues == 0);
+        timeOk &= (r->backwardsTime == 0);
+    }
+    char what[80];
+    snprintf(what, sizeof what, "reports delivered (%u GRV, %u gyro, %u accel)",
+             rx[SH2_GAME_ROTATION_VECTOR].count, rx[SH2_GYROSCOPE_CALIBRATED].count,
+             rx[SH2_LINEAR_ACCELERATION].count);
+    check(countOk, what);
+    check(seqOk, "no report sequence gaps");
+    check(timeOk, "event timestamps non-decreasing");
+    if (checkValues) {
+        check(valuesOk, "decoded values match generated values");
+    }
+    check(sim.queueOverflows == 0 && sim.badWrites == 0, "no hub queue overflows or bad writes");
+    
+    sh2_close();
+    if (sim.record != NULL) {
+        fclose(sim.record);
+        sim.record = NULL;
+    }
+    printf("\n");
+}
+
+// Several sensors at 1 kHz; host cost per report and per transfer
+static void run_throughput(uint16_t maxTransferIn, int seconds) {
+    const sh2_SensorId_t sensors[4] = {
+        SH2_GAME_ROTATION_VECTOR, SH2_GYROSCOPE_CALIBRATED, SH2_LINEAR_ACCELERATION, SH2_ACCELEROMETER
+    };
+    
+    open_stack(maxTransferIn, 0, NULL);
+    for (int s = 0; s < 4; s++) {
+        enable(sensors[s], 1000);
+    }
+    checkValues = false;
+    memset(rx, 0, sizeof rx);
+    drain();
+    uint32_t reports0 = sim.reportsOut, transfers0 = sim.transfersOut, bytes0 = sim.bytesOut;
+    
+    uint64_t t0 = now_ns();
+    for (int ms = 0; ms < seconds * 1000; ms++) {
+        SimBno085_Advance(&sim, 1000);
+        drain();
+    }
+    uint64_t elapsed = now_ns() - t0;
+    
+    uint32_t reports = sim.reportsOut - reports0;
+    uint32_t transfers = sim.transfersOut - transfers0;
+    uint32_t gaps = 0, delivered = 0;
+    for (int s = 0; s < 4; s++) {
+        gaps += rx[sensors[s]].seqGaps;
+        delivered += rx[sensors[s]].count;
+    }
+    
+    uint32_t bytes = sim.bytesOut - bytes0;
+    printf("  %4u B transfers: %6u reports in %6u transfers (%5.0f/s), %4.0f ns/report, %4.0f ns/transfer, "
+           "SPI load %3.0f%%, lost %u, gaps %u\n",
+           maxTransferIn, reports, transfers, (double)transfers / seconds,
+           (double)elapsed / reports, (double)elapsed / transfers,
+           100.0 * bytes * 8.0 / SPI_CLOCK_HZ / seconds, reports - delivered, gaps);
+    if (delivered != reports || gaps != 0) failures++;
+    
+    sh2_close();
+}
+
+// Replay a firmware capture with the main.c bring-up and check the stream
+static void run_capture(const char *path) {
+    SimBno085_Release(&sim);
+    SimBno085_Init(&sim);
+    int frames = SimBno085_LoadCapture(&sim, path);
+    printf("Capture replay: %s (%d transfers, %u sequence gaps)\n", path, frames, sim.captureGaps);
+    if (frames <= 0) {
+        check(false, "capture holds transfers");
+        return;
+    }
+    
+    memset(rx, 0, sizeof rx);
+    resetSeen = false;
+    int status = sh2_open(&sim.hal, event_cb, NULL);
+    check(status == SH2_OK && resetSeen, "sh2_open: advertisement and reset complete");
+    sh2_setSensorCallback(sensor_cb, NULL);
+    
+    // Same requests as main.c; the captured responses answer them
+    enable_main_sensors();
+    
+    // Play out the rest of the capture in 1 ms steps
+    checkValues = false;
+    uint64_t t0 = now_ns();
+    while (sim.captureNextRead < sim.captureCount || SimBno085_Pending(&sim) > 0) {
+        SimBno085_Advance(&sim, 1000);
+        drain();
+    }
+    uint64_t elapsed = now_ns() - t0;
+    
+    uint32_t reports = 0, seqGaps = 0, backwards = 0;
+    for (int id = 1; id < MAX_SENSOR_ID; id++) {
+        const RxStats_t *r = &rx[id];
+        if (r->count == 0) continue;
+        printf("  sensor 0x%02X: %6u reports, %u sequence gaps\n", id, r->count, r->seqGaps);
+        reports += r->count;
+        seqGaps += r->seqGaps;
+        backwards += r->backwardsTime;
+    }
+    if (reports > 0) {
+        printf("  %.0f ns/report host cost, %u host writes differ from the capture\n",
+               (double)elapsed / reports, sim.captureWriteMismatches);
+    }
+    check(reports > 0, "reports delivered");
+    check(seqGaps == 0 || sim.captureGaps > 0, "no report sequence gaps (capture complete)");
+    check(backwards == 0, "event timestamps non-decreasing");
+    check(sim.queueOverflows == 0, "no hub queue overflows");
+    
+    sh2_close();
+    SimBno085_Release(&sim);
+}
+
+int main(int argc, char **argv) {
+    int seconds = 10;
+    const char *tracePath = NULL;
+    const char *capturePath = NULL;
+    int positional = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordFile = fopen(argv[++i], "wb");
+            if (recordFile == NULL) {
+                perror(argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            capturePath = argv[++i];
+        } else if (positional++ == 0) {
+            seconds = atoi(argv[i]);
+        } else {
+            tracePath = argv[i];
+        }
+    }
+    if (seconds <= 0) seconds = 10;
+    
+    if (capturePath != NULL) {
+        run_capture(capturePath);
+        printf("\n%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+        return failures ? 1 : 0;
+    }
+    
+    if (recordFile != NULL) {
+        run_record(seconds, tracePath);
+    }
+    run_functional("Default transfers", SH2_HAL_MAX_TRANSFER_IN, 0, seconds, tracePath);
+    run_functional("Fragmented transfers", 32, 0, seconds, tracePath);
+    run_functional("Tiny fragments, busy hub", 12, 3, seconds, tracePath);
+    
+    printf("Throughput: GRV + gyro + linear accel + accel at 1kHz, %d s\n", seconds);
+    run_throughput(SH2_HAL_MAX_TRANSFER_IN, seconds);
+    run_throughput(64, seconds);
+    run_throughput(32, seconds);
+    
+    printf("\n%s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,355 @@
+// drumsweep.cpp
+// Offline parameter sweep of the hit detector over labelled recordings
+//
+// Runs the firmware's drum_detection.c (one DrumDetector_t per job, as
+// DrumDetection_ProcessSensorData runs on the board) over every recording
+// for each parameter set of a grid or random search, in a work-stealing
+// thread pool (work_pool.hpp). Hits are scored against the labels the same
+// way replay.c does: a hit matches the first unmatched label it falls
+// within [label - early, label + late] of.
+//
+// Usage:
+//   ./drumsweep RECORDING... [--param SPEC ...] [--random N [--seed S]]
+//               [--threads N] [--window early_ms late_ms] [--max-latency-ms L]
+//               [--out results.csv] [--top N] [--list]
+// A RECORDING is a session (.dses, labels in the session) or a replay.c
+// trace given as trace.csv:labels.csv. SPEC is a param_space.hpp axis, for
+// example holdoff=2:10:1 or cymbal_pitch=40,45,50,55.
+//
+// Prints the firmware defaults' score, the precision/recall front (the sets
+// no other set beats on both; at each point the one with the best drum
+// accuracy, then the lowest p90 latency) and the best sets by F1. --out
+// writes every set with its score for plotting the trade-off curves.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "param_space.hpp"
+#include "sweep_trace.hpp"
+#include "work_pool.hpp"
+
+using namespace drumsweep;
+
+struct Hit {
+    int64_t tUs;
+    uint8_t drum;
+};
+
+struct Score {
+    uint32_t labels = 0;
+    uint32_t matched = 0;
+    uint32_t rightDrum = 0;
+    uint32_t extra = 0;
+    double latP50Ms = 0.0;   // Hit time - label time, matched hits
+    double latP90Ms = 0.0;
+    double latMaxMs = 0.0;
+
+    double precision() const { return matched + extra ? (double)matched / (matched + extra) : 0.0; }
+    double recall() const { return labels ? (double)matched / labels : 0.0; }
+    double drumAccuracy() const { return matched ? (double)rightDrum / matched : 0.0; }
+    double f1() const {
+        double p = precision(), r = recall();
+        return p + r > 0.0 ? 2.0 * p * r / (p + r) : 0.0;
+    }
+};
+
+// Per-worker buffers, reused across jobs
+struct Scratch {
+    std::vector<Hit> hits;
+    std::vector<char> used;
+    std::vector<int64_t> latency;
+};
+
+static void usage() {
+    std::fprintf(stderr,
+        "usage: drumsweep RECORDING... [--param SPEC ...] [--random N [--seed S]]\n"
+        "                 [--threads N] [--window early_ms late_ms] [--max-latency-ms L]\n"
+        "                 [--out results.csv] [--top N] [--list]\n"
+        "  RECORDING: session.dses or trace.csv:labels.csv\n"
+        "  SPEC: name=v1,v2,...  name=lo:hi:step  name=lo:hi (random only)\n");
+    std::exit(1);
+}
+
+static void list_params() {
+    ParamSet d = defaultParams();
+    std::printf("%-18s %10s  %s\n", "parameter", "default", "");
+    for (const ParamDef &p : paramDefs()) {
+        std::printf("%-18s %10g  %s\n", p.name, p.get(d), p.help);
+    }
+}
+
+// Run one recording through a fresh detector and collect its hits
+static void detect(const Trace &trace, const ParamSet &params, std::vector<Hit> &hits) {
+    DrumDetector_t det;
+    DrumDetector_Init(&det, &params.thresholds, &params.zones);
+    DrumHitState_t state;
+    std::memset(&state, 0, sizeof(state));
+    state.lastDrumSound = DRUM_NONE;
+    state.lastStrokeType = STROKE_UNKNOWN;
+
+    hits.clear();
+    for (const TraceEvent &e : trace.events) {
+        sh2_SensorValue_t value = e.value;
+        uint8_t drumId = DrumDetector_Process(&det, &value, &state);
+        if (drumId != DRUM_NONE) {
+            hits.push_back(Hit{e.tUs, drumId});
+        }
+    }
+}
+
+// Pair labels and hits in time order (replay.c score())
+static void score(const Trace &trace, int64_t earlyUs, int64_t lateUs, Scratch &s, Score &sc) {
+    const std::vector<Hit> &hits = s.hits;
+    s.used.assign(hits.size(), 0);
+    size_t first = 0;
+
+    for (const TraceLabel &lab : trace.labels) {
+        sc.labels++;
+        while (first < hits.size() && hits[first].tUs + earlyUs < lab.tUs) {
+            first++;
+        }
+        for (size_t h = first; h < hits.size() && hits[h].tUs <= lab.tUs + lateUs; h++) {
+            if (!s.used[h]) {
+                s.used[h] = 1;
+                sc.matched++;
+                sc.rightDrum += (hits[h].drum == lab.drum);
+                s.latency.push_back(hits[h].tUs - lab.tUs);
+                break;
+            }
+        }
+    }
+    for (char u : s.used) {
+        sc.extra += !u;
+    }
+}
+
+static double percentile_ms(std::vector<int64_t> &v, double p) {
+    if (v.empty()) {
+        return 0.0;
+    }
+    size_t i = (size_t)(p * (v.size() - 1) + 0.5);
+    std::nth_element(v.begin(), v.begin() + i, v.end());
+    return v[i] / 1e3;
+}
+
+static Score evaluate(const std::vector<Trace> &traces, const ParamSet &params,
+                      int64_t earlyUs, int64_t lateUs, Scratch &s) {
+    Score sc;
+    s.latency.clear();
+    for (const Trace &t : traces) {
+        detect(t, params, s.hits);
+        score(t, earlyUs, lateUs, s, sc);
+    }
+    sc.latP50Ms = percentile_ms(s.latency, 0.5);
+    sc.latP90Ms = percentile_ms(s.latency, 0.9);
+    sc.latMaxMs = percentile_ms(s.latency, 1.0);
+    return sc;
+}
+
+static void print_header(const ParamSpace &space) {
+    std::printf("  %6s %6s %6s %7s %7s %6s", "recall", "prec", "drum", "p50 ms", "p90 ms", "F1");
+    for (size_t a = 0; a < space.axisCount(); a++) {
+        std::printf("  %s", space.axis(a).name);
+    }
+    std::printf("\n");
+}
+
+static void print_row(const ParamSpace &space, const ParamSet &p, const Score &sc) {
+    std::printf("  %5.1f%% %5.1f%% %5.1f%% %7.1f %7.1f %6.3f", 100.0 * sc.recall(), 100.0 * sc.precision(),
+                100.0 * sc.drumAccuracy(), sc.latP50Ms, sc.latP90Ms, sc.f1());
+    for (size_t a = 0; a < space.axisCount(); a++) {
+        std::printf("  %g", space.axis(a).get(p));
+    }
+    std::printf("\n");
+}
+
+static bool write_csv(const std::string &path, const ParamSpace &space,
+                      const std::vector<ParamSet> &sets, const std::vector<Score> &scores) {
+    FILE *f = std::fopen(path.c_str(), "w");
+    if (f == nullptr) {
+        std::perror(path.c_str());
+        return false;
+    }
+    std::fprintf(f, "config");
+    for (size_t a = 0; a < space.axisCount(); a++) {
+        std::fprintf(f, ",%s", space.axis(a).name);
+    }
+    std::fprintf(f, ",labels,matched,missed,extra,wrong_drum,precision,recall,drum_accuracy,f1,"
+                    "latency_p50_ms,latency_p90_ms,latency_max_ms\n");
+    for (size_t i = 0; i < sets.size(); i++) {
+        const Score &sc = scores[i];
+        std::fprintf(f, "%zu", i);
+        for (size_t a = 0; a < space.axisCount(); a++) {
+            std::fprintf(f, ",%g", space.axis(a).get(sets[i]));
+        }
+        std::fprintf(f, ",%u,%u,%u,%u,%u,%.4f,%.4f,%.4f,%.4f,%.2f,%.2f,%.2f\n",
+                     sc.labels, sc.matched, sc.labels - sc.matched, sc.extra, sc.matched - sc.rightDrum,
+                     sc.precision(), sc.recall(), sc.drumAccuracy(), sc.f1(),
+                     sc.latP50Ms, sc.latP90Ms, sc.latMaxMs);
+    }
+    return std::fclose(f) == 0;
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> recordings;
+    ParamSpace space;
+    size_t randomCount = 0, top = 10;
+    uint64_t seed = 1;
+    unsigned threads = std::thread::hardware_concurrency();
+    int64_t earlyUs = 100000, lateUs = 50000;
+    double maxLatencyMs = -1.0;
+    std::string outPath, err;
+
+    for (int a = 1; a < argc; a++) {
+        std::string arg = argv[a];
+        bool more = a + 1 < argc;
+        if (arg == "--param" && more) {
+            if (!space.add(argv[++a], err)) {
+                std::fprintf(stderr, "drumsweep: %s\n", err.c_str());
+                return 1;
+            }
+        } else if (arg == "--random" && more) {
+            randomCount = std::strtoul(argv[++a], nullptr, 10);
+        } else if (arg == "--seed" && more) {
+            seed = std::strtoull(argv[++a], nullptr, 10);
+        } else if (arg == "--threads" && more) {
+            threads = (unsigned)std::atoi(argv[++a]);
+        } else if (arg == "--window" && a + 2 < argc) {
+            earlyUs = (int64_t)(std::atof(argv[++a]) * 1000);
+            lateUs = (int64_t)(std::atof(argv[++a]) * 1000);
+        } else if (arg == "--max-latency-ms" && more) {
+            maxLatencyMs = std::atof(argv[++a]);
+        } else if (arg == "--out" && more) {
+            outPath = argv[++a];
+        } else if (arg == "--top" && more) {
+            top = std::strtoul(argv[++a], nullptr, 10);
+        } else if (arg == "--list") {
+            list_params();
+            return 0;
+        } else if (arg[0] != '-') {
+            recordings.push_back(arg);
+        } else {
+            usage();
+        }
+    }
+    if (recordings.empty()) {
+        usage();
+    }
+
+    // Load and decode every recording once; jobs only read them
+    std::vector<Trace> traces(recordings.size());
+    size_t events = 0, labels = 0;
+    for (size_t i = 0; i < recordings.size(); i++) {
+        const std::string &r = recordings[i];
+        size_t colon = r.rfind(':');
+        bool ok = (r.size() > 5 && r.compare(r.size() - 5, 5, ".dses") == 0)
+                      ? loadSession(r, traces[i], err)
+                      : loadCsvTrace(r.substr(0, colon), colon == std::string::npos ? "" : r.substr(colon + 1),
+                                     traces[i], err);
+        if (!ok) {
+            std::fprintf(stderr, "drumsweep: %s\n", err.c_str());
+            return 1;
+        }
+        if (traces[i].labels.empty()) {
+            std::fprintf(stderr, "drumsweep: %s has no labels; recall cannot be scored\n", r.c_str());
+        }
+        events += traces[i].events.size();
+        labels += traces[i].labels.size();
+    }
+
+    ParamSet base = defaultParams();
+    std::vector<ParamSet> sets;
+    if (randomCount > 0) {
+        sets = space.random(base, randomCount, seed);
+    } else if (space.gridSize() == 0.0) {
+        std::fprintf(stderr, "drumsweep: lo:hi ranges need a step for a grid, or use --random N\n");
+        return 1;
+    } else if (space.gridSize() > 5e6) {
+        std::fprintf(stderr, "drumsweep: grid has %.0f sets; narrow it or use --random N\n", space.gridSize());
+        return 1;
+    } else {
+        sets = space.grid(base);
+    }
+
+    WorkPool pool(threads);
+    std::printf("%zu recordings, %zu sensor reports, %zu labels; %zu parameter sets on %u threads\n",
+                traces.size(), events, labels, sets.size(), pool.threads());
+
+    std::vector<Scratch> scratch(pool.threads());
+    Score defaults = evaluate(traces, base, earlyUs, lateUs, scratch[0]);
+
+    std::vector<Score> scores(sets.size());
+    auto t0 = std::chrono::steady_clock::now();
+    pool.run(sets.size(), [&](size_t i, unsigned worker) {
+        scores[i] = evaluate(traces, sets[i], earlyUs, lateUs, scratch[worker]);
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::printf("Done in %.2f s: %.0f sets/s, %.1f M reports/s, %llu steals\n", seconds,
+                sets.size() / seconds, (double)events * sets.size() / seconds / 1e6,
+                (unsigned long long)pool.steals());
+
+    std::printf("\nFirmware defaults (window -%lld/+%lld ms)\n",
+                (long long)(earlyUs / 1000), (long long)(lateUs / 1000));
+    print_header(space);
+    print_row(space, base, defaults);
+
+    // Candidates under the latency budget
+    std::vector<size_t> order;
+    for (size_t i = 0; i < sets.size(); i++) {
+        if (maxLatencyMs < 0.0 || scores[i].latP90Ms <= maxLatencyMs) {
+            order.push_back(i);
+        }
+    }
+
+    // Precision/recall front: by recall (best first), then precision, then
+    // latency; keep a set only if its precision beats every set before it
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        const Score &x = scores[a], &y = scores[b];
+        if (x.recall() != y.recall()) return x.recall() > y.recall();
+        if (x.precision() != y.precision()) return x.precision() > y.precision();
+        if (x.drumAccuracy() != y.drumAccuracy()) return x.drumAccuracy() > y.drumAccuracy();
+        return x.latP90Ms < y.latP90Ms;
+    });
+    std::vector<size_t> front;
+    double bestPrecision = -1.0;
+    for (size_t i : order) {
+        if (scores[i].precision() > bestPrecision) {
+            front.push_back(i);
+            bestPrecision = scores[i].precision();
+        }
+    }
+
+    std::printf("\nPrecision/recall front (%zu of %zu sets", front.size(), order.size());
+    if (maxLatencyMs >= 0.0) {
+        std::printf(" with p90 latency <= %.1f ms", maxLatencyMs);
+    }
+    std::printf(")\n");
+    print_header(space);
+    for (size_t i : front) {
+        print_row(space, sets[i], scores[i]);
+    }
+
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        const Score &x = scores[a], &y = scores[b];
+        if (x.f1() != y.f1()) return x.f1() > y.f1();
+        if (x.drumAccuracy() != y.drumAccuracy()) return x.drumAccuracy() > y.drumAccuracy();
+        return x.latP90Ms < y.latP90Ms;
+    });
+    std::printf("\nBest %zu by F1\n", std::min(top, order.size()));
+    print_header(space);
+    for (size_t k = 0; k < order.size() && k < top; k++) {
+        print_row(space, sets[order[k]], scores[order[k]]);
+    }
+
+    if (!outPath.empty() && !write_csv(outPath, space, sets, scores)) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,206 @@
+// param_space.cpp
+// Sweep parameter definitions and search spaces
+
+#include "param_space.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+namespace drumsweep {
+
+ParamSet defaultParams() {
+    ParamSet p;
+    p.thresholds.version = DRUM_THRESHOLDS_VERSION;
+    p.thresholds.gyroHit = GYRO_HIT_THRESHOLD;
+    OnsetDetector_DefaultParams(&p.thresholds.onset);
+    DrumDetection_DefaultZones(&p.zones);
+    return p;
+}
+
+#define INT_PARAM(name, field, lo, hi, help) \
+    {name, help, true, lo, hi, \
+     [](const ParamSet &p) { return (double)p.field; }, \
+     [](ParamSet &p, double v) { p.field = (decltype(p.field))std::lround(v); }}
+
+#define FLOAT_PARAM(name, field, lo, hi, help) \
+    {name, help, false, lo, hi, \
+     [](const ParamSet &p) { return (double)p.field; }, \
+     [](ParamSet &p, double v) { p.field = (float)v; }}
+
+const std::vector<ParamDef> &paramDefs() {
+    static const std::vector<ParamDef> defs = {
+        INT_PARAM("gyro_hit", thresholds.gyroHit, -32768, 0,
+                  "gyro_y hit threshold, rad/s*1000 (DRUM_USE_FUSED_ONSET 0 builds)"),
+        INT_PARAM("swing_min", thresholds.onset.swingMin, 0, 100000,
+                  "peak angular speed that counts as a swing, rad/s*1000"),
+        INT_PARAM("decel_min", thresholds.onset.decelMin, 0, 100000,
+                  "minimum drop in angular speed between gyro samples"),
+        INT_PARAM("jerk_min", thresholds.onset.jerkMin, 0, 100000,
+                  "minimum change in linear acceleration, m/s^2*100"),
+        INT_PARAM("score_min", thresholds.onset.scoreMin, 0, 200000,
+                  "decel + jerk must reach this"),
+        INT_PARAM("rearm_speed", thresholds.onset.rearmSpeed, 0, 100000,
+                  "angular speed below which the detector re-arms"),
+        INT_PARAM("holdoff", thresholds.onset.holdoffSamples, 0, 255,
+                  "refractory time after a hit, gyro samples"),
+        FLOAT_PARAM("snare_yaw_min", zones.snareYawMin, 0, 360, "snare zone start, degrees"),
+        FLOAT_PARAM("snare_yaw_max", zones.snareYawMax, 0, 360, "snare zone end"),
+        FLOAT_PARAM("high_tom_yaw_min", zones.highTomYawMin, 0, 360, "high tom/crash zone start (runs through 0)"),
+        FLOAT_PARAM("mid_tom_yaw_min", zones.midTomYawMin, 0, 360, "mid tom/ride zone start"),
+        FLOAT_PARAM("low_tom_yaw_min", zones.lowTomYawMin, 0, 360, "low tom/ride zone start"),
+        FLOAT_PARAM("cymbal_pitch", zones.cymbalPitch, -90, 90, "crash/ride above this pitch"),
+        FLOAT_PARAM("low_cymbal_pitch", zones.lowCymbalPitch, -90, 90, "ride above this pitch in the low tom zone"),
+    };
+    return defs;
+}
+
+static bool parse_number(const std::string &s, double &v) {
+    char *end;
+    v = std::strtod(s.c_str(), &end);
+    return !s.empty() && *end == '\0';
+}
+
+bool ParamSpace::add(const std::string &spec, std::string &err) {
+    size_t eq = spec.find('=');
+    std::string name = spec.substr(0, eq);
+    const ParamDef *def = nullptr;
+    for (const ParamDef &d : paramDefs()) {
+        if (name == d.name) {
+            def = &d;
+        }
+    }
+    if (def == nullptr || eq == std::string::npos) {
+        err = "unknown parameter or missing '=': " + spec;
+        return false;
+    }
+    for (const Axis &a : axes_) {
+        if (a.def == def) {
+            err = "parameter given twice: " + name;
+            return false;
+        }
+    }
+
+    Axis axis;
+    axis.def = def;
+    std::string body = spec.substr(eq + 1);
+    std::vector<std::string> parts;
+    char sep = (body.find(':') != std::string::npos) ? ':' : ',';
+    for (size_t start = 0;;) {
+        size_t end = body.find(sep, start);
+        parts.push_back(body.substr(start, end - start));
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+
+    std::vector<double> nums;
+    for (const std::string &p : parts) {
+        double v;
+        if (!parse_number(p, v)) {
+            err = "bad number '" + p + "' in " + spec;
+            return false;
+        }
+        nums.push_back(v);
+    }
+
+    if (sep == ',') {
+        axis.values = nums;
+    } else if (nums.size() == 2 || nums.size() == 3) {
+        axis.lo = nums[0];
+        axis.hi = nums[1];
+        if (axis.hi < axis.lo) {
+            err = "empty range in " + spec;
+            return false;
+        }
+        if (nums.size() == 3) {
+            double step = nums[2];
+            if (step <= 0.0) {
+                err = "step must be positive in " + spec;
+                return false;
+            }
+            // A little slack so that 0:1:0.1 includes 1
+            for (double v = axis.lo; v <= axis.hi + step * 1e-9; v += step) {
+                axis.values.push_back(v);
+            }
+        }
+    } else {
+        err = "expected lo:hi or lo:hi:step in " + spec;
+        return false;
+    }
+
+    for (double v : axis.values.empty() ? std::vector<double>{axis.lo, axis.hi} : axis.values) {
+        if (v < def->lo || v > def->hi) {
+            err = name + " is limited to " + std::to_string(def->lo) + ".." + std::to_string(def->hi);
+            return false;
+        }
+    }
+    axes_.push_back(axis);
+    return true;
+}
+
+double ParamSpace::gridSize() const {
+    double n = 1.0;
+    for (const Axis &a : axes_) {
+        n *= (double)a.values.size();
+    }
+    return n;
+}
+
+std::vector<ParamSet> ParamSpace::grid(const ParamSet &base) const {
+    std::vector<ParamSet> out;
+    if (gridSize() == 0.0) {
+        return out;
+    }
+
+    // Odometer over the axes, last axis fastest
+    std::vector<size_t> at(axes_.size(), 0);
+    for (;;) {
+        ParamSet p = base;
+        for (size_t i = 0; i < axes_.size(); i++) {
+            axes_[i].def->set(p, axes_[i].values[at[i]]);
+        }
+        out.push_back(p);
+
+        size_t i = axes_.size();
+        while (i > 0) {
+            i--;
+            if (++at[i] < axes_[i].values.size()) {
+                break;
+            }
+            at[i] = 0;
+            if (i == 0) {
+                return out;
+            }
+        }
+        if (axes_.empty()) {
+            return out;
+        }
+    }
+}
+
+std::vector<ParamSet> ParamSpace::random(const ParamSet &base, size_t n, uint64_t seed) const {
+    std::mt19937_64 rng(seed);
+    std::vector<ParamSet> out;
+    out.reserve(n);
+    for (size_t k = 0; k < n; k++) {
+        ParamSet p = base;
+        for (const Axis &a : axes_) {
+            double v;
+            if (!a.values.empty()) {
+                v = a.values[std::uniform_int_distribution<size_t>(0, a.values.size() - 1)(rng)];
+            } else if (a.def->integer) {
+                v = (double)std::uniform_int_distribution<long>(std::lround(std::ceil(a.lo)),
+                                                                std::lround(std::floor(a.hi)))(rng);
+            } else {
+                v = std::uniform_real_distribution<double>(a.lo, a.hi)(rng);
+            }
+            a.def->set(p, v);
+        }
+        out.push_back(p);
+    }
+    return out;
+}
+
+}  // namespace drumsweep
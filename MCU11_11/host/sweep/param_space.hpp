@@ -0,0 +1,75 @@
+// param_space.hpp
+// Detection parameters a sweep can vary, and grid / random search over them
+//
+// A parameter set is the DrumThresholds_t the link can set on the board plus
+// the hand-tuned zone layout (DrumZoneLayout_t). Each axis names one field:
+//
+//   name=v1,v2,...    these values
+//   name=lo:hi:step   lo, lo+step, ... up to hi
+//   name=lo:hi        any value in [lo, hi] (random search only)
+//
+// grid() is the Cartesian product of all axes; random(n) draws n sets with
+// every axis sampled independently (integer fields are rounded). Fields
+// without an axis keep the base values (the firmware defaults).
+
+#ifndef PARAM_SPACE_HPP
+#define PARAM_SPACE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "drum_detection.h"
+}
+
+namespace drumsweep {
+
+struct ParamSet {
+    DrumThresholds_t thresholds;
+    DrumZoneLayout_t zones;
+};
+
+// Firmware defaults
+ParamSet defaultParams();
+
+struct ParamDef {
+    const char *name;
+    const char *help;
+    bool integer;
+    double lo, hi;  // Field range
+    double (*get)(const ParamSet &p);
+    void (*set)(ParamSet &p, double v);
+};
+
+// All parameters, for --list
+const std::vector<ParamDef> &paramDefs();
+
+class ParamSpace {
+public:
+    // Add an axis from a "name=..." spec
+    bool add(const std::string &spec, std::string &err);
+
+    size_t axisCount() const { return axes_.size(); }
+    const ParamDef &axis(size_t i) const { return *axes_[i].def; }
+
+    // Number of grid points (0 if a range axis has no step)
+    double gridSize() const;
+
+    std::vector<ParamSet> grid(const ParamSet &base) const;
+    std::vector<ParamSet> random(const ParamSet &base, size_t n, uint64_t seed) const;
+
+private:
+    struct Axis {
+        const ParamDef *def;
+        std::vector<double> values;  // Listed or stepped values
+        double lo = 0.0, hi = 0.0;   // Continuous range when values is empty
+    };
+
+    std::vector<Axis> axes_;
+};
+
+}  // namespace drumsweep
+
+#endif  // PARAM_SPACE_HPP
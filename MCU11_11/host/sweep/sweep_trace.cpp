@@ -0,0 +1,203 @@
+// sweep_trace.cpp
+// Loading labelled recordings for the parameter sweep
+
+#include "sweep_trace.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../session/session_file.hpp"
+
+namespace drumsweep {
+
+static const char *drumNames[] = {
+    "SNARE", "HIHAT", "KICK", "HIGH_TOM", "MID_TOM", "CRASH", "RIDE", "LOW_TOM"
+};
+static const int numDrums = DRUM_LOW_TOM + 1;
+
+int parseDrum(const char *s) {
+    while (*s == ' ') s++;
+    for (int d = 0; d < numDrums; d++) {
+        size_t n = std::strlen(drumNames[d]);
+        if (std::strncmp(s, drumNames[d], n) == 0 && (s[n] == '\0' || std::strchr(" \t\r\n", s[n]))) {
+            return d;
+        }
+    }
+    if (*s >= '0' && *s <= '9') {
+        int d = std::atoi(s);
+        return d < numDrums ? d : -1;
+    }
+    return -1;
+}
+
+const char *drumName(uint8_t drum) {
+    return drum < numDrums ? drumNames[drum] : "NONE";
+}
+
+// One report in sh2_SensorValue_t units, as sh2_decodeSensorEvent() fills it
+static TraceEvent make_event(int64_t tUs, uint8_t sensorId, uint8_t seq, const float *v) {
+    TraceEvent e;
+    std::memset(&e, 0, sizeof(e));
+    e.tUs = tUs;
+    e.value.sensorId = sensorId;
+    e.value.sequence = seq;
+    e.value.timestamp = (uint64_t)tUs;
+    switch (sensorId) {
+    case SH2_GAME_ROTATION_VECTOR:
+        e.value.un.gameRotationVector.real = v[0];
+        e.value.un.gameRotationVector.i = v[1];
+        e.value.un.gameRotationVector.j = v[2];
+        e.value.un.gameRotationVector.k = v[3];
+        break;
+    case SH2_GYROSCOPE_CALIBRATED:
+        e.value.un.gyroscope.x = v[0];
+        e.value.un.gyroscope.y = v[1];
+        e.value.un.gyroscope.z = v[2];
+        break;
+    default:
+        e.value.un.linearAcceleration.x = v[0];
+        e.value.un.linearAcceleration.y = v[1];
+        e.value.un.linearAcceleration.z = v[2];
+        break;
+    }
+    return e;
+}
+
+bool loadSession(const std::string &path, Trace &trace, std::string &err) {
+    drumsession::SessionReader r;
+    if (!r.open(path, err)) {
+        return false;
+    }
+    r.adviseSequential();
+
+    trace.name = path;
+    trace.events.clear();
+    trace.labels.clear();
+    trace.events.reserve(r.rowCount() * 3 / 2);
+
+    // Rows repeat the latest quaternion and acceleration; a report is only
+    // emitted where the value changes (the defaults are the row builder's)
+    drumsession::Quat lastQuat = {1.0f, 0.0f, 0.0f, 0.0f};
+    drumsession::Vec3 lastAccel = {0.0f, 0.0f, 0.0f};
+    uint8_t seq[3] = {0, 0, 0};
+
+    for (size_t c = 0; c < r.chunkCount(); c++) {
+        drumsession::ChunkView v = r.chunk(c);
+        for (size_t i = 0; i < v.rows; i++) {
+            int64_t t = v.t[i];
+            const drumsession::Quat &q = v.quat[i];
+            const drumsession::Vec3 &a = v.accel[i];
+            const drumsession::Vec3 &g = v.gyro[i];
+
+            if (std::memcmp(&q, &lastQuat, sizeof(q)) != 0) {
+                float f[4] = {q.w, q.x, q.y, q.z};
+                trace.events.push_back(make_event(t, SH2_GAME_ROTATION_VECTOR, seq[0]++, f));
+                lastQuat = q;
+            }
+            if (std::memcmp(&a, &lastAccel, sizeof(a)) != 0) {
+                float f[3] = {a.x, a.y, a.z};
+                trace.events.push_back(make_event(t, SH2_LINEAR_ACCELERATION, seq[1]++, f));
+                lastAccel = a;
+            }
+            float f[3] = {g.x, g.y, g.z};
+            trace.events.push_back(make_event(t, SH2_GYROSCOPE_CALIBRATED, seq[2]++, f));
+
+            if (v.label[i] != SESSION_LABEL_NONE) {
+                trace.labels.push_back(TraceLabel{t, v.label[i]});
+            }
+        }
+    }
+    return true;
+}
+
+// Round a value to the hub's fixed point (quaternion Q14, gyro Q9, linear
+// acceleration Q8), as replay.c does by encoding each sample as an SH2 report
+static void quantise(float *v, int n, float scale) {
+    for (int i = 0; i < n; i++) {
+        float raw = std::round(v[i] * scale);
+        raw = std::min(std::max(raw, -32768.0f), 32767.0f);
+        v[i] = raw / scale;
+    }
+}
+
+static bool load_labels(const std::string &path, Trace &trace, std::string &err) {
+    FILE *f = std::fopen(path.c_str(), "r");
+    if (f == nullptr) {
+        err = path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    char line[256];
+    int lineNo = 0;
+    while (std::fgets(line, sizeof line, f) != nullptr) {
+        lineNo++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+        const char *comma = std::strchr(line, ',');
+        int drum = comma ? parseDrum(comma + 1) : -1;
+        if (drum < 0) {
+            std::fprintf(stderr, "%s:%d: bad label, skipped\n", path.c_str(), lineNo);
+            continue;
+        }
+        trace.labels.push_back(TraceLabel{(int64_t)std::strtoul(line, nullptr, 10) * 1000, (uint8_t)drum});
+    }
+    std::fclose(f);
+
+    std::stable_sort(trace.labels.begin(), trace.labels.end(),
+                     [](const TraceLabel &a, const TraceLabel &b) { return a.tUs < b.tUs; });
+    return true;
+}
+
+bool loadCsvTrace(const std::string &path, const std::string &labelPath, Trace &trace, std::string &err) {
+    FILE *f = std::fopen(path.c_str(), "r");
+    if (f == nullptr) {
+        err = path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    trace.name = path;
+    trace.events.clear();
+    trace.labels.clear();
+
+    char line[512];
+    int lineNo = 0;
+    uint8_t seq[3] = {0, 0, 0};
+    while (std::fgets(line, sizeof line, f) != nullptr) {
+        lineNo++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+        unsigned t;
+        char kind;
+        float v[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        int n = std::sscanf(line, "%u,%c,%f,%f,%f,%f", &t, &kind, &v[0], &v[1], &v[2], &v[3]);
+        if (n < 5 || (kind == 'Q' && n != 6) || !std::strchr("QGA", kind)) {
+            if (n >= 2 && std::isdigit((unsigned char)line[0])) {
+                std::fprintf(stderr, "%s:%d: unrecognised sample, skipped\n", path.c_str(), lineNo);
+            }
+            continue;
+        }
+        int64_t tUs = (int64_t)t * 1000;
+        if (kind == 'Q') {
+            quantise(v, 4, 16384.0f);
+            trace.events.push_back(make_event(tUs, SH2_GAME_ROTATION_VECTOR, seq[0]++, v));
+        } else if (kind == 'A') {
+            quantise(v, 3, 256.0f);
+            trace.events.push_back(make_event(tUs, SH2_LINEAR_ACCELERATION, seq[1]++, v));
+        } else {
+            quantise(v, 3, 512.0f);
+            trace.events.push_back(make_event(tUs, SH2_GYROSCOPE_CALIBRATED, seq[2]++, v));
+        }
+    }
+    std::fclose(f);
+
+    return labelPath.empty() || load_labels(labelPath, trace, err);
+}
+
+}  // namespace drumsweep
@@ -0,0 +1,58 @@
+// sweep_trace.hpp
+// Labelled sensor recordings, decoded once and shared by every sweep job
+//
+// A Trace is the sensor report sequence of one session as sh2_SensorValue_t
+// (what DrumDetector_Process() takes on the board) plus its hit labels.
+// Loading does all parsing up front, so a sweep job is only the detector
+// loop over a read-only array.
+//
+// Inputs:
+//   .dses  a session (host/session), one row per gyro report. A row's
+//          quaternion and acceleration are the latest values, so they are
+//          turned back into reports only where they change; labels come
+//          from the label column.
+//   .csv   a replay.c trace (t_ms,Q|G|A,...) with a separate label file
+//          (t_ms,DRUM), as written by replay --synth --dump.
+
+#ifndef SWEEP_TRACE_HPP
+#define SWEEP_TRACE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "drum_detection.h"
+}
+
+namespace drumsweep {
+
+struct TraceEvent {
+    int64_t tUs;
+    sh2_SensorValue_t value;
+};
+
+struct TraceLabel {
+    int64_t tUs;
+    uint8_t drum;
+};
+
+struct Trace {
+    std::string name;
+    std::vector<TraceEvent> events;
+    std::vector<TraceLabel> labels;  // Ascending time
+};
+
+// .dses session with its label column
+bool loadSession(const std::string &path, Trace &trace, std::string &err);
+
+// replay.c CSV trace; labelPath may be empty (no labels)
+bool loadCsvTrace(const std::string &path, const std::string &labelPath, Trace &trace, std::string &err);
+
+// DRUM_* from a name such as SNARE or a number, -1 if neither
+int parseDrum(const char *s);
+const char *drumName(uint8_t drum);
+
+}  // namespace drumsweep
+
+#endif  // SWEEP_TRACE_HPP
@@ -0,0 +1,100 @@
+// work_pool.cpp
+// Work-stealing thread pool implementation
+
+#include "work_pool.hpp"
+
+#include <thread>
+
+namespace drumsweep {
+
+WorkPool::WorkPool(unsigned threads) : threads_(threads ? threads : 1) {
+    for (unsigned i = 0; i < threads_; i++) {
+        slices_.push_back(std::make_unique<Slice>());
+    }
+}
+
+void WorkPool::run(size_t count, const std::function<void(size_t, unsigned)> &fn) {
+    steals_ = 0;
+    for (unsigned i = 0; i < threads_; i++) {
+        slices_[i]->next = count * i / threads_;
+        slices_[i]->end = count * (i + 1) / threads_;
+    }
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads_; i++) {
+        pool.emplace_back(&WorkPool::worker, this, i, std::cref(fn));
+    }
+    worker(0, fn);
+    for (std::thread &t : pool) {
+        t.join();
+    }
+}
+
+void WorkPool::worker(unsigned self, const std::function<void(size_t, unsigned)> &fn) {
+    size_t index;
+    for (;;) {
+        while (take(self, index)) {
+            fn(index, self);
+        }
+        if (!steal(self)) {
+            return;
+        }
+    }
+}
+
+// Next index of this worker's own slice
+bool WorkPool::take(unsigned self, size_t &index) {
+    Slice &s = *slices_[self];
+    std::lock_guard<std::mutex> g(s.lock);
+    if (s.next >= s.end) {
+        return false;
+    }
+    index = s.next++;
+    return true;
+}
+
+// Move the back half of the largest other slice into this worker's slice
+// Returns false when no work is left anywhere. Work is only ever moved
+// between slices, never added, so an empty scan means the run is done (a
+// thief holding a stolen range it has not stored yet finishes it itself).
+bool WorkPool::steal(unsigned self) {
+    for (;;) {
+        unsigned victim = self;
+        size_t most = 0;
+        for (unsigned i = 0; i < threads_; i++) {
+            if (i == self) {
+                continue;
+            }
+            Slice &s = *slices_[i];
+            std::lock_guard<std::mutex> g(s.lock);
+            if (s.end > s.next && s.end - s.next > most) {
+                most = s.end - s.next;
+                victim = i;
+            }
+        }
+        if (victim == self) {
+            return false;
+        }
+
+        size_t first, end;
+        {
+            Slice &v = *slices_[victim];
+            std::lock_guard<std::mutex> g(v.lock);
+            if (v.next >= v.end) {
+                continue;  // Drained since the scan; look again
+            }
+            end = v.end;
+            first = v.end - (v.end - v.next + 1) / 2;
+            v.end = first;
+        }
+
+        Slice &s = *slices_[self];
+        std::lock_guard<std::mutex> g(s.lock);
+        s.next = first;
+        s.end = end;
+        steals_++;
+        return true;
+    }
+}
+
+}  // namespace drumsweep
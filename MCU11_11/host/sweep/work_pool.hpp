@@ -0,0 +1,56 @@
+// work_pool.hpp
+// Work-stealing thread pool for independent, indexed jobs
+//
+// run(count, fn) calls fn(index, worker) once for every index in [0, count)
+// and returns when all calls have finished. Each worker starts with an equal
+// slice of the indices and takes them from the front of its own slice. A
+// worker that runs out steals the back half of the largest remaining slice,
+// so jobs of uneven cost (a config that fires thousands of hits, a longer
+// session) still keep every thread busy to the end. Slices are guarded by a
+// mutex per worker; jobs here take milliseconds, so the lock is never the
+// cost.
+
+#ifndef WORK_POOL_HPP
+#define WORK_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace drumsweep {
+
+class WorkPool {
+public:
+    explicit WorkPool(unsigned threads);
+
+    unsigned threads() const { return threads_; }
+
+    // Calls fn(index, worker) for every index in [0, count), in parallel
+    void run(size_t count, const std::function<void(size_t, unsigned)> &fn);
+
+    // Slices stolen during the last run()
+    uint64_t steals() const { return steals_.load(); }
+
+private:
+    struct Slice {
+        std::mutex lock;
+        size_t next = 0;
+        size_t end = 0;
+    };
+
+    void worker(unsigned self, const std::function<void(size_t, unsigned)> &fn);
+    bool take(unsigned self, size_t &index);
+    bool steal(unsigned self);
+
+    unsigned threads_;
+    std::vector<std::unique_ptr<Slice>> slices_;
+    std::atomic<uint64_t> steals_{0};
+};
+
+}  // namespace drumsweep
+
+#endif  // WORK_POOL_HPP
@@ -0,0 +1,280 @@
+#!/usr/bin/env python3
+# train_classifier.py
+# Offline trainer for the table-driven hit classifier (drum_classifier.c)
+#
+# Reads labelled strokes, trains a small CART decision tree on the same
+# fixed-point features the firmware uses, reports held-out accuracy against the
+# hand-tuned if/else zone rules, and exports the tree as const tables in
+# drum_classifier_model.h.
+#
+# Input: one stroke per line, either
+#   STROKE,<yaw>,<pitch>,<gyro_y>,<label>     (firmware log with
+#                                             DRUM_DETECTION_LOG_STROKES=1,
+#                                             label appended while recording)
+#   <yaw>,<pitch>,<gyro_y>,<label>            (plain CSV, optional header)
+# yaw/pitch in degrees, gyro_y in rad/s * 1000, label a drum name or ID.
+#
+# Usage:
+#   python3 train_classifier.py strokes.csv [--max-depth 6] [--min-leaf 3]
+#                               [--folds 5] [--out ../drum_classifier_model.h]
+#
+# No third-party packages required.
+
+import argparse
+import random
+import sys
+
+DRUM_NAMES = ["SNARE", "HIHAT", "KICK", "HIGH_TOM", "MID_TOM", "CRASH", "RIDE", "LOW_TOM"]
+DRUM_NONE = 255
+
+FEATURE_NAMES = ["DRUM_FEATURE_YAW", "DRUM_FEATURE_PITCH", "DRUM_FEATURE_GYRO_Y"]
+
+# Firmware limit: node indices are uint8_t
+MAX_NODES = 255
+
+
+def parse_label(text):
+    text = text.strip().upper()
+    if text in DRUM_NAMES:
+        return DRUM_NAMES.index(text)
+    if text in ("NONE", "UNKNOWN"):
+        return DRUM_NONE
+    value = int(text)
+    if value != DRUM_NONE and not 0 <= value < len(DRUM_NAMES):
+        raise ValueError("bad drum id %d" % value)
+    return value
+
+
+def quantise(yaw, pitch, gyro_y):
+    # Must match DrumClassifier_MakeFeatures(): C float->int16 casts truncate toward zero
+    return (int(yaw * 10.0), int(pitch * 10.0), int(gyro_y))
+
+
+def load_strokes(path):
+    strokes = []
+    with open(path) as f:
+        for line_no, line in enumerate(f, 1):
+            fields = [x.strip() for x in line.strip().split(",")]
+            if fields and fields[0].upper() == "STROKE":
+                fields = fields[1:]
+            if len(fields) < 4:
+                continue
+            try:
+                yaw, pitch, gyro_y = float(fields[0]), float(fields[1]), float(fields[2])
+                label = parse_label(fields[3])
+            except ValueError:
+                continue  # header or malformed line
+            strokes.append((yaw, pitch, gyro_y, quantise(yaw, pitch, gyro_y), label))
+    return strokes
+
+
+def classify_rules(yaw, pitch):
+    # Python copy of DrumDetection_ClassifyZone()
+    if 20.0 <= yaw <= 120.0:
+        return 0
+    if yaw >= 340.0 or yaw <= 20.0:
+        return 5 if pitch > 50.0 else 3
+    if 305.0 <= yaw <= 340.0:
+        return 6 if pitch > 50.0 else 4
+    if 200.0 <= yaw <= 305.0:
+        return 6 if pitch > 30.0 else 7
+    return DRUM_NONE
+
+
+def gini(counts, total):
+    if total == 0:
+        return 0.0
+    return 1.0 - sum((c / total) ** 2 for c in counts.values())
+
+
+def majority(rows):
+    counts = {}
+    for r in rows:
+        counts[r[1]] = counts.get(r[1], 0) + 1
+    return max(sorted(counts), key=lambda k: counts[k])
+
+
+def best_split(rows, min_leaf):
+    # rows: list of (features, label); exhaustive CART split search
+    total = len(rows)
+    parent = {}
+    for _, label in rows:
+        parent[label] = parent.get(label, 0) + 1
+    best = None
+    best_score = gini(parent, total)
+
+    for feature in range(len(FEATURE_NAMES)):
+        ordered = sorted(rows, key=lambda r: r[0][feature])
+        left = {}
+        right = dict(parent)
+        for i in range(total - 1):
+            label = ordered[i][1]
+            left[label] = left.get(label, 0) + 1
+            right[label] -= 1
+            value, next_value = ordered[i][0][feature], ordered[i + 1][0][feature]
+            if value == next_value:
+                continue
+            n_left = i + 1
+            n_right = total - n_left
+            if n_left < min_leaf or n_right < min_leaf:
+                continue
+            score = (n_left * gini(left, n_left) + n_right * gini(right, n_right)) / total
+            if score < best_score - 1e-12:
+                best_score = score
+                # Threshold is the left value itself: firmware tests "<= threshold"
+                best = (feature, value)
+    return best
+
+
+def build_tree(rows, depth, max_depth, min_leaf):
+    labels = set(label for _, label in rows)
+    if len(labels) == 1 or depth >= max_depth or len(rows) < 2 * min_leaf:
+        return ("leaf", majority(rows))
+    split = best_split(rows, min_leaf)
+    if split is None:
+        return ("leaf", majority(rows))
+    feature, threshold = split
+    left = [r for r in rows if r[0][feature] <= threshold]
+    right = [r for r in rows if r[0][feature] > threshold]
+    return ("node", feature, threshold,
+            build_tree(left, depth + 1, max_depth, min_leaf),
+            build_tree(right, depth + 1, max_depth, min_leaf))
+
+
+def predict(tree, features):
+    while tree[0] == "node":
+        _, feature, threshold, left, right = tree
+        tree = left if features[feature] <= threshold else right
+    return tree[1]
+
+
+def tree_depth(tree):
+    if tree[0] == "leaf":
+        return 0
+    return 1 + max(tree_depth(tree[3]), tree_depth(tree[4]))
+
+
+def flatten(tree):
+    # Breadth-first numbering so the root is node 0
+    nodes = []
+    queue = [tree]
+    while queue:
+        t = queue.pop(0)
+        nodes.append(t)
+        if t[0] == "node":
+            queue.append(t[3])
+            queue.append(t[4])
+    index = {id(t): i for i, t in enumerate(nodes)}
+    table = []
+    for t in nodes:
+        if t[0] == "leaf":
+            table.append(("DRUM_CLASSIFIER_LEAF", 0, t[1], 0))
+        else:
+            table.append((FEATURE_NAMES[t[1]], t[2], index[id(t[3])], index[id(t[4])]))
+    return table
+
+
+def drum_symbol(drum_id):
+    if drum_id == DRUM_NONE:
+        return "DRUM_NONE"
+    return "DRUM_" + DRUM_NAMES[drum_id]
+
+
+def write_header(path, tree, source, n_strokes, accuracy):
+    table = flatten(tree)
+    if len(table) > MAX_NODES:
+        sys.exit("tree has %d nodes; firmware supports at most %d (lower --max-depth)"
+                 % (len(table), MAX_NODES))
+    lines = [
+        "// drum_classifier_model.h",
+        "// Decision tree tables for drum_classifier.c",
+        "//",
+        "// GENERATED by host/train_classifier.py - do not edit by hand.",
+        "// Trained on %d strokes from %s" % (n_strokes, source),
+        "// Cross-validated accuracy: %.1f%%" % (100.0 * accuracy),
+        "",
+        "#ifndef DRUM_CLASSIFIER_MODEL_H",
+        "#define DRUM_CLASSIFIER_MODEL_H",
+        "",
+        '#include "drum_classifier.h"',
+        '#include "drum_detection.h"',
+        "",
+        "// Longest root-to-leaf path (number of comparisons); bounds evaluation time",
+        "#define DRUM_CLASSIFIER_MODEL_DEPTH  %d" % tree_depth(tree),
+        "#define DRUM_CLASSIFIER_MODEL_NODES  %d" % len(table),
+        "",
+        "static const DrumClassifierNode_t drum_classifier_nodes[DRUM_CLASSIFIER_MODEL_NODES] = {",
+    ]
+    for i, (feature, threshold, left, right) in enumerate(table):
+        if feature == "DRUM_CLASSIFIER_LEAF":
+            lines.append("    /* %2d */ { DRUM_CLASSIFIER_LEAF,  0, %s, 0 }," % (i, drum_symbol(left)))
+        else:
+            lines.append("    /* %2d */ { %s, %d, %d, %d }," % (i, feature, threshold, left, right))
+    lines += ["};", "", "#endif // DRUM_CLASSIFIER_MODEL_H", ""]
+    with open(path, "w") as f:
+        f.write("\n".join(lines))
+
+
+def confusion_report(pairs):
+    ids = sorted(set(t for t, _ in pairs) | set(p for _, p in pairs))
+    names = [drum_symbol(i)[5:] for i in ids]
+    width = max(len(n) for n in names) + 1
+    print("  truth \\ predicted".ljust(width + 2) + "".join(n[:8].rjust(9) for n in names))
+    for t in ids:
+        row = [sum(1 for a, b in pairs if a == t and b == p) for p in ids]
+        print("  " + drum_symbol(t)[5:].ljust(width) + "".join(str(c).rjust(9) for c in row))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Train the drum hit classifier")
+    parser.add_argument("strokes")
+    parser.add_argument("--max-depth", type=int, default=6)
+    parser.add_argument("--min-leaf", type=int, default=3)
+    parser.add_argument("--folds", type=int, default=5)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--out", help="write drum_classifier_model.h here")
+    args = parser.parse_args()
+
+    strokes = load_strokes(args.strokes)
+    if len(strokes) < args.folds:
+        sys.exit("need at least %d labelled strokes, got %d" % (args.folds, len(strokes)))
+
+    order = list(range(len(strokes)))
+    random.Random(args.seed).shuffle(order)
+
+    # k-fold cross-validation: tree trained on k-1 folds, scored on the held-out fold
+    tree_pairs = []
+    for fold in range(args.folds):
+        test_idx = set(order[fold::args.folds])
+        train = [(s[3], s[4]) for i, s in enumerate(strokes) if i not in test_idx]
+        tree = build_tree(train, 0, args.max_depth, args.min_leaf)
+        tree_pairs += [(strokes[i][4], predict(tree, strokes[i][3])) for i in sorted(test_idx)]
+
+    rule_pairs = [(s[4], classify_rules(s[0], s[1])) for s in strokes]
+
+    tree_acc = sum(1 for t, p in tree_pairs if t == p) / len(tree_pairs)
+    rule_acc = sum(1 for t, p in rule_pairs if t == p) / len(rule_pairs)
+
+    final = build_tree([(s[3], s[4]) for s in strokes], 0, args.max_depth, args.min_leaf)
+
+    print("Strokes: %d" % len(strokes))
+    print("If/else rules accuracy:          %.1f%%" % (100.0 * rule_acc))
+    print("Decision tree %d-fold accuracy:   %.1f%% (depth %d, %d nodes)"
+          % (args.folds, 100.0 * tree_acc, tree_depth(final), len(flatten(final))))
+    print("")
+    print("Rules confusion:")
+    confusion_report(rule_pairs)
+    print("")
+    print("Tree confusion (held-out):")
+    confusion_report(tree_pairs)
+
+    if args.out:
+        write_header(args.out, final, args.strokes, len(strokes), tree_acc)
+        print("")
+        print("Wrote %s - build with DRUM_USE_TREE_CLASSIFIER=1 to ship it" % args.out)
+        if tree_acc <= rule_acc:
+            print("NOTE: tree does not beat the if/else rules on this data set")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,182 @@
+// yaw_drift_test.c
+// Host test for the resting-yaw drift estimator (yaw_drift.c)
+//
+// Replays a long session through YawDrift exactly as drum_detection.c does
+// and prints, per interval, where the stick rested relative to the learned
+// resting yaw: without compensation (raw GRV yaw) and with compensation
+// (yaw minus the accumulated yawOffset corrections).
+//
+// Input is either an RTT log from the firmware (the "[Q #n] ... Yaw=" and
+// "[G #n] x= y= z=" lines printed by sensorHandler in main.c), or a
+// synthetic session with a known drift rate (--synth).
+//
+// Build and run (from this folder):
+//   gcc -std=c99 -O2 -I.. yaw_drift_test.c ../yaw_drift.c -lm -o yaw_drift_test
+//   ./yaw_drift_test rtt_log.txt [interval_min]
+//   ./yaw_drift_test --synth 60 [drift_deg_per_min]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "yaw_drift.h"
+
+#define RATE_HZ  100
+
+static YawDrift_t drift;
+static float yawOffset;
+
+// Per-interval rest statistics
+static int intervalSamples;
+static int sampleCount;
+static int restCount;
+static double rawErrSum, compErrSum, compErrMax;
+static double truthErrSum;
+static int haveTruth;
+
+static float wrap180(float deg) {
+    while (deg > 180.0f) deg -= 360.0f;
+    while (deg < -180.0f) deg += 360.0f;
+    return deg;
+}
+
+static void print_header(void) {
+    printf("%8s %7s %14s %14s %14s%s\n", "minute", "rests", "raw err", "comp err",
+           "comp max", haveTruth ? "   true drift" : "");
+}
+
+static void flush_interval(void) {
+    printf("%8.1f %7d", (double)sampleCount / RATE_HZ / 60.0, restCount);
+    if (restCount > 0) {
+        printf(" %13.2f%c %13.2f%c %13.2f%c", rawErrSum / restCount, 'd',
+               compErrSum / restCount, 'd', compErrMax, 'd');
+        if (haveTruth) {
+            printf(" %12.2fd", truthErrSum / restCount);
+        }
+    } else {
+        printf(" %14s %14s %14s", "-", "-", "-");
+    }
+    printf("\n");
+    restCount = 0;
+    rawErrSum = compErrSum = compErrMax = truthErrSum = 0.0;
+}
+
+// One orientation sample: rawYaw is the GRV yaw before offset, truthDrift the
+// known drift at this sample (synthetic sessions only)
+static void add_yaw(float rawYaw, float truthDrift) {
+    float yaw = fmodf(rawYaw - yawOffset + 720.0f, 360.0f);
+    yawOffset += YawDrift_AddYaw(&drift, yaw);
+    
+    if (drift.learned && YawDrift_IsStill(&drift)) {
+        float compErr = wrap180(yaw - drift.restYaw);
+        if (fabsf(compErr) <= YAW_DRIFT_MAX_ERROR) {
+            // Raw error: same rest measured without any correction applied
+            float rawErr = wrap180(compErr + drift.totalCorrection);
+            rawErrSum += rawErr;
+            compErrSum += compErr;
+            if (fabsf(compErr) > compErrMax) compErrMax = fabsf(compErr);
+            truthErrSum += truthDrift;
+            restCount++;
+        }
+    }
+    
+    sampleCount++;
+    if (sampleCount % intervalSamples == 0) {
+        flush_interval();
+    }
+}
+
+static void add_gyro(float gx, float gy, float gz) {
+    YawDrift_AddGyro(&drift, (int16_t)(gx * 1000.0f), (int16_t)(gy * 1000.0f), (int16_t)(gz * 1000.0f));
+}
+
+static float frand(float lo, float hi) {
+    return lo + (hi - lo) * (float)rand() / (float)RAND_MAX;
+}
+
+// Synthetic session: strokes around the kit, rests at a home yaw, some rests
+// elsewhere, GRV yaw drifting at a constant rate plus a slow random walk
+static void run_synth(int minutes, float driftPerMin) {
+    const float home = 60.0f;
+    float walk = 0.0f;
+    int total = minutes * 60 * RATE_HZ;
+    int n = 0;
+    
+    haveTruth = 1;
+    print_header();
+    
+    while (n < total) {
+        // Playing: 2-20 s of strokes
+        int play = (int)frand(2.0f, 20.0f) * RATE_HZ;
+        float target = home;
+        for (int i = 0; i < play && n < total; i++, n++) {
+            if (i % 40 == 0) target = frand(200.0f, 420.0f);
+            float d = driftPerMin * n / (60.0f * RATE_HZ) + walk;
+            float w = 6.0f * sinf(2.0f * 3.14159f * i / 40.0f);
+            add_gyro(frand(-0.5f, 0.5f), w, frand(-1.0f, 1.0f));
+            add_yaw(target + d + frand(-3.0f, 3.0f), d);
+            walk += frand(-0.002f, 0.002f);
+        }
+        
+        // Resting: 1-8 s, at home most of the time
+        int rest = (int)frand(1.0f, 8.0f) * RATE_HZ;
+        float restYaw = (rand() % 5 == 0) ? home + 90.0f : home + frand(-4.0f, 4.0f);
+        for (int i = 0; i < rest && n < total; i++, n++) {
+            float d = driftPerMin * n / (60.0f * RATE_HZ) + walk;
+            add_gyro(frand(-0.03f, 0.03f), frand(-0.03f, 0.03f), frand(-0.03f, 0.03f));
+            add_yaw(restYaw + d + frand(-0.3f, 0.3f), d);
+        }
+    }
+}
+
+// Replay "[Q #n] ... Yaw=" and "[G #n] x= y= z=" lines from an RTT log
+static int run_log(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return 1;
+    }
+    
+    char line[512];
+    print_header();
+    while (fgets(line, sizeof line, f) != NULL) {
+        char *p;
+        if (strncmp(line, "[Q #", 4) == 0 && (p = strstr(line, "Yaw=")) != NULL) {
+            // Logged yaw already had yawOffset (0 unless button 2 was used) removed
+            add_yaw(strtof(p + 4, NULL), 0.0f);
+        } else if (strncmp(line, "[G #", 4) == 0) {
+            char *x = strstr(line, "x="), *y = strstr(line, "y="), *z = strstr(line, "z=");
+            if (x && y && z) {
+                add_gyro(strtof(x + 2, NULL), strtof(y + 2, NULL), strtof(z + 2, NULL));
+            }
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s rtt_log.txt [interval_min] | --synth minutes [drift_deg_per_min]\n", argv[0]);
+        return 1;
+    }
+    
+    YawDrift_Reset(&drift);
+    srand(1);
+    
+    if (strcmp(argv[1], "--synth") == 0) {
+        int minutes = argc > 2 ? atoi(argv[2]) : 60;
+        float rate = argc > 3 ? strtof(argv[3], NULL) : 0.5f;
+        intervalSamples = 5 * 60 * RATE_HZ;
+        printf("Synthetic %d min session, drift %.2f deg/min\n", minutes, rate);
+        run_synth(minutes, rate);
+    } else {
+        intervalSamples = (argc > 2 ? atoi(argv[2]) : 5) * 60 * RATE_HZ;
+        if (run_log(argv[1]) != 0) {
+            return 1;
+        }
+    }
+    
+    printf("Total yawOffset correction: %.2f deg\n", drift.totalCorrection);
+    return 0;
+}
@@ -0,0 +1,98 @@
+// irq_priority.c
+// Central interrupt priority map and interrupt latency self-test implementation
+
+#include "irq_priority.h"
+#include "STM32L432KC_NVIC.h"
+#include "STM32L432KC_RCC.h"
+#include "STM32L432KC_TIMER.h"  // For TIM_TypeDef
+#include "STM32L432KC_RTT.h"    // For debug output (RTT)
+#include <stdint.h>
+
+// Apply the priority map (call before enabling any interrupt)
+void IrqPriority_Init(void) {
+    NVIC_SetPriority(IRQN_TIM6_DAC, IRQ_PRIO_AUDIO);
+    NVIC_SetPriority(IRQN_EXTI1, IRQ_PRIO_SENSOR);
+    NVIC_SetPriority(IRQN_SPI1, IRQ_PRIO_SENSOR);
+    NVIC_SetSystemPriority(NVIC_SYS_SYSTICK, IRQ_PRIO_TICK);
+    NVIC_SetPriority(IRQN_USART1, IRQ_PRIO_TELEMETRY);
+    NVIC_SetPriority(IRQN_USART2, IRQ_PRIO_TELEMETRY);
+    NVIC_SetPriority(IRQN_DMA1_CH4, IRQ_PRIO_TELEMETRY);
+    NVIC_SetPriority(IRQN_DMA1_CH6, IRQ_PRIO_TELEMETRY);
+    NVIC_SetPriority(IRQN_DMA1_CH7, IRQ_PRIO_TELEMETRY);
+    NVIC_SetSystemPriority(NVIC_SYS_PENDSV, IRQ_PRIO_PENDSV);
+}
+
+#if IRQ_LATENCY_TEST
+
+// TIM7: basic timer on APB1 (undivided SYSCLK), same register layout as TIM6
+#define TIM7  ((TIM_TypeDef *) 0x40001400UL)
+#define RCC_APB1ENR1_TIM7EN  (1 << 5)
+
+// Probe period: 1 ms at the measured SYSCLK
+#define LATENCY_PERIOD_CYCLES  (RCC_GetSysclkHz() / 1000)
+
+// Levels the probe visits, in the order of the map
+static const uint8_t levels[] = {
+    IRQ_PRIO_AUDIO, IRQ_PRIO_SENSOR, IRQ_PRIO_TICK, IRQ_PRIO_TELEMETRY, IRQ_PRIO_PENDSV
+};
+#define NUM_LEVELS  (sizeof(levels) / sizeof(levels[0]))
+
+static volatile uint32_t maxCycles[NUM_LEVELS];
+static volatile uint32_t samples[NUM_LEVELS];
+static volatile uint8_t current = 0;
+
+// Start the 1 ms probe timer
+void IrqLatency_Init(void) {
+    RCC->APB1ENR1 |= RCC_APB1ENR1_TIM7EN;
+    
+    TIM7->CR1 = 0;
+    TIM7->PSC = 0;                           // Count CPU cycles
+    TIM7->ARR = LATENCY_PERIOD_CYCLES - 1;
+    TIM7->EGR = 1;                           // Load PSC/ARR
+    TIM7->SR = 0;
+    TIM7->DIER = 1;                          // Update interrupt
+    
+    current = 0;
+    NVIC_SetPriority(IRQN_TIM7, levels[0]);
+    NVIC_EnableIRQ(IRQN_TIM7);
+    TIM7->CR1 = 1;                           // CEN
+}
+
+// Counter at entry = cycles from the update event to the first instruction
+// of the handler (12 cycles stacking minimum, plus anything that blocked it)
+void TIM7_IRQHandler(void) {
+    uint32_t cycles = TIM7->CNT;
+    TIM7->SR = 0;
+    
+    uint8_t level = current;
+    samples[level]++;
+    if (cycles > maxCycles[level]) {
+        maxCycles[level] = cycles;
+    }
+    
+    // Next update event is measured at the next level
+    level = (uint8_t)((level + 1) % NUM_LEVELS);
+    current = level;
+    NVIC_SetPriority(IRQN_TIM7, levels[level]);
+}
+
+// Print worst-case response per priority level and start a new window
+void IrqLatency_Report(void) {
+    DEBUG_PRINTLN("[IRQ] priority / samples / worst response cycles (us)");
+    for (uint32_t i = 0; i < NUM_LEVELS; i++) {
+        DEBUG_PRINT("[IRQ] ");
+        DEBUG_PRINT_INT(levels[i]);
+        DEBUG_PRINT(" / ");
+        DEBUG_PRINT_INT(samples[i]);
+        DEBUG_PRINT(" / ");
+        DEBUG_PRINT_INT(maxCycles[i]);
+        DEBUG_PRINT(" (");
+        DEBUG_PRINT_FLOAT(maxCycles[i] / (RCC_GetSysclkHz() / 1000000.0f), 2);
+        DEBUG_PRINT(")");
+        DEBUG_PRINT_NEWLINE();
+        maxCycles[i] = 0;
+        samples[i] = 0;
+    }
+}
+
+#endif
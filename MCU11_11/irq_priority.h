@@ -0,0 +1,64 @@
+// irq_priority.h
+// Central interrupt priority map and interrupt latency self-test
+//
+// Every interrupt priority in the firmware is set here, nowhere else, so the
+// ordering can be read in one place:
+//
+//   0  audio render   TIM6 sample clock (audio_mixer.c); must never wait
+//   2  sensor I/O     EXTI1 (BNO085 H_INTN), SPI1
+//   3  system tick    SysTick (1 ms time base, scheduler tick)
+//   4  telemetry      USART1/USART2 and their DMA channels, buttons
+//  15  deferred work  PendSV (scheduler tasks marked deferred)
+//
+// Interrupt handlers above PendSV only acknowledge the hardware and post an
+// event; the work itself runs in PendSV or thread mode, where the audio
+// interrupt can always preempt it. Critical sections that protect state
+// shared with the sensor/tick handlers mask with BASEPRI at IRQ_PRIO_SENSOR,
+// so they do not hold off audio either.
+//
+// With IRQ_LATENCY_TEST enabled, TIM7 fires every millisecond and its handler
+// reads how many cycles have passed since the update event. The handler
+// moves itself through each level of the map in turn, so the worst case per
+// level covers everything that can block an interrupt at that priority.
+// IrqLatency_Report() prints the results.
+
+#ifndef IRQ_PRIORITY_H
+#define IRQ_PRIORITY_H
+
+#include <stdint.h>
+
+// Priority map (0 = highest, 15 = lowest)
+#define IRQ_PRIO_AUDIO      0
+#define IRQ_PRIO_SENSOR     2
+#define IRQ_PRIO_TICK       3
+#define IRQ_PRIO_TELEMETRY  4
+#define IRQ_PRIO_PENDSV     15
+
+// BASEPRI value that masks sensor I/O and everything below, but not audio
+#define IRQ_BASEPRI_SENSOR  (IRQ_PRIO_SENSOR << 4)
+
+// Measure worst-case interrupt response per priority level (TIM7)
+#ifndef IRQ_LATENCY_TEST
+#define IRQ_LATENCY_TEST  0
+#endif
+
+// Mask interrupts at sensor priority and below, returning the previous BASEPRI
+static inline uint32_t irq_mask_sensor(void) {
+    uint32_t basepri;
+    __asm volatile ("mrs %0, basepri" : "=r" (basepri));
+    __asm volatile ("msr basepri_max, %0" : : "r" (IRQ_BASEPRI_SENSOR) : "memory");
+    return basepri;
+}
+
+static inline void irq_unmask(uint32_t basepri) {
+    __asm volatile ("msr basepri, %0" : : "r" (basepri) : "memory");
+}
+
+// Function prototypes
+void IrqPriority_Init(void);
+#if IRQ_LATENCY_TEST
+void IrqLatency_Init(void);
+void IrqLatency_Report(void);
+#endif
+
+#endif // IRQ_PRIORITY_H
@@ -0,0 +1,219 @@
+// latency_trace.c
+// End-to-end hit latency tracer implementation
+
+#include "latency_trace.h"
+#include "irq_priority.h"
+#include "STM32L432KC_DWT.h"
+#include "STM32L432KC_RCC.h"   // For RCC_GetSysclkHz
+#include "STM32L432KC_RTT.h"  // For debug output (RTT)
+
+// Stage names for the report (indexed by LT_STAGE_*)
+static const char *stageNames[LT_NUM_STAGES] = {
+    "INT", "SPI", "SHTP", "DECODE", "DETECT", "VOICE", "DAC"
+};
+
+// Record for the transfer in flight, and the hit being followed to the DAC
+static LatencyTraceRecord_t current;
+static LatencyTraceRecord_t pending;
+static uint8_t pendingActive = 0;
+
+// Latest H_INTN edge not yet claimed by a transfer (0 = none)
+static volatile uint32_t intEdge = 0;
+
+// First DAC sample of the pending hit's voice (TIM6, 0 = not yet out)
+// TIM6 only stores it while dacWanted is set; the record is committed by
+// the next stamp or report outside the audio interrupt.
+static volatile uint8_t dacWanted = 0;
+static volatile uint32_t dacTime = 0;
+
+// Completed hit traces
+static LatencyTraceRecord_t ring[LT_RING_LEN];
+static uint32_t ringCount = 0;  // Total committed (ring holds the newest LT_RING_LEN)
+
+// Start the cycle counter and clear all traces
+void LatencyTrace_Init(void) {
+    DWT_Init();
+    for (int s = 0; s < LT_NUM_STAGES; s++) {
+        current.t[s] = 0;
+    }
+    pendingActive = 0;
+    intEdge = 0;
+    dacWanted = 0;
+    dacTime = 0;
+    ringCount = 0;
+}
+
+// Commit the pending hit once its first DAC sample is out (caller holds BASEPRI)
+static void commit_pending(void) {
+    if (pendingActive && dacTime != 0) {
+        pending.t[LT_STAGE_DAC] = dacTime;
+        ring[ringCount & (LT_RING_LEN - 1)] = pending;
+        ringCount++;
+        pendingActive = 0;
+        dacTime = 0;
+    }
+}
+
+// Latch the time of an H_INTN falling edge (EXTI1, interrupt context)
+void LatencyTrace_IntEdge(void) {
+    uint32_t now = DWT_GET_CYCLES();
+    intEdge = now ? now : 1;
+}
+
+// Timestamp a pipeline stage
+// INT starts a new record for the next transfer, at the latched edge if
+// there is one. SPI ends the transfer: edges during it (H_INTN re-asserted
+// between the header and the rest) belong to it. DETECT takes over the
+// current record as a hit; VOICE and DAC complete it.
+// DAC comes from TIM6, which BASEPRI does not mask, so it only stores its
+// time; every other stage runs with BASEPRI at IRQ_PRIO_SENSOR.
+void LatencyTrace_Stamp(uint8_t stage) {
+    uint32_t now = DWT_GET_CYCLES();
+    
+    if (stage == LT_STAGE_DAC) {
+        if (dacWanted) {
+            dacTime = now ? now : 1;
+            dacWanted = 0;
+        }
+        return;
+    }
+    
+    uint32_t basepri = irq_mask_sensor();
+    commit_pending();
+    
+    switch (stage) {
+        case LT_STAGE_INT:
+            for (int s = 1; s < LT_NUM_STAGES; s++) {
+                current.t[s] = 0;
+            }
+            current.t[LT_STAGE_INT] = intEdge ? intEdge : now;
+            intEdge = 0;
+            break;
+        
+        case LT_STAGE_SPI:
+            current.t[stage] = now;
+            intEdge = 0;
+            break;
+        
+        case LT_STAGE_SHTP:
+        case LT_STAGE_DECODE:
+            current.t[stage] = now;
+            break;
+        
+        case LT_STAGE_DETECT:
+            // A hit whose voice never started is dropped
+            dacWanted = 0;
+            dacTime = 0;
+            pending = current;
+            pending.t[LT_STAGE_DETECT] = now;
+            pendingActive = 1;
+            break;
+        
+        case LT_STAGE_VOICE:
+            if (pendingActive && pending.t[LT_STAGE_VOICE] == 0) {
+                pending.t[LT_STAGE_VOICE] = now;
+                dacTime = 0;
+                __asm volatile ("" : : : "memory");
+                dacWanted = 1;
+            }
+            break;
+        
+        default:
+            break;
+    }
+    irq_unmask(basepri);
+}
+
+// Number of hit traces committed since init
+uint32_t LatencyTrace_Count(void) {
+    uint32_t basepri = irq_mask_sensor();
+    commit_pending();
+    uint32_t count = ringCount;
+    irq_unmask(basepri);
+    return count;
+}
+
+// Sort a small array in place (insertion sort, n <= LT_RING_LEN)
+static void sort_u32(uint32_t *v, int n) {
+    for (int i = 1; i < n; i++) {
+        uint32_t x = v[i];
+        int j = i - 1;
+        while (j >= 0 && v[j] > x) {
+            v[j + 1] = v[j];
+            j--;
+        }
+        v[j + 1] = x;
+    }
+}
+
+// Print p50/p99/max of one set of cycle counts in microseconds
+static void print_stats(uint32_t *cycles, int n, float cyclesPerUs) {
+    if (n == 0) {
+        DEBUG_PRINT("        -        -        -");
+        return;
+    }
+    
+    sort_u32(cycles, n);
+    uint32_t p50 = cycles[(n - 1) / 2];
+    uint32_t p99 = cycles[(n * 99 + 99) / 100 - 1];
+    uint32_t max = cycles[n - 1];
+    
+    DEBUG_PRINT(" ");
+    DEBUG_PRINT_FLOAT((float)p50 / cyclesPerUs, 1);
+    DEBUG_PRINT(" ");
+    DEBUG_PRINT_FLOAT((float)p99 / cyclesPerUs, 1);
+    DEBUG_PRINT(" ");
+    DEBUG_PRINT_FLOAT((float)max / cyclesPerUs, 1);
+}
+
+// Print per-stage latency over the traces in the ring (microseconds)
+// "step" is the time from the previous stage, "total" the time from INT.
+// Stages a trace did not reach are left out of that stage's statistics.
+// Thread mode only: it prints, and works on a copy of the ring taken with
+// BASEPRI set, so traces committed meanwhile do not tear a record.
+void LatencyTrace_Report(void) {
+    static LatencyTraceRecord_t snapshot[LT_RING_LEN];
+    static uint32_t step[LT_RING_LEN];
+    static uint32_t total[LT_RING_LEN];
+    float cyclesPerUs = (float)RCC_GetSysclkHz() / 1000000.0f;
+    
+    uint32_t basepri = irq_mask_sensor();
+    commit_pending();
+    uint32_t count = ringCount;
+    int records = (count < LT_RING_LEN) ? (int)count : LT_RING_LEN;
+    for (int r = 0; r < records; r++) {
+        snapshot[r] = ring[r];
+    }
+    irq_unmask(basepri);
+    
+    DEBUG_PRINT("[Latency] ");
+    DEBUG_PRINT_INT(records);
+    DEBUG_PRINT(" of ");
+    DEBUG_PRINT_INT(count);
+    DEBUG_PRINT(" hit traces, us: stage step p50/p99/max | total p50/p99/max");
+    DEBUG_PRINT_NEWLINE();
+    
+    for (int s = 1; s < LT_NUM_STAGES; s++) {
+        int nStep = 0, nTotal = 0;
+        
+        for (int r = 0; r < records; r++) {
+            const LatencyTraceRecord_t *rec = &snapshot[r];
+            if (rec->t[s] == 0) {
+                continue;
+            }
+            if (rec->t[s - 1] != 0) {
+                step[nStep++] = rec->t[s] - rec->t[s - 1];
+            }
+            if (rec->t[LT_STAGE_INT] != 0) {
+                total[nTotal++] = rec->t[s] - rec->t[LT_STAGE_INT];
+            }
+        }
+        
+        DEBUG_PRINT("[Latency] ");
+        DEBUG_PRINT(stageNames[s]);
+        print_stats(step, nStep, cyclesPerUs);
+        DEBUG_PRINT(" |");
+        print_stats(total, nTotal, cyclesPerUs);
+        DEBUG_PRINT_NEWLINE();
+    }
+}
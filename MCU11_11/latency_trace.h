@@ -0,0 +1,63 @@
+// latency_trace.h
+// End-to-end hit latency tracer (motion to sound)
+//
+// Every sensor transfer gets a trace record with DWT cycle timestamps at
+// each pipeline stage. When a transfer leads to a hit, the record is kept
+// through voice start and the first DAC sample, then committed to a fixed
+// ring. LatencyTrace_Report() prints p50/p99/max per stage over RTT.
+//
+// The H_INTN edge is latched in EXTI1 (LATENCY_TRACE_INT_EDGE) and claimed
+// by the next transfer when spihal_read starts it (LT_STAGE_INT), so the
+// INT -> SPI step includes the EXTI -> PendSV dispatch. Without an edge
+// (polled build, or H_INTN still low after the previous transfer) the
+// record starts when the pin is seen asserted. Stamps come from EXTI1,
+// PendSV and thread mode, which update the records with BASEPRI at
+// IRQ_PRIO_SENSOR, and from TIM6 (first DAC sample). Audio is never masked,
+// so the TIM6 stamp only stores its time and the next stamp, count or
+// report commits the trace. LatencyTrace_Report() prints, so it is called
+// from thread mode (the status in the tick task), never from PendSV.
+
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <stdint.h>
+
+// Enable stage timestamps (a DWT read and a store per stage when enabled)
+#ifndef LATENCY_TRACE
+#define LATENCY_TRACE  1
+#endif
+
+// Pipeline stages, in order
+#define LT_STAGE_INT       0  // H_INTN asserted (EXTI1 edge, claimed by spihal_read)
+#define LT_STAGE_SPI       1  // SPI transfer done (spihal_read)
+#define LT_STAGE_SHTP      2  // SHTP payload assembled and dispatched (sensor callback entry)
+#define LT_STAGE_DECODE    3  // Sensor event decoded (sensor callback)
+#define LT_STAGE_DETECT    4  // Detector decided on a hit (main loop)
+#define LT_STAGE_VOICE     5  // Drum voice started (PlayDrumSound)
+#define LT_STAGE_DAC       6  // First sample of the voice written to the DAC
+#define LT_NUM_STAGES      7
+
+// Completed hit traces kept for the summary (power of 2)
+#define LT_RING_LEN  64
+
+// One hit trace: DWT_CYCCNT at each stage (0 = stage not reached)
+typedef struct {
+    uint32_t t[LT_NUM_STAGES];
+} LatencyTraceRecord_t;
+
+#if LATENCY_TRACE
+#define LATENCY_TRACE_STAMP(stage)  LatencyTrace_Stamp(stage)
+#define LATENCY_TRACE_INT_EDGE()    LatencyTrace_IntEdge()
+#else
+#define LATENCY_TRACE_STAMP(stage)  ((void)0)
+#define LATENCY_TRACE_INT_EDGE()    ((void)0)
+#endif
+
+// Function prototypes
+void LatencyTrace_Init(void);
+void LatencyTrace_Stamp(uint8_t stage);
+void LatencyTrace_IntEdge(void);
+uint32_t LatencyTrace_Count(void);
+void LatencyTrace_Report(void);
+
+#endif // LATENCY_TRACE_H
@@ -11,7 +11,24 @@
 #include "STM32L432KC_RTT.h"  // Debug RTT (Real-Time Transfer)
 #include "BNO085_SPI_HAL.h"   // Provides BNO085_INT_PIN definition
 #include "drum_detection.h"
-#include "wav_arrays/drum_samples.h"
+#include "drum_classifier.h"
+#include "drum_calibration.h"
+#include "stroke_recognizer.h"
+#include "latency_trace.h"
+#include "shtp_capture.h"
+#include "binlog.h"
+#include "scheduler.h"
+#include "irq_priority.h"
+#include "audio_mixer.h"
+#include "ramfunc.h"
+#include "flash_bench.h"
+#include "clock_check.h"
+#include "config_store.h"
+#include "drum_kit.h"
+#include "serial_link.h"
+#include "remote_control.h"
+#include "sensor_capture.h"
+#include "midi_out.h"
 #include "sh2.h"
 #include "sh2_SensorValue.h"
 #include "sh2_err.h"  // For SH2_OK definition
@@ -27,14 +44,34 @@
 #define DEBOUNCE_DELAY1  50  // ms
 #define DEBOUNCE_DELAY2  50  // ms
 
+// Holding button 2 this long enters/leaves drum position calibration
+#define CALIBRATION_HOLD_MS  2000
+
+// Transfers the sensor task reads per run before yielding to other events
+#define SENSOR_TRANSFERS_PER_RUN  4
+
+// Report interval of every enabled sensor. Detection is tuned for 100 Hz;
+// builds that record training data (sensor_capture.h) set 1000 for 1 kHz,
+// which the hub caps at each sensor's maximum rate.
+#ifndef SENSOR_REPORT_INTERVAL_US
+#define SENSOR_REPORT_INTERVAL_US  10000
+#endif
+
+// Input report payload of one of each sensor enabled in main() below. The
+// SHTP receive buffer (sh2_hal.h) holds SH2_REPORT_BATCH_DEPTH of these plus
+// a timebase reference; keep this in step with the sh2_setSensorConfig calls.
+#define SENSOR_REPORTS_LEN  (SH2_REPORT_LEN_GRV + SH2_REPORT_LEN_GYRO + \
+                             (DRUM_USE_FUSED_ONSET ? SH2_REPORT_LEN_LINACC : 0))
+typedef char sensor_batch_size_check[(SH2_REPORT_LEN_TIMEBASE + SH2_REPORT_BATCH_DEPTH *
+                                      SENSOR_REPORTS_LEN <= SH2_INPUT_PAYLOAD_MAX) ? 1 : -1];
+
 // Button state variables
 static uint32_t lastDebounceTime1 = 0;
 static uint32_t lastDebounceTime2 = 0;
 static bool buttonPrinted1 = false;
 static bool buttonPrinted2 = false;
-
-// Note: yawOffset is declared as extern in drum_detection.h and defined in drum_detection.c
-// Do not redeclare it here
+static uint32_t button2PressTime = 0;
+static bool button2HoldHandled = false;
 
 // Drum hit detection state
 static DrumHitState_t drumState = {0};
@@ -42,21 +79,38 @@ static DrumHitState_t drumState = {0};
 // SH2 HAL instance
 static sh2_Hal_t hal;
 
-// Sensor value structure (shared with callback)
+// Sensor value structure (the report being handled by the callback)
 static sh2_SensorValue_t sensorValue;
-static bool newSensorData = false;
+
+// Run detection on reports (off during bring-up, which services the stack
+// before the main loop is set up)
+static bool detectionEnabled = false;
+
+// SH2 opened successfully (sensor is serviced only then)
+static bool sensorOpen = false;
+
+static void ProcessSensorReport(void);
 
 // Sensor callback function
+// Called once per report: a transfer batches the GRV, gyro and linear accel
+// reports that fell due together, and the detector has to see every one.
 static void sensorHandler(void *cookie, sh2_SensorEvent_t *event) {
+    LATENCY_TRACE_STAMP(LT_STAGE_SHTP);
+    
     // Decode sensor event
     sh2_decodeSensorEvent(&sensorValue, event);
-    newSensorData = true;
+    LATENCY_TRACE_STAMP(LT_STAGE_DECODE);
+    
+#if SERIAL_LINK
+    // Telemetry values and the capture stream
+    RemoteControl_OnSensor(&sensorValue);
+#endif
     
-    // Debug: Print detailed sensor data when it arrives
+    // Debug: Log detailed sensor data when it arrives (binary records, see binlog.h)
     static uint32_t sensor_data_count = 0;
     sensor_data_count++;
     
-    // Print every sample with detailed information
+    // Log every sample with detailed information
     if (sensorValue.sensorId == SH2_GAME_ROTATION_VECTOR) {
         float q_real = sensorValue.un.gameRotationVector.real;
         float q_i = sensorValue.un.gameRotationVector.i;
@@ -66,25 +120,10 @@ static void sensorHandler(void *cookie, sh2_SensorEvent_t *event) {
         // Convert to Euler angles for display
         float roll, pitch, yaw;
         DrumDetection_QuaternionToEuler(q_real, q_i, q_j, q_k, &roll, &pitch, &yaw);
-        yaw = DrumDetection_NormalizeYaw(yaw - yawOffset);
+        yaw = DrumDetection_NormalizeYaw(yaw - DrumDetection_GetYawOffset());
         
-        DEBUG_PRINT("[Q #");
-        DEBUG_PRINT_INT(sensor_data_count);
-        DEBUG_PRINT("] r=");
-        DEBUG_PRINT_FLOAT(q_real, 3);
-        DEBUG_PRINT(" i=");
-        DEBUG_PRINT_FLOAT(q_i, 3);
-        DEBUG_PRINT(" j=");
-        DEBUG_PRINT_FLOAT(q_j, 3);
-        DEBUG_PRINT(" k=");
-        DEBUG_PRINT_FLOAT(q_k, 3);
-        DEBUG_PRINT(" | Roll=");
-        DEBUG_PRINT_FLOAT(roll, 1);
-        DEBUG_PRINT(" Pitch=");
-        DEBUG_PRINT_FLOAT(pitch, 1);
-        DEBUG_PRINT(" Yaw=");
-        DEBUG_PRINT_FLOAT(yaw, 1);
-        DEBUG_PRINT_NEWLINE();
+        BINLOG(BL_SENSOR_QUAT, BL_U(sensor_data_count), BL_F(q_real), BL_F(q_i), BL_F(q_j), BL_F(q_k),
+               BL_F(roll), BL_F(pitch), BL_F(yaw));
     } 
     else if (sensorValue.sensorId == SH2_GYROSCOPE_CALIBRATED) {
         float gx = sensorValue.un.gyroscope.x;
@@ -96,29 +135,20 @@ static void sensorHandler(void *cookie, sh2_SensorEvent_t *event) {
         int16_t gyro_y_raw = (int16_t)(gy * 1000.0f);
         int16_t gyro_z_raw = (int16_t)(gz * 1000.0f);
         
-        DEBUG_PRINT("[G #");
-        DEBUG_PRINT_INT(sensor_data_count);
-        DEBUG_PRINT("] x=");
-        DEBUG_PRINT_FLOAT(gx, 3);
-        DEBUG_PRINT(" y=");
-        DEBUG_PRINT_FLOAT(gy, 3);
-        DEBUG_PRINT(" z=");
-        DEBUG_PRINT_FLOAT(gz, 3);
-        DEBUG_PRINT(" | Raw: x=");
-        DEBUG_PRINT_INT(gyro_x_raw);
-        DEBUG_PRINT(" y=");
-        DEBUG_PRINT_INT(gyro_y_raw);
-        DEBUG_PRINT(" z=");
-        DEBUG_PRINT_INT(gyro_z_raw);
-        DEBUG_PRINT_NEWLINE();
+        BINLOG(BL_SENSOR_GYRO, BL_U(sensor_data_count), BL_F(gx), BL_F(gy), BL_F(gz),
+               BL_I(gyro_x_raw), BL_I(gyro_y_raw), BL_I(gyro_z_raw));
+    }
+    else if (sensorValue.sensorId == SH2_LINEAR_ACCELERATION) {
+        BINLOG(BL_SENSOR_ACCEL, BL_U(sensor_data_count), BL_F(sensorValue.un.linearAcceleration.x),
+               BL_F(sensorValue.un.linearAcceleration.y), BL_F(sensorValue.un.linearAcceleration.z));
     }
     else {
         // Other sensor types
-        DEBUG_PRINT("[Sensor #");
-        DEBUG_PRINT_INT(sensor_data_count);
-        DEBUG_PRINT("] ID=");
-        DEBUG_PRINT_INT(sensorValue.sensorId);
-        DEBUG_PRINT_NEWLINE();
+        BINLOG(BL_SENSOR_OTHER, BL_U(sensor_data_count), BL_U(sensorValue.sensorId));
+    }
+    
+    if (detectionEnabled) {
+        ProcessSensorReport();
     }
 }
 
@@ -126,12 +156,17 @@ static void sensorHandler(void *cookie, sh2_SensorEvent_t *event) {
 // Using a simple counter based on loop iterations
 // For accurate timing, should use SysTick timer interrupt
 static uint32_t get_millis(void) {
+#if USE_SCHEDULER
+    // Buttons run from the 1 ms scheduler tick
+    return Scheduler_Millis();
+#else
     static uint32_t ms_counter = 0;
     
     // Approximate: assume each main loop iteration takes ~1ms
     // This is very approximate - for production, use hardware timer
     ms_counter++;
     return ms_counter;
+#endif
 }
 
 // Initialize buttons
@@ -196,15 +231,33 @@ static void ProcessButton2(void) {
         
         if (reading && !buttonPrinted2) {
             buttonPrinted2 = true;
+            button2PressTime = currentTime;
+            button2HoldHandled = false;
             lastDebounceTime2 = currentTime;
             
             // Read current quaternion and set yaw offset
             // This will be done when we get sensor data
-            // For now, just reset the offset
+            // For now, just reset the offset (the sensor task runs in PendSV)
+            uint32_t basepri = irq_mask_sensor();
             DrumDetection_SetYawOffset(0.0f);
+            irq_unmask(basepri);
             DEBUG_PRINTLN("Button 2 pressed - Yaw offset reset");
         }
         
+        // Long hold: toggle drum position calibration
+        if (reading && buttonPrinted2 && !button2HoldHandled &&
+            currentTime - button2PressTime >= CALIBRATION_HOLD_MS) {
+            button2HoldHandled = true;
+            // Finish rewrites the zone map the sensor task classifies with
+            uint32_t basepri = irq_mask_sensor();
+            if (DrumCalibration_IsActive()) {
+                DrumCalibration_Finish();
+            } else {
+                DrumCalibration_Start();
+            }
+            irq_unmask(basepri);
+        }
+        
         if (!reading) {
             buttonPrinted2 = false;
         }
@@ -213,51 +266,201 @@ static void ProcessButton2(void) {
     }
 }
 
-// Play drum sound based on ID
+// Play the current kit's sample for a drum ID (drum_kit.c)
 static void PlayDrumSound(uint8_t drumId) {
-    const char* drumNames[] = {
-        "SNARE", "HIHAT", "KICK", "HIGH_TOM", "MID_TOM", "CRASH", "RIDE", "LOW_TOM"
-    };
+    LATENCY_TRACE_STAMP(LT_STAGE_VOICE);
     
-    if (drumId < 8) {
-        DEBUG_PRINT("Playing: ");
-        DEBUG_PRINTLN(drumNames[drumId]);
+    const DrumKitSample_t *sample = DrumKit_Sample(drumId);
+    if (sample == NULL) {
+        BINLOG(BL_PLAY_UNKNOWN, BL_U(drumId));
+        return;
     }
+    BINLOG(BL_PLAY, BL_U(drumId));
     
-    switch (drumId) {
-        case DRUM_SNARE:
-            DAC_PlayWAV(snare_sample_data, snare_sample_length, snare_sample_sample_rate);
-            break;
-        case DRUM_HIHAT:
-            DAC_PlayWAV(hihat_closed_sample_data, hihat_closed_sample_length, hihat_closed_sample_sample_rate);
-            break;
-        case DRUM_KICK:
-            DAC_PlayWAV(kick_sample_data, kick_sample_length, kick_sample_sample_rate);
-            break;
-        case DRUM_HIGH_TOM:
-            DAC_PlayWAV(tom_high_sample_data, tom_high_sample_length, tom_high_sample_sample_rate);
-            break;
-        case DRUM_MID_TOM:
-            // Use mid tom or high tom (adjust as needed)
-            DAC_PlayWAV(tom_high_sample_data, tom_high_sample_length, tom_high_sample_sample_rate);
-            break;
-        case DRUM_CRASH:
-            DAC_PlayWAV(crash_sample_data, crash_sample_length, crash_sample_sample_rate);
-            break;
-        case DRUM_RIDE:
-            DAC_PlayWAV(ride_sample_data, ride_sample_length, ride_sample_sample_rate);
-            break;
-        case DRUM_LOW_TOM:
-            DAC_PlayWAV(tom_low_sample_data, tom_low_sample_length, tom_low_sample_sample_rate);
-            break;
-        default:
-            DEBUG_PRINT("Unknown drum ID: ");
-            DEBUG_PRINT_INT(drumId);
-            DEBUG_PRINT_NEWLINE();
-            break;
+#if AUDIO_USE_MIXER
+    Mixer_Play(sample->data, *sample->length);
+#else
+    DAC_PlayWAV(sample->data, *sample->length, *sample->sampleRate);
+#endif
+}
+
+// Service the SH2 protocol once; sensorHandler() runs detection on each report
+static void ServiceSensor(void) {
+    static uint32_t sh2_service_count = 0;
+    
+    // Service SH2 protocol (must be called regularly) - only if opened successfully
+    if (sensorOpen) {
+        sh2_service();
+        sh2_service_count++;
+        
+        // Debug: Log first few service calls and then periodically
+        // (binary log: this runs in PendSV while thread mode may be printing)
+        if (sh2_service_count <= 10 || sh2_service_count % 1000 == 0) {
+            BINLOG(BL_SH2_SERVICE, BL_U(sh2_service_count));
+        }
+    }
+}
+
+// Run drum detection on the report in sensorValue (sensor callback)
+static void ProcessSensorReport(void) {
+    // Periodic debug output for sensor values (every 1000 samples)
+    static uint32_t sensor_debug_count = 0;
+    sensor_debug_count++;
+    if (sensor_debug_count % 1000 == 0) {
+        if (sensorValue.sensorId == SH2_GAME_ROTATION_VECTOR) {
+            BINLOG(BL_SENSOR_QUAT_SUMMARY,
+                   BL_F(sensorValue.un.gameRotationVector.real),
+                   BL_F(sensorValue.un.gameRotationVector.i),
+                   BL_F(sensorValue.un.gameRotationVector.j),
+                   BL_F(sensorValue.un.gameRotationVector.k));
+        } else if (sensorValue.sensorId == SH2_GYROSCOPE_CALIBRATED) {
+            BINLOG(BL_SENSOR_GYRO_SUMMARY,
+                   BL_F(sensorValue.un.gyroscope.x),
+                   BL_F(sensorValue.un.gyroscope.y),
+                   BL_F(sensorValue.un.gyroscope.z));
+        }
+    }
+    
+    // Process sensor data for drum detection
+    uint8_t drumId = DrumDetection_ProcessSensorData(&sensorValue, &drumState);
+    if (drumId != DRUM_NONE) {
+        LATENCY_TRACE_STAMP(LT_STAGE_DETECT);
+        PlayDrumSound(drumId);
+#if MIDI_OUT
+        MidiOut_Hit(drumId, MidiOut_Velocity(drumState.hitStrength, drumState.lastStrokeType),
+                    drumState.lastStrokeType);
+#endif
+#if SERIAL_LINK
+        RemoteControl_OnHit(drumId, &drumState, (uint32_t)sensorValue.timestamp);
+#endif
+    }
+}
+
+// Process buttons
+static void ServiceButtons(void) {
+    uint8_t buttonDrum = ProcessButton1();
+    if (buttonDrum != DRUM_NONE) {
+        PlayDrumSound(buttonDrum);
+#if MIDI_OUT
+        MidiOut_Hit(buttonDrum, MIDI_BUTTON_VELOCITY, STROKE_NORMAL);
+#endif
+    }
+    
+    ProcessButton2();
+}
+
+// Advance a pending config store write by one flash operation
+// Programs and erases stall flash reads, so they wait until no sample is playing.
+static void ServiceConfigStore(void) {
+#if AUDIO_USE_MIXER
+    ConfigStore_Poll(Mixer_ActiveVoices() == 0);
+#else
+    ConfigStore_Poll(true);  // DAC_PlayWAV blocks, so nothing plays here
+#endif
+}
+
+// Periodic status update (about every 10 seconds)
+static void PeriodicStatus(uint32_t loop_count) {
+    DEBUG_PRINT("Loop count: ");
+    DEBUG_PRINT_INT(loop_count);
+    DEBUG_PRINT_NEWLINE();
+    
+#if LATENCY_TRACE
+    // Motion-to-sound latency summary, when new hits were traced
+    static uint32_t reported_traces = 0;
+    if (LatencyTrace_Count() != reported_traces) {
+        reported_traces = LatencyTrace_Count();
+        LatencyTrace_Report();
+    }
+#endif
+    
+#if SERIAL_LINK
+    SerialLink_Report();
+    SensorCapture_Report();
+#endif
+#if MIDI_OUT
+    MidiOut_Report();
+#endif
+    
+#if USE_SCHEDULER
+    // Task run time and idle share since the last status
+    Scheduler_Report();
+#endif
+    
+#if IRQ_LATENCY_TEST
+    // Worst-case interrupt response per priority level
+    IrqLatency_Report();
+#endif
+}
+
+// Background output, when there is nothing else to do
+static void IdleWork(void) {
+#if SHTP_CAPTURE
+    // Stream the captured SHTP transfers
+    ShtpCapture_Flush();
+#endif
+    
+    // Write out the queued log records
+    BinLog_Drain();
+}
+
+#if USE_SCHEDULER
+// H_INTN fell: the hub has a transfer ready (EXTI1, interrupt context)
+static void OnSensorDataReady(void) {
+    Scheduler_Post(SCHED_EV_SENSOR);
+}
+
+// Sensor task (PendSV): read transfers while H_INTN stays asserted
+// After SENSOR_TRANSFERS_PER_RUN the task returns with H_INTN still low; the
+// tick task posts it again, so a hub that keeps H_INTN low cannot hold off
+// thread mode.
+static void Task_Sensor(void) {
+    for (int i = 0; i < SENSOR_TRANSFERS_PER_RUN; i++) {
+        ServiceSensor();
+        if (!BNO085_SPI_HAL_DataReady()) {
+            return;
+        }
     }
 }
 
+// Tick task (1 ms): buttons and the periodic status
+static void Task_Tick(void) {
+    static uint32_t lastStatusMs = 0;
+    
+    // H_INTN still low after the last sensor run (no new edge will come)
+    if (sensorOpen && BNO085_SPI_HAL_DataReady()) {
+        Scheduler_Post(SCHED_EV_SENSOR);
+    }
+    
+    ServiceButtons();
+    ServiceConfigStore();
+    
+    uint32_t now = Scheduler_Millis();
+#if MIDI_OUT
+    MidiOut_Tick();
+#endif
+#if SERIAL_LINK
+    RemoteControl_Tick(now, sensorOpen);
+#endif
+    if (now - lastStatusMs >= 10000) {
+        lastStatusMs = now;
+        PeriodicStatus(now);
+    }
+}
+
+#if SERIAL_LINK
+// USART2 bytes waiting (idle line or DMA half/full, interrupt context)
+static void OnLinkData(void) {
+    Scheduler_Post(SCHED_EV_LINK);
+}
+
+// Link task: decode received frames and answer commands
+static void Task_Link(void) {
+    SerialLink_Service();
+}
+#endif
+#endif
+
 int main(void) {
     // Initialize RTT for debug output first
     RTT_Init();
@@ -273,8 +476,16 @@ int main(void) {
     configureClock();
     DEBUG_PRINTLN("Clock configured");
     
+#if CLOCK_CHECK
+    // Verify SYSCLK before anything derives timing constants from it
+    ClockCheck_Run();
+#endif
+    
     DEBUG_PRINTLN("System initialized");
     
+    // Interrupt priorities (irq_priority.h) before any interrupt is enabled
+    IrqPriority_Init();
+    
     // Initialize DAC for audio output
     DEBUG_PRINTLN("Initializing DAC...");
     DAC_InitAudio(DAC_CHANNEL_1);
@@ -285,11 +496,72 @@ int main(void) {
     Buttons_Init();
     DEBUG_PRINTLN("Buttons initialized");
     
+    // Deferred binary log for the per-report debug output
+    BinLog_Init(RCC_GetSysclkHz());
+    
+    // Saved settings (zone map, thresholds) for drum detection
+    ConfigStore_Init();
+    ConfigStore_Report();
+    
     // Initialize drum detection
     DEBUG_PRINTLN("Initializing Drum Detection...");
     DrumDetection_Init();
+    DrumKit_Init();
     DEBUG_PRINTLN("Drum detection initialized");
     
+#if MIDI_OUT
+    MidiOut_Init();
+#endif
+    
+#if FLASH_BENCH
+    // Time the decode/detect/mix/Euler kernels under every ART cache and
+    // prefetch setting and keep the fastest (the detect kernel moves
+    // detector state and logs, so both are reset afterwards)
+    FlashBench_Run();
+    DrumDetection_Init();
+    BinLog_Init(RCC_GetSysclkHz());
+#endif
+    
+#if RAMFUNC_BENCHMARK
+    // Mixer render from flash against SRAM, warm and cold ART cache (DWT cycles)
+    RamFunc_ReportCycles();
+#endif
+    
+#if AUDIO_USE_MIXER
+    // Sample clock for the drum voice mixer (TIM6, top interrupt priority)
+    Mixer_Init();
+#endif
+    
+#if DRUM_CLASSIFIER_BENCHMARK
+    // Compare tree classifier against the if/else zone rules (DWT cycles)
+    DrumClassifier_ReportCycles();
+#endif
+    
+#if LATENCY_TRACE
+    // Start the DWT cycle counter for hit latency traces
+    LatencyTrace_Init();
+#endif
+    
+#if BINLOG_BENCHMARK
+    // Binary log record against the RTT text line it replaces (DWT cycles)
+    BinLog_ReportCycles();
+#endif
+    
+#if STROKE_RECOGNIZER_BENCHMARK
+    // Per-hit DTW stroke recognition cost at 100Hz and 1kHz gyro input (DWT cycles)
+    StrokeRecognizer_ReportCycles();
+#endif
+    
+#if IRQ_LATENCY_TEST
+    // 1 ms probe interrupt stepping through every priority level (TIM7)
+    IrqLatency_Init();
+#endif
+    
+#if SHTP_CAPTURE
+    // Record raw SHTP transfers from the first reset advertisement on
+    ShtpCapture_Init();
+#endif
+    
     // Initialize BNO085 SPI HAL (matches Adafruit library begin_SPI)
     DEBUG_PRINTLN("Initializing BNO085 SPI HAL...");
     BNO085_SPI_HAL_Init(&hal);
@@ -350,6 +622,7 @@ int main(void) {
     }
     
     int status = sh2_open(&hal, NULL, NULL);
+    sensorOpen = (status == SH2_OK);
     
     // Note: sh2_open() should timeout after 200ms (ADVERT_TIMEOUT_US)
     // If it hangs longer, there may be an issue with getTimeUs() or the timeout logic
@@ -452,7 +725,7 @@ int main(void) {
         config.changeSensitivity = 0;
         config.batchInterval_us = 0;
         config.sensorSpecific = 0;
-        config.reportInterval_us = 10000;  // 10ms = 100Hz
+        config.reportInterval_us = SENSOR_REPORT_INTERVAL_US;
         
         // Service SH2 before configuring to ensure ready
         sh2_service();
@@ -467,6 +740,9 @@ int main(void) {
             DEBUG_PRINTLN("This may indicate sensor hub not ready or control channel not set");
         } else {
             DEBUG_PRINTLN("Game Rotation Vector configured");
+#if SERIAL_LINK
+            SensorCapture_AddSensor(SH2_GAME_ROTATION_VECTOR, config.reportInterval_us);
+#endif
         }
         
         // Service SH2 to process the configuration response
@@ -489,6 +765,9 @@ int main(void) {
             DEBUG_PRINTLN("This may indicate sensor hub not ready or control channel not set");
         } else {
             DEBUG_PRINTLN("Gyroscope configured");
+#if SERIAL_LINK
+            SensorCapture_AddSensor(SH2_GYROSCOPE_CALIBRATED, config.reportInterval_us);
+#endif
         }
         
         // Service SH2 to process the configuration response
@@ -496,7 +775,34 @@ int main(void) {
             sh2_service();
             ms_delay(10);
         }
+    
+#if DRUM_USE_FUSED_ONSET
+        // Enable Linear Acceleration reports (impact jerk for fused onset detection)
+        DEBUG_PRINTLN("Configuring Linear Acceleration...");
+        sh2_service();  // Service before config
+        ms_delay(10);
+        
+        int accel_status = sh2_setSensorConfig(SH2_LINEAR_ACCELERATION, &config);
+        if (accel_status != SH2_OK) {
+            DEBUG_PRINT("ERROR: Failed to configure Linear Acceleration. Status: ");
+            DEBUG_PRINT_INT(accel_status);
+            DEBUG_PRINT(" (SH2_ERR_BAD_PARAM = -2)");
+            DEBUG_PRINT_NEWLINE();
+            DEBUG_PRINTLN("This may indicate sensor hub not ready or control channel not set");
+        } else {
+            DEBUG_PRINTLN("Linear Acceleration configured");
+#if SERIAL_LINK
+            SensorCapture_AddSensor(SH2_LINEAR_ACCELERATION, config.reportInterval_us);
+#endif
+        }
         
+        // Service SH2 to process the configuration response
+        for (int i = 0; i < 50; i++) {
+            sh2_service();
+            ms_delay(10);
+        }
+#endif
+    
         // Give sensor a moment to start sending data after configuration
         DEBUG_PRINTLN("Waiting for sensor to start sending data...");
         ms_delay(200);  // Increased delay to allow sensor to start
@@ -514,90 +820,63 @@ int main(void) {
     
     DEBUG_PRINTLN("=== System Ready - Entering Main Loop ===");
     
+    DEBUG_PRINTLN("Entering main loop...");
+    detectionEnabled = true;
+    
+#if USE_SCHEDULER
+    // Event-driven main loop: H_INTN and SysTick post events, the core
+    // sleeps in WFI otherwise. Sensor work runs in PendSV, so status prints
+    // and log draining in thread mode never delay it.
+    Scheduler_Init();
+    Scheduler_AddTask(SCHED_EV_SENSOR, Task_Sensor, "sensor");
+    Scheduler_AddTask(SCHED_EV_TICK, Task_Tick, "tick");
+    Scheduler_SetDeferred(SCHED_EV_SENSOR);
+    Scheduler_SetIdleHook(IdleWork);
+#if SERIAL_LINK
+    Scheduler_AddTask(SCHED_EV_LINK, Task_Link, "link");
+    RemoteControl_Init(OnLinkData);
+#endif
+    if (sensorOpen) {
+        BNO085_SPI_HAL_SetReadWait(0);
+        BNO085_SPI_HAL_EnableDataReadyIrq(OnSensorDataReady);
+        Scheduler_Post(SCHED_EV_SENSOR);  // H_INTN may already be low (no edge to come)
+    }
+    BNO085_SPI_HAL_SetTickCallback(Scheduler_Tick);
+    Scheduler_Run();
+#else
     // Main loop
     static uint32_t loop_count = 0;
-    static uint32_t sh2_service_count = 0;
     
-    DEBUG_PRINTLN("Entering main loop...");
+#if SERIAL_LINK
+    RemoteControl_Init(NULL);  // Polled below
+#endif
     
     while (1) {
         loop_count++;
         
-        // Service SH2 protocol (must be called regularly) - only if opened successfully
-        if (status == SH2_OK) {
-            sh2_service();
-            sh2_service_count++;
-            
-            // Debug: Print first few service calls and then periodically
-            if (sh2_service_count <= 10 || sh2_service_count % 1000 == 0) {
-                DEBUG_PRINT("[SH2] Service call #");
-                DEBUG_PRINT_INT(sh2_service_count);
-                DEBUG_PRINT_NEWLINE();
-            }
-        }
-        
-        // Check for new sensor data
-        if (newSensorData) {
-            newSensorData = false;
-            
-            // Periodic debug output for sensor values (every 1000 samples)
-            static uint32_t sensor_debug_count = 0;
-            sensor_debug_count++;
-            if (sensor_debug_count % 1000 == 0) {
-                if (sensorValue.sensorId == SH2_GAME_ROTATION_VECTOR) {
-                    float q_real = sensorValue.un.gameRotationVector.real;
-                    float q_i = sensorValue.un.gameRotationVector.i;
-                    float q_j = sensorValue.un.gameRotationVector.j;
-                    float q_k = sensorValue.un.gameRotationVector.k;
-                    DEBUG_PRINT("Quaternion: r=");
-                    DEBUG_PRINT_FLOAT(q_real, 3);
-                    DEBUG_PRINT(" i=");
-                    DEBUG_PRINT_FLOAT(q_i, 3);
-                    DEBUG_PRINT(" j=");
-                    DEBUG_PRINT_FLOAT(q_j, 3);
-                    DEBUG_PRINT(" k=");
-                    DEBUG_PRINT_FLOAT(q_k, 3);
-                    DEBUG_PRINT_NEWLINE();
-                } else if (sensorValue.sensorId == SH2_GYROSCOPE_CALIBRATED) {
-                    float gx = sensorValue.un.gyroscope.x;
-                    float gy = sensorValue.un.gyroscope.y;
-                    float gz = sensorValue.un.gyroscope.z;
-                    DEBUG_PRINT("Gyro: x=");
-                    DEBUG_PRINT_FLOAT(gx, 3);
-                    DEBUG_PRINT(" y=");
-                    DEBUG_PRINT_FLOAT(gy, 3);
-                    DEBUG_PRINT(" z=");
-                    DEBUG_PRINT_FLOAT(gz, 3);
-                    DEBUG_PRINT_NEWLINE();
-                }
-            }
-            
-            // Process sensor data for drum detection
-            uint8_t drumId = DrumDetection_ProcessSensorData(&sensorValue, &drumState);
-            if (drumId != DRUM_NONE) {
-                PlayDrumSound(drumId);
-            }
-        }
-        
-        // Process buttons
-        uint8_t buttonDrum = ProcessButton1();
-        if (buttonDrum != DRUM_NONE) {
-            PlayDrumSound(buttonDrum);
-        }
-        
-        ProcessButton2();
+        ServiceSensor();
+        ServiceButtons();
+        ServiceConfigStore();
+#if MIDI_OUT
+        MidiOut_Tick();
+#endif
+#if SERIAL_LINK
+        SerialLink_Service();
+        RemoteControl_Tick(loop_count, sensorOpen);
+#endif
         
         // Periodic status update (every 10000 loops ~ every 10 seconds at 1ms delay)
         if (loop_count % 10000 == 0) {
-            DEBUG_PRINT("Loop count: ");
-            DEBUG_PRINT_INT(loop_count);
-            DEBUG_PRINT_NEWLINE();
+            PeriodicStatus(loop_count);
         }
         
+        IdleWork();
+        
         // Small delay to prevent tight loop
         // Note: DAC_PlayWAV is blocking, so this delay mainly affects sensor reading rate
         ms_delay(1);
     }
+#endif
     
     return 0;
 }
@@ -0,0 +1,210 @@
+// midi_out.c
+// MIDI note output implementation
+
+#include "midi_out.h"
+#include "drum_kit.h"
+#include "stroke_recognizer.h"  // For STROKE_ACCENT / STROKE_GHOST
+#include "STM32L432KC_USART.h"
+#include "STM32L432KC_DMA.h"
+#include "STM32L432KC_NVIC.h"
+#include "STM32L432KC_RCC.h"
+#include "STM32L432KC_TIMER.h"  // Provides GPIOA and GPIO_TypeDef
+#include "STM32L432KC_RTT.h"    // For debug output (RTT)
+#include "irq_priority.h"
+#include <stdint.h>
+
+#if MIDI_OUT
+
+#define MIDI_TX_CHANNEL  4
+#define TX_DMA  DMA1_CHANNEL(MIDI_TX_CHANNEL)
+#define TX_MASK  (MIDI_TX_RING_LEN - 1)
+
+#define RCC_APB2ENR_USART1EN  (1 << 14)
+
+#define MIDI_NOTE_ON  0x90
+
+// Notes waiting for their note-off
+#define MIDI_ACTIVE_NOTES  8
+
+typedef struct {
+    uint8_t note;       // 0 = free slot
+    uint8_t msLeft;
+} MidiActiveNote_t;
+
+// Transmit ring (head and tail are free-running byte counts); head moves with
+// sensor interrupts masked, tail in the DMA interrupt that mask holds off
+static uint8_t txRing[MIDI_TX_RING_LEN];
+static uint32_t txHead = 0;
+static volatile uint32_t txTail = 0;
+static volatile uint32_t txInFlight = 0;
+
+static MidiActiveNote_t active[MIDI_ACTIVE_NOTES];
+static bool midiReady = false;
+static uint32_t notesSent = 0;
+static uint32_t dropped = 0;
+
+// Start DMA on the next contiguous run of the ring, if idle
+static void tx_start(void) {
+    if (txInFlight != 0) {
+        return;
+    }
+    uint32_t pending = txHead - txTail;
+    if (pending == 0) {
+        return;
+    }
+    
+    uint32_t start = txTail & TX_MASK;
+    uint32_t len = MIDI_TX_RING_LEN - start;
+    if (len > pending) {
+        len = pending;
+    }
+    txInFlight = len;
+    
+    TX_DMA->CCR &= ~DMA_CCR_EN;
+    TX_DMA->CMAR = (uint32_t)&txRing[start];
+    TX_DMA->CNDTR = len;
+    TX_DMA->CCR |= DMA_CCR_EN;
+}
+
+// Queue a note-on (velocity 0 = note-off); call with sensor interrupts masked
+// The status byte is only sent when the ring is empty: anything still queued
+// or in flight already carries it (running status).
+static void queue_note(uint8_t note, uint8_t velocity) {
+    bool idle = (txHead == txTail);
+    uint32_t need = idle ? 3 : 2;
+    if (need > MIDI_TX_RING_LEN - (txHead - txTail)) {
+        dropped++;
+        return;
+    }
+    
+    if (idle) {
+        txRing[txHead++ & TX_MASK] = MIDI_NOTE_ON | MIDI_CHANNEL;
+    }
+    txRing[txHead++ & TX_MASK] = note & 0x7F;
+    txRing[txHead++ & TX_MASK] = velocity & 0x7F;
+    tx_start();
+}
+
+// Configure USART1 TX on PA9 and its DMA channel
+void MidiOut_Init(void) {
+    RCC->AHB2ENR |= (1 << 0);  // GPIOA
+    RCC->APB2ENR |= RCC_APB2ENR_USART1EN;
+    (void)RCC->APB2ENR;
+    
+    // PA9: alternate function 7 (USART1_TX)
+    GPIOA->MODER &= ~(0b11 << (2 * 9));
+    GPIOA->MODER |= (0b10 << (2 * 9));
+    GPIOA->AFRH &= ~(0b1111 << (4 * (9 - 8)));
+    GPIOA->AFRH |= (0b0111 << (4 * (9 - 8)));
+    GPIOA->OSPEEDR |= (0b11 << (2 * 9));
+    
+    DMA1_Enable();
+    DMA1_SelectRequest(MIDI_TX_CHANNEL, DMA1_CH4_USART1_TX);
+    TX_DMA->CCR = 0;
+    TX_DMA->CPAR = (uint32_t)&USART1->TDR;
+    TX_DMA->CCR = DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_TCIE | DMA_CCR_TEIE;
+    DMA1->IFCR = DMA_FLAG_GIF(MIDI_TX_CHANNEL);
+    
+    txHead = 0;
+    txTail = 0;
+    txInFlight = 0;
+    for (int i = 0; i < MIDI_ACTIVE_NOTES; i++) {
+        active[i].note = 0;
+    }
+    
+    // 8N1, transmit only
+    USART1->CR1 = 0;
+    USART1->BRR = USART_BRR(RCC_GetSysclkHz(), MIDI_BAUD);
+    USART1->CR3 = USART_CR3_DMAT;
+    USART1->CR1 = USART_CR1_UE | USART_CR1_TE;
+    
+    NVIC_EnableIRQ(IRQN_DMA1_CH4);
+    midiReady = true;
+}
+
+// Send a note-on for a hit (sensor task or tick); the note-off is scheduled
+void MidiOut_Hit(uint8_t drumId, uint8_t velocity, uint8_t strokeType) {
+    uint8_t note = DrumKit_MidiNote(drumId, strokeType);
+    if (!midiReady || note == 0) {
+        return;
+    }
+    
+    uint32_t basepri = irq_mask_sensor();
+    queue_note(note, velocity);
+    notesSent++;
+    
+    // Restart the note's timer, or take a free slot (a full table just
+    // skips the note-off; drum voices end on their own)
+    int slot = -1;
+    for (int i = 0; i < MIDI_ACTIVE_NOTES; i++) {
+        if (active[i].note == note) {
+            slot = i;
+            break;
+        }
+        if (active[i].note == 0 && slot < 0) {
+            slot = i;
+        }
+    }
+    if (slot >= 0) {
+        active[slot].note = note;
+        active[slot].msLeft = MIDI_NOTE_MS;
+    }
+    irq_unmask(basepri);
+}
+
+// Send the note-offs that are due (call every 1 ms)
+void MidiOut_Tick(void) {
+    if (!midiReady) {
+        return;
+    }
+    
+    uint32_t basepri = irq_mask_sensor();
+    for (int i = 0; i < MIDI_ACTIVE_NOTES; i++) {
+        if (active[i].note != 0 && --active[i].msLeft == 0) {
+            queue_note(active[i].note, 0);
+            active[i].note = 0;
+        }
+    }
+    irq_unmask(basepri);
+}
+
+// Print MIDI statistics
+void MidiOut_Report(void) {
+    DEBUG_PRINT("[MIDI] USART1 ");
+    DEBUG_PRINT_INT(MIDI_BAUD);
+    DEBUG_PRINT(" baud: ");
+    DEBUG_PRINT_INT(notesSent);
+    DEBUG_PRINT(" notes, ");
+    DEBUG_PRINT_INT(dropped);
+    DEBUG_PRINT(" messages dropped");
+    DEBUG_PRINT_NEWLINE();
+}
+
+// Transmit run finished: release it and start the next one
+void DMA1_Channel4_IRQHandler(void) {
+    DMA1->IFCR = DMA_FLAG_GIF(MIDI_TX_CHANNEL);
+    TX_DMA->CCR &= ~DMA_CCR_EN;
+    txTail += txInFlight;
+    txInFlight = 0;
+    tx_start();
+}
+
+#endif
+
+// Velocity (1..127) from the swing speed of a stroke (DrumHitState_t.hitStrength)
+// Accents get a boost and ghost notes are halved, so the recognised stroke
+// type is audible even when the swing speed alone does not separate them.
+// Built with MIDI_OUT 0 too: the serial link's hit events carry it.
+uint8_t MidiOut_Velocity(int32_t strength, uint8_t strokeType) {
+    int32_t v = 1 + (strength - MIDI_SWING_SOFT) * 126 / (MIDI_SWING_HARD - MIDI_SWING_SOFT);
+    
+    if (strokeType == STROKE_ACCENT) {
+        v += 20;
+    } else if (strokeType == STROKE_GHOST) {
+        v /= 2;
+    }
+    
+    if (v < 1) v = 1;
+    if (v > 127) v = 127;
+    return (uint8_t)v;
+}
@@ -0,0 +1,61 @@
+// midi_out.h
+// MIDI note output of drum hits on USART1
+//
+// Every hit becomes a General MIDI percussion note-on (channel 10) on USART1
+// TX (PA9, Nucleo-32 pin D1), with the note taken from the kit table
+// (drum_kit.c) and a velocity from the swing speed of the stroke. A note-off
+// follows MIDI_NOTE_MS later for sound modules that wait for one.
+//
+// Sending never blocks: messages go into a small RAM ring that DMA1 channel
+// 4 streams to the USART. Within a burst the status byte is sent once
+// (running status) and note-off is sent as note-on with velocity 0, so a
+// hit costs two bytes on the wire: 0.64 ms at the standard 31250 baud. The
+// status byte is repeated whenever the line has gone idle, so a receiver
+// plugged in mid-stream picks up at the next hit.
+//
+// Wire PA9 through a standard MIDI OUT circuit (3.3 V variant: 33R/10R
+// resistors) for DIN devices, or set MIDI_BAUD to a serial-MIDI rate (e.g.
+// 115200) for a USB-serial bridge.
+
+#ifndef MIDI_OUT_H
+#define MIDI_OUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Enable MIDI output on USART1
+#ifndef MIDI_OUT
+#define MIDI_OUT  1
+#endif
+
+// Line rate (31250 = MIDI DIN; faster rates for serial-MIDI bridges)
+#ifndef MIDI_BAUD
+#define MIDI_BAUD  31250
+#endif
+
+// General MIDI percussion channel (10, sent as 9)
+#define MIDI_CHANNEL  9
+
+// Note length before the note-off
+#ifndef MIDI_NOTE_MS
+#define MIDI_NOTE_MS  50
+#endif
+
+// Swing speed (rad/s * 1000) mapped to velocity 1 and to 127
+#define MIDI_SWING_SOFT  2000   // ONSET_SWING_MIN: the softest stroke that counts
+#define MIDI_SWING_HARD  14000
+
+// Velocity of button-triggered hits
+#define MIDI_BUTTON_VELOCITY  100
+
+// Transmit ring (power of 2)
+#define MIDI_TX_RING_LEN  128
+
+// Function prototypes
+void MidiOut_Init(void);
+uint8_t MidiOut_Velocity(int32_t strength, uint8_t strokeType);
+void MidiOut_Hit(uint8_t drumId, uint8_t velocity, uint8_t strokeType);
+void MidiOut_Tick(void);
+void MidiOut_Report(void);
+
+#endif // MIDI_OUT_H
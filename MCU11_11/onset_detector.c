@@ -0,0 +1,107 @@
+// onset_detector.c
+// Fused gyro + linear-acceleration hit onset detector implementation
+
+#include "onset_detector.h"
+
+#define ABS32(x) ((x) < 0 ? -(x) : (x))
+
+// Check the fused condition; called after either stream updates its term
+static bool onset_check(OnsetDetector_t *det) {
+    if (!det->armed || det->holdoff > 0) {
+        return false;
+    }
+    
+    const OnsetParams_t *p = &det->params;
+    if (det->swingPeak < p->swingMin ||
+        det->decel < p->decelMin ||
+        det->decel < det->lastSpeed ||  // Speed must at least halve in one sample
+        det->jerk < p->jerkMin ||
+        det->decel + det->jerk < p->scoreMin) {
+        return false;
+    }
+    
+    // Fire once, then wait for the stick to settle before the next stroke
+    // The impact's jerk must not count towards the next one
+    det->armed = false;
+    det->hitSwing = det->swingPeak;
+    det->swingPeak = 0;
+    det->jerk = 0;
+    det->holdoff = p->holdoffSamples;
+    return true;
+}
+
+// Built-in thresholds
+void OnsetDetector_DefaultParams(OnsetParams_t *params) {
+    params->swingMin = ONSET_SWING_MIN;
+    params->decelMin = ONSET_DECEL_MIN;
+    params->jerkMin = ONSET_JERK_MIN;
+    params->scoreMin = ONSET_SCORE_MIN;
+    params->rearmSpeed = ONSET_REARM_SPEED;
+    params->holdoffSamples = ONSET_HOLDOFF_SAMPLES;
+}
+
+// Reset detector state and load the default thresholds
+void OnsetDetector_Init(OnsetDetector_t *det) {
+    OnsetDetector_DefaultParams(&det->params);
+    det->lastSpeed = 0;
+    det->swingPeak = 0;
+    det->hitSwing = 0;
+    det->decel = 0;
+    det->jerk = 0;
+    det->lastAccel[0] = 0;
+    det->lastAccel[1] = 0;
+    det->lastAccel[2] = 0;
+    det->holdoff = 0;
+    det->haveAccel = false;
+    det->accelFresh = false;
+    det->armed = true;
+}
+
+// Add a calibrated gyro sample (rad/s * 1000)
+// Returns true if this sample completes a hit onset
+bool OnsetDetector_AddGyro(OnsetDetector_t *det, int16_t gx, int16_t gy, int16_t gz) {
+    int32_t speed = ABS32((int32_t)gx) + ABS32((int32_t)gy) + ABS32((int32_t)gz);
+    
+    det->decel = det->lastSpeed - speed;
+    det->lastSpeed = speed;
+    
+    // A jerk spike only pairs with the deceleration around it: let it fade
+    // when the accel stream falls behind or stops
+    if (!det->accelFresh) {
+        det->jerk >>= 1;
+    }
+    det->accelFresh = false;
+    
+    if (speed > det->swingPeak) {
+        det->swingPeak = speed;
+    }
+    
+    if (det->holdoff > 0) {
+        det->holdoff--;
+    }
+    
+    if (!det->armed && speed < det->params.rearmSpeed && det->holdoff == 0) {
+        det->armed = true;
+        det->swingPeak = speed;
+    }
+    
+    return onset_check(det);
+}
+
+// Add a linear acceleration sample (m/s^2 * 100, gravity removed)
+// Returns true if this sample completes a hit onset
+bool OnsetDetector_AddAccel(OnsetDetector_t *det, int16_t ax, int16_t ay, int16_t az) {
+    if (det->haveAccel) {
+        det->jerk = ABS32((int32_t)ax - det->lastAccel[0]) +
+                    ABS32((int32_t)ay - det->lastAccel[1]) +
+                    ABS32((int32_t)az - det->lastAccel[2]);
+    }
+    
+    det->lastAccel[0] = ax;
+    det->lastAccel[1] = ay;
+    det->lastAccel[2] = az;
+    det->haveAccel = true;
+    det->accelFresh = true;
+    
+    return onset_check(det);
+}
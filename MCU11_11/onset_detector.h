@@ -0,0 +1,57 @@
+// onset_detector.h
+// Fused gyro + linear-acceleration hit onset detector
+//
+// A stroke ends when the wrist stops the stick: angular speed collapses and
+// the linear acceleration jumps. Requiring both (after a real swing) rejects
+// flourishes, which spin the stick fast but stop smoothly, and catches hits
+// about any axis, not just gyro_y. Each sample costs a few integer adds and
+// compares; no floats, no history beyond the previous sample.
+
+#ifndef ONSET_DETECTOR_H
+#define ONSET_DETECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Default thresholds, tuned at 100Hz with host/onset_harness.c
+// Gyro terms in rad/s * 1000 (L1 norm over x/y/z), accel terms in m/s^2 * 100
+// Tuned values replace them at run time (DrumDetection_SetThresholds).
+#define ONSET_SWING_MIN       2000  // Peak angular speed since re-arm that counts as a swing
+#define ONSET_DECEL_MIN       1000  // Minimum drop in angular speed between gyro samples
+#define ONSET_JERK_MIN        2000  // Minimum change in linear acceleration between accel samples
+#define ONSET_SCORE_MIN       4000  // decel + jerk must reach this
+#define ONSET_REARM_SPEED     1000  // Angular speed below which the detector re-arms
+#define ONSET_HOLDOFF_SAMPLES    5  // Minimum gyro samples between onsets
+
+// Runtime thresholds (the ONSET_* values above by default)
+typedef struct {
+    int32_t swingMin;
+    int32_t decelMin;
+    int32_t jerkMin;
+    int32_t scoreMin;
+    int32_t rearmSpeed;
+    uint8_t holdoffSamples;
+} OnsetParams_t;
+
+// Fused onset detector state
+typedef struct {
+    OnsetParams_t params;
+    int32_t lastSpeed;     // Previous gyro L1 norm
+    int32_t swingPeak;     // Highest gyro L1 norm since re-arm
+    int32_t hitSwing;      // swingPeak of the stroke that last fired (hit strength)
+    int32_t decel;         // Latest drop in angular speed (>0 = slowing)
+    int32_t jerk;          // Latest L1 change in linear acceleration (halves per gyro sample without accel)
+    int16_t lastAccel[3];
+    uint8_t holdoff;       // Gyro samples left before a new onset is allowed
+    bool haveAccel;        // lastAccel is valid
+    bool accelFresh;       // An accel sample arrived since the last gyro sample
+    bool armed;
+} OnsetDetector_t;
+
+// Function prototypes
+void OnsetDetector_DefaultParams(OnsetParams_t *params);
+void OnsetDetector_Init(OnsetDetector_t *det);
+bool OnsetDetector_AddGyro(OnsetDetector_t *det, int16_t gx, int16_t gy, int16_t gz);
+bool OnsetDetector_AddAccel(OnsetDetector_t *det, int16_t ax, int16_t ay, int16_t az);
+
+#endif // ONSET_DETECTOR_H
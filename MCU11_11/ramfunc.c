@@ -0,0 +1,73 @@
+// ramfunc.c
+// Flash/SRAM execution benchmark for the RAMFUNC hot paths
+
+#include "ramfunc.h"
+#include "audio_mixer.h"
+#include "STM32L432KC_FLASH.h"
+#include "STM32L432KC_DWT.h"
+#include "STM32L432KC_RTT.h"  // For debug output (RTT)
+#include <stdint.h>
+
+#if RAMFUNC_BENCHMARK
+
+// Rendered samples per case
+#define BENCH_RUNS  32
+
+// Silent test voice (mixing cost does not depend on the sample values)
+static const int16_t benchSample[BENCH_RUNS * 2] = {0};
+
+// Time one render call, optionally after invalidating the ART caches
+static uint32_t time_render(void (*render)(void), int cold) {
+    if (cold) {
+        FLASH_ResetCaches();
+    }
+    uint32_t start = DWT_GET_CYCLES();
+    render();
+    return DWT_GET_CYCLES() - start;
+}
+
+// Print avg/max cycles of one case
+static void report_case(const char *name, void (*render)(void), int cold) {
+    uint32_t total = 0, max = 0;
+    
+    for (int v = 0; v < MIXER_VOICES; v++) {
+        Mixer_Play(benchSample, BENCH_RUNS * 2);
+    }
+    for (int i = 0; i < BENCH_RUNS; i++) {
+        uint32_t cycles = time_render(render, cold);
+        total += cycles;
+        if (cycles > max) max = cycles;
+    }
+    Mixer_Stop();
+    
+    DEBUG_PRINT("[RamFunc] ");
+    DEBUG_PRINT(name);
+    DEBUG_PRINT(cold ? " cold: avg " : " warm: avg ");
+    DEBUG_PRINT_INT(total / BENCH_RUNS);
+    DEBUG_PRINT(" max ");
+    DEBUG_PRINT_INT(max);
+    DEBUG_PRINT(" cycles");
+    DEBUG_PRINT_NEWLINE();
+}
+
+// Compare the mixer render (all voices active) run from flash and from SRAM
+// "Cold" invalidates the ART instruction/data caches before every call, the
+// state the render interrupt finds after the main loop has run other code.
+// Call before Mixer_Init() (the sample clock must not be running).
+void RamFunc_ReportCycles(void) {
+    DWT_Init();
+    
+    DEBUG_PRINT("[RamFunc] mixer render, ");
+    DEBUG_PRINT_INT(MIXER_VOICES);
+    DEBUG_PRINT(" voices, ");
+    DEBUG_PRINT_INT(BENCH_RUNS);
+    DEBUG_PRINT(" calls per case");
+    DEBUG_PRINT_NEWLINE();
+    
+    report_case("flash", Mixer_RenderSampleFlash, 0);
+    report_case("flash", Mixer_RenderSampleFlash, 1);
+    report_case("sram ", Mixer_RenderSample, 0);
+    report_case("sram ", Mixer_RenderSample, 1);
+}
+
+#endif
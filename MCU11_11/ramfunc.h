@@ -0,0 +1,54 @@
+// ramfunc.h
+// Hot interrupt code and the vector table in SRAM
+//
+// Code marked RAMFUNC goes to the .ramfunc section, which the linker script
+// (STM32L4xx_Flash.icf) places in SRAM2 and the start-up code copies there
+// from flash. SRAM2 is mapped at 0x10000000 on the Cortex-M4 code bus, so
+// these routines run with no wait states and their timing does not depend on
+// whether the ART cache happens to hold them. With 4 flash wait states a
+// cache miss costs several cycles per 64-bit line.
+//
+// The project defines __VECTORS_IN_RAM, so the start-up code
+// (STM32L4xx_Startup.s) copies the vector table to SRAM2 as well and points
+// VTOR at it: the vector fetch on exception entry does not touch flash either.
+//
+// Keep RAMFUNC to short, hot routines (audio render, SPI byte transfer, the
+// H_INTN and tick handlers): SRAM2 is 16KB and is shared with data placed
+// there. Calls from RAM code to flash go through linker veneers.
+//
+// The gain has not been measured on a board yet, so USE_RAMFUNC is off by
+// default. Build with USE_RAMFUNC=1 RAMFUNC_BENCHMARK=1 to get the flash
+// and SRAM render cycle counts (warm and cold ART cache) at boot; turn it
+// on by default only with those numbers showing the SRAM render ahead.
+
+#ifndef RAMFUNC_H
+#define RAMFUNC_H
+
+#include <stdint.h>
+
+// Place RAMFUNC code in SRAM (0 = leave everything in flash)
+#ifndef USE_RAMFUNC
+#define USE_RAMFUNC  0
+#endif
+
+// Run RamFunc_ReportCycles() once at boot
+#ifndef RAMFUNC_BENCHMARK
+#define RAMFUNC_BENCHMARK  0
+#endif
+
+#if RAMFUNC_BENCHMARK && !USE_RAMFUNC
+#error "RAMFUNC_BENCHMARK compares flash with SRAM: build with USE_RAMFUNC=1"
+#endif
+
+#if USE_RAMFUNC
+#define RAMFUNC  __attribute__((section(".ramfunc"), noinline))
+#else
+#define RAMFUNC
+#endif
+
+// Function prototypes
+#if RAMFUNC_BENCHMARK
+void RamFunc_ReportCycles(void);
+#endif
+
+#endif // RAMFUNC_H
@@ -0,0 +1,246 @@
+// remote_control.c
+// Serial link commands and event streams implementation
+
+#include "remote_control.h"
+#include "drum_calibration.h"
+#include "drum_kit.h"
+#include "midi_out.h"  // For MidiOut_Velocity
+#include "sensor_capture.h"
+#include "audio_mixer.h"
+#include "config_store.h"
+#include "irq_priority.h"
+#include <stdint.h>
+#include <string.h>  // For memcpy
+
+#if SERIAL_LINK
+
+// Wire layouts are fixed (host/drumlink.py)
+typedef char link_hit_size_check[(sizeof(LinkHit_t) == 20) ? 1 : -1];
+typedef char link_telemetry_size_check[(sizeof(LinkTelemetry_t) == 52) ? 1 : -1];
+typedef char link_sensor_size_check[(sizeof(LinkSensor_t) == 24) ? 1 : -1];
+typedef char link_zone_map_size_check[(sizeof(DrumZoneMap_t) <= LINK_MAX_PAYLOAD) ? 1 : -1];
+
+// Stream settings (written by commands in thread mode, read by the sensor task)
+static volatile uint16_t telemetryMs = REMOTE_TELEMETRY_MS;
+static volatile bool captureOn = false;
+static uint32_t lastTelemetryMs = 0;
+
+// Latest sensor values for the telemetry snapshot (written by the sensor task)
+static float quat[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+static float gyro[3];
+static float linAccel[3];
+static uint32_t hitCount = 0;
+
+// Reply status for a CONFIG_STORE_* result
+static uint8_t store_status(int rc) {
+    if (rc == CONFIG_STORE_OK) {
+        return LINK_STATUS_OK;
+    }
+    return (rc == CONFIG_STORE_BUSY) ? LINK_STATUS_BUSY : LINK_STATUS_ERROR;
+}
+
+static uint8_t set_thresholds(const uint8_t *payload, uint16_t len) {
+    DrumThresholds_t t;
+    if (len != sizeof(t)) {
+        return LINK_STATUS_BAD_LENGTH;
+    }
+    memcpy(&t, payload, sizeof(t));
+    if (t.version != DRUM_THRESHOLDS_VERSION) {
+        return LINK_STATUS_BAD_VALUE;
+    }
+    
+    // The sensor task reads the thresholds on every report
+    uint32_t basepri = irq_mask_sensor();
+    int rc = DrumDetection_SetThresholds(&t);
+    irq_unmask(basepri);
+    return store_status(rc);
+}
+
+// An empty payload deletes the learned map (back to the default zones)
+static uint8_t set_zone_map(const uint8_t *payload, uint16_t len) {
+    const DrumZoneMap_t *map = (const DrumZoneMap_t *)payload;
+    if (len == 0) {
+        map = NULL;
+    } else if (len != sizeof(DrumZoneMap_t)) {
+        return LINK_STATUS_BAD_LENGTH;
+    } else if (map->version != DRUM_ZONE_MAP_VERSION) {
+        return LINK_STATUS_BAD_VALUE;
+    }
+    
+    uint32_t basepri = irq_mask_sensor();
+    int rc = DrumCalibration_SetZoneMap(map);
+    irq_unmask(basepri);
+    return store_status(rc);
+}
+
+static uint8_t set_kit(const uint8_t *payload, uint16_t len) {
+    if (len != 1) {
+        return LINK_STATUS_BAD_LENGTH;
+    }
+    if (payload[0] >= DRUM_KIT_COUNT) {
+        return LINK_STATUS_BAD_VALUE;
+    }
+    return store_status(DrumKit_Select(payload[0]));
+}
+
+static uint8_t set_streams(const uint8_t *payload, uint16_t len) {
+    LinkStreams_t s;
+    if (len != sizeof(s)) {
+        return LINK_STATUS_BAD_LENGTH;
+    }
+    memcpy(&s, payload, sizeof(s));
+    if (s.capture > LINK_CAPTURE_BATCHED) {
+        return LINK_STATUS_BAD_VALUE;
+    }
+    telemetryMs = s.telemetryMs;
+    captureOn = (s.capture == LINK_CAPTURE_REPORTS);
+    
+    // Restarting a batched capture sends a fresh header
+    if (s.capture == LINK_CAPTURE_BATCHED) {
+        SensorCapture_Start();
+    } else {
+        SensorCapture_Stop();
+    }
+    return LINK_STATUS_OK;
+}
+
+// One command from the host (SerialLink_Service, thread mode)
+// Get commands reply with the data, everything else with a status byte.
+static void handle_frame(uint8_t type, uint8_t seq, const uint8_t *payload, uint16_t len) {
+    uint8_t reply = type | LINK_REPLY;
+    uint8_t status;
+    
+    switch (type) {
+        case LINK_CMD_PING:
+            SerialLink_Send(reply, seq, payload, len);
+            return;
+        case LINK_CMD_GET_THRESHOLDS:
+            SerialLink_Send(reply, seq, DrumDetection_GetThresholds(), sizeof(DrumThresholds_t));
+            return;
+        case LINK_CMD_GET_ZONE_MAP: {
+            const DrumZoneMap_t *map = DrumCalibration_GetZoneMap();
+            SerialLink_Send(reply, seq, map, (map != NULL) ? sizeof(*map) : 0);
+            return;
+        }
+        case LINK_CMD_GET_KIT: {
+            LinkKit_t kit = { DrumKit_Current(), DRUM_KIT_COUNT };
+            SerialLink_Send(reply, seq, &kit, sizeof(kit));
+            return;
+        }
+        case LINK_CMD_SET_THRESHOLDS:
+            status = set_thresholds(payload, len);
+            break;
+        case LINK_CMD_SET_ZONE_MAP:
+            status = set_zone_map(payload, len);
+            break;
+        case LINK_CMD_SET_KIT:
+            status = set_kit(payload, len);
+            break;
+        case LINK_CMD_SET_STREAMS:
+            status = set_streams(payload, len);
+            break;
+        default:
+            status = LINK_STATUS_UNKNOWN;
+            break;
+    }
+    SerialLink_Send(reply, seq, &status, 1);
+}
+
+// Start the link (rxCallback: see SerialLink_Init)
+void RemoteControl_Init(SerialLinkRxCallback_t rxCallback) {
+    SerialLink_Init(handle_frame, rxCallback);
+}
+
+// Every decoded sensor report (sensor task): keep the latest values for
+// telemetry and stream the report while capture is on
+void RemoteControl_OnSensor(const sh2_SensorValue_t *value) {
+    LinkSensor_t r;
+    
+    SensorCapture_OnSensor(value);
+    
+    switch (value->sensorId) {
+        case SH2_GAME_ROTATION_VECTOR:
+            r.v[0] = quat[0] = value->un.gameRotationVector.real;
+            r.v[1] = quat[1] = value->un.gameRotationVector.i;
+            r.v[2] = quat[2] = value->un.gameRotationVector.j;
+            r.v[3] = quat[3] = value->un.gameRotationVector.k;
+            break;
+        case SH2_GYROSCOPE_CALIBRATED:
+            r.v[0] = gyro[0] = value->un.gyroscope.x;
+            r.v[1] = gyro[1] = value->un.gyroscope.y;
+            r.v[2] = gyro[2] = value->un.gyroscope.z;
+            r.v[3] = 0.0f;
+            break;
+        case SH2_LINEAR_ACCELERATION:
+            r.v[0] = linAccel[0] = value->un.linearAcceleration.x;
+            r.v[1] = linAccel[1] = value->un.linearAcceleration.y;
+            r.v[2] = linAccel[2] = value->un.linearAcceleration.z;
+            r.v[3] = 0.0f;
+            break;
+        default:
+            return;
+    }
+    
+    if (captureOn) {
+        r.timeUs = (uint32_t)value->timestamp;
+        r.sensorId = value->sensorId;
+        r.status = value->status;
+        r.reserved = 0;
+        SerialLink_SendEvent(LINK_EV_SENSOR, &r, sizeof(r));
+    }
+}
+
+// A detected hit (sensor task)
+void RemoteControl_OnHit(uint8_t drumId, const DrumHitState_t *state, uint32_t timeUs) {
+    LinkHit_t hit = {
+        .timeUs = timeUs,
+        .yaw = state->hitYaw,
+        .pitch = state->hitPitch,
+        .gyroY = state->hitGyroY,
+        .drumId = drumId,
+        .strokeType = state->lastStrokeType,
+        .velocity = MidiOut_Velocity(state->hitStrength, state->lastStrokeType),
+    };
+    hitCount++;
+    SerialLink_SendEvent(LINK_EV_HIT, &hit, sizeof(hit));
+}
+
+// Send a telemetry snapshot when one is due (1 ms tick, thread mode)
+void RemoteControl_Tick(uint32_t nowMs, bool sensorOk) {
+    SensorCapture_Tick(nowMs);
+    
+    uint16_t period = telemetryMs;
+    if (period == 0 || nowMs - lastTelemetryMs < period) {
+        return;
+    }
+    lastTelemetryMs = nowMs;
+    
+    LinkTelemetry_t t;
+    float q[4];
+    
+    // Copy the sensor task's values in one piece
+    uint32_t basepri = irq_mask_sensor();
+    memcpy(q, quat, sizeof(q));
+    memcpy(t.gyro, gyro, sizeof(t.gyro));
+    memcpy(t.linAccel, linAccel, sizeof(t.linAccel));
+    t.hits = hitCount;
+    irq_unmask(basepri);
+    
+    DrumDetection_QuaternionToEuler(q[0], q[1], q[2], q[3], &t.roll, &t.pitch, &t.yaw);
+    t.yaw = DrumDetection_NormalizeYaw(t.yaw - DrumDetection_GetYawOffset());
+    t.timeMs = nowMs;
+    t.txDropped = SerialLink_TxDropped();
+#if AUDIO_USE_MIXER
+    t.activeVoices = Mixer_ActiveVoices();
+#else
+    t.activeVoices = 0;
+#endif
+    t.kit = DrumKit_Current();
+    t.flags = (DrumCalibration_IsActive() ? LINK_TELEM_CALIBRATING : 0) |
+              (DrumCalibration_HasZoneMap() ? LINK_TELEM_ZONE_MAP : 0) |
+              (sensorOk ? LINK_TELEM_SENSOR_OK : 0);
+    t.reserved = 0;
+    SerialLink_SendEvent(LINK_EV_TELEMETRY, &t, sizeof(t));
+}
+
+#endif
@@ -0,0 +1,32 @@
+// remote_control.h
+// Serial link commands and event streams
+//
+// Connects the serial link (serial_link.h) to the rest of the firmware. Host
+// commands read or change the detection thresholds, the zone map and the
+// drum kit, and switch the event streams; changed settings are applied at
+// once and saved in the config store. Events go out unprompted: a hit event
+// per detected hit, a telemetry snapshot every LinkStreams_t.telemetryMs, and
+// every decoded sensor report while capture is on (one frame per report, or
+// in batches of raw records: sensor_capture.h).
+
+#ifndef REMOTE_CONTROL_H
+#define REMOTE_CONTROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "serial_link.h"
+#include "drum_detection.h"
+#include "sh2_SensorValue.h"
+
+// Telemetry period at boot (ms, 0 = off until the host asks)
+#ifndef REMOTE_TELEMETRY_MS
+#define REMOTE_TELEMETRY_MS  0
+#endif
+
+// Function prototypes
+void RemoteControl_Init(SerialLinkRxCallback_t rxCallback);
+void RemoteControl_OnSensor(const sh2_SensorValue_t *value);
+void RemoteControl_OnHit(uint8_t drumId, const DrumHitState_t *state, uint32_t timeUs);
+void RemoteControl_Tick(uint32_t nowMs, bool sensorOk);
+
+#endif // REMOTE_CONTROL_H
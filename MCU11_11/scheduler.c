@@ -0,0 +1,235 @@
+// scheduler.c
+// Event-driven run-to-completion scheduler implementation
+
+#include "scheduler.h"
+#include "irq_priority.h"
+#include "STM32L432KC_NVIC.h"
+#include "STM32L432KC_DWT.h"
+#include "STM32L432KC_RCC.h"   // For RCC_GetSysclkHz
+#include "STM32L432KC_RTT.h"  // For debug output (RTT)
+#include <stdint.h>
+#include <stddef.h>  // For NULL definition
+
+// Debug MCU configuration: keep the debug clock (RTT) running in Sleep mode
+#define DBGMCU_CR      (*((volatile uint32_t*)0xE0042004))
+#define DBGMCU_SLEEP   (1 << 0)
+
+// Per-task statistics for the current report window
+typedef struct {
+    SchedulerTask_t task;
+    const char *name;
+    uint32_t runs;
+    uint32_t cycles;     // Total run time in the window
+    uint32_t maxCycles;  // Longest single run in the window
+} SchedulerSlot_t;
+
+static SchedulerSlot_t slots[SCHED_NUM_EVENTS];
+static SchedulerTask_t idleHook = NULL;
+
+// Pending event bits (set from interrupts, cleared in thread mode or PendSV)
+static volatile uint32_t pending = 0;
+
+// Events whose tasks run in PendSV instead of thread mode
+static uint32_t deferred = 0;
+
+// Total cycles spent in PendSV (taken out of the thread-mode work it preempted)
+static volatile uint32_t deferredCycles = 0;
+
+// Milliseconds since Scheduler_Init, and at the start of the report window
+static volatile uint32_t millis = 0;
+static uint32_t windowStartMs = 0;
+static uint32_t idleHookCycles = 0;
+static uint32_t sleeps = 0;
+
+// Clear all tasks and statistics, start the cycle counter
+void Scheduler_Init(void) {
+    for (int e = 0; e < SCHED_NUM_EVENTS; e++) {
+        slots[e].task = NULL;
+        slots[e].name = "";
+        slots[e].runs = 0;
+        slots[e].cycles = 0;
+        slots[e].maxCycles = 0;
+    }
+    idleHook = NULL;
+    pending = 0;
+    deferred = 0;
+    deferredCycles = 0;
+    millis = 0;
+    windowStartMs = 0;
+    idleHookCycles = 0;
+    sleeps = 0;
+    
+    DWT_Init();
+    DBGMCU_CR |= DBGMCU_SLEEP;
+}
+
+// Bind a task to an event
+void Scheduler_AddTask(uint8_t event, SchedulerTask_t task, const char *name) {
+    if (event < SCHED_NUM_EVENTS) {
+        slots[event].task = task;
+        slots[event].name = name;
+    }
+}
+
+// Work to do before sleeping (log draining and other background output)
+void Scheduler_SetIdleHook(SchedulerTask_t hook) {
+    idleHook = hook;
+}
+
+// Run an event's task in PendSV (lowest interrupt priority) instead of
+// thread mode, so it preempts thread-mode tasks and the idle hook
+void Scheduler_SetDeferred(uint8_t event) {
+    if (event < SCHED_NUM_EVENTS) {
+        deferred |= (1UL << event);
+    }
+}
+
+// Mark an event pending (safe from interrupts and thread mode)
+// The update masks sensor I/O and below only; audio is never held off.
+void Scheduler_Post(uint8_t event) {
+    if (event >= SCHED_NUM_EVENTS) {
+        return;
+    }
+    uint32_t basepri = irq_mask_sensor();
+    pending |= (1UL << event);
+    irq_unmask(basepri);
+    
+    if (deferred & (1UL << event)) {
+        NVIC_TRIGGER_PENDSV();
+    }
+}
+
+// 1 ms tick (call from the SysTick interrupt)
+void Scheduler_Tick(void) {
+    millis++;
+    Scheduler_Post(SCHED_EV_TICK);
+}
+
+// Milliseconds since Scheduler_Init
+uint32_t Scheduler_Millis(void) {
+    return millis;
+}
+
+// Take the highest-priority pending event in mask, or -1 if none
+static int take_event(uint32_t mask) {
+    int event = -1;
+    uint32_t basepri = irq_mask_sensor();
+    uint32_t ready = pending & mask;
+    if (ready != 0) {
+        event = __builtin_ctz(ready);
+        pending &= ~(1UL << event);
+    }
+    irq_unmask(basepri);
+    return event;
+}
+
+// Run one event's task and account for its run time
+static void run_task(int event) {
+    SchedulerSlot_t *slot = &slots[event];
+    if (slot->task != NULL) {
+        uint32_t preempted = deferredCycles;
+        uint32_t start = DWT_GET_CYCLES();
+        slot->task();
+        uint32_t cycles = DWT_GET_CYCLES() - start - (deferredCycles - preempted);
+        slot->runs++;
+        slot->cycles += cycles;
+        if (cycles > slot->maxCycles) {
+            slot->maxCycles = cycles;
+        }
+    }
+}
+
+// Deferred tasks (PendSV runs only when no other handler is active)
+// A deferred task's time is counted in its own slot, and not again in the
+// thread-mode task or idle hook it preempted.
+void PendSV_Handler(void) {
+    uint32_t start = DWT_GET_CYCLES();
+    int event;
+    while ((event = take_event(deferred)) >= 0) {
+        run_task(event);
+    }
+    deferredCycles += DWT_GET_CYCLES() - start;
+}
+
+// Dispatch events forever
+void Scheduler_Run(void) {
+    while (1) {
+        int event = take_event(~deferred);
+        if (event >= 0) {
+            run_task(event);
+            continue;
+        }
+        
+        if (idleHook != NULL) {
+            uint32_t preempted = deferredCycles;
+            uint32_t start = DWT_GET_CYCLES();
+            idleHook();
+            idleHookCycles += DWT_GET_CYCLES() - start - (deferredCycles - preempted);
+        }
+        
+        // Sleep until an interrupt. With PRIMASK set, an event posted after
+        // the check still ends the WFI; its handler runs after cpsie.
+        __asm volatile ("cpsid i" : : : "memory");
+        if ((pending & ~deferred) == 0) {
+            __asm volatile ("dsb\n\twfi" : : : "memory");
+            sleeps++;
+        }
+        __asm volatile ("cpsie i" : : : "memory");
+    }
+}
+
+// Print per-task run counts, average/max run time and CPU share, and the
+// idle share, over the window since the last report; then start a new window
+// Idle is what the tasks and the idle hook did not use (the cycle counter
+// stops during WFI, so sleep is not measured directly).
+void Scheduler_Report(void) {
+    uint32_t windowMs = millis - windowStartMs;
+    if (windowMs == 0) {
+        return;
+    }
+    float cyclesPerUs = (float)RCC_GetSysclkHz() / 1000000.0f;
+    uint32_t windowCycles = windowMs * (RCC_GetSysclkHz() / 1000);
+    uint32_t busyCycles = idleHookCycles;
+    
+    DEBUG_PRINT("[Sched] ");
+    DEBUG_PRINT_INT(windowMs);
+    DEBUG_PRINT(" ms, task runs / avg us / max us / cpu%");
+    DEBUG_PRINT_NEWLINE();
+    
+    for (int e = 0; e < SCHED_NUM_EVENTS; e++) {
+        SchedulerSlot_t *slot = &slots[e];
+        if (slot->task == NULL) {
+            continue;
+        }
+        busyCycles += slot->cycles;
+        
+        DEBUG_PRINT("[Sched] ");
+        DEBUG_PRINT(slot->name);
+        DEBUG_PRINT(" ");
+        DEBUG_PRINT_INT(slot->runs);
+        DEBUG_PRINT(" / ");
+        DEBUG_PRINT_FLOAT(slot->runs ? (float)slot->cycles / slot->runs / cyclesPerUs : 0.0f, 1);
+        DEBUG_PRINT(" / ");
+        DEBUG_PRINT_FLOAT((float)slot->maxCycles / cyclesPerUs, 1);
+        DEBUG_PRINT(" / ");
+        DEBUG_PRINT_FLOAT(100.0f * slot->cycles / windowCycles, 1);
+        DEBUG_PRINT_NEWLINE();
+        
+        slot->runs = 0;
+        slot->cycles = 0;
+        slot->maxCycles = 0;
+    }
+    
+    float idle = 100.0f - 100.0f * busyCycles / windowCycles;
+    DEBUG_PRINT("[Sched] idle hook ");
+    DEBUG_PRINT_FLOAT(100.0f * idleHookCycles / windowCycles, 1);
+    DEBUG_PRINT("% | idle ");
+    DEBUG_PRINT_FLOAT(idle > 0.0f ? idle : 0.0f, 1);
+    DEBUG_PRINT("% | sleeps ");
+    DEBUG_PRINT_INT(sleeps);
+    DEBUG_PRINT_NEWLINE();
+    
+    idleHookCycles = 0;
+    sleeps = 0;
+    windowStartMs = millis;
+}
@@ -0,0 +1,48 @@
+// scheduler.h
+// Event-driven run-to-completion scheduler with WFI idle
+//
+// Interrupt handlers post events; Scheduler_Run() runs the task bound to the
+// highest-priority pending event (lowest event number first) to completion,
+// then looks again. With nothing pending it calls the idle hook and sleeps in
+// WFI until the next interrupt. Each event is a pending bit, so posts that
+// arrive while the task is queued or running coalesce into one run.
+//
+// Events marked with Scheduler_SetDeferred() run in PendSV instead, at the
+// lowest interrupt priority (irq_priority.h): they preempt thread-mode tasks
+// and the idle hook, and every other interrupt preempts them.
+//
+// Run time per task and the share of time spent idle are measured with the
+// DWT cycle counter over 1 ms scheduler ticks and printed by Scheduler_Report(),
+// converted at the SYSCLK that RCC_GetSysclkHz() reports.
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+// Replace the polling main loop with the scheduler
+#ifndef USE_SCHEDULER
+#define USE_SCHEDULER  1
+#endif
+
+// Events, in priority order (0 = highest)
+#define SCHED_EV_SENSOR    0  // BNO085 H_INTN asserted (EXTI1)
+#define SCHED_EV_TICK      1  // 1 ms SysTick: buttons, status
+#define SCHED_EV_LINK      2  // USART2 bytes received (serial_link.c)
+#define SCHED_NUM_EVENTS   3
+
+// Task: runs to completion in thread mode
+typedef void (*SchedulerTask_t)(void);
+
+// Function prototypes
+void Scheduler_Init(void);
+void Scheduler_AddTask(uint8_t event, SchedulerTask_t task, const char *name);
+void Scheduler_SetIdleHook(SchedulerTask_t hook);
+void Scheduler_SetDeferred(uint8_t event);
+void Scheduler_Post(uint8_t event);
+void Scheduler_Tick(void);
+uint32_t Scheduler_Millis(void);
+void Scheduler_Run(void);
+void Scheduler_Report(void);
+
+#endif // SCHEDULER_H
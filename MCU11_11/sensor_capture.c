@@ -0,0 +1,189 @@
+// sensor_capture.c
+// Batched binary capture of sensor reports over the serial link
+
+#include "sensor_capture.h"
+#include "serial_link.h"
+#include "irq_priority.h"
+#include "STM32L432KC_RTT.h"  // For debug output (RTT)
+#include "sh2.h"              // For SH2_* sensor ids
+#include <stdint.h>
+
+#if SERIAL_LINK
+
+typedef char capture_record_size_check[(sizeof(LinkCaptureRecord_t) == 16) ? 1 : -1];
+typedef char capture_header_size_check[(sizeof(LinkCaptureHeader_t) == 44) ? 1 : -1];
+typedef char capture_batch_fits_check[
+    (sizeof(LinkCaptureBatch_t) + SENSOR_CAPTURE_BATCH * sizeof(LinkCaptureRecord_t) <= LINK_MAX_PAYLOAD) ? 1 : -1];
+
+// Batch header and records, sent as one payload
+typedef struct {
+    LinkCaptureBatch_t hdr;
+    LinkCaptureRecord_t rec[SENSOR_CAPTURE_BATCH];
+} CaptureFrame_t;
+
+static LinkCaptureHeader_t header;
+
+// Shared by the sensor task and the tick (sensor interrupts masked)
+static CaptureFrame_t frame;
+static volatile bool active = false;
+static uint32_t nextRecord = 0;
+static uint32_t batchStartMs = 0;
+static volatile uint32_t lastTickMs = 0;
+
+static uint32_t recordsSent = 0;
+static uint32_t recordsDropped = 0;
+
+// Fixed-point scale of each sensor's values (as sh2_SensorValue.c decodes them)
+static int8_t q_point(uint8_t sensorId) {
+    switch (sensorId) {
+        case SH2_GAME_ROTATION_VECTOR:  return 14;
+        case SH2_GYROSCOPE_CALIBRATED:  return 9;
+        case SH2_LINEAR_ACCELERATION:   return 8;
+        default:                        return -1;
+    }
+}
+
+// Decoded value back to the hub's raw int16 (exact: it came from one)
+static int16_t to_fixed(float v, int8_t q) {
+    float scaled = v * (float)(1 << q);
+    return (int16_t)(scaled + ((scaled >= 0.0f) ? 0.5f : -0.5f));
+}
+
+// Send the pending batch; call with sensor interrupts masked
+static void send_batch(void) {
+    uint16_t count = frame.hdr.count;
+    if (count == 0) {
+        return;
+    }
+    
+    frame.hdr.firstRecord = nextRecord;
+    frame.hdr.reserved = 0;
+    if (SerialLink_SendEvent(LINK_EV_CAPTURE, &frame,
+                             sizeof(frame.hdr) + count * sizeof(LinkCaptureRecord_t))) {
+        recordsSent += count;
+    } else {
+        recordsDropped += count;  // The host sees the gap in firstRecord
+    }
+    nextRecord += count;
+    frame.hdr.count = 0;
+}
+
+// Record a sensor enabled at boot (main.c, after sh2_setSensorConfig)
+void SensorCapture_AddSensor(uint8_t sensorId, uint32_t intervalUs) {
+    if (header.sensorCount >= LINK_CAPTURE_MAX_SENSORS || q_point(sensorId) < 0) {
+        return;
+    }
+    LinkCaptureSensor_t *s = &header.sensors[header.sensorCount++];
+    s->sensorId = sensorId;
+    s->qPoint = q_point(sensorId);
+    s->reserved = 0;
+    s->intervalUs = intervalUs;
+}
+
+// Send the header and start recording (thread mode, from a host command)
+void SensorCapture_Start(void) {
+    header.magic = LINK_CAPTURE_MAGIC;
+    header.version = LINK_CAPTURE_VERSION;
+    header.recordSize = sizeof(LinkCaptureRecord_t);
+    
+    uint32_t basepri = irq_mask_sensor();
+    frame.hdr.count = 0;
+    nextRecord = 0;
+    recordsSent = 0;
+    recordsDropped = 0;
+    batchStartMs = lastTickMs;
+    SerialLink_SendEvent(LINK_EV_CAPTURE_HEADER, &header, sizeof(header));
+    active = true;
+    irq_unmask(basepri);
+}
+
+// Send what is left and stop
+void SensorCapture_Stop(void) {
+    uint32_t basepri = irq_mask_sensor();
+    if (active) {
+        send_batch();
+        active = false;
+    }
+    irq_unmask(basepri);
+}
+
+bool SensorCapture_Active(void) {
+    return active;
+}
+
+// Every decoded sensor report (sensor task)
+void SensorCapture_OnSensor(const sh2_SensorValue_t *value) {
+    if (!active) {
+        return;
+    }
+    int8_t q = q_point(value->sensorId);
+    if (q < 0) {
+        return;
+    }
+    
+    uint32_t basepri = irq_mask_sensor();
+    if (frame.hdr.count == 0) {
+        batchStartMs = lastTickMs;
+    }
+    LinkCaptureRecord_t *r = &frame.rec[frame.hdr.count++];
+    r->timeUs = (uint32_t)value->timestamp;
+    r->sensorId = value->sensorId;
+    r->status = value->status;
+    r->sequence = value->sequence;
+    r->reserved = 0;
+    
+    switch (value->sensorId) {
+        case SH2_GAME_ROTATION_VECTOR:
+            r->v[0] = to_fixed(value->un.gameRotationVector.real, q);
+            r->v[1] = to_fixed(value->un.gameRotationVector.i, q);
+            r->v[2] = to_fixed(value->un.gameRotationVector.j, q);
+            r->v[3] = to_fixed(value->un.gameRotationVector.k, q);
+            break;
+        case SH2_GYROSCOPE_CALIBRATED:
+            r->v[0] = to_fixed(value->un.gyroscope.x, q);
+            r->v[1] = to_fixed(value->un.gyroscope.y, q);
+            r->v[2] = to_fixed(value->un.gyroscope.z, q);
+            r->v[3] = 0;
+            break;
+        default:  // SH2_LINEAR_ACCELERATION
+            r->v[0] = to_fixed(value->un.linearAcceleration.x, q);
+            r->v[1] = to_fixed(value->un.linearAcceleration.y, q);
+            r->v[2] = to_fixed(value->un.linearAcceleration.z, q);
+            r->v[3] = 0;
+            break;
+    }
+    
+    if (frame.hdr.count == SENSOR_CAPTURE_BATCH) {
+        send_batch();
+    }
+    irq_unmask(basepri);
+}
+
+// Send a partly filled batch once it is SENSOR_CAPTURE_FLUSH_MS old (1 ms tick)
+void SensorCapture_Tick(uint32_t nowMs) {
+    lastTickMs = nowMs;
+    if (!active) {
+        return;
+    }
+    
+    uint32_t basepri = irq_mask_sensor();
+    if (frame.hdr.count != 0 && nowMs - batchStartMs >= SENSOR_CAPTURE_FLUSH_MS) {
+        send_batch();
+    }
+    irq_unmask(basepri);
+}
+
+// Print capture statistics while a capture runs
+void SensorCapture_Report(void) {
+    if (!active) {
+        return;
+    }
+    DEBUG_PRINT("[CAPTURE] ");
+    DEBUG_PRINT_INT(recordsSent);
+    DEBUG_PRINT(" records sent, ");
+    DEBUG_PRINT_INT(recordsDropped);
+    DEBUG_PRINT(" dropped");
+    DEBUG_PRINT_NEWLINE();
+}
+
+#endif
@@ -0,0 +1,46 @@
+// sensor_capture.h
+// Batched binary capture of sensor reports over the serial link
+//
+// For recording detector training data at full rate. Each decoded report
+// becomes a 16-byte LinkCaptureRecord_t holding the hub's raw fixed-point
+// values (exact, no float formatting), and records go out in batches of
+// SENSOR_CAPTURE_BATCH per LINK_EV_CAPTURE frame, so framing costs about 1%.
+// Three sensors at 1 kHz are 48 KB/s, half the 1 Mbaud link; the
+// per-report LINK_EV_SENSOR stream needs twice that.
+//
+// Capture starts when the host sets LinkStreams_t.capture to
+// LINK_CAPTURE_BATCHED: a LINK_EV_CAPTURE_HEADER with the sensor
+// configuration goes out first, then the batches. host/capture.py records
+// the stream and converts it to CSV and .npy columns.
+//
+// Reports arrive in the sensor task; a partly filled batch is sent from the
+// tick after SENSOR_CAPTURE_FLUSH_MS so low-rate captures are not held back.
+
+#ifndef SENSOR_CAPTURE_H
+#define SENSOR_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "serial_link_protocol.h"
+#include "sh2_SensorValue.h"
+
+// Records per LINK_EV_CAPTURE frame
+#ifndef SENSOR_CAPTURE_BATCH
+#define SENSOR_CAPTURE_BATCH  32
+#endif
+
+// Longest time a record waits in a partly filled batch
+#ifndef SENSOR_CAPTURE_FLUSH_MS
+#define SENSOR_CAPTURE_FLUSH_MS  20
+#endif
+
+// Function prototypes
+void SensorCapture_AddSensor(uint8_t sensorId, uint32_t intervalUs);
+void SensorCapture_Start(void);
+void SensorCapture_Stop(void);
+bool SensorCapture_Active(void);
+void SensorCapture_OnSensor(const sh2_SensorValue_t *value);
+void SensorCapture_Tick(uint32_t nowMs);
+void SensorCapture_Report(void);
+
+#endif // SENSOR_CAPTURE_H
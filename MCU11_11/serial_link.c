@@ -0,0 +1,368 @@
+// serial_link.c
+// DMA-driven framed binary link implementation
+
+#include "serial_link.h"
+#include "STM32L432KC_USART.h"
+#include "STM32L432KC_DMA.h"
+#include "STM32L432KC_NVIC.h"
+#include "STM32L432KC_RCC.h"
+#include "STM32L432KC_TIMER.h"  // Provides GPIOA and GPIO_TypeDef
+#include "STM32L432KC_RTT.h"    // For debug output (RTT)
+#include "irq_priority.h"
+#include "shtp_capture.h"
+#include "crc32.h"
+#include <stdint.h>
+#include <stddef.h>  // For NULL definition
+
+#if SERIAL_LINK
+
+#if SHTP_CAPTURE && SHTP_CAPTURE_SINK == SHTP_CAPTURE_SINK_UART
+#error "SHTP capture to USART2 and the serial link cannot share the port"
+#endif
+
+typedef char serial_link_tx_ring_check[(SERIAL_LINK_TX_RING_LEN >= LINK_COBS_MAX(LINK_MAX_RAW)) ? 1 : -1];
+
+// DMA1 channels for USART2
+#define LINK_RX_CHANNEL  6
+#define LINK_TX_CHANNEL  7
+#define RX_DMA  DMA1_CHANNEL(LINK_RX_CHANNEL)
+#define TX_DMA  DMA1_CHANNEL(LINK_TX_CHANNEL)
+
+#define RCC_APB1ENR1_USART2EN  (1 << 17)
+#define TX_MASK  (SERIAL_LINK_TX_RING_LEN - 1)
+#define RX_MASK  (SERIAL_LINK_RX_DMA_LEN - 1)
+
+// Transmit ring (head and tail are free-running byte counts)
+// head moves with sensor interrupts masked; tail and the DMA state move in
+// the DMA interrupt, which that mask also holds off.
+static uint8_t txRing[SERIAL_LINK_TX_RING_LEN];
+static uint32_t txHead = 0;
+static volatile uint32_t txTail = 0;
+static volatile uint32_t txInFlight = 0;  // Bytes of the running DMA transfer
+
+// COBS encoder position while a frame is written
+static uint32_t encHead;
+static uint32_t encCodePos;
+static uint8_t encCode;
+
+// Receive: circular DMA buffer and the frame being decoded
+static uint8_t rxDma[SERIAL_LINK_RX_DMA_LEN];
+static uint32_t rxRead = 0;
+static uint8_t rxFrame[LINK_MAX_RAW] __attribute__((aligned(4)));  // Payload at +2 is 2-byte aligned
+static uint16_t rxLen = 0;
+static uint8_t rxLeft = 0;      // Data bytes left in the current COBS block
+static uint8_t rxCode = 0;      // Code byte of the current block (0 = none yet)
+static bool rxDiscard = false;  // Frame too long: skip to the next delimiter
+
+static SerialLinkFrameHandler_t frameHandler = NULL;
+static SerialLinkRxCallback_t rxNotify = NULL;
+static bool linkReady = false;
+static uint8_t eventSeq = 0;
+
+// Statistics
+static uint32_t txFrames = 0;
+static uint32_t txDropped = 0;
+static uint32_t rxFrames = 0;
+static uint32_t rxBadFrames = 0;
+static volatile uint32_t lineErrors = 0;
+
+// Start DMA on the next contiguous run of the ring, if idle
+// Called with sensor interrupts masked or from the DMA interrupt.
+static void tx_start(void) {
+    if (txInFlight != 0) {
+        return;
+    }
+    uint32_t pending = txHead - txTail;
+    if (pending == 0) {
+        return;
+    }
+    
+    // Ring may wrap: send up to the end of the buffer now, the rest next time
+    uint32_t start = txTail & TX_MASK;
+    uint32_t len = SERIAL_LINK_TX_RING_LEN - start;
+    if (len > pending) {
+        len = pending;
+    }
+    txInFlight = len;
+    
+    TX_DMA->CCR &= ~DMA_CCR_EN;
+    TX_DMA->CMAR = (uint32_t)&txRing[start];
+    TX_DMA->CNDTR = len;
+    TX_DMA->CCR |= DMA_CCR_EN;
+}
+
+// COBS encoder: each block is a code byte (1 + data bytes that follow)
+// and up to 254 non-zero bytes; a code below 0xFF stands for a zero after
+// the block. The code byte is reserved first and filled in when the block
+// ends.
+static void enc_block(void) {
+    encCodePos = encHead++;
+    encCode = 1;
+}
+
+static void enc_bytes(const uint8_t *data, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        if (data[i] == 0) {
+            txRing[encCodePos & TX_MASK] = encCode;
+            enc_block();
+            continue;
+        }
+        txRing[encHead++ & TX_MASK] = data[i];
+        if (++encCode == 0xFF) {
+            txRing[encCodePos & TX_MASK] = encCode;
+            enc_block();
+        }
+    }
+}
+
+static void enc_finish(void) {
+    txRing[encCodePos & TX_MASK] = encCode;
+    txRing[encHead++ & TX_MASK] = 0x00;
+}
+
+// Configure USART2 and both DMA channels, and start receiving
+// handler: called for each valid frame from SerialLink_Service()
+// rxCallback: called in interrupt context when received bytes are waiting
+void SerialLink_Init(SerialLinkFrameHandler_t handler, SerialLinkRxCallback_t rxCallback) {
+    frameHandler = handler;
+    rxNotify = rxCallback;
+    
+    // Enable GPIOA and USART2 clocks
+    RCC->AHB2ENR |= (1 << 0);
+    RCC->APB1ENR1 |= RCC_APB1ENR1_USART2EN;
+    (void)RCC->APB1ENR1;
+    
+    // PA2 (TX) and PA3 (RX): alternate function 7, RX pulled up when idle
+    GPIOA->MODER &= ~((0b11 << (2 * 2)) | (0b11 << (2 * 3)));
+    GPIOA->MODER |= (0b10 << (2 * 2)) | (0b10 << (2 * 3));
+    GPIOA->AFRL &= ~((0b1111 << (4 * 2)) | (0b1111 << (4 * 3)));
+    GPIOA->AFRL |= (0b0111 << (4 * 2)) | (0b0111 << (4 * 3));
+    GPIOA->OSPEEDR |= (0b11 << (2 * 2));
+    GPIOA->PURPDR = (GPIOA->PURPDR & ~(0b11 << (2 * 3))) | (0b01 << (2 * 3));
+    
+    // Reset USART2
+    RCC->APB1RSTR1 |= RCC_APB1ENR1_USART2EN;
+    RCC->APB1RSTR1 &= ~RCC_APB1ENR1_USART2EN;
+    
+    // Receive: circular DMA from RDR, interrupts at half and full buffer
+    DMA1_Enable();
+    DMA1_SelectRequest(LINK_RX_CHANNEL, DMA1_CH6_USART2_RX);
+    DMA1_SelectRequest(LINK_TX_CHANNEL, DMA1_CH7_USART2_TX);
+    
+    RX_DMA->CCR = 0;
+    RX_DMA->CPAR = (uint32_t)&USART2->RDR;
+    RX_DMA->CMAR = (uint32_t)rxDma;
+    RX_DMA->CNDTR = SERIAL_LINK_RX_DMA_LEN;
+    RX_DMA->CCR = DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_PL_HIGH;
+    RX_DMA->CCR |= DMA_CCR_EN;
+    
+    // Transmit: memory to TDR, started per contiguous run by tx_start()
+    TX_DMA->CCR = 0;
+    TX_DMA->CPAR = (uint32_t)&USART2->TDR;
+    TX_DMA->CCR = DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_TCIE | DMA_CCR_TEIE;
+    DMA1->IFCR = DMA_FLAG_GIF(LINK_RX_CHANNEL) | DMA_FLAG_GIF(LINK_TX_CHANNEL);
+    
+    txHead = 0;
+    txTail = 0;
+    txInFlight = 0;
+    rxRead = 0;
+    rxLen = 0;
+    rxLeft = 0;
+    rxCode = 0;
+    rxDiscard = false;
+    eventSeq = 0;
+    
+    // 8N1, 16x oversampling; an overrun keeps the receiver running (the lost
+    // byte shows up as a bad CRC)
+    USART2->BRR = USART_BRR(RCC_GetSysclkHz(), SERIAL_LINK_BAUD);
+    USART2->CR3 = USART_CR3_DMAR | USART_CR3_DMAT | USART_CR3_OVRDIS | USART_CR3_EIE;
+    USART2->CR1 = USART_CR1_UE | USART_CR1_RE | USART_CR1_TE | USART_CR1_IDLEIE;
+    
+    NVIC_EnableIRQ(IRQN_DMA1_CH6);
+    NVIC_EnableIRQ(IRQN_DMA1_CH7);
+    NVIC_EnableIRQ(IRQN_USART2);
+    linkReady = true;
+}
+
+// Encode one frame into the transmit ring and start DMA if idle
+// Events take the next event sequence number here, inside the mask, so the
+// sequence order on the wire is the order of the frames.
+static bool queue_frame(uint8_t type, bool event, uint8_t seq, const void *payload, uint16_t len) {
+    if (!linkReady || len > LINK_MAX_PAYLOAD) {
+        return false;
+    }
+    uint32_t need = LINK_COBS_MAX(LINK_HDR_LEN + (uint32_t)len + LINK_CRC_LEN);
+    
+    uint32_t basepri = irq_mask_sensor();
+    if (event) {
+        seq = eventSeq++;
+    }
+    if (need > SERIAL_LINK_TX_RING_LEN - (txHead - txTail)) {
+        txDropped++;
+        irq_unmask(basepri);
+        return false;
+    }
+    
+    uint8_t hdr[LINK_HDR_LEN] = { type, seq };
+    uint32_t crc = CRC32_Update(CRC32_Update(0, hdr, LINK_HDR_LEN), payload, len);
+    uint8_t crcBytes[LINK_CRC_LEN] = {
+        (uint8_t)crc, (uint8_t)(crc >> 8), (uint8_t)(crc >> 16), (uint8_t)(crc >> 24)
+    };
+    
+    encHead = txHead;
+    enc_block();
+    enc_bytes(hdr, LINK_HDR_LEN);
+    enc_bytes((const uint8_t *)payload, len);
+    enc_bytes(crcBytes, LINK_CRC_LEN);
+    enc_finish();
+    txHead = encHead;
+    txFrames++;
+    
+    tx_start();
+    irq_unmask(basepri);
+    return true;
+}
+
+// Queue a reply to a command (seq = the command's seq)
+// Returns false (and counts a drop) if the link is down or the ring is full.
+bool SerialLink_Send(uint8_t type, uint8_t seq, const void *payload, uint16_t len) {
+    return queue_frame(type, false, seq, payload, len);
+}
+
+// Queue a device event with the next event sequence number
+// A dropped event still uses its number, so the host sees the gap.
+bool SerialLink_SendEvent(uint8_t type, const void *payload, uint16_t len) {
+    return queue_frame(type, true, 0, payload, len);
+}
+
+// A complete frame: check length and CRC, then hand it on
+static void rx_frame(void) {
+    if (rxLen < LINK_HDR_LEN + LINK_CRC_LEN) {
+        rxBadFrames++;
+        return;
+    }
+    
+    uint16_t bodyLen = rxLen - LINK_CRC_LEN;
+    const uint8_t *c = &rxFrame[bodyLen];
+    uint32_t crc = (uint32_t)c[0] | ((uint32_t)c[1] << 8) | ((uint32_t)c[2] << 16) | ((uint32_t)c[3] << 24);
+    if (CRC32_Compute(rxFrame, bodyLen) != crc) {
+        rxBadFrames++;
+        return;
+    }
+    
+    rxFrames++;
+    if (frameHandler != NULL) {
+        frameHandler(rxFrame[0], rxFrame[1], &rxFrame[LINK_HDR_LEN], bodyLen - LINK_HDR_LEN);
+    }
+}
+
+static void rx_put(uint8_t b) {
+    if (rxLen >= sizeof(rxFrame)) {
+        rxDiscard = true;
+        return;
+    }
+    rxFrame[rxLen++] = b;
+}
+
+// COBS decoder, one received byte at a time
+static void rx_byte(uint8_t b) {
+    if (b == 0x00) {
+        // Delimiter: the frame is complete if its last block is
+        if (rxCode != 0) {
+            if (rxLeft != 0 || rxDiscard) {
+                rxBadFrames++;
+            } else {
+                rx_frame();
+            }
+        }
+        rxLen = 0;
+        rxLeft = 0;
+        rxCode = 0;
+        rxDiscard = false;
+        return;
+    }
+    if (rxDiscard) {
+        return;
+    }
+    
+    if (rxLeft == 0) {
+        // Code byte: the previous block (unless a full one) ended in a zero
+        if (rxCode != 0 && rxCode != 0xFF) {
+            rx_put(0x00);
+        }
+        rxCode = b;
+        rxLeft = b - 1;
+    } else {
+        rx_put(b);
+        rxLeft--;
+    }
+}
+
+// Decode the bytes received since the last call (call from thread mode)
+void SerialLink_Service(void) {
+    if (!linkReady) {
+        return;
+    }
+    
+    uint32_t write = (SERIAL_LINK_RX_DMA_LEN - RX_DMA->CNDTR) & RX_MASK;
+    while (rxRead != write) {
+        rx_byte(rxDma[rxRead]);
+        rxRead = (rxRead + 1) & RX_MASK;
+    }
+}
+
+// Frames lost to a full transmit ring since init
+uint32_t SerialLink_TxDropped(void) {
+    return txDropped;
+}
+
+// Print link statistics
+void SerialLink_Report(void) {
+    DEBUG_PRINT("[Link] USART2 ");
+    DEBUG_PRINT_INT(SERIAL_LINK_BAUD);
+    DEBUG_PRINT(" baud: rx ");
+    DEBUG_PRINT_INT(rxFrames);
+    DEBUG_PRINT(" frames (");
+    DEBUG_PRINT_INT(rxBadFrames);
+    DEBUG_PRINT(" bad, ");
+    DEBUG_PRINT_INT(lineErrors);
+    DEBUG_PRINT(" line errors), tx ");
+    DEBUG_PRINT_INT(txFrames);
+    DEBUG_PRINT(" frames (");
+    DEBUG_PRINT_INT(txDropped);
+    DEBUG_PRINT(" dropped)");
+    DEBUG_PRINT_NEWLINE();
+}
+
+// Transmit run finished: release it and start the next one
+void DMA1_Channel7_IRQHandler(void) {
+    DMA1->IFCR = DMA_FLAG_GIF(LINK_TX_CHANNEL);
+    TX_DMA->CCR &= ~DMA_CCR_EN;
+    txTail += txInFlight;
+    txInFlight = 0;
+    tx_start();
+}
+
+// Receive buffer half or completely filled
+void DMA1_Channel6_IRQHandler(void) {
+    DMA1->IFCR = DMA_FLAG_GIF(LINK_RX_CHANNEL);
+    if (rxNotify != NULL) {
+        rxNotify();
+    }
+}
+
+// Line went idle after a burst (end of a command), or a line error
+void USART2_IRQHandler(void) {
+    uint32_t isr = USART2->ISR;
+    
+    if (isr & (USART_ISR_FE | USART_ISR_NE | USART_ISR_ORE)) {
+        lineErrors++;
+    }
+    USART2->ICR = USART_ICR_IDLECF | USART_ICR_FECF | USART_ICR_NCF | USART_ICR_ORECF;
+    
+    if ((isr & USART_ISR_IDLE) && rxNotify != NULL) {
+        rxNotify();
+    }
+}
+
+#endif
@@ -0,0 +1,67 @@
+// serial_link.h
+// DMA-driven framed binary link on USART2
+//
+// Carries the messages in serial_link_protocol.h between the firmware and a
+// host (host/drumlink.py) over USART2 (PA2 TX, PA3 RX; the Nucleo-32 routes
+// PA2 to the ST-LINK virtual COM port). Neither direction costs CPU per byte:
+//
+//   TX  SerialLink_Send() COBS-encodes a frame into a RAM ring and DMA1
+//       channel 7 streams the ring to the USART. The DMA complete interrupt
+//       starts the next contiguous run, so frames queued from the sensor task
+//       and from thread mode go out back to back.
+//   RX  DMA1 channel 6 copies received bytes into a circular buffer. The
+//       USART idle-line interrupt and the DMA half/full interrupts call the
+//       receive callback, which posts a scheduler event; SerialLink_Service()
+//       then decodes the new bytes and passes each valid frame to the frame
+//       handler in thread mode.
+//
+// The transmit ring has more than one producer (sensor task in PendSV,
+// tick/link tasks in thread mode), so frames are written with sensor-level
+// interrupts masked (irq_mask_sensor). A frame that does not fit is dropped
+// whole and counted; each frame is encoded with that mask held, so keep
+// large replies (the 1 KB zone map) to rare commands.
+
+#ifndef SERIAL_LINK_H
+#define SERIAL_LINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "serial_link_protocol.h"
+
+// Enable the serial link (USART2 and DMA1 channels 6/7)
+#ifndef SERIAL_LINK
+#define SERIAL_LINK  1
+#endif
+
+// Line rate; the USART divides SYSCLK by 16 x BRR, so 1 and 2 Mbaud are exact
+#ifndef SERIAL_LINK_BAUD
+#define SERIAL_LINK_BAUD  1000000
+#endif
+
+// Transmit ring (power of 2); must hold the largest encoded frame
+#ifndef SERIAL_LINK_TX_RING_LEN
+#define SERIAL_LINK_TX_RING_LEN  2048
+#endif
+
+// Circular receive buffer (power of 2). Must cover the bytes that arrive
+// while thread mode is busy: 512 B is 5 ms at 1 Mbaud.
+#ifndef SERIAL_LINK_RX_DMA_LEN
+#define SERIAL_LINK_RX_DMA_LEN  512
+#endif
+
+// Frame handler: called from SerialLink_Service() for each frame whose CRC
+// checks out. The payload is 2-byte aligned and valid until the call returns.
+typedef void (*SerialLinkFrameHandler_t)(uint8_t type, uint8_t seq, const uint8_t *payload, uint16_t len);
+
+// Receive notification: called in interrupt context when bytes are waiting
+typedef void (*SerialLinkRxCallback_t)(void);
+
+// Function prototypes
+void SerialLink_Init(SerialLinkFrameHandler_t handler, SerialLinkRxCallback_t rxCallback);
+bool SerialLink_Send(uint8_t type, uint8_t seq, const void *payload, uint16_t len);
+bool SerialLink_SendEvent(uint8_t type, const void *payload, uint16_t len);
+void SerialLink_Service(void);
+uint32_t SerialLink_TxDropped(void);
+void SerialLink_Report(void);
+
+#endif // SERIAL_LINK_H
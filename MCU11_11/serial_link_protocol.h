@@ -0,0 +1,161 @@
+// serial_link_protocol.h
+// Message set of the USART2 serial link (serial_link.c, remote_control.c)
+//
+// Frame on the wire:
+//   COBS(type, seq, payload..., CRC32) 0x00
+// COBS removes every zero byte from the frame, so 0x00 only ever marks the
+// end of a frame and a receiver that starts mid-stream resynchronises at the
+// next one. The CRC32 (crc32.h, same as Python binascii.crc32) covers type,
+// seq and payload and is sent little-endian.
+//
+// Commands go from the host to the device (type < 0x80). Each one is answered
+// by a reply with type | LINK_REPLY and the command's seq, so the host can
+// match replies to requests and retry on a timeout. Device events (type >=
+// 0xC0) are sent unprompted with their own running seq; a gap means frames
+// were dropped on a full transmit ring.
+//
+// Payloads are the little-endian structs below (laid out without padding)
+// or the firmware structs named at each message. host/drumlink.py mirrors
+// this file; change both together.
+
+#ifndef SERIAL_LINK_PROTOCOL_H
+#define SERIAL_LINK_PROTOCOL_H
+
+#include <stdint.h>
+
+#define LINK_HDR_LEN       2     // type, seq
+#define LINK_CRC_LEN       4
+#define LINK_MAX_PAYLOAD   1040  // Largest payload (the zone map is 1028)
+#define LINK_MAX_RAW       (LINK_HDR_LEN + LINK_MAX_PAYLOAD + LINK_CRC_LEN)
+
+// Worst-case COBS size of n bytes, plus the 0x00 delimiter
+#define LINK_COBS_MAX(n)   ((n) + (n) / 254 + 2)
+
+// Commands (host to device)                 Payload -> reply payload
+#define LINK_CMD_PING            0x01  // any bytes -> the same bytes
+#define LINK_CMD_GET_THRESHOLDS  0x02  // none -> DrumThresholds_t
+#define LINK_CMD_SET_THRESHOLDS  0x03  // DrumThresholds_t -> status
+#define LINK_CMD_GET_ZONE_MAP    0x04  // none -> DrumZoneMap_t, or none if unset
+#define LINK_CMD_SET_ZONE_MAP    0x05  // DrumZoneMap_t, or none to delete -> status
+#define LINK_CMD_GET_KIT         0x06  // none -> LinkKit_t
+#define LINK_CMD_SET_KIT         0x07  // uint8 kit -> status
+#define LINK_CMD_SET_STREAMS     0x08  // LinkStreams_t -> status
+
+#define LINK_REPLY               0x80  // Reply type = command | LINK_REPLY
+
+// Device events
+#define LINK_EV_HIT              0xC0  // LinkHit_t
+#define LINK_EV_TELEMETRY        0xC1  // LinkTelemetry_t
+#define LINK_EV_SENSOR           0xC2  // LinkSensor_t (capture stream)
+#define LINK_EV_CAPTURE_HEADER   0xC3  // LinkCaptureHeader_t (batched capture start)
+#define LINK_EV_CAPTURE          0xC4  // LinkCaptureBatch_t + records
+
+// Status byte of a reply to a set command (or to an unknown command)
+#define LINK_STATUS_OK           0
+#define LINK_STATUS_UNKNOWN      1  // Unknown command
+#define LINK_STATUS_BAD_LENGTH   2  // Payload size does not match the command
+#define LINK_STATUS_BAD_VALUE    3  // Field out of range (version, kit number)
+#define LINK_STATUS_BUSY         4  // Applied, but the flash store is still
+                                    // writing an earlier value: retry to save
+#define LINK_STATUS_ERROR        5
+
+// LINK_EV_HIT: one detected drum hit
+typedef struct {
+    uint32_t timeUs;       // Sensor hub timestamp of the report that triggered it
+    float yaw;             // Degrees, offset-corrected, 0..360
+    float pitch;           // Degrees
+    int16_t gyroY;         // Raw gyro_y at the hit
+    uint8_t drumId;        // DRUM_* (drum_detection.h)
+    uint8_t strokeType;    // STROKE_* (stroke_recognizer.h)
+    uint8_t velocity;      // 1..127, from the swing speed (MidiOut_Velocity)
+    uint8_t reserved[3];
+} LinkHit_t;
+
+// LINK_EV_TELEMETRY: periodic snapshot (LinkStreams_t.telemetryMs)
+#define LINK_TELEM_CALIBRATING  (1 << 0)  // Zone calibration running
+#define LINK_TELEM_ZONE_MAP     (1 << 1)  // Learned zone map in use
+#define LINK_TELEM_SENSOR_OK    (1 << 2)  // SH2 open
+
+typedef struct {
+    uint32_t timeMs;
+    float roll;            // Degrees, from the last game rotation vector
+    float pitch;
+    float yaw;             // Offset-corrected
+    float gyro[3];         // rad/s
+    float linAccel[3];     // m/s^2
+    uint32_t hits;         // Hits since boot
+    uint32_t txDropped;    // Link frames lost to a full transmit ring
+    uint8_t activeVoices;
+    uint8_t kit;
+    uint8_t flags;         // LINK_TELEM_*
+    uint8_t reserved;
+} LinkTelemetry_t;
+
+// LINK_EV_SENSOR: one decoded sensor report, while capture is on
+typedef struct {
+    uint32_t timeUs;       // Sensor hub timestamp
+    uint8_t sensorId;      // SH2_GAME_ROTATION_VECTOR, SH2_GYROSCOPE_CALIBRATED, ...
+    uint8_t status;        // Accuracy bits of the report
+    uint16_t reserved;
+    float v[4];            // real,i,j,k / x,y,z,0
+} LinkSensor_t;
+
+// Batched binary capture (sensor_capture.h). A capture file (.dcap) is the
+// header event's payload followed by the records of every batch, so it
+// loads directly as a fixed-size record array on the host.
+#define LINK_CAPTURE_MAGIC        0x50414344  // "DCAP"
+#define LINK_CAPTURE_VERSION      1
+#define LINK_CAPTURE_MAX_SENSORS  4
+
+typedef struct {
+    uint8_t sensorId;      // SH2_GAME_ROTATION_VECTOR, ...
+    int8_t qPoint;         // Record values are v * 2^-qPoint
+    uint16_t reserved;
+    uint32_t intervalUs;   // Report interval requested from the hub
+} LinkCaptureSensor_t;
+
+// LINK_EV_CAPTURE_HEADER: sent when batched capture starts
+typedef struct {
+    uint32_t magic;        // LINK_CAPTURE_MAGIC
+    uint16_t version;      // LINK_CAPTURE_VERSION
+    uint16_t recordSize;   // sizeof(LinkCaptureRecord_t)
+    uint8_t sensorCount;
+    uint8_t reserved[3];
+    LinkCaptureSensor_t sensors[LINK_CAPTURE_MAX_SENSORS];
+} LinkCaptureHeader_t;
+
+// One sensor report, as the raw fixed-point values the hub sent
+typedef struct {
+    uint32_t timeUs;       // Sensor hub timestamp
+    uint8_t sensorId;
+    uint8_t status;        // Accuracy bits of the report
+    uint8_t sequence;      // Hub report sequence, per sensor (gap = lost in the hub/SPI)
+    uint8_t reserved;
+    int16_t v[4];          // real,i,j,k / x,y,z,0
+} LinkCaptureRecord_t;
+
+// LINK_EV_CAPTURE: count records follow
+typedef struct {
+    uint32_t firstRecord;  // Index of the first record since capture start
+    uint16_t count;        // (gap = records lost on a full transmit ring)
+    uint16_t reserved;
+} LinkCaptureBatch_t;
+
+// LINK_CMD_SET_STREAMS
+#define LINK_CAPTURE_OFF      0
+#define LINK_CAPTURE_REPORTS  1  // Every sensor report as LINK_EV_SENSOR
+#define LINK_CAPTURE_BATCHED  2  // LINK_EV_CAPTURE_HEADER, then LINK_EV_CAPTURE
+
+typedef struct {
+    uint16_t telemetryMs;  // Telemetry period, 0 = off
+    uint8_t capture;       // LINK_CAPTURE_*
+    uint8_t reserved;
+} LinkStreams_t;
+
+// LINK_CMD_GET_KIT reply
+typedef struct {
+    uint8_t kit;           // Selected kit
+    uint8_t kitCount;      // Kits available (0..kitCount-1)
+} LinkKit_t;
+
+#endif // SERIAL_LINK_PROTOCOL_H
@@ -813,6 +813,9 @@ typedef PACKED_STRUCT {
     uint32_t sensorSpecific;
 } SetFeatureReport_t;
 
+// The HAL out buffer is sized for this request (sh2_hal.h)
+typedef char set_feature_size_check[(sizeof(SetFeatureReport_t) <= SH2_MAX_CARGO_OUT) ? 1 : -1];
+
 static int setSensorConfigStart(sh2_t *pSh2)
 {
     SetFeatureReport_t req;
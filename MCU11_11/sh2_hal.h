@@ -25,20 +25,41 @@
 
 #include <stdint.h>
 
-// SH2 Implementations generally have a max out transfer len of 256
-#define SH2_HAL_MAX_TRANSFER_OUT (256)
-#define SH2_HAL_MAX_PAYLOAD_OUT  (256)
+// Buffer sizes below are fixed bounds for what this firmware sends and
+// receives, not the protocol maxima. The report lengths are the BNO085
+// datasheet values (the hub advertises them at run time); main.c and sh2.c
+// check at compile time that their requests and enabled reports fit. Check
+// the RAM they take with host/ram_map.py.
 
-// Although some implementations adversize a max in transfer of 32K,
-// in practice, the largest transfer performed is the advertisements
-// which is 272 bytes at time of writing.
-// NOTE: BNO085 can send advertisement packets up to 528 bytes,
-// so we need a larger buffer to handle them.
-#define SH2_HAL_MAX_TRANSFER_IN  (640)  // Increased from 384 to handle 528-byte advertisements
-#define SH2_HAL_MAX_PAYLOAD_IN   (640)  // Increased from 384 to handle 528-byte advertisements
+// Out: shtp.c splits a payload over as many transfers as needed, so the
+// transfer buffer only has to hold the largest single request sh2.c sends
+// (Set Feature, 17 bytes) in one piece. Payloads are still limited to 256.
+#define SH2_MAX_CARGO_OUT        (17)
+#define SH2_HAL_MAX_TRANSFER_OUT (4 + SH2_MAX_CARGO_OUT)  // SHTP header + cargo
+#define SH2_HAL_MAX_PAYLOAD_OUT  (256)
 
-// This needs to be a power of 2, greater than max of the above.
-#define SH2_HAL_DMA_SIZE (1024)  // Increased from 512 to accommodate larger buffers
+// In: the largest payload is the advertisement at startup (the BNO085 sends
+// it as one 528-byte transfer). Hub firmware that advertises more apps or
+// channels sends a longer one, so the bound has headroom over that; a
+// transfer that still does not fit is dropped by the SPI HAL with a
+// BL_SPI_OVERSIZE log record. At run time a transfer carries a timebase
+// reference plus queued input reports of the kinds main.c enables: game
+// rotation vector, calibrated gyroscope and linear acceleration. The buffer
+// is sized for whichever is larger; shtp.c assembles payloads in place, so
+// this is the only receive buffer.
+#define SH2_ADVERT_PAYLOAD_LEN   (524)  // BNO085 advertisement as received
+#define SH2_PAYLOAD_IN_HEADROOM  (64)
+#define SH2_ADVERT_PAYLOAD_MAX   (SH2_ADVERT_PAYLOAD_LEN + SH2_PAYLOAD_IN_HEADROOM)
+#define SH2_REPORT_LEN_TIMEBASE  (5)
+#define SH2_REPORT_LEN_GRV       (12)
+#define SH2_REPORT_LEN_GYRO      (10)
+#define SH2_REPORT_LEN_LINACC    (10)
+#define SH2_REPORT_BATCH_DEPTH   (4)  // Reports of each kind per transfer when the host lags
+#define SH2_INPUT_PAYLOAD_MAX    (SH2_REPORT_LEN_TIMEBASE + SH2_REPORT_BATCH_DEPTH * \
+                                  (SH2_REPORT_LEN_GRV + SH2_REPORT_LEN_GYRO + SH2_REPORT_LEN_LINACC))
+#define SH2_HAL_MAX_PAYLOAD_IN   (SH2_ADVERT_PAYLOAD_MAX > SH2_INPUT_PAYLOAD_MAX ? \
+                                  SH2_ADVERT_PAYLOAD_MAX : SH2_INPUT_PAYLOAD_MAX)
+#define SH2_HAL_MAX_TRANSFER_IN  (4 + SH2_HAL_MAX_PAYLOAD_IN)
 
 typedef struct sh2_Hal_s sh2_Hal_t;
 
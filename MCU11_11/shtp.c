@@ -103,10 +103,12 @@ typedef struct shtp_s {
     uint16_t inMaxTransfer;
     uint16_t inRemaining;
     uint8_t  inChan;
-    uint8_t  inPayload[SH2_HAL_MAX_PAYLOAD_IN];
     uint16_t inCursor;
     uint32_t inTimestamp;
-    uint8_t inTransfer[SH2_HAL_MAX_TRANSFER_IN];
+    // Payload under assembly at inBuf + SHTP_HDR_LEN. Transfers are read
+    // straight into it (see shtp_service), so there is no separate
+    // transfer buffer.
+    uint8_t  inBuf[SHTP_HDR_LEN + SH2_HAL_MAX_PAYLOAD_IN];
     
     // What stage of advertisement processing are we in.
     advert_phase_t advertPhase;
@@ -541,8 +543,12 @@ static void shtpCmdListener(void *cookie, uint8_t *payload, uint16_t len, uint32
     }
 }
 
-static void rxAssemble(shtp_t *pShtp, uint8_t *in, uint16_t len, uint32_t t_us)
+// Process a transfer read to inBuf + at (0, or the payload cursor while an
+// assembly is in progress). In the second case the transfer header covers
+// the last SHTP_HDR_LEN payload bytes, passed in saved.
+static void rxAssemble(shtp_t *pShtp, uint16_t at, const uint8_t *saved, uint16_t len, uint32_t t_us)
 {
+    uint8_t *in = pShtp->inBuf + at;
     uint16_t payloadLen;
     bool continuation;
     uint8_t chan = 0;
@@ -550,15 +556,21 @@ static void rxAssemble(shtp_t *pShtp, uint8_t *in, uint16_t len, uint32_t t_us)
 
     // discard invalid short fragments
     if (len < SHTP_HDR_LEN) {
+        if (at > 0) {
+            memcpy(in, saved, SHTP_HDR_LEN);
+        }
         pShtp->shortFragments++;
         return;
     }
     
-    // Interpret header fields
+    // Interpret header fields, then put back the payload bytes under them
     payloadLen = (in[0] + (in[1] << 8)) & (~0x8000);
     continuation = ((in[1] & 0x80) != 0);
     chan = in[2];
     seq = in[3];
+    if (at > 0) {
+        memcpy(in, saved, SHTP_HDR_LEN);
+    }
     
     if (payloadLen < SHTP_HDR_LEN) {
       pShtp->shortFragments++;
@@ -592,7 +604,7 @@ static void rxAssemble(shtp_t *pShtp, uint8_t *in, uint16_t len, uint32_t t_us)
     }
 
     if (pShtp->inRemaining == 0) {
-        if (payloadLen > sizeof(pShtp->inPayload)) {
+        if (payloadLen > SH2_HAL_MAX_PAYLOAD_IN) {
             // Error: This payload won't fit! Discard it.
             pShtp->tooLargePayloads++;
             
@@ -617,7 +629,11 @@ static void rxAssemble(shtp_t *pShtp, uint8_t *in, uint16_t len, uint32_t t_us)
         // Only use the valid portion of the transfer
         len = payloadLen;
     }
-    memcpy(pShtp->inPayload + pShtp->inCursor, in+SHTP_HDR_LEN, len-SHTP_HDR_LEN);
+    // A continuation was read in place. A new payload read after a
+    // discarded assembly moves down to the start of the buffer.
+    if (pShtp->inCursor != at) {
+        memmove(pShtp->inBuf + SHTP_HDR_LEN + pShtp->inCursor, in+SHTP_HDR_LEN, len-SHTP_HDR_LEN);
+    }
     pShtp->inCursor += len-SHTP_HDR_LEN;
     pShtp->inRemaining = payloadLen - len;
 
@@ -627,7 +643,7 @@ static void rxAssemble(shtp_t *pShtp, uint8_t *in, uint16_t len, uint32_t t_us)
         // Call callback if there is one.
         if (pShtp->chan[chan].callback != 0) {
             pShtp->chan[chan].callback(pShtp->chan[chan].cookie,
-                                       pShtp->inPayload, pShtp->inCursor,
+                                       pShtp->inBuf + SHTP_HDR_LEN, pShtp->inCursor,
                                        pShtp->inTimestamp);
         }
     }
@@ -812,8 +828,15 @@ void shtp_service(void *pInstance)
         }
     }
 
-    int len = pShtp->pHal->read(pShtp->pHal, pShtp->inTransfer, sizeof(pShtp->inTransfer), &t_us);
+    // While a payload is being assembled, read the next transfer to the
+    // payload cursor: its header overwrites the last SHTP_HDR_LEN payload
+    // bytes, which are saved here and restored by rxAssemble().
+    uint16_t at = pShtp->inRemaining ? pShtp->inCursor : 0;
+    uint8_t saved[SHTP_HDR_LEN];
+    memcpy(saved, pShtp->inBuf + at, SHTP_HDR_LEN);
+    
+    int len = pShtp->pHal->read(pShtp->pHal, pShtp->inBuf + at, sizeof(pShtp->inBuf) - at, &t_us);
     if (len) {
-        rxAssemble(pShtp, pShtp->inTransfer, len, t_us);
+        rxAssemble(pShtp, at, saved, len, t_us);
     }
 }
@@ -0,0 +1,95 @@
+// shtp_capture.c
+// Raw SHTP transfer capture implementation
+
+#include "shtp_capture.h"
+#if SHTP_CAPTURE_SINK == SHTP_CAPTURE_SINK_UART
+#include "STM32L432KC_UART.h"
+#else
+#include "STM32L432KC_RTT.h"
+#endif
+#include <stdint.h>
+
+// Frame ring (head and tail are free-running byte counts)
+static uint8_t ring[SHTP_CAPTURE_RING_LEN];
+static uint32_t head = 0;
+static uint32_t tail = 0;
+static uint8_t seq = 0;
+static uint32_t dropped = 0;
+
+// Clear the ring and open the output
+void ShtpCapture_Init(void) {
+    head = 0;
+    tail = 0;
+    seq = 0;
+    dropped = 0;
+#if SHTP_CAPTURE_SINK == SHTP_CAPTURE_SINK_UART
+    UART_Init(SHTP_CAPTURE_UART_BAUD);
+#endif
+}
+
+// Copy bytes into the ring at the head, wrapping as needed
+static void ring_put(const uint8_t *data, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        ring[(head + i) & (SHTP_CAPTURE_RING_LEN - 1)] = data[i];
+    }
+    head += len;
+}
+
+// Append one transfer as a frame
+// A frame that does not fit is dropped whole; its sequence number is still
+// used so the decoder sees the gap.
+void ShtpCapture_Record(uint8_t dir, const uint8_t *data, uint16_t len, uint32_t t_us) {
+    uint32_t frameLen = SHTP_CAPTURE_HDR_LEN + len;
+    uint8_t s = seq++;
+    
+    if (len >= SHTP_CAPTURE_WRITE || frameLen > SHTP_CAPTURE_RING_LEN - (head - tail)) {
+        dropped++;
+        return;
+    }
+    
+    uint16_t lenField = len | (dir == SHTP_CAPTURE_DIR_WRITE ? SHTP_CAPTURE_WRITE : 0);
+    uint8_t hdr[SHTP_CAPTURE_HDR_LEN] = {
+        SHTP_CAPTURE_SYNC, s,
+        (uint8_t)(lenField & 0xFF), (uint8_t)(lenField >> 8),
+        (uint8_t)(t_us & 0xFF), (uint8_t)((t_us >> 8) & 0xFF),
+        (uint8_t)((t_us >> 16) & 0xFF), (uint8_t)(t_us >> 24)
+    };
+    ring_put(hdr, SHTP_CAPTURE_HDR_LEN);
+    ring_put(data, len);
+}
+
+// Write a contiguous run of ring bytes to the output
+static void sink_write(const uint8_t *data, uint32_t len) {
+#if SHTP_CAPTURE_SINK == SHTP_CAPTURE_SINK_UART
+    for (uint32_t i = 0; i < len; i++) {
+        UART_PrintChar((char)data[i]);
+    }
+#else
+    RTT_Write(data, len);
+#endif
+}
+
+// Stream all pending frames (call from the main loop, not from the HAL)
+void ShtpCapture_Flush(void) {
+    uint32_t pending = head - tail;
+    if (pending == 0) {
+        return;
+    }
+    
+    // Ring may wrap: send up to the end of the buffer, then the rest
+    uint32_t start = tail & (SHTP_CAPTURE_RING_LEN - 1);
+    uint32_t first = SHTP_CAPTURE_RING_LEN - start;
+    if (first > pending) {
+        first = pending;
+    }
+    sink_write(&ring[start], first);
+    if (pending > first) {
+        sink_write(&ring[0], pending - first);
+    }
+    tail += pending;
+}
+
+// Frames lost to a full ring since init
+uint32_t ShtpCapture_Dropped(void) {
+    return dropped;
+}
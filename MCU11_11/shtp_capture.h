@@ -0,0 +1,61 @@
+// shtp_capture.h
+// Raw SHTP transfer capture for the BNO085 SPI HAL
+//
+// Records every transfer spihal_read()/spihal_write() complete, with a
+// microsecond timestamp, as a length-prefixed frame in a RAM ring.
+// ShtpCapture_Flush() streams the pending frames out over RTT or USART2.
+// host/sim_bno085.c replays a capture into the unmodified sh2/shtp stack.
+//
+// Frame layout (little-endian, 8-byte header):
+//   [0]    0xA5 sync (never appears in the ASCII debug text around it)
+//   [1]    Sequence number (a gap means frames were dropped on overflow)
+//   [2..3] Length of data; bit 15 set for writes (host to hub)
+//   [4..7] Timestamp in microseconds
+//   [8..]  Transfer bytes, SHTP header included
+
+#ifndef SHTP_CAPTURE_H
+#define SHTP_CAPTURE_H
+
+#include <stdint.h>
+
+// Enable transfer capture (disabled: the HAL hooks compile to nothing)
+#ifndef SHTP_CAPTURE
+#define SHTP_CAPTURE  0
+#endif
+
+// Output for captured frames
+#define SHTP_CAPTURE_SINK_RTT   0  // Binary frames interleaved with the RTT text
+#define SHTP_CAPTURE_SINK_UART  1  // USART2 (PA2), nothing else on the line
+
+#ifndef SHTP_CAPTURE_SINK
+#define SHTP_CAPTURE_SINK  SHTP_CAPTURE_SINK_RTT
+#endif
+
+#define SHTP_CAPTURE_UART_BAUD  921600
+
+// RAM ring for frames waiting to be streamed (power of 2)
+#ifndef SHTP_CAPTURE_RING_LEN
+#define SHTP_CAPTURE_RING_LEN  4096
+#endif
+
+#define SHTP_CAPTURE_SYNC      0xA5
+#define SHTP_CAPTURE_HDR_LEN   8
+#define SHTP_CAPTURE_WRITE     0x8000  // Length flag: host-to-hub transfer
+
+// Transfer direction for ShtpCapture_Record()
+#define SHTP_CAPTURE_DIR_READ   0
+#define SHTP_CAPTURE_DIR_WRITE  1
+
+#if SHTP_CAPTURE
+#define SHTP_CAPTURE_RECORD(dir, data, len, t_us)  ShtpCapture_Record(dir, data, len, t_us)
+#else
+#define SHTP_CAPTURE_RECORD(dir, data, len, t_us)  ((void)0)
+#endif
+
+// Function prototypes
+void ShtpCapture_Init(void);
+void ShtpCapture_Record(uint8_t dir, const uint8_t *data, uint16_t len, uint32_t t_us);
+void ShtpCapture_Flush(void);
+uint32_t ShtpCapture_Dropped(void);
+
+#endif // SHTP_CAPTURE_H
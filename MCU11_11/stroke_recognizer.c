@@ -0,0 +1,255 @@
+// stroke_recognizer.c
+// Stroke-shape recognition implementation (fixed-point DTW)
+
+#include "stroke_recognizer.h"
+#include "stroke_templates.h"
+#include "STM32L432KC_DWT.h"
+#include "STM32L432KC_RTT.h"  // For debug output (RTT)
+#include <stddef.h>  // For NULL definition
+
+// Stroke names for debug output (indexed by stroke type)
+static const char *strokeNames[STROKE_NUM_TYPES] = {
+    "NORMAL", "ACCENT", "RIMSHOT", "GHOST"
+};
+
+// Append one gyro_y sample to the history ring
+void StrokeHistory_Push(StrokeHistory_t *history, int16_t sample) {
+    history->samples[history->head] = sample;
+    history->head = (history->head + 1) & (STROKE_HISTORY_LEN - 1);
+    if (history->count < STROKE_HISTORY_LEN) {
+        history->count++;
+    }
+}
+
+// Copy the newest n samples to window[], oldest first
+// Returns the number of samples copied (less than n if history is short)
+uint16_t StrokeHistory_GetWindow(const StrokeHistory_t *history, int16_t *window, uint16_t n) {
+    return StrokeHistory_GetWindowAt(history, window, n, 0);
+}
+
+// Copy the n samples that end age samples before the newest, oldest first
+// Returns the number of samples copied (less than n if history is short)
+uint16_t StrokeHistory_GetWindowAt(const StrokeHistory_t *history, int16_t *window, uint16_t n, uint16_t age) {
+    if (age >= history->count) {
+        return 0;
+    }
+    if (n > history->count - age) {
+        n = history->count - age;
+    }
+    
+    uint16_t index = (history->head - age - n) & (STROKE_HISTORY_LEN - 1);
+    for (uint16_t i = 0; i < n; i++) {
+        window[i] = history->samples[index];
+        index = (index + 1) & (STROKE_HISTORY_LEN - 1);
+    }
+    return n;
+}
+
+// Resample an n-sample window to STROKE_TEMPLATE_LEN points
+// Longer windows are box-averaged (one bin per output point), shorter ones
+// repeat the nearest earlier sample. Cost is O(n + STROKE_TEMPLATE_LEN).
+void StrokeRecognizer_Resample(const int16_t *window, uint16_t n, int16_t out[STROKE_TEMPLATE_LEN]) {
+    if (n == 0) {
+        for (int k = 0; k < STROKE_TEMPLATE_LEN; k++) {
+            out[k] = 0;
+        }
+        return;
+    }
+    
+    for (uint32_t k = 0; k < STROKE_TEMPLATE_LEN; k++) {
+        uint32_t start = k * n / STROKE_TEMPLATE_LEN;
+        uint32_t end = (k + 1) * n / STROKE_TEMPLATE_LEN;
+        
+        if (end <= start) {
+            out[k] = window[start];
+            continue;
+        }
+        
+        int32_t sum = 0;
+        for (uint32_t i = start; i < end; i++) {
+            sum += window[i];
+        }
+        out[k] = (int16_t)(sum / (int32_t)(end - start));
+    }
+}
+
+// Banded DTW distance between two STROKE_TEMPLATE_LEN sequences
+// Local cost is |a[i] - b[j]|; steps are (1,0), (0,1) and (1,1).
+// Only cells with |i - j| <= band are evaluated (Sakoe-Chiba band).
+// Every warping path crosses every row, so once a whole row is >= abandonAt
+// the final distance must be too: return STROKE_DTW_ABANDONED immediately.
+uint32_t StrokeRecognizer_Distance(const int16_t *a, const int16_t *b, uint16_t band, uint32_t abandonAt) {
+    uint32_t rows[2][STROKE_TEMPLATE_LEN];
+    uint32_t *prev = rows[0];
+    uint32_t *curr = rows[1];
+    
+    for (int i = 0; i < STROKE_TEMPLATE_LEN; i++) {
+        int lo = (i > band) ? i - band : 0;
+        int hi = (i + band < STROKE_TEMPLATE_LEN - 1) ? i + band : STROKE_TEMPLATE_LEN - 1;
+        uint32_t rowMin = STROKE_DTW_ABANDONED;
+        
+        for (int j = 0; j < STROKE_TEMPLATE_LEN; j++) {
+            if (j < lo || j > hi) {
+                curr[j] = STROKE_DTW_ABANDONED;
+                continue;
+            }
+            
+            int32_t diff = (int32_t)a[i] - (int32_t)b[j];
+            uint32_t cost = (uint32_t)(diff < 0 ? -diff : diff);
+            
+            uint32_t best;
+            if (i == 0 && j == 0) {
+                best = 0;
+            } else {
+                best = STROKE_DTW_ABANDONED;
+                if (i > 0 && prev[j] < best) best = prev[j];
+                if (j > 0 && curr[j - 1] < best) best = curr[j - 1];
+                if (i > 0 && j > 0 && prev[j - 1] < best) best = prev[j - 1];
+            }
+            
+            curr[j] = (best == STROKE_DTW_ABANDONED) ? STROKE_DTW_ABANDONED : best + cost;
+            if (curr[j] < rowMin) {
+                rowMin = curr[j];
+            }
+        }
+        
+        if (rowMin >= abandonAt) {
+            return STROKE_DTW_ABANDONED;
+        }
+        
+        uint32_t *tmp = prev;
+        prev = curr;
+        curr = tmp;
+    }
+    
+    return prev[STROKE_TEMPLATE_LEN - 1];
+}
+
+// Classify an n-sample gyro_y window (oldest first, ending at the hit)
+// Templates are tried in order with the best distance so far as the abandon
+// bound, so later templates usually stop after a few rows.
+// Returns the stroke type, or STROKE_UNKNOWN if nothing is within
+// STROKE_DTW_MAX_DISTANCE. *distance (optional) receives the best distance.
+uint8_t StrokeRecognizer_Classify(const int16_t *window, uint16_t n, uint32_t *distance) {
+    int16_t resampled[STROKE_TEMPLATE_LEN];
+    uint32_t bestDistance = STROKE_DTW_MAX_DISTANCE;
+    uint8_t bestType = STROKE_UNKNOWN;
+    
+    StrokeRecognizer_Resample(window, n, resampled);
+    
+    for (int t = 0; t < STROKE_NUM_TEMPLATES; t++) {
+        uint32_t d = StrokeRecognizer_Distance(resampled, stroke_templates[t].samples,
+                                               STROKE_DTW_BAND, bestDistance);
+        if (d < bestDistance) {
+            bestDistance = d;
+            bestType = stroke_templates[t].strokeType;
+        }
+    }
+    
+    if (distance != NULL) {
+        *distance = (bestType == STROKE_UNKNOWN) ? STROKE_DTW_ABANDONED : bestDistance;
+    }
+    return bestType;
+}
+
+// Get printable stroke name
+const char *StrokeRecognizer_Name(uint8_t strokeType) {
+    if (strokeType < STROKE_NUM_TYPES) {
+        return strokeNames[strokeType];
+    }
+    return "UNKNOWN";
+}
+
+// Build a noisy copy of template t at n samples (linear interpolation)
+static void make_test_window(int t, uint16_t n, uint32_t *seed, int16_t *window) {
+    const int16_t *s = stroke_templates[t].samples;
+    
+    for (uint16_t i = 0; i < n; i++) {
+        // Position in template, 8.8 fixed point
+        uint32_t pos = (n > 1) ? ((uint32_t)i * (STROKE_TEMPLATE_LEN - 1) * 256) / (n - 1) : 0;
+        uint32_t k = pos >> 8;
+        int32_t frac = pos & 0xFF;
+        int32_t v = s[k];
+        if (k + 1 < STROKE_TEMPLATE_LEN) {
+            v += ((s[k + 1] - s[k]) * frac) >> 8;
+        }
+        
+        // +-200 (0.2 rad/s) of uniform noise from an LCG
+        *seed = *seed * 1664525u + 1013904223u;
+        v += (int32_t)((*seed >> 16) % 401) - 200;
+        window[i] = (int16_t)v;
+    }
+}
+
+// Report one input rate: resample + classify cycles, and unbanded full DTW for comparison
+static void report_rate(uint16_t rateHz, uint16_t n, int16_t *window) {
+    uint32_t min = 0xFFFFFFFF, max = 0, total = 0;
+    uint32_t full_min = 0xFFFFFFFF, full_max = 0, full_total = 0;
+    uint32_t calls = 0, correct = 0;
+    uint32_t seed = 12345;
+    
+    for (int rep = 0; rep < 8; rep++) {
+        for (int t = 0; t < STROKE_NUM_TEMPLATES; t++) {
+            make_test_window(t, n, &seed, window);
+            
+            uint32_t start = DWT_GET_CYCLES();
+            uint8_t type = StrokeRecognizer_Classify(window, n, NULL);
+            uint32_t cycles = DWT_GET_CYCLES() - start;
+            
+            // Reference: every cell, no abandoning
+            int16_t resampled[STROKE_TEMPLATE_LEN];
+            start = DWT_GET_CYCLES();
+            StrokeRecognizer_Resample(window, n, resampled);
+            for (int u = 0; u < STROKE_NUM_TEMPLATES; u++) {
+                (void)StrokeRecognizer_Distance(resampled, stroke_templates[u].samples,
+                                                STROKE_TEMPLATE_LEN, STROKE_DTW_ABANDONED);
+            }
+            uint32_t full_cycles = DWT_GET_CYCLES() - start;
+            
+            if (cycles < min) min = cycles;
+            if (cycles > max) max = cycles;
+            if (full_cycles < full_min) full_min = full_cycles;
+            if (full_cycles > full_max) full_max = full_cycles;
+            total += cycles;
+            full_total += full_cycles;
+            calls++;
+            
+            if (type == stroke_templates[t].strokeType) {
+                correct++;
+            }
+        }
+    }
+    
+    DEBUG_PRINT("[Stroke] ");
+    DEBUG_PRINT_INT(rateHz);
+    DEBUG_PRINT("Hz, ");
+    DEBUG_PRINT_INT(n);
+    DEBUG_PRINT(" samples: band+abandon cycles min/avg/max=");
+    DEBUG_PRINT_INT(min);
+    DEBUG_PRINT("/");
+    DEBUG_PRINT_INT(total / calls);
+    DEBUG_PRINT("/");
+    DEBUG_PRINT_INT(max);
+    DEBUG_PRINT(" full DTW=");
+    DEBUG_PRINT_INT(full_min);
+    DEBUG_PRINT("/");
+    DEBUG_PRINT_INT(full_total / calls);
+    DEBUG_PRINT("/");
+    DEBUG_PRINT_INT(full_max);
+    DEBUG_PRINT(" correct ");
+    DEBUG_PRINT_INT(correct);
+    DEBUG_PRINT("/");
+    DEBUG_PRINT_INT(calls);
+    DEBUG_PRINT_NEWLINE();
+}
+
+// Measure per-hit recognition cost for 100Hz and 1kHz gyro input
+// Uses noisy copies of the stored templates as test strokes.
+void StrokeRecognizer_ReportCycles(void) {
+    static int16_t window[STROKE_HISTORY_LEN];
+    
+    DWT_Init();
+    
+    report_rate(100, STROKE_WINDOW_MS * 100 / 1000, window);
+    report_rate(1000, STROKE_WINDOW_MS * 1000 / 1000, window);
+}
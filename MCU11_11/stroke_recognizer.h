@@ -0,0 +1,74 @@
+// stroke_recognizer.h
+// Stroke-shape recognition for invisible drum system
+//
+// Tells stroke types (normal, accent, rimshot, ghost) apart by matching the
+// gyro_y samples leading up to a hit against stored templates with dynamic
+// time warping (DTW). Everything is fixed point; the input window is first
+// resampled to STROKE_TEMPLATE_LEN points, so the per-hit cost is the same at
+// any sensor rate. A Sakoe-Chiba band and early abandoning bound the worst case.
+
+#ifndef STROKE_RECOGNIZER_H
+#define STROKE_RECOGNIZER_H
+
+#include <stdint.h>
+
+// Stroke type IDs
+#define STROKE_NORMAL     0
+#define STROKE_ACCENT     1
+#define STROKE_RIMSHOT    2
+#define STROKE_GHOST      3
+#define STROKE_NUM_TYPES  4
+#define STROKE_UNKNOWN    255
+
+// Template length in samples (window is resampled to this length before DTW)
+#define STROKE_TEMPLATE_LEN  16
+
+// Sakoe-Chiba band half-width: path may stray at most this many samples off the diagonal
+#define STROKE_DTW_BAND  3
+
+// Reject a match whose DTW distance (sum of |gyro_y| differences along the
+// warping path) is this large or larger; also the initial early-abandon bound
+#define STROKE_DTW_MAX_DISTANCE  20000
+
+// Returned by StrokeRecognizer_Distance() when the match was abandoned
+#define STROKE_DTW_ABANDONED  0xFFFFFFFFu
+
+// Gyro input rate and the stretch of history matched against the templates
+#ifndef STROKE_INPUT_RATE_HZ
+#define STROKE_INPUT_RATE_HZ  100  // Must match the SH2_GYROSCOPE_CALIBRATED report interval
+#endif
+#define STROKE_WINDOW_MS       160
+#define STROKE_WINDOW_SAMPLES  (STROKE_WINDOW_MS * STROKE_INPUT_RATE_HZ / 1000)
+
+// History ring size in samples (power of 2, enough for the window at 1kHz)
+#define STROKE_HISTORY_LEN  256
+
+// Run StrokeRecognizer_ReportCycles() once at boot
+#ifndef STROKE_RECOGNIZER_BENCHMARK
+#define STROKE_RECOGNIZER_BENCHMARK  0
+#endif
+
+// Stored stroke template
+typedef struct {
+    uint8_t strokeType;
+    int16_t samples[STROKE_TEMPLATE_LEN];  // gyro_y, rad/s * 1000, oldest first
+} StrokeTemplate_t;
+
+// Ring buffer of recent gyro_y samples (the detector's event history)
+typedef struct {
+    int16_t samples[STROKE_HISTORY_LEN];
+    uint16_t head;   // Next write position
+    uint16_t count;  // Valid samples, saturates at STROKE_HISTORY_LEN
+} StrokeHistory_t;
+
+// Function prototypes
+void StrokeHistory_Push(StrokeHistory_t *history, int16_t sample);
+uint16_t StrokeHistory_GetWindow(const StrokeHistory_t *history, int16_t *window, uint16_t n);
+uint16_t StrokeHistory_GetWindowAt(const StrokeHistory_t *history, int16_t *window, uint16_t n, uint16_t age);
+void StrokeRecognizer_Resample(const int16_t *window, uint16_t n, int16_t out[STROKE_TEMPLATE_LEN]);
+uint32_t StrokeRecognizer_Distance(const int16_t *a, const int16_t *b, uint16_t band, uint32_t abandonAt);
+uint8_t StrokeRecognizer_Classify(const int16_t *window, uint16_t n, uint32_t *distance);
+const char *StrokeRecognizer_Name(uint8_t strokeType);
+void StrokeRecognizer_ReportCycles(void);
+
+#endif // STROKE_RECOGNIZER_H
@@ -0,0 +1,30 @@
+// stroke_templates.h
+// Stroke templates for stroke_recognizer.c
+//
+// Hand-drawn starting shapes: gyro_y over the 160 ms before the hit threshold
+// is crossed, resampled to STROKE_TEMPLATE_LEN points. Replace them with
+// averages of recorded strokes using host/make_stroke_templates.py.
+
+#ifndef STROKE_TEMPLATES_H
+#define STROKE_TEMPLATES_H
+
+#include "stroke_recognizer.h"
+
+#define STROKE_NUM_TEMPLATES  4
+
+static const StrokeTemplate_t stroke_templates[STROKE_NUM_TEMPLATES] = {
+    // Normal: small backswing, steady drop through the threshold
+    { STROKE_NORMAL,  {   13,   46,  120,  242,  366,  389,  231,  -81,
+                        -452, -805,-1134,-1467,-1830,-2237,-2693,-3199 } },
+    // Accent: large backswing, fast deep drop
+    { STROKE_ACCENT,  {   15,   69,  232,  596, 1166, 1714, 1848, 1359,
+                         436, -547,-1384,-2097,-2800,-3577,-4471,-5499 } },
+    // Rimshot: stick held still, late wrist snap
+    { STROKE_RIMSHOT, {    0,    0,    4,   18,   53,  118,  193,  222,
+                         140,  -82, -443, -955,-1685,-2749,-4295,-6499 } },
+    // Ghost: no backswing, slow shallow drop that barely crosses the threshold
+    { STROKE_GHOST,   {    0,  -79, -196, -333, -484, -647, -820,-1002,
+                       -1192,-1389,-1593,-1804,-2020,-2241,-2468,-2700 } },
+};
+
+#endif // STROKE_TEMPLATES_H
@@ -0,0 +1,81 @@
+// yaw_drift.c
+// Yaw drift estimation implementation
+
+#include "yaw_drift.h"
+
+#define ABS32(x) ((x) < 0 ? -(x) : (x))
+
+// Wrap an angle difference into -180..180 degrees
+static float wrap180(float deg) {
+    while (deg > 180.0f) deg -= 360.0f;
+    while (deg < -180.0f) deg += 360.0f;
+    return deg;
+}
+
+// Forget the learned resting yaw (call whenever yawOffset is set by hand)
+void YawDrift_Reset(YawDrift_t *drift) {
+    drift->stillCount = 0;
+    drift->learnCount = 0;
+    drift->learnSum = 0.0f;
+    drift->learnBase = 0.0f;
+    drift->restYaw = 0.0f;
+    drift->learned = false;
+    drift->totalCorrection = 0.0f;
+}
+
+// Update stillness from a calibrated gyro sample (rad/s * 1000)
+void YawDrift_AddGyro(YawDrift_t *drift, int16_t gx, int16_t gy, int16_t gz) {
+    int32_t speed = ABS32((int32_t)gx) + ABS32((int32_t)gy) + ABS32((int32_t)gz);
+    
+    if (speed < YAW_DRIFT_STILL_GYRO) {
+        if (drift->stillCount < YAW_DRIFT_STILL_SAMPLES) {
+            drift->stillCount++;
+        }
+    } else {
+        drift->stillCount = 0;
+    }
+}
+
+// True once the stick has been still for YAW_DRIFT_STILL_SAMPLES
+bool YawDrift_IsStill(const YawDrift_t *drift) {
+    return drift->stillCount >= YAW_DRIFT_STILL_SAMPLES;
+}
+
+// Feed an offset-corrected yaw (0-360 degrees)
+// Returns the correction to add to yawOffset (degrees, usually 0 or tiny)
+float YawDrift_AddYaw(YawDrift_t *drift, float yaw) {
+    if (!YawDrift_IsStill(drift)) {
+        return 0.0f;
+    }
+    
+    // First rests after a reset define where the stick normally rests
+    if (!drift->learned) {
+        if (drift->learnCount == 0) {
+            drift->learnBase = yaw;
+        }
+        
+        // Skip rests away from the first one while learning
+        float offset = wrap180(yaw - drift->learnBase);
+        if (offset > YAW_DRIFT_MAX_ERROR || offset < -YAW_DRIFT_MAX_ERROR) {
+            return 0.0f;
+        }
+        drift->learnSum += offset;
+        drift->learnCount++;
+        
+        if (drift->learnCount >= YAW_DRIFT_LEARN_SAMPLES) {
+            drift->restYaw = drift->learnBase + drift->learnSum / (float)drift->learnCount;
+            drift->learned = true;
+        }
+        return 0.0f;
+    }
+    
+    // Resting somewhere else (e.g. hand on the knee): not a drift sample
+    float error = wrap180(yaw - drift->restYaw);
+    if (error > YAW_DRIFT_MAX_ERROR || error < -YAW_DRIFT_MAX_ERROR) {
+        return 0.0f;
+    }
+    
+    float correction = error * YAW_DRIFT_GAIN;
+    drift->totalCorrection += correction;
+    return correction;
+}
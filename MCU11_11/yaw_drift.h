@@ -0,0 +1,47 @@
+// yaw_drift.h
+// Yaw drift estimation for the Game Rotation Vector
+//
+// The Game Rotation Vector has no magnetometer reference, so its yaw slowly
+// drifts and the drum zones rotate away from the kit. Between strokes the
+// stick rests at roughly the same spot. The estimator learns that resting yaw
+// right after the yaw is zeroed, and afterwards nudges yawOffset so that later
+// rests line up with it again. Rests far from the learned spot are ignored.
+
+#ifndef YAW_DRIFT_H
+#define YAW_DRIFT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Stillness: gyro L1 norm (rad/s * 1000, x+y+z) below this for YAW_DRIFT_STILL_SAMPLES
+#define YAW_DRIFT_STILL_GYRO     150
+#define YAW_DRIFT_STILL_SAMPLES   50  // 0.5 s at 100Hz
+
+// Orientation samples averaged to learn the resting yaw after a reset
+#define YAW_DRIFT_LEARN_SAMPLES  200
+
+// Rests further than this from the learned resting yaw are not used (degrees)
+#define YAW_DRIFT_MAX_ERROR  20.0f
+
+// Fraction of the rest error corrected per still orientation sample
+// (time constant ~10 s of stillness at 100Hz)
+#define YAW_DRIFT_GAIN  0.001f
+
+// Drift estimator state
+typedef struct {
+    uint16_t stillCount;   // Consecutive still gyro samples
+    uint16_t learnCount;   // Still orientation samples averaged so far
+    float learnSum;        // Sum of yaw errors relative to learnBase
+    float learnBase;       // First yaw seen while learning
+    float restYaw;         // Learned resting yaw (offset-corrected frame)
+    bool learned;
+    float totalCorrection; // Sum of corrections since reset (degrees, for debug)
+} YawDrift_t;
+
+// Function prototypes
+void YawDrift_Reset(YawDrift_t *drift);
+void YawDrift_AddGyro(YawDrift_t *drift, int16_t gx, int16_t gy, int16_t gz);
+float YawDrift_AddYaw(YawDrift_t *drift, float yaw);
+bool YawDrift_IsStill(const YawDrift_t *drift);
+
+#endif // YAW_DRIFT_H